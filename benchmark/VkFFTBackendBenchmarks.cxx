@@ -0,0 +1,952 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         https://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+// Benchmark the eight Vk FFT filters against the ITK CPU FFT backends.
+//
+// Sizes are swept over powers of two, 7-smooth sizes and primes for each
+// precision and image dimension. Each case is timed cold (a new filter
+// instance, including backend setup and plan creation) and warm (repeated
+// updates of one filter instance). Medians and percentiles are reported
+// as JSON or CSV. Inputs are generated from a fixed seed so that runs are
+// reproducible.
+//
+// Given a baseline CSV written by an earlier run on the same machine
+// class, warm medians are compared per configuration and slowdowns
+// beyond a tolerance are reported as regressions.
+
+#include "itkVkComplexToComplex1DFFTImageFilter.h"
+#include "itkVkComplexToComplexFFTImageFilter.h"
+#include "itkVkForward1DFFTImageFilter.h"
+#include "itkVkForwardFFTImageFilter.h"
+#include "itkVkGlobalConfiguration.h"
+#include "itkVkHalfHermitianToRealInverseFFTImageFilter.h"
+#include "itkVkInverse1DFFTImageFilter.h"
+#include "itkVkInverseFFTImageFilter.h"
+#include "itkVkRealToHalfHermitianForwardFFTImageFilter.h"
+
+#include "itkVnlComplexToComplex1DFFTImageFilter.h"
+#include "itkVnlComplexToComplexFFTImageFilter.h"
+#include "itkVnlForward1DFFTImageFilter.h"
+#include "itkVnlForwardFFTImageFilter.h"
+#include "itkVnlHalfHermitianToRealInverseFFTImageFilter.h"
+#include "itkVnlInverse1DFFTImageFilter.h"
+#include "itkVnlInverseFFTImageFilter.h"
+#include "itkVnlRealToHalfHermitianForwardFFTImageFilter.h"
+
+#include "itkConfigure.h"
+#if defined(ITK_USE_FFTWF) && defined(ITK_USE_FFTWD)
+#  define VKFFTBACKEND_BENCHMARK_FFTW
+#  include "itkFFTWComplexToComplex1DFFTImageFilter.h"
+#  include "itkFFTWComplexToComplexFFTImageFilter.h"
+#  include "itkFFTWForward1DFFTImageFilter.h"
+#  include "itkFFTWForwardFFTImageFilter.h"
+#  include "itkFFTWHalfHermitianToRealInverseFFTImageFilter.h"
+#  include "itkFFTWInverse1DFFTImageFilter.h"
+#  include "itkFFTWInverseFFTImageFilter.h"
+#  include "itkFFTWRealToHalfHermitianForwardFFTImageFilter.h"
+#endif
+
+#include "itkImage.h"
+#include "itkImageRegionIterator.h"
+#include "itkMersenneTwisterRandomVariateGenerator.h"
+#include "itkMultiThreaderBase.h"
+#include "itkVersion.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace
+{
+struct BenchmarkOptions
+{
+  std::string   outputFileName{};
+  std::string   format{ "json" };
+  std::string   precision{ "all" };
+  std::string   backend{ "all" };
+  std::string   filter{ "all" };
+  std::string   family{ "all" };
+  unsigned int  dimension{ 0 }; // 0 selects all of 1, 2 and 3
+  unsigned int  coldRuns{ 3 };
+  unsigned int  warmRuns{ 10 };
+  unsigned int  threads{ 0 }; // 0 keeps the ITK default
+  uint64_t      deviceID{ 0 };
+  uint64_t      maxPixels{ uint64_t{ 1 } << 24 };
+  uint32_t seed{ 20240501 };
+  bool          profiling{ false };
+  std::string   baselineFileName{};
+  double        tolerance{ 0.25 };     // Allowed fractional slowdown of warm medians
+  double        minimumDelta{ 1.0e-4 }; // Slowdowns below this many seconds are timing noise
+  bool          failOnRegression{ false };
+};
+
+struct SizeCase
+{
+  std::string                     family;
+  std::vector<itk::SizeValueType> size;
+
+  uint64_t
+  GetNumberOfPixels() const
+  {
+    uint64_t pixels{ 1 };
+    for (const auto side : size)
+    {
+      pixels *= side;
+    }
+    return pixels;
+  }
+
+  std::string
+  GetSizeString() const
+  {
+    std::ostringstream sizeString;
+    for (size_t dim = 0; dim < size.size(); ++dim)
+    {
+      sizeString << (dim > 0 ? "x" : "") << size[dim];
+    }
+    return sizeString.str();
+  }
+};
+
+struct BenchmarkResult
+{
+  std::string         filter;
+  std::string         backend;
+  std::string         precision;
+  unsigned int        dimension{ 0 };
+  SizeCase            sizeCase;
+  std::string         status{ "ok" };
+  std::string         message{};
+  std::vector<double> coldSeconds{};
+  std::vector<double> warmSeconds{};
+  uint64_t            warmConfigurations{ 0 };   // Vk only: backend reconfigurations during warm runs
+  double              warmKernelSeconds{ -1.0 }; // Vk only: mean device kernel time when profiling
+};
+
+/** Percentile of a sample with linear interpolation between order statistics. */
+double
+Percentile(std::vector<double> values, double percentile)
+{
+  if (values.empty())
+  {
+    return 0.0;
+  }
+  std::sort(values.begin(), values.end());
+  const double position{ percentile / 100.0 * static_cast<double>(values.size() - 1) };
+  const auto   lower{ static_cast<size_t>(position) };
+  const size_t upper{ std::min(lower + 1, values.size() - 1) };
+  return values[lower] + (position - static_cast<double>(lower)) * (values[upper] - values[lower]);
+}
+
+double
+Mean(const std::vector<double> & values)
+{
+  double sum{ 0.0 };
+  for (const double value : values)
+  {
+    sum += value;
+  }
+  return values.empty() ? 0.0 : sum / static_cast<double>(values.size());
+}
+
+bool
+IsPrime(itk::SizeValueType n)
+{
+  if (n < 2)
+  {
+    return false;
+  }
+  for (itk::SizeValueType factor = 2; factor * factor <= n; ++factor)
+  {
+    if (n % factor == 0)
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool
+IsSevenSmoothWithSeven(itk::SizeValueType n)
+{
+  if (n % 7 != 0)
+  {
+    return false;
+  }
+  for (const itk::SizeValueType factor : { 2, 3, 5, 7 })
+  {
+    while (n % factor == 0)
+    {
+      n /= factor;
+    }
+  }
+  return n == 1;
+}
+
+/** Side lengths near 2^exponent: the power of two itself, the largest
+ *  7-smooth size with a factor of 7 below it (not supported by the
+ *  radix-2/3/5 CPU implementations), and the largest prime below it
+ *  (Bluestein's algorithm in VkFFT). */
+std::vector<SizeCase>
+GetSizeCases(unsigned int dimension, const BenchmarkOptions & options)
+{
+  std::vector<unsigned int> exponents;
+  switch (dimension)
+  {
+    case 1:
+      exponents = { 8, 12, 16, 20 };
+      break;
+    case 2:
+      exponents = { 6, 8, 10, 12 };
+      break;
+    default:
+      exponents = { 4, 6, 7, 8 };
+      break;
+  }
+
+  std::vector<SizeCase> sizeCases;
+  for (const unsigned int exponent : exponents)
+  {
+    const itk::SizeValueType powerOfTwo{ itk::SizeValueType{ 1 } << exponent };
+    itk::SizeValueType       sevenSmooth{ powerOfTwo - 1 };
+    while (!IsSevenSmoothWithSeven(sevenSmooth))
+    {
+      --sevenSmooth;
+    }
+    itk::SizeValueType prime{ powerOfTwo - 1 };
+    while (!IsPrime(prime))
+    {
+      --prime;
+    }
+    for (const auto & familySide : { std::make_pair(std::string{ "pow2" }, powerOfTwo),
+                                     std::make_pair(std::string{ "7-smooth" }, sevenSmooth),
+                                     std::make_pair(std::string{ "prime" }, prime) })
+    {
+      if (options.family != "all" && options.family != familySide.first)
+      {
+        continue;
+      }
+      SizeCase sizeCase{ familySide.first, std::vector<itk::SizeValueType>(dimension, familySide.second) };
+      if (sizeCase.GetNumberOfPixels() <= options.maxPixels)
+      {
+        sizeCases.push_back(sizeCase);
+      }
+    }
+  }
+  return sizeCases;
+}
+
+// Vk filters expose backend timings; other backends do not.
+template <typename TFilter>
+auto
+ResetVkTimings(TFilter * filter, int) -> decltype(filter->ResetVkTimings(), void())
+{
+  filter->ResetVkTimings();
+}
+
+template <typename TFilter>
+void
+ResetVkTimings(TFilter *, long)
+{}
+
+template <typename TFilter>
+auto
+RecordVkTimings(TFilter * filter, BenchmarkResult & result, int) -> decltype(filter->GetVkTimings(), void())
+{
+  const itk::VkCommon::VkTimings timings{ filter->GetVkTimings() };
+  result.warmConfigurations = timings.numberOfConfigurations;
+  if (timings.numberOfProfiledRuns > 0)
+  {
+    result.warmKernelSeconds = timings.deviceKernelSeconds / static_cast<double>(timings.numberOfProfiledRuns);
+  }
+}
+
+template <typename TFilter>
+void
+RecordVkTimings(TFilter *, BenchmarkResult &, long)
+{}
+
+template <typename TFilter>
+auto
+SetActualXDimensionIsOdd(TFilter * filter, bool isOdd, int) -> decltype(filter->SetActualXDimensionIsOdd(isOdd), void())
+{
+  filter->SetActualXDimensionIsOdd(isOdd);
+}
+
+template <typename TFilter>
+void
+SetActualXDimensionIsOdd(TFilter *, bool, long)
+{}
+
+using ClockType = std::chrono::steady_clock;
+
+double
+SecondsSince(const ClockType::time_point & start)
+{
+  return std::chrono::duration<double>(ClockType::now() - start).count();
+}
+
+/** Time cold and warm updates of one filter type. `configure` is applied
+ *  to every new filter instance before its input is set. */
+template <typename TFilter, typename TConfigure>
+void
+MeasureFilter(const typename TFilter::InputImageType * input,
+              const BenchmarkOptions &                options,
+              TConfigure                              configure,
+              BenchmarkResult &                       result)
+{
+  try
+  {
+    for (unsigned int run = 0; run < options.coldRuns; ++run)
+    {
+      const auto start{ ClockType::now() };
+      auto       filter{ TFilter::New() };
+      configure(filter.GetPointer());
+      filter->SetInput(input);
+      filter->Update();
+      result.coldSeconds.push_back(SecondsSince(start));
+    }
+
+    auto filter{ TFilter::New() };
+    configure(filter.GetPointer());
+    filter->SetInput(input);
+    filter->Update(); // Warm-up
+    ResetVkTimings(filter.GetPointer(), 0);
+    for (unsigned int run = 0; run < options.warmRuns; ++run)
+    {
+      filter->Modified();
+      const auto start{ ClockType::now() };
+      filter->Update();
+      result.warmSeconds.push_back(SecondsSince(start));
+    }
+    RecordVkTimings(filter.GetPointer(), result, 0);
+  }
+  catch (const itk::ExceptionObject & exception)
+  {
+    // CPU backends reject sizes they cannot factor
+    result.status = "failed";
+    result.message = exception.GetDescription();
+    result.coldSeconds.clear();
+    result.warmSeconds.clear();
+  }
+}
+
+template <typename TImage>
+typename TImage::Pointer
+MakeRandomImage(const typename TImage::SizeType & size, uint32_t seed)
+{
+  using RealType = typename itk::NumericTraits<typename TImage::PixelType>::ValueType;
+  auto generator{ itk::Statistics::MersenneTwisterRandomVariateGenerator::New() };
+  generator->Initialize(seed);
+
+  auto image{ TImage::New() };
+  image->SetRegions(size);
+  image->Allocate();
+  for (itk::ImageRegionIterator<TImage> it(image, image->GetBufferedRegion()); !it.IsAtEnd(); ++it)
+  {
+    RealType * value{ reinterpret_cast<RealType *>(&it.Value()) };
+    for (unsigned int component = 0; component < sizeof(typename TImage::PixelType) / sizeof(RealType); ++component)
+    {
+      value[component] = static_cast<RealType>(generator->GetUniformVariate(-1.0, 1.0));
+    }
+  }
+  return image;
+}
+
+template <typename TPrecision, unsigned int VDimension>
+struct VkBackend
+{
+  using RealImageType = itk::Image<TPrecision, VDimension>;
+  using ComplexImageType = itk::Image<std::complex<TPrecision>, VDimension>;
+
+  static const char *
+  GetName()
+  {
+    return "Vk";
+  }
+
+  using ForwardFFT = itk::VkForwardFFTImageFilter<RealImageType, ComplexImageType>;
+  using InverseFFT = itk::VkInverseFFTImageFilter<ComplexImageType, RealImageType>;
+  using ComplexToComplexFFT = itk::VkComplexToComplexFFTImageFilter<ComplexImageType>;
+  using RealToHalfHermitianForwardFFT =
+    itk::VkRealToHalfHermitianForwardFFTImageFilter<RealImageType, ComplexImageType>;
+  using HalfHermitianToRealInverseFFT =
+    itk::VkHalfHermitianToRealInverseFFTImageFilter<ComplexImageType, RealImageType>;
+  using Forward1DFFT = itk::VkForward1DFFTImageFilter<RealImageType, ComplexImageType>;
+  using Inverse1DFFT = itk::VkInverse1DFFTImageFilter<ComplexImageType, RealImageType>;
+  using ComplexToComplex1DFFT = itk::VkComplexToComplex1DFFTImageFilter<ComplexImageType>;
+};
+
+template <typename TPrecision, unsigned int VDimension>
+struct VnlBackend
+{
+  using RealImageType = itk::Image<TPrecision, VDimension>;
+  using ComplexImageType = itk::Image<std::complex<TPrecision>, VDimension>;
+
+  static const char *
+  GetName()
+  {
+    return "Vnl";
+  }
+
+  using ForwardFFT = itk::VnlForwardFFTImageFilter<RealImageType, ComplexImageType>;
+  using InverseFFT = itk::VnlInverseFFTImageFilter<ComplexImageType, RealImageType>;
+  using ComplexToComplexFFT = itk::VnlComplexToComplexFFTImageFilter<ComplexImageType>;
+  using RealToHalfHermitianForwardFFT =
+    itk::VnlRealToHalfHermitianForwardFFTImageFilter<RealImageType, ComplexImageType>;
+  using HalfHermitianToRealInverseFFT =
+    itk::VnlHalfHermitianToRealInverseFFTImageFilter<ComplexImageType, RealImageType>;
+  using Forward1DFFT = itk::VnlForward1DFFTImageFilter<RealImageType, ComplexImageType>;
+  using Inverse1DFFT = itk::VnlInverse1DFFTImageFilter<ComplexImageType, RealImageType>;
+  using ComplexToComplex1DFFT = itk::VnlComplexToComplex1DFFTImageFilter<ComplexImageType>;
+};
+
+#ifdef VKFFTBACKEND_BENCHMARK_FFTW
+template <typename TPrecision, unsigned int VDimension>
+struct FFTWBackend
+{
+  using RealImageType = itk::Image<TPrecision, VDimension>;
+  using ComplexImageType = itk::Image<std::complex<TPrecision>, VDimension>;
+
+  static const char *
+  GetName()
+  {
+    return "FFTW";
+  }
+
+  using ForwardFFT = itk::FFTWForwardFFTImageFilter<RealImageType, ComplexImageType>;
+  using InverseFFT = itk::FFTWInverseFFTImageFilter<ComplexImageType, RealImageType>;
+  using ComplexToComplexFFT = itk::FFTWComplexToComplexFFTImageFilter<ComplexImageType>;
+  using RealToHalfHermitianForwardFFT =
+    itk::FFTWRealToHalfHermitianForwardFFTImageFilter<RealImageType, ComplexImageType>;
+  using HalfHermitianToRealInverseFFT =
+    itk::FFTWHalfHermitianToRealInverseFFTImageFilter<ComplexImageType, RealImageType>;
+  using Forward1DFFT = itk::FFTWForward1DFFTImageFilter<RealImageType, ComplexImageType>;
+  using Inverse1DFFT = itk::FFTWInverse1DFFTImageFilter<ComplexImageType, RealImageType>;
+  using ComplexToComplex1DFFT = itk::FFTWComplexToComplex1DFFTImageFilter<ComplexImageType>;
+};
+#endif
+
+template <typename TBackend, unsigned int VDimension>
+void
+BenchmarkBackend(const std::string &            precision,
+                 const SizeCase &               sizeCase,
+                 const BenchmarkOptions &       options,
+                 std::vector<BenchmarkResult> & results)
+{
+  using RealImageType = typename TBackend::RealImageType;
+  using ComplexImageType = typename TBackend::ComplexImageType;
+
+  if (options.backend != "all" && options.backend != TBackend::GetName())
+  {
+    return;
+  }
+
+  typename RealImageType::SizeType size;
+  for (unsigned int dim = 0; dim < VDimension; ++dim)
+  {
+    size[dim] = sizeCase.size[dim];
+  }
+  typename ComplexImageType::SizeType halfSize{ size };
+  halfSize[0] = size[0] / 2 + 1;
+
+  const auto realImage{ MakeRandomImage<RealImageType>(size, options.seed) };
+  const auto complexImage{ MakeRandomImage<ComplexImageType>(size, options.seed) };
+  const auto halfComplexImage{ MakeRandomImage<ComplexImageType>(halfSize, options.seed) };
+
+  const bool actualXDimensionIsOdd{ size[0] % 2 == 1 };
+  const auto run = [&](const char * filterName, auto * filterTypeTag, const auto * input) {
+    using FilterType = std::remove_pointer_t<decltype(filterTypeTag)>;
+    if (options.filter != "all" && options.filter != filterName)
+    {
+      return;
+    }
+    BenchmarkResult result;
+    result.filter = filterName;
+    result.backend = TBackend::GetName();
+    result.precision = precision;
+    result.dimension = VDimension;
+    result.sizeCase = sizeCase;
+    MeasureFilter<FilterType>(
+      input, options, [&](FilterType * filter) { SetActualXDimensionIsOdd(filter, actualXDimensionIsOdd, 0); }, result);
+    std::cerr << result.backend << " " << result.filter << " " << result.precision << " " << sizeCase.GetSizeString()
+              << ": " << result.status << std::endl;
+    results.push_back(result);
+  };
+
+  run("ForwardFFT", static_cast<typename TBackend::ForwardFFT *>(nullptr), realImage.GetPointer());
+  run("InverseFFT", static_cast<typename TBackend::InverseFFT *>(nullptr), complexImage.GetPointer());
+  run("ComplexToComplexFFT", static_cast<typename TBackend::ComplexToComplexFFT *>(nullptr), complexImage.GetPointer());
+  run("RealToHalfHermitianForwardFFT",
+      static_cast<typename TBackend::RealToHalfHermitianForwardFFT *>(nullptr),
+      realImage.GetPointer());
+  run("HalfHermitianToRealInverseFFT",
+      static_cast<typename TBackend::HalfHermitianToRealInverseFFT *>(nullptr),
+      halfComplexImage.GetPointer());
+  run("Forward1DFFT", static_cast<typename TBackend::Forward1DFFT *>(nullptr), realImage.GetPointer());
+  run("Inverse1DFFT", static_cast<typename TBackend::Inverse1DFFT *>(nullptr), complexImage.GetPointer());
+  run("ComplexToComplex1DFFT",
+      static_cast<typename TBackend::ComplexToComplex1DFFT *>(nullptr),
+      complexImage.GetPointer());
+}
+
+template <typename TPrecision, unsigned int VDimension>
+void
+BenchmarkDimension(const std::string &            precision,
+                   const BenchmarkOptions &       options,
+                   std::vector<BenchmarkResult> & results)
+{
+  if (options.dimension != 0 && options.dimension != VDimension)
+  {
+    return;
+  }
+  for (const SizeCase & sizeCase : GetSizeCases(VDimension, options))
+  {
+    BenchmarkBackend<VkBackend<TPrecision, VDimension>, VDimension>(precision, sizeCase, options, results);
+    BenchmarkBackend<VnlBackend<TPrecision, VDimension>, VDimension>(precision, sizeCase, options, results);
+#ifdef VKFFTBACKEND_BENCHMARK_FFTW
+    BenchmarkBackend<FFTWBackend<TPrecision, VDimension>, VDimension>(precision, sizeCase, options, results);
+#endif
+  }
+}
+
+template <typename TPrecision>
+void
+BenchmarkPrecision(const std::string &            precision,
+                   const BenchmarkOptions &       options,
+                   std::vector<BenchmarkResult> & results)
+{
+  if (options.precision != "all" && options.precision != precision)
+  {
+    return;
+  }
+  BenchmarkDimension<TPrecision, 1>(precision, options, results);
+  BenchmarkDimension<TPrecision, 2>(precision, options, results);
+  BenchmarkDimension<TPrecision, 3>(precision, options, results);
+}
+
+std::string
+EscapeJSON(const std::string & text)
+{
+  std::string escaped;
+  for (const char character : text)
+  {
+    switch (character)
+    {
+      case '"':
+        escaped += "\\\"";
+        break;
+      case '\\':
+        escaped += "\\\\";
+        break;
+      case '\n':
+        escaped += "\\n";
+        break;
+      default:
+        escaped += character;
+    }
+  }
+  return escaped;
+}
+
+void
+WriteJSON(std::ostream & stream, const BenchmarkOptions & options, const std::vector<BenchmarkResult> & results)
+{
+  stream << "{\n  \"metadata\": {\"itkVersion\": \"" << itk::Version::GetITKVersion()
+         << "\", \"vkfftVersion\": " << VkFFTGetVersion() << ", \"vkfftBackend\": " << VKFFT_BACKEND
+         << ", \"deviceID\": " << options.deviceID
+         << ", \"threads\": " << itk::MultiThreaderBase::GetGlobalDefaultNumberOfThreads()
+         << ", \"seed\": " << options.seed << ", \"coldRuns\": " << options.coldRuns
+         << ", \"warmRuns\": " << options.warmRuns << ", \"profiling\": " << (options.profiling ? "true" : "false")
+         << "},\n  \"results\": [";
+  for (size_t index = 0; index < results.size(); ++index)
+  {
+    const BenchmarkResult & result{ results[index] };
+    stream << (index > 0 ? "," : "") << "\n    {\"filter\": \"" << result.filter << "\", \"backend\": \""
+           << result.backend << "\", \"precision\": \"" << result.precision
+           << "\", \"dimension\": " << result.dimension << ", \"family\": \"" << result.sizeCase.family
+           << "\", \"size\": \"" << result.sizeCase.GetSizeString()
+           << "\", \"pixels\": " << result.sizeCase.GetNumberOfPixels() << ", \"status\": \"" << result.status
+           << "\"";
+    if (result.status == "ok")
+    {
+      stream << ", \"coldMedianSeconds\": " << Percentile(result.coldSeconds, 50.0)
+             << ", \"coldMinSeconds\": " << Percentile(result.coldSeconds, 0.0)
+             << ", \"coldMaxSeconds\": " << Percentile(result.coldSeconds, 100.0)
+             << ", \"warmMedianSeconds\": " << Percentile(result.warmSeconds, 50.0)
+             << ", \"warmP10Seconds\": " << Percentile(result.warmSeconds, 10.0)
+             << ", \"warmP90Seconds\": " << Percentile(result.warmSeconds, 90.0)
+             << ", \"warmMinSeconds\": " << Percentile(result.warmSeconds, 0.0)
+             << ", \"warmMaxSeconds\": " << Percentile(result.warmSeconds, 100.0)
+             << ", \"warmMeanSeconds\": " << Mean(result.warmSeconds);
+      if (result.backend == "Vk")
+      {
+        stream << ", \"warmConfigurations\": " << result.warmConfigurations;
+      }
+      if (result.warmKernelSeconds >= 0.0)
+      {
+        stream << ", \"warmKernelSeconds\": " << result.warmKernelSeconds;
+      }
+    }
+    else
+    {
+      stream << ", \"message\": \"" << EscapeJSON(result.message) << "\"";
+    }
+    stream << "}";
+  }
+  stream << "\n  ]\n}\n";
+}
+
+void
+WriteCSV(std::ostream & stream, const std::vector<BenchmarkResult> & results)
+{
+  stream << "filter,backend,precision,dimension,family,size,pixels,status,coldMedianSeconds,coldMinSeconds,"
+            "coldMaxSeconds,warmMedianSeconds,warmP10Seconds,warmP90Seconds,warmMinSeconds,warmMaxSeconds,"
+            "warmMeanSeconds,warmConfigurations,warmKernelSeconds\n";
+  for (const BenchmarkResult & result : results)
+  {
+    stream << result.filter << "," << result.backend << "," << result.precision << "," << result.dimension << ","
+           << result.sizeCase.family << "," << result.sizeCase.GetSizeString() << ","
+           << result.sizeCase.GetNumberOfPixels() << "," << result.status << ",";
+    if (result.status == "ok")
+    {
+      stream << Percentile(result.coldSeconds, 50.0) << "," << Percentile(result.coldSeconds, 0.0) << ","
+             << Percentile(result.coldSeconds, 100.0) << "," << Percentile(result.warmSeconds, 50.0) << ","
+             << Percentile(result.warmSeconds, 10.0) << "," << Percentile(result.warmSeconds, 90.0) << ","
+             << Percentile(result.warmSeconds, 0.0) << "," << Percentile(result.warmSeconds, 100.0) << ","
+             << Mean(result.warmSeconds) << ",";
+      if (result.backend == "Vk")
+      {
+        stream << result.warmConfigurations;
+      }
+      stream << ",";
+      if (result.warmKernelSeconds >= 0.0)
+      {
+        stream << result.warmKernelSeconds;
+      }
+    }
+    else
+    {
+      stream << ",,,,,,,,,,";
+    }
+    stream << "\n";
+  }
+}
+
+std::string
+GetBaselineKey(const std::string & filter,
+               const std::string & backend,
+               const std::string & precision,
+               const std::string & size)
+{
+  return backend + " " + filter + " " + precision + " " + size;
+}
+
+/** Read warm medians from a CSV file written with `--format csv`. */
+bool
+ReadBaseline(const std::string & fileName, std::map<std::string, double> & baseline)
+{
+  std::ifstream file(fileName.c_str());
+  if (!file)
+  {
+    return false;
+  }
+  const auto split = [](const std::string & line) {
+    std::vector<std::string> fields;
+    std::istringstream       lineStream(line);
+    std::string              field;
+    while (std::getline(lineStream, field, ','))
+    {
+      fields.push_back(field);
+    }
+    return fields;
+  };
+
+  std::string line;
+  if (!std::getline(file, line))
+  {
+    return false;
+  }
+  std::map<std::string, size_t> columns;
+  const std::vector<std::string> header{ split(line) };
+  for (size_t column = 0; column < header.size(); ++column)
+  {
+    columns[header[column]] = column;
+  }
+  for (const char * name : { "filter", "backend", "precision", "size", "status", "warmMedianSeconds" })
+  {
+    if (columns.count(name) == 0)
+    {
+      std::cerr << "Baseline '" << fileName << "' has no '" << name << "' column." << std::endl;
+      return false;
+    }
+  }
+  while (std::getline(file, line))
+  {
+    const std::vector<std::string> fields{ split(line) };
+    if (fields.size() <= columns["warmMedianSeconds"] || fields[columns["status"]] != "ok")
+    {
+      continue;
+    }
+    baseline[GetBaselineKey(
+      fields[columns["filter"]], fields[columns["backend"]], fields[columns["precision"]], fields[columns["size"]])] =
+      std::stod(fields[columns["warmMedianSeconds"]]);
+  }
+  if (baseline.empty())
+  {
+    // A gate against an empty baseline would compare nothing and always pass
+    std::cerr << "Baseline '" << fileName << "' has no configurations." << std::endl;
+    return false;
+  }
+  return true;
+}
+
+/** Compare warm medians against the baseline and return the number of regressions, and the number of
+ *  configurations compared in `numberOfCompared`. */
+unsigned int
+CompareWithBaseline(const std::vector<BenchmarkResult> &  results,
+                    const std::map<std::string, double> & baseline,
+                    const BenchmarkOptions &              options,
+                    unsigned int &                        numberOfCompared)
+{
+  unsigned int numberOfRegressions{ 0 };
+  numberOfCompared = 0;
+  for (const BenchmarkResult & result : results)
+  {
+    const auto entry =
+      baseline.find(GetBaselineKey(result.filter, result.backend, result.precision, result.sizeCase.GetSizeString()));
+    if (entry == baseline.end())
+    {
+      continue;
+    }
+    ++numberOfCompared;
+    const std::string name{ entry->first };
+    if (result.status != "ok")
+    {
+      std::cerr << "REGRESSION " << name << ": " << result.status << " (" << result.message << ")" << std::endl;
+      ++numberOfRegressions;
+      continue;
+    }
+    const double current{ Percentile(result.warmSeconds, 50.0) };
+    const double change{ entry->second > 0.0 ? current / entry->second - 1.0 : 0.0 };
+    if (change > options.tolerance && current - entry->second > options.minimumDelta)
+    {
+      std::cerr << "REGRESSION " << name << ": median " << current << " s, baseline " << entry->second << " s (+"
+                << 100.0 * change << "%)" << std::endl;
+      ++numberOfRegressions;
+    }
+  }
+  std::cerr << "Compared " << numberOfCompared << " of " << baseline.size() << " baseline configurations: "
+            << numberOfRegressions << " regressions beyond " << 100.0 * options.tolerance << "%." << std::endl;
+  if (numberOfCompared == 0)
+  {
+    std::cerr << "ERROR: no configuration matched the baseline, so nothing was gated." << std::endl;
+  }
+  return numberOfRegressions;
+}
+
+void
+PrintUsage(const char * executable)
+{
+  std::cerr << "Usage: " << executable << " [options]\n"
+            << "  --output <file>         Write results to file instead of standard output\n"
+            << "  --format <json|csv>     Output format (default json)\n"
+            << "  --precision <float|double|all>\n"
+            << "  --dimension <1|2|3|all>\n"
+            << "  --backend <Vk|Vnl|FFTW|all>\n"
+            << "  --filter <name|all>     e.g. ForwardFFT, ComplexToComplex1DFFT\n"
+            << "  --family <pow2|7-smooth|prime|all>\n"
+            << "  --max-pixels <n>        Skip sizes with more pixels (default 16777216)\n"
+            << "  --cold-runs <n>         New filter instances timed per case (default 3)\n"
+            << "  --warm-runs <n>         Repeated updates timed per case (default 10)\n"
+            << "  --threads <n>           ITK CPU threads (default: ITK global default)\n"
+            << "  --device <id>           VkFFT device (default 0)\n"
+            << "  --seed <n>              Input random seed\n"
+            << "  --profiling             Record Vk device kernel times\n"
+            << "  --baseline <csv>        Compare warm medians with a baseline written with --format csv\n"
+            << "  --tolerance <fraction>  Allowed slowdown relative to the baseline (default 0.25)\n"
+            << "  --minimum-delta <s>     Ignore slowdowns smaller than this (default 0.0001)\n"
+            << "  --fail-on-regression    Exit with failure rather than warn on regressions" << std::endl;
+}
+} // namespace
+
+int
+main(int argc, char * argv[])
+{
+  BenchmarkOptions options;
+  for (int arg = 1; arg < argc; ++arg)
+  {
+    const std::string option{ argv[arg] };
+    if (option == "--profiling")
+    {
+      options.profiling = true;
+      continue;
+    }
+    if (option == "--fail-on-regression")
+    {
+      options.failOnRegression = true;
+      continue;
+    }
+    if (option == "--help" || arg + 1 >= argc)
+    {
+      PrintUsage(argv[0]);
+      return option == "--help" ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+    const std::string value{ argv[++arg] };
+    if (option == "--output")
+    {
+      options.outputFileName = value;
+    }
+    else if (option == "--format")
+    {
+      options.format = value;
+    }
+    else if (option == "--precision")
+    {
+      options.precision = value;
+    }
+    else if (option == "--dimension")
+    {
+      options.dimension = (value == "all") ? 0 : static_cast<unsigned int>(std::stoul(value));
+    }
+    else if (option == "--backend")
+    {
+      options.backend = value;
+    }
+    else if (option == "--filter")
+    {
+      options.filter = value;
+    }
+    else if (option == "--family")
+    {
+      options.family = value;
+    }
+    else if (option == "--max-pixels")
+    {
+      options.maxPixels = std::stoull(value);
+    }
+    else if (option == "--cold-runs")
+    {
+      options.coldRuns = static_cast<unsigned int>(std::stoul(value));
+    }
+    else if (option == "--warm-runs")
+    {
+      options.warmRuns = static_cast<unsigned int>(std::stoul(value));
+    }
+    else if (option == "--threads")
+    {
+      options.threads = static_cast<unsigned int>(std::stoul(value));
+    }
+    else if (option == "--device")
+    {
+      options.deviceID = std::stoull(value);
+    }
+    else if (option == "--baseline")
+    {
+      options.baselineFileName = value;
+    }
+    else if (option == "--tolerance")
+    {
+      options.tolerance = std::stod(value);
+    }
+    else if (option == "--minimum-delta")
+    {
+      options.minimumDelta = std::stod(value);
+    }
+    else if (option == "--seed")
+    {
+      options.seed = static_cast<uint32_t>(std::stoul(value));
+    }
+    else
+    {
+      std::cerr << "Unknown option '" << option << "'." << std::endl;
+      PrintUsage(argv[0]);
+      return EXIT_FAILURE;
+    }
+  }
+  if (options.format != "json" && options.format != "csv")
+  {
+    std::cerr << "Unknown format '" << options.format << "'. Expected 'json' or 'csv'." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  if (options.threads > 0)
+  {
+    itk::MultiThreaderBase::SetGlobalDefaultNumberOfThreads(options.threads);
+  }
+  std::map<std::string, double> baseline;
+  if (!options.baselineFileName.empty() && !ReadBaseline(options.baselineFileName, baseline))
+  {
+    std::cerr << "Could not read baseline '" << options.baselineFileName << "'." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  itk::VkGlobalConfiguration::SetDeviceID(options.deviceID);
+  itk::VkGlobalConfiguration::SetProfiling(options.profiling);
+
+  std::vector<BenchmarkResult> results;
+  BenchmarkPrecision<float>("float", options, results);
+  BenchmarkPrecision<double>("double", options, results);
+
+  std::ofstream outputFile;
+  if (!options.outputFileName.empty())
+  {
+    outputFile.open(options.outputFileName.c_str());
+    if (!outputFile)
+    {
+      std::cerr << "Could not open '" << options.outputFileName << "' for writing." << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+  std::ostream & stream{ options.outputFileName.empty() ? std::cout : outputFile };
+  stream.precision(9);
+  if (options.format == "csv")
+  {
+    WriteCSV(stream, results);
+  }
+  else
+  {
+    WriteJSON(stream, options, results);
+  }
+
+  if (!options.baselineFileName.empty())
+  {
+    unsigned int numberOfCompared{ 0 };
+    if (CompareWithBaseline(results, baseline, options, numberOfCompared) > 0)
+    {
+      if (options.failOnRegression)
+      {
+        return EXIT_FAILURE;
+      }
+      std::cerr << "WARNING: performance regressions detected." << std::endl;
+    }
+    // A baseline of another sweep or machine class gates nothing, which fails even when regressions only warn
+    if (numberOfCompared == 0)
+    {
+      return EXIT_FAILURE;
+    }
+  }
+  return EXIT_SUCCESS;
+}
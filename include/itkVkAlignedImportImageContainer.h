@@ -0,0 +1,145 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         https://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkVkAlignedImportImageContainer_h
+#define itkVkAlignedImportImageContainer_h
+
+#include "itkImportImageContainer.h"
+#include "itkVkCommon.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+
+namespace itk
+{
+/**
+ *\class VkAlignedImportImageContainer
+ *
+ * \brief Image buffer aligned for use in place by a VkFFT device.
+ *
+ * VkFFT devices that share memory with the host use CPU buffers in place,
+ * without copies, when they are aligned to
+ * VkCommon::GetDeviceHostPointerAlignment. This container allocates its
+ * elements at such an alignment. See AllocateVkAlignedBuffer.
+ *
+ * \ingroup FourierTransform
+ * \ingroup VkFFTBackend
+ */
+template <typename TElementIdentifier, typename TElement>
+class VkAlignedImportImageContainer : public ImportImageContainer<TElementIdentifier, TElement>
+{
+public:
+  ITK_DISALLOW_COPY_AND_MOVE(VkAlignedImportImageContainer);
+
+  /** Standard class type aliases. */
+  using Self = VkAlignedImportImageContainer;
+  using Superclass = ImportImageContainer<TElementIdentifier, TElement>;
+  using Pointer = SmartPointer<Self>;
+  using ConstPointer = SmartPointer<const Self>;
+
+  using ElementIdentifier = TElementIdentifier;
+  using Element = TElement;
+
+  static_assert(std::is_trivially_destructible<Element>::value, "Elements are released without destruction.");
+
+  itkNewMacro(Self);
+  itkOverrideGetNameOfClassMacro(VkAlignedImportImageContainer);
+
+  /** Alignment in bytes of buffers allocated from now on. Defaults to the
+   *  alignment of any scalar type. */
+  itkSetMacro(Alignment, SizeValueType);
+  itkGetConstMacro(Alignment, SizeValueType);
+
+protected:
+  VkAlignedImportImageContainer() = default;
+  ~VkAlignedImportImageContainer() override
+  {
+    // The destructor of the superclass would release the buffer with delete[]
+    this->DeallocateManagedMemory();
+  }
+
+  Element *
+  AllocateElements(ElementIdentifier size, bool useValueInitialization = false) const override
+  {
+    // The address of the allocation is stored just before the aligned elements
+    const SizeValueType alignment{ std::max<SizeValueType>(m_Alignment, sizeof(void *)) };
+    char * const        allocation{ new char[size * sizeof(Element) + alignment + sizeof(void *)] };
+    const uintptr_t     address{ reinterpret_cast<uintptr_t>(allocation) + sizeof(void *) };
+    Element * const     elements{ reinterpret_cast<Element *>((address + alignment - 1) / alignment * alignment) };
+    reinterpret_cast<char **>(elements)[-1] = allocation;
+    for (ElementIdentifier n{ 0 }; n < size; ++n)
+    {
+      if (useValueInitialization)
+      {
+        new (elements + n) Element();
+      }
+      else
+      {
+        new (elements + n) Element;
+      }
+    }
+    return elements;
+  }
+
+  void
+  DeallocateManagedMemory() override
+  {
+    Element * const elements{ this->GetImportPointer() };
+    if (elements && this->GetContainerManageMemory())
+    {
+      delete[] reinterpret_cast<char **>(elements)[-1];
+    }
+    // Let the superclass reset its state without releasing the buffer again
+    const bool containerManageMemory{ this->GetContainerManageMemory() };
+    this->SetContainerManageMemory(false);
+    Superclass::DeallocateManagedMemory();
+    this->SetContainerManageMemory(containerManageMemory);
+  }
+
+private:
+  SizeValueType m_Alignment{ alignof(std::max_align_t) };
+};
+
+/** Allocate the requested region of `image` as its buffered region, as
+ *  ImageSource::AllocateOutputs does, in a buffer that the VkFFT device
+ *  `deviceID` can use in place. A buffer that Allocate would reuse, such as
+ *  a grafted one, is kept as it is. */
+template <typename TImage>
+void
+AllocateVkAlignedBuffer(TImage * const image, const uint64_t deviceID)
+{
+  using PixelContainerType = typename TImage::PixelContainer;
+  using AlignedContainerType =
+    VkAlignedImportImageContainer<typename PixelContainerType::ElementIdentifier,
+                                  typename PixelContainerType::Element>;
+
+  image->SetBufferedRegion(image->GetRequestedRegion());
+  const uint64_t alignment{ VkCommon::GetDeviceHostPointerAlignment(deviceID) };
+  if (alignment > 0 && image->GetPixelContainer()->Capacity() == 0)
+  {
+    auto buffer = AlignedContainerType::New();
+    buffer->SetAlignment(alignment);
+    image->SetPixelContainer(buffer);
+  }
+  image->Allocate();
+}
+} // namespace itk
+
+#endif // itkVkAlignedImportImageContainer_h
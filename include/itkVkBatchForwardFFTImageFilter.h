@@ -0,0 +1,150 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         https://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkVkBatchForwardFFTImageFilter_h
+#define itkVkBatchForwardFFTImageFilter_h
+
+#include "itkImage.h"
+#include "itkImageToImageFilter.h"
+#include "itkVkAlignedImportImageContainer.h"
+#include "itkVkCommon.h"
+#include "itkVkGlobalConfiguration.h"
+#include "itkVkTimingsReporter.h"
+
+namespace itk
+{
+/**
+ *\class VkBatchForwardFFTImageFilter
+ *
+ * \brief Vk-based forward Fast Fourier Transform of a batch of images.
+ *
+ * The last dimension of the input image indexes a batch of images of one
+ * less dimension that are stored one after the other. Each image of the
+ * batch is transformed as by VkForwardFFTImageFilter, and the whole batch
+ * is submitted to VkFFT in a single run.
+ *
+ * From Python, a stacked NumPy array can be viewed without copying with
+ * `itk.image_view_from_array`. Results are written in place into a
+ * preallocated output of the same size given with GraftOutput, such as
+ * another view of a NumPy array, because the filter does not release its
+ * output data before updating.
+ *
+ * \ingroup FourierTransform
+ * \ingroup VkFFTBackend
+ *
+ * \sa VkForwardFFTImageFilter
+ * \sa VkGlobalConfiguration
+ */
+template <typename TInputImage,
+          typename TOutputImage = Image<std::complex<typename TInputImage::PixelType>, TInputImage::ImageDimension>>
+class VkBatchForwardFFTImageFilter
+  : public ImageToImageFilter<TInputImage, TOutputImage>
+  , public VkTimingsReporter
+{
+public:
+  ITK_DISALLOW_COPY_AND_MOVE(VkBatchForwardFFTImageFilter);
+
+  using InputImageType = TInputImage;
+  using OutputImageType = TOutputImage;
+  static_assert(std::is_same<typename TInputImage::PixelType, float>::value ||
+                  std::is_same<typename TInputImage::PixelType, double>::value,
+                "Unsupported pixel type");
+  static_assert(std::is_same<typename TOutputImage::PixelType, std::complex<float>>::value ||
+                  std::is_same<typename TOutputImage::PixelType, std::complex<double>>::value,
+                "Unsupported pixel type");
+  static_assert(TInputImage::ImageDimension >= 2 && TInputImage::ImageDimension <= 4, "Unsupported image dimension");
+
+  /** Standard class type aliases. */
+  using Self = VkBatchForwardFFTImageFilter;
+  using Superclass = ImageToImageFilter<InputImageType, OutputImageType>;
+  using Pointer = SmartPointer<Self>;
+  using ConstPointer = SmartPointer<const Self>;
+
+  using InputPixelType = typename InputImageType::PixelType;
+  using OutputPixelType = typename OutputImageType::PixelType;
+  using ComplexType = OutputPixelType;
+  using RealType = typename ComplexType::value_type;
+  using SizeType = typename InputImageType::SizeType;
+  using SizeValueType = typename InputImageType::SizeValueType;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkOverrideGetNameOfClassMacro(VkBatchForwardFFTImageFilter);
+
+  static constexpr unsigned int ImageDimension{ InputImageType::ImageDimension };
+
+  /** Dimension of each transformed image of the batch. */
+  static constexpr unsigned int TransformDimension{ ImageDimension - 1 };
+
+  /** Determine whether local or global properties will be
+   *  referenced for setting up GPU acceleration. */
+  itkSetMacro(UseVkGlobalConfiguration, bool);
+  itkGetMacro(UseVkGlobalConfiguration, bool);
+
+  /** Local setting for enumerated GPU device to use for FFT.
+   *  Ignored if `UseVkGlobalConfiguration` is true. */
+  itkSetMacro(DeviceID, uint64_t);
+
+  /** Return the enumerated GPU device to use for FFT
+   *  according to current filter settings. With the global
+   *  configuration, runs are placed on devices by its scheduling
+   *  policy, which is this device only for the FIXED policy. */
+  uint64_t
+  GetDeviceID() const
+  {
+    return uint64_t{ m_UseVkGlobalConfiguration ? VkGlobalConfiguration::GetDeviceID() : m_DeviceID };
+  }
+
+  SizeValueType
+  GetSizeGreatestPrimeFactor() const
+  {
+    return SizeValueType{ m_VkCommon.GetGreatestPrimeFactor() };
+  }
+
+protected:
+  VkBatchForwardFFTImageFilter();
+  ~VkBatchForwardFFTImageFilter() override = default;
+
+  /** The whole input is needed to compute the transforms. */
+  void
+  GenerateInputRequestedRegion() override;
+
+  void
+  EnlargeOutputRequestedRegion(DataObject * output) override;
+
+  void
+  GenerateData() override;
+
+  void
+  PrintSelf(std::ostream & os, Indent indent) const override;
+
+private:
+  bool     m_UseVkGlobalConfiguration{ true };
+  uint64_t m_DeviceID{ 0UL };
+
+  VkCommon m_VkCommon{};
+};
+
+} // namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#  include "itkVkBatchForwardFFTImageFilter.hxx"
+#endif
+
+#endif // itkVkBatchForwardFFTImageFilter_h
@@ -0,0 +1,148 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         https://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkVkBatchForwardFFTImageFilter_hxx
+#define itkVkBatchForwardFFTImageFilter_hxx
+
+#include "itkVkBatchForwardFFTImageFilter.h"
+#include "itkVkTracer.h"
+#include "itkIndent.h"
+#include "itkProgressReporter.h"
+
+#include <iostream>
+
+namespace itk
+{
+
+template <typename TInputImage, typename TOutputImage>
+VkBatchForwardFFTImageFilter<TInputImage, TOutputImage>::VkBatchForwardFFTImageFilter()
+  : VkTimingsReporter{ &m_VkCommon }
+{
+  // Keep a grafted output buffer so that results are written in place
+  this->ReleaseDataBeforeUpdateFlagOff();
+}
+
+template <typename TInputImage, typename TOutputImage>
+void
+VkBatchForwardFFTImageFilter<TInputImage, TOutputImage>::GenerateInputRequestedRegion()
+{
+  Superclass::GenerateInputRequestedRegion();
+
+  const typename InputImageType::Pointer input{ const_cast<InputImageType *>(this->GetInput()) };
+  if (input)
+  {
+    input->SetRequestedRegionToLargestPossibleRegion();
+  }
+}
+
+template <typename TInputImage, typename TOutputImage>
+void
+VkBatchForwardFFTImageFilter<TInputImage, TOutputImage>::EnlargeOutputRequestedRegion(DataObject * output)
+{
+  Superclass::EnlargeOutputRequestedRegion(output);
+  output->SetRequestedRegionToLargestPossibleRegion();
+}
+
+template <typename TInputImage, typename TOutputImage>
+void
+VkBatchForwardFFTImageFilter<TInputImage, TOutputImage>::GenerateData()
+{
+  const VkTraceScope traceScope{ this->GetNameOfClass(), "GenerateData", this->GetDeviceID() };
+
+  // get pointers to the input and output
+  const InputImageType * const input{ this->GetInput() };
+  OutputImageType * const      output{ this->GetOutput() };
+
+  if (!input || !output)
+  {
+    return;
+  }
+
+  const ProgressReporter progress(this, 0, 1);
+
+  // allocate output buffer memory aligned for use in place by the device,
+  // reusing a grafted buffer of the same size
+  AllocateVkAlignedBuffer(output, this->GetDeviceID());
+
+  const SizeType & inputSize{ input->GetLargestPossibleRegion().GetSize() };
+
+  const InputPixelType * const inputCPUBuffer{ input->GetBufferPointer() };
+  OutputPixelType * const      outputCPUBuffer{ output->GetBufferPointer() };
+  itkAssertOrThrowMacro(inputCPUBuffer != nullptr, "No CPU input buffer");
+  itkAssertOrThrowMacro(outputCPUBuffer != nullptr, "No CPU output buffer");
+  const SizeValueType inBytes{ input->GetLargestPossibleRegion().GetNumberOfPixels() * sizeof(InputPixelType) };
+  const SizeValueType outBytes{ output->GetLargestPossibleRegion().GetNumberOfPixels() * sizeof(OutputPixelType) };
+
+  // Describe this filter in VkCommon::VkParameters
+  typename VkCommon::VkParameters vkParameters;
+  if (TransformDimension > 0)
+    vkParameters.X = inputSize[0];
+  if (TransformDimension > 1)
+    vkParameters.Y = inputSize[1];
+  if (TransformDimension > 2)
+    vkParameters.Z = inputSize[2];
+  vkParameters.B = inputSize[TransformDimension];
+  if (std::is_same<RealType, float>::value)
+    vkParameters.P = VkCommon::PrecisionEnum::FLOAT;
+  else if (std::is_same<RealType, double>::value)
+    vkParameters.P = VkCommon::PrecisionEnum::DOUBLE;
+  else
+    itkAssertOrThrowMacro(false, "Unsupported type for real numbers.");
+  vkParameters.fft = VkCommon::FFTEnum::R2FullH;
+  vkParameters.PSize = sizeof(RealType);
+  vkParameters.I = VkCommon::DirectionEnum::FORWARD;
+  vkParameters.normalized = VkCommon::NormalizationEnum::UNNORMALIZED;
+
+  vkParameters.inputCPUBuffer = inputCPUBuffer;
+  vkParameters.inputBufferBytes = inBytes;
+  vkParameters.outputCPUBuffer = outputCPUBuffer;
+  vkParameters.outputBufferBytes = outBytes;
+
+  // Count this run as outstanding on the device of the plan it reuses,
+  // or else on a device chosen by the scheduling policy
+  const VkDeviceReservation deviceReservation{
+    m_UseVkGlobalConfiguration, m_DeviceID, inBytes + outBytes, m_VkCommon, vkParameters
+  };
+
+  // Mostly use defaults for VkCommon::VkGPU
+  typename VkCommon::VkGPU vkGPU;
+  vkGPU.device_id = deviceReservation.GetDeviceID();
+  vkGPU.profiling = VkGlobalConfiguration::GetProfiling();
+
+  const VkFFTResult resFFT{ m_VkCommon.Run(vkGPU, vkParameters) };
+  if (resFFT != VKFFT_SUCCESS)
+  {
+    std::ostringstream mesg;
+    mesg << "VkFFT third-party library failed with error code " << resFFT << ".";
+    itkAssertOrThrowMacro(false, mesg.str());
+  }
+}
+
+template <typename TInputImage, typename TOutputImage>
+void
+VkBatchForwardFFTImageFilter<TInputImage, TOutputImage>::PrintSelf(std::ostream & os, Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+  os << indent << "UseVkGlobalConfiguration: " << m_UseVkGlobalConfiguration << std::endl;
+  os << indent << "Local DeviceID: " << m_DeviceID << std::endl;
+  os << indent << "Global DeviceID: " << VkGlobalConfiguration::GetDeviceID() << std::endl;
+  os << indent << "Preferred DeviceID: " << this->GetDeviceID() << std::endl;
+}
+
+} // end namespace itk
+
+#endif // itkVkBatchForwardFFTImageFilter_hxx
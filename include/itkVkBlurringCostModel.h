@@ -0,0 +1,358 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         https://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkVkBlurringCostModel_h
+#define itkVkBlurringCostModel_h
+
+#include "itkMultiThreaderBase.h"
+#include "itkNumericTraits.h"
+#include "itkObject.h"
+#include "itkObjectFactory.h"
+#include "itkVkCommon.h"
+
+#include <algorithm>
+
+namespace itk
+{
+/**
+ *\class VkBlurringCostModel
+ * \brief Estimate separable spatial and VkFFT Gaussian blurring runtimes
+ *     in seconds
+ *
+ * VkBlurringPerformanceMetric reduces the spatial versus FFT tradeoff to a
+ * single unitless value that must be compared with a hand-tuned threshold.
+ * VkBlurringCostModel instead estimates the runtime of each blurring
+ * procedure in seconds so that the faster procedure can be selected
+ * directly:
+ *
+ * - Separable spatial blurring costs one multiply-add per pixel per kernel
+ *   element along each dimension, divided across the CPU threads
+ *   available to the spatial filter.
+ * - FFT blurring pads the region by the kernel size and to a size supported
+ *   by the radix kernels of the FFT backend, then costs three real-to-complex
+ *   transforms (input, kernel, inverse), each about half a complex transform
+ *   as estimated by VkCommon::EstimateTransformCost. Host-device transfers
+ *   of each input and output buffer, a fixed dispatch overhead per transform
+ *   and plan creation for each transform for which no VkCommon in the process
+ *   holds a plan are added.
+ *
+ * The per-device constants default to conservative values for a discrete GPU
+ * and a multicore CPU. They should be calibrated for a given machine, for
+ * instance with the benchmarking scripts in the ITKVkFFTBackend repository.
+ *
+ * The same costs are estimated for blurring along a single dimension, where
+ * spatial blurring applies one 1-D kernel and FFT blurring runs a batch of
+ * 1-D forward and inverse transforms along that dimension with the kernel
+ * frequency response computed on the host.
+ *
+ * Override EstimateSpatialSeconds and EstimateFFTSeconds, and their 1-D
+ * counterparts, in a subclass to plug in a different cost model.
+ *
+ * \sa VkBlurringPerformanceMetric
+ * \sa VkDiscreteGaussianImageFilter
+ * \sa VkMultiResolutionPyramidImageFilter
+ *
+ * \ingroup ITKFFT
+ * \ingroup ITKNumerics
+ * \ingroup VkFFTBackend
+ */
+template <typename TImage>
+class VkBlurringCostModel : public Object
+{
+public:
+  ITK_DISALLOW_COPY_AND_MOVE(VkBlurringCostModel);
+
+  /** Standard class type aliases. */
+  using Self = VkBlurringCostModel;
+  using Superclass = Object;
+  using Pointer = SmartPointer<Self>;
+  using ConstPointer = SmartPointer<const Self>;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkOverrideGetNameOfClassMacro(VkBlurringCostModel);
+
+  using ImageType = TImage;
+  using RegionSizeType = typename ImageType::SizeType;
+  using KernelSizeType = typename ImageType::SizeType;
+  using SizeValueType = typename RegionSizeType::SizeValueType;
+  using RealType = typename NumericTraits<typename ImageType::PixelType>::ValueType;
+
+  static constexpr unsigned int ImageDimension = ImageType::ImageDimension;
+
+  /** Seconds for one multiply-add in separable spatial convolution
+   *  on a single CPU thread. */
+  itkSetMacro(SpatialSecondsPerMultiplyAdd, double);
+  itkGetConstMacro(SpatialSecondsPerMultiplyAdd, double);
+
+  /** Number of CPU threads available to separable spatial convolution.
+   *  Defaults to the ITK global default number of threads. */
+  itkSetClampMacro(NumberOfSpatialThreads, unsigned int, 1, NumericTraits<unsigned int>::max());
+  itkGetConstMacro(NumberOfSpatialThreads, unsigned int);
+
+  /** Seconds per single-precision floating point operation
+   *  in a VkFFT transform on the device. */
+  itkSetMacro(FFTSecondsPerFlop, double);
+  itkGetConstMacro(FFTSecondsPerFlop, double);
+
+  /** Ratio of double-precision to single-precision FFT throughput
+   *  on the device. Applied when the pixel type is at least 8 bytes. */
+  itkSetMacro(DoublePrecisionFlopFactor, double);
+  itkGetConstMacro(DoublePrecisionFlopFactor, double);
+
+  /** Host-device transfer bandwidth in bytes per second. */
+  itkSetMacro(TransferBytesPerSecond, double);
+  itkGetConstMacro(TransferBytesPerSecond, double);
+
+  /** Fixed overhead in seconds for each transform dispatch. */
+  itkSetMacro(FFTDispatchSeconds, double);
+  itkGetConstMacro(FFTDispatchSeconds, double);
+
+  /** Seconds to create a device context and VkFFT plan. Charged for
+   *  each transform for which no VkCommon holds a plan, see
+   *  VkCommon::HasAnyPlanFor. */
+  itkSetMacro(FFTPlanSeconds, double);
+  itkGetConstMacro(FFTPlanSeconds, double);
+
+  /** Greatest prime factor handled by the radix kernels of the FFT backend.
+   *  Larger prime factors fall back on Bluestein's algorithm.
+   *  Defaults to VkCommon::GetGreatestPrimeFactor(). */
+  itkSetClampMacro(GreatestPrimeFactor, SizeValueType, 2, NumericTraits<SizeValueType>::max());
+  itkGetConstMacro(GreatestPrimeFactor, SizeValueType);
+
+  /** Estimate the runtime of separable spatial blurring in seconds. */
+  virtual double
+  EstimateSpatialSeconds(const RegionSizeType & regionSize, const KernelSizeType & kernelSize) const
+  {
+    double numberOfPixels = 1.0;
+    double totalKernelSize = 0.0;
+    for (unsigned int dim = 0; dim < ImageDimension; ++dim)
+    {
+      numberOfPixels *= regionSize[dim];
+      totalKernelSize += kernelSize[dim];
+    }
+    return numberOfPixels * totalKernelSize * m_SpatialSecondsPerMultiplyAdd / m_NumberOfSpatialThreads;
+  }
+
+  /** Estimate the runtime of VkFFT blurring in seconds. */
+  virtual double
+  EstimateFFTSeconds(const RegionSizeType & regionSize, const KernelSizeType & kernelSize) const
+  {
+    // Forward transforms of the input and the kernel, then one inverse transform
+    constexpr double numberOfTransforms = 3.0;
+
+    RegionSizeType paddedSize;
+    double         numberOfPaddedPixels = 1.0;
+    for (unsigned int dim = 0; dim < ImageDimension; ++dim)
+    {
+      paddedSize[dim] = this->GetNextSupportedSize(regionSize[dim] + std::max<SizeValueType>(kernelSize[dim], 1) - 1);
+      numberOfPaddedPixels *= paddedSize[dim];
+    }
+
+    // A separable N-D transform costs the sum over dimensions of the 1-D
+    // transforms along that dimension, i.e. (N / n_d) transforms of length n_d.
+    double flopsPerTransform = 0.0;
+    for (unsigned int dim = 0; dim < ImageDimension; ++dim)
+    {
+      flopsPerTransform += (numberOfPaddedPixels / paddedSize[dim]) * this->Estimate1DFlops(paddedSize[dim]);
+    }
+    // Real-to-half-Hermitian transforms do about half the work of complex transforms
+    flopsPerTransform *= 0.5;
+
+    double secondsPerFlop = m_FFTSecondsPerFlop;
+    if (sizeof(RealType) >= 8)
+    {
+      secondsPerFlop *= m_DoublePrecisionFlopFactor;
+    }
+
+    // Each transform uploads a real buffer and downloads a half-Hermitian complex buffer, or vice versa
+    const double bytesPerTransform = numberOfPaddedPixels * sizeof(RealType) * 2.0;
+
+    double seconds = numberOfTransforms * (flopsPerTransform * secondsPerFlop +
+                                           bytesPerTransform / m_TransferBytesPerSecond + m_FFTDispatchSeconds);
+    if (!this->HasPlanFor(paddedSize, VkCommon::FFTEnum::R2HalfH, VkCommon::DirectionEnum::FORWARD))
+    {
+      seconds += 2.0 * m_FFTPlanSeconds;
+    }
+    if (!this->HasPlanFor(paddedSize, VkCommon::FFTEnum::R2HalfH, VkCommon::DirectionEnum::INVERSE))
+    {
+      seconds += m_FFTPlanSeconds;
+    }
+    return seconds;
+  }
+
+  /** Whether FFT blurring is anticipated to run faster than
+   *  separable spatial blurring. */
+  bool
+  GetUseFFT(const RegionSizeType & regionSize, const KernelSizeType & kernelSize) const
+  {
+    return this->EstimateFFTSeconds(regionSize, kernelSize) < this->EstimateSpatialSeconds(regionSize, kernelSize);
+  }
+
+  /** Estimate the runtime in seconds of spatial blurring along one dimension. */
+  virtual double
+  EstimateSpatialSeconds1D(const RegionSizeType & regionSize,
+                           const KernelSizeType & kernelSize,
+                           const unsigned int     dimension) const
+  {
+    double numberOfPixels = 1.0;
+    for (unsigned int dim = 0; dim < ImageDimension; ++dim)
+    {
+      numberOfPixels *= regionSize[dim];
+    }
+    return numberOfPixels * kernelSize[dimension] * m_SpatialSecondsPerMultiplyAdd / m_NumberOfSpatialThreads;
+  }
+
+  /** Estimate the runtime in seconds of batched 1-D FFT blurring along one dimension. */
+  virtual double
+  EstimateFFTSeconds1D(const RegionSizeType & regionSize,
+                       const KernelSizeType & kernelSize,
+                       const unsigned int     dimension) const
+  {
+    // Forward and inverse transforms; the kernel response is computed on the host
+    constexpr double numberOfTransforms = 2.0;
+
+    const SizeValueType paddedSize =
+      this->GetNextSupportedSize(regionSize[dimension] + std::max<SizeValueType>(kernelSize[dimension], 1) - 1);
+    double numberOfPaddedPixels = paddedSize;
+    for (unsigned int dim = 0; dim < ImageDimension; ++dim)
+    {
+      if (dim != dimension)
+      {
+        numberOfPaddedPixels *= regionSize[dim];
+      }
+    }
+
+    double secondsPerFlop = m_FFTSecondsPerFlop;
+    if (sizeof(RealType) >= 8)
+    {
+      secondsPerFlop *= m_DoublePrecisionFlopFactor;
+    }
+    const double flopsPerTransform = (numberOfPaddedPixels / paddedSize) * this->Estimate1DFlops(paddedSize);
+
+    // Each transform exchanges a real buffer and a full complex buffer with the device
+    const double bytesPerTransform = numberOfPaddedPixels * sizeof(RealType) * 3.0;
+
+    double seconds = numberOfTransforms * (flopsPerTransform * secondsPerFlop +
+                                           bytesPerTransform / m_TransferBytesPerSecond + m_FFTDispatchSeconds);
+    RegionSizeType transformSize = regionSize;
+    transformSize[dimension] = paddedSize;
+    for (const auto direction : { VkCommon::DirectionEnum::FORWARD, VkCommon::DirectionEnum::INVERSE })
+    {
+      if (!this->HasPlanFor(transformSize, VkCommon::FFTEnum::R2FullH, direction, dimension))
+      {
+        seconds += m_FFTPlanSeconds;
+      }
+    }
+    return seconds;
+  }
+
+  /** Whether FFT blurring along one dimension is anticipated to run
+   *  faster than spatial blurring along that dimension. */
+  bool
+  GetUseFFT1D(const RegionSizeType & regionSize, const KernelSizeType & kernelSize, const unsigned int dimension) const
+  {
+    return this->EstimateFFTSeconds1D(regionSize, kernelSize, dimension) <
+           this->EstimateSpatialSeconds1D(regionSize, kernelSize, dimension);
+  }
+
+protected:
+  VkBlurringCostModel() = default;
+  ~VkBlurringCostModel() override = default;
+
+  /** Approximate flops for a complex 1-D transform of length n, from
+   *  VkCommon::EstimateTransformCost. */
+  double
+  Estimate1DFlops(const SizeValueType n) const
+  {
+    const VkCommon::PrecisionEnum precision{ sizeof(RealType) >= 8 ? VkCommon::PrecisionEnum::DOUBLE
+                                                                   : VkCommon::PrecisionEnum::FLOAT };
+    return VkCommon::EstimateTransformCost(n, precision, VkCommon::FFTEnum::C2C, m_GreatestPrimeFactor);
+  }
+
+  /** Whether a VkCommon holds a plan for the transform of `transformSize`
+   *  by the Vk FFT filter of kind `fft` and `direction`, along `dimension`
+   *  only when it is less than ImageDimension. */
+  bool
+  HasPlanFor(const RegionSizeType &  transformSize,
+             VkCommon::FFTEnum       fft,
+             VkCommon::DirectionEnum direction,
+             unsigned int            dimension = ImageDimension) const
+  {
+    VkCommon::VkParameters vkParameters;
+    vkParameters.X = transformSize[0];
+    if (ImageDimension > 1)
+    {
+      vkParameters.Y = transformSize[1];
+    }
+    if (ImageDimension > 2)
+    {
+      vkParameters.Z = transformSize[2];
+    }
+    vkParameters.P = sizeof(RealType) >= 8 ? VkCommon::PrecisionEnum::DOUBLE : VkCommon::PrecisionEnum::FLOAT;
+    vkParameters.fft = fft;
+    vkParameters.PSize = sizeof(RealType);
+    vkParameters.I = direction;
+    vkParameters.normalized = direction == VkCommon::DirectionEnum::INVERSE ? VkCommon::NormalizationEnum::NORMALIZED
+                                                                            : VkCommon::NormalizationEnum::UNNORMALIZED;
+    if (dimension < ImageDimension)
+    {
+      for (unsigned int dim = 0; dim < ImageDimension && dim < 3; ++dim)
+      {
+        vkParameters.omitDimension[dim] = dim == dimension ? 0 : 1;
+      }
+    }
+    return VkCommon::HasAnyPlanFor(vkParameters);
+  }
+
+  /** Smallest size of at least n with no prime factor greater than
+   *  `GreatestPrimeFactor`. */
+  SizeValueType
+  GetNextSupportedSize(const SizeValueType n) const
+  {
+    return static_cast<SizeValueType>(VkCommon::GetNextSupportedSize(n, m_GreatestPrimeFactor));
+  }
+
+  void
+  PrintSelf(std::ostream & os, Indent indent) const override
+  {
+    Superclass::PrintSelf(os, indent);
+    os << indent << "SpatialSecondsPerMultiplyAdd: " << m_SpatialSecondsPerMultiplyAdd << std::endl;
+    os << indent << "NumberOfSpatialThreads: " << m_NumberOfSpatialThreads << std::endl;
+    os << indent << "FFTSecondsPerFlop: " << m_FFTSecondsPerFlop << std::endl;
+    os << indent << "DoublePrecisionFlopFactor: " << m_DoublePrecisionFlopFactor << std::endl;
+    os << indent << "TransferBytesPerSecond: " << m_TransferBytesPerSecond << std::endl;
+    os << indent << "FFTDispatchSeconds: " << m_FFTDispatchSeconds << std::endl;
+    os << indent << "FFTPlanSeconds: " << m_FFTPlanSeconds << std::endl;
+    os << indent << "GreatestPrimeFactor: " << m_GreatestPrimeFactor << std::endl;
+  }
+
+private:
+  double        m_SpatialSecondsPerMultiplyAdd{ 1.0e-9 };
+  unsigned int  m_NumberOfSpatialThreads{ MultiThreaderBase::GetGlobalDefaultNumberOfThreads() };
+  double        m_FFTSecondsPerFlop{ 1.0e-11 };
+  double        m_DoublePrecisionFlopFactor{ 4.0 };
+  double        m_TransferBytesPerSecond{ 8.0e9 };
+  double        m_FFTDispatchSeconds{ 1.0e-4 };
+  double        m_FFTPlanSeconds{ 5.0e-3 };
+  SizeValueType m_GreatestPrimeFactor{ VkCommon::GetGreatestPrimeFactor() };
+};
+} // end namespace itk
+
+#endif // itkVkBlurringCostModel_h
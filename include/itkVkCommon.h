@@ -36,9 +36,32 @@
 #endif
 #include "vkFFT.h"
 
+#include <algorithm>
+#include <iterator>
+#include <map>
+#include <mutex>
+#include <vector>
+
 namespace itk
 {
 
+/** Runs VkFFT transforms of CPU buffers on a GPU device.
+ *
+ *  An instance keeps the VkFFT application of its last run, with the GPU
+ *  buffers it was planned for, while the sizes, batch, precision, type and
+ *  direction of the transforms and the device stay the same. Runs of such a
+ *  plan only copy their CPU buffers to and from the GPU buffers.
+ *
+ *  Thread safety: Run may be called concurrently on different instances.
+ *  Instances using the same device share one context with OpenCL (through
+ *  a process-wide registry) and CUDA (the primary context), and each has a
+ *  context of its own with Level Zero. Each instance submits its copies
+ *  and transforms to a queue of its own without holding any process-wide
+ *  lock: an OpenCL, Level Zero or Metal command queue, or a CUDA stream
+ *  that does not synchronize with the default stream, and waits for that
+ *  queue only. Calls to Run on one instance are serialized. Timings are
+ *  updated by Run and should only be read while no Run of that instance
+ *  is in progress. */
 class VkFFTBackend_EXPORT VkCommon
 {
 public:
@@ -60,7 +83,22 @@ public:
   {
     C2C = 0,     // Complex to Complex
     R2HalfH = 1, // Real to Half Hermetian
-    R2FullH = 2  // Real to Full Hermetian (aka Complex)
+    R2FullH = 2, // Real to Full Hermetian (aka Complex)
+    R2R = 3      // Real to Real (discrete cosine or sine transform)
+  };
+
+  // Kind of real-to-real transform. The inverse of DCT-II is DCT-III and vice versa;
+  // the other kinds are their own inverse, up to normalization.
+  enum class R2REnum
+  {
+    DCT_I = 1,
+    DCT_II = 2,
+    DCT_III = 3,
+    DCT_IV = 4,
+    DST_I = 11,
+    DST_II = 12,
+    DST_III = 13,
+    DST_IV = 14
   };
 
   enum class DirectionEnum
@@ -75,6 +113,29 @@ public:
     NORMALIZED = 1
   };
 
+  // Computation that follows the transform of a run on the device, so that only its result is copied back.
+  // Stages run as OpenCL kernels; with the other backends VkCommon copies the transformed buffer back and
+  // runs the stage on the host, which gives the same result.
+  enum class OutputStageEnum
+  {
+    NONE = 0,
+    // A forward R2HalfH run of six planes: the fixed mask, the masked fixed image and its square, then the
+    // same of the moving side rotated by 180 degrees. Their spectra are multiplied into the overlap, sum,
+    // sum of squares and cross-correlation maps of Padfield's masked NCC, which are transformed back and
+    // normalized into the correlation over stageOutputSize. The output holds the correlation followed by
+    // the largest overlap.
+    MASKED_NCC = 1,
+    // The real maps of a convolution or of an inverse R2HalfH run, each reduced to its largest value over
+    // stageOutputSize after multiplication by its weight plane, if any, where weights of 0 exclude positions.
+    // The output holds the index in stageOutputSize of the maximum of each map, as uint64_t, or UINT64_MAX
+    // where all weights are 0. Then follow MaximumStageValues values of each map, of the real type of the
+    // run: the weighted maximum, and the weighted values at -1 and +1 along each dimension, wrapping around
+    // stageOutputSize, for interpolation.
+    MAXIMUM = 2
+  };
+
+  static constexpr unsigned int MaximumStageValues{ 7 };
+
   struct VkParameters
   {
     uint64_t X{ 0 }; // size of fastest varying dimension
@@ -85,9 +146,11 @@ public:
                                   0 }; // disable FFT for this dimension (0 - FFT enabled, 1 - FFT disabled). Default 0.
                                        // Doesn't work for R2C dimension 0 for now. Doesn't work with convolutions.
     PrecisionEnum P = PrecisionEnum::FLOAT; // type for real numbers
-    uint64_t      B{ 1 };                   // Number of batches -- always 1
+    uint64_t      B{ 1 };                   // Number of batches, stored one after the other in the CPU buffers
+    uint64_t      C{ 1 }; // Number of coordinate features (pixel components), stored one after the other in a batch
     uint64_t      N{ 1 };                   // Number of redundant iterations, for benchmarking -- always 1.
-    FFTEnum       fft{ FFTEnum::C2C };      // ComplexToComplex, RealToHalfHermetian, RealToFullHermetian
+    FFTEnum       fft{ FFTEnum::C2C };      // ComplexToComplex, RealToHalfHermetian, RealToFullHermetian, RealToReal
+    R2REnum       r2r{ R2REnum::DCT_II };   // kind of RealToReal transform; ignored for other transforms
     uint64_t      PSize{ 4 }; // sizeof(float), sizeof(double), or sizeof(half) according to VkParameters.P.
     DirectionEnum I{
       DirectionEnum::FORWARD
@@ -100,22 +163,62 @@ public:
     void *       outputCPUBuffer{ nullptr }; // output buffer in CPU memory
     uint64_t     outputBufferBytes{ 0 };     // number of bytes in outputCPUBuffer
 
+    bool interleavedComponents{ false }; // the C components of each pixel are adjacent in the CPU buffers, as
+                                         // in ITK vector images, rather than planes one after the other; they
+                                         // are reordered on the GPU
+
+    // Convolution: a forward R2HalfH run that multiplies the spectrum of its input by each of
+    // numberOfKernels kernel spectra and transforms the products back in the same run. The output
+    // buffer holds numberOfKernels real results. Kernel spectra are half Hermitian, one after the other.
+    bool             convolution{ false };
+    uint64_t         numberOfKernels{ 1 };
+    bool             conjugateKernel{ false };   // multiply by the conjugate kernel spectra, which correlates
+    bool             normalizeProducts{ false }; // divide the products by their magnitude, as for phase
+                                                 // correlation; products must not vanish, or they give NaN
+    bool             transformKernel{ false };   // kernelCPUBuffer holds real kernels of the transform size, one
+                                                 // after the other, which are transformed on the GPU
+    bool             kernelPerBatch{ false };    // the kernels hold numberOfKernels for each of the B batches,
+                                                 // which convolve only that batch, rather than for all batches
+    const void *     kernelCPUBuffer{ nullptr }; // kernel spectra in CPU memory
+    uint64_t         kernelBufferBytes{ 0 };     // number of bytes in kernelCPUBuffer
+    ModifiedTimeType kernelModifiedTime{ 0 };    // kernels are copied to the GPU again only when this
+                                                 // changes, or on each run when it is 0
+
+    // Output stage, see OutputStageEnum. The output buffer holds the result of the stage only.
+    OutputStageEnum outputStage{ OutputStageEnum::NONE };
+    uint64_t        stageOutputSize[3] = { 1, 1, 1 }; // region at the lowest indices that the stage reads
+    uint64_t        requiredOverlap{ 0 };             // MASKED_NCC: least number of overlapping pixels
+    double          requiredOverlapFraction{ 0.0 };   // MASKED_NCC: least fraction of the largest overlap
+
+    // MAXIMUM: optional weight planes over stageOutputSize, and the plane of each map, or plane 0 for all maps
+    const void *     stageWeightsCPUBuffer{ nullptr };
+    uint64_t         stageWeightsBufferBytes{ 0 };
+    const uint64_t * stageWeightPlanes{ nullptr };
+
+    /** Whether the transforms differ so that they need different plans.
+     *  The CPU buffers of a run are not part of its plan. */
     bool
     operator!=(const VkParameters & rhs) const
     {
       return this->X != rhs.X || this->Y != rhs.Y || this->Z != rhs.Z || this->P != rhs.P || this->B != rhs.B ||
-             this->N != rhs.N || this->fft != rhs.fft || this->PSize != rhs.PSize || this->I != rhs.I ||
-             this->normalized != rhs.normalized || this->inputCPUBuffer != rhs.inputCPUBuffer ||
-             this->inputBufferBytes != rhs.inputBufferBytes || this->outputCPUBuffer != rhs.outputCPUBuffer ||
-             this->outputBufferBytes != rhs.outputBufferBytes;
+             this->C != rhs.C || this->N != rhs.N || this->fft != rhs.fft || this->r2r != rhs.r2r ||
+             this->PSize != rhs.PSize || this->I != rhs.I || this->normalized != rhs.normalized ||
+             this->interleavedComponents != rhs.interleavedComponents || this->convolution != rhs.convolution ||
+             this->numberOfKernels != rhs.numberOfKernels || this->conjugateKernel != rhs.conjugateKernel ||
+             this->normalizeProducts != rhs.normalizeProducts || this->transformKernel != rhs.transformKernel ||
+             this->kernelPerBatch != rhs.kernelPerBatch || this->outputStage != rhs.outputStage ||
+             !std::equal(
+               std::begin(this->stageOutputSize), std::end(this->stageOutputSize), std::begin(rhs.stageOutputSize)) ||
+             !std::equal(std::begin(this->omitDimension), std::end(this->omitDimension), std::begin(rhs.omitDimension));
     }
   };
 
   struct VkGPU
   {
 #if (VKFFT_BACKEND == CUDA)
-    CUdevice  device{ 0 };
-    CUcontext context{ 0 };
+    CUdevice     device{ 0 };
+    CUcontext    context{ 0 };
+    cudaStream_t stream{ nullptr };
 #elif (VKFFT_BACKEND == OPENCL)
     cl_platform_id   platform{ 0 };
     cl_device_id     device{ 0 };
@@ -131,13 +234,19 @@ public:
     MTL::Device *       device{ nullptr };
     MTL::CommandQueue * queue{ nullptr };
 #endif
-    uint64_t device_id{ 0 }; // default value
+    uint64_t device_id{ 0 };    // default value
+    bool     profiling{ false }; // record device-side timestamps of copies and transforms
 
     bool
     operator!=(const VkGPU & rhs) const
     {
+      if (this->profiling != rhs.profiling)
+      {
+        return true;
+      }
 #if (VKFFT_BACKEND == CUDA)
-      return this->device != rhs.device || this->context != rhs.context || this->device_id != rhs.device_id;
+      return this->device != rhs.device || this->context != rhs.context || this->stream != rhs.stream ||
+             this->device_id != rhs.device_id;
 #elif (VKFFT_BACKEND == OPENCL)
       return this->platform != rhs.platform || this->device != rhs.device || this->context != rhs.context ||
              this->commandQueue != rhs.commandQueue || this->device_id != rhs.device_id;
@@ -153,38 +262,483 @@ public:
     }
   };
 
+  /** Wall-clock seconds spent in each phase of Run, accumulated over
+   *  all runs since construction or the last call to ResetTimings.
+   *
+   *  When VkGPU::profiling is set, copies and transforms are additionally
+   *  timed on the device: with OpenCL profiling queue events (markers
+   *  bracket the transform kernels), with CUDA events, or with the Metal
+   *  command buffer GPU times. Metal copies are host memcpy into shared
+   *  memory, whose time is only in hostToDeviceSeconds and
+   *  deviceToHostSeconds. Device-side timings are not recorded with
+   *  Level Zero. */
+  struct VkTimings
+  {
+    double   setupSeconds{ 0.0 };         // ConfigureBackend: device, context and queue
+    double   allocationSeconds{ 0.0 };    // Device buffer allocation for a new plan
+    double   hostToDeviceSeconds{ 0.0 };  // Input copy from CPU to GPU
+    double   planSeconds{ 0.0 };          // initializeVkFFT for a new plan
+    double   appendSeconds{ 0.0 };        // VkFFTAppend: recording or launching the transform
+    double   synchronizeSeconds{ 0.0 };   // Waiting for the device to complete the transform
+    double   deviceToHostSeconds{ 0.0 };  // Output copy from GPU to CPU
+    double   conjugateFillSeconds{ 0.0 }; // Host fill of the redundant R2FullH half
+    double   outputStageSeconds{ 0.0 };   // Output stage, including the copy of its result to the CPU
+    uint64_t numberOfRuns{ 0 };
+    uint64_t numberOfConfigurations{ 0 }; // Runs that made a new plan
+    uint64_t numberOfZeroCopyRuns{ 0 }; // Runs that used the CPU buffers in place of device copies
+
+    // Device-side timings, recorded only when profiling
+    double   deviceHostToDeviceSeconds{ 0.0 };
+    double   deviceKernelSeconds{ 0.0 };
+    double   deviceDeviceToHostSeconds{ 0.0 };
+    uint64_t hostToDeviceBytes{ 0 };
+    uint64_t deviceToHostBytes{ 0 };
+    double   transformFlops{ 0.0 }; // Estimated as 5 N log2(N) per complex transform
+    uint64_t numberOfProfiledRuns{ 0 };
+
+    double
+    GetTotalSeconds() const
+    {
+      return setupSeconds + allocationSeconds + hostToDeviceSeconds + planSeconds + appendSeconds +
+             synchronizeSeconds + deviceToHostSeconds + conjugateFillSeconds + outputStageSeconds;
+    }
+
+    /** Transform throughput over device kernel time only. */
+    double
+    GetKernelGFLOPS() const
+    {
+      return deviceKernelSeconds > 0.0 ? 1.0e-9 * transformFlops / deviceKernelSeconds : 0.0;
+    }
+
+    /** Achieved transfer bandwidth in 10^9 bytes per second. */
+    double
+    GetHostToDeviceGBPerSecond() const
+    {
+      return deviceHostToDeviceSeconds > 0.0 ? 1.0e-9 * hostToDeviceBytes / deviceHostToDeviceSeconds : 0.0;
+    }
+
+    double
+    GetDeviceToHostGBPerSecond() const
+    {
+      return deviceDeviceToHostSeconds > 0.0 ? 1.0e-9 * deviceToHostBytes / deviceDeviceToHostSeconds : 0.0;
+    }
+
+    VkTimings &
+    operator+=(const VkTimings & rhs)
+    {
+      setupSeconds += rhs.setupSeconds;
+      allocationSeconds += rhs.allocationSeconds;
+      hostToDeviceSeconds += rhs.hostToDeviceSeconds;
+      planSeconds += rhs.planSeconds;
+      appendSeconds += rhs.appendSeconds;
+      synchronizeSeconds += rhs.synchronizeSeconds;
+      deviceToHostSeconds += rhs.deviceToHostSeconds;
+      conjugateFillSeconds += rhs.conjugateFillSeconds;
+      outputStageSeconds += rhs.outputStageSeconds;
+      numberOfRuns += rhs.numberOfRuns;
+      numberOfConfigurations += rhs.numberOfConfigurations;
+      numberOfZeroCopyRuns += rhs.numberOfZeroCopyRuns;
+      deviceHostToDeviceSeconds += rhs.deviceHostToDeviceSeconds;
+      deviceKernelSeconds += rhs.deviceKernelSeconds;
+      deviceDeviceToHostSeconds += rhs.deviceDeviceToHostSeconds;
+      hostToDeviceBytes += rhs.hostToDeviceBytes;
+      deviceToHostBytes += rhs.deviceToHostBytes;
+      transformFlops += rhs.transformFlops;
+      numberOfProfiledRuns += rhs.numberOfProfiledRuns;
+      return *this;
+    }
+  };
+
   VkFFTResult
   Run(const VkGPU & vkGPU, const VkParameters & vkParameters);
 
+  /** Timings are returned by copy under the run lock, and so wait for a
+   *  run in progress on another thread. */
+  VkTimings
+  GetTimings() const
+  {
+    const std::lock_guard<std::mutex> lock(m_RunMutex);
+    return m_VkTimings;
+  }
+
+  /** Timings of the most recent run only. */
+  VkTimings
+  GetLastRunTimings() const
+  {
+    const std::lock_guard<std::mutex> lock(m_RunMutex);
+    return m_LastRunTimings;
+  }
+
+  void
+  ResetTimings()
+  {
+    const std::lock_guard<std::mutex> lock(m_RunMutex);
+    m_VkTimings = VkTimings{};
+  }
+
   VkFFTResult
   ReleaseBackend();
 
-  uint64_t
-  GetGreatestPrimeFactor() const
+  /** Greatest prime factor of the lengths VkFFT transforms with its
+   *  radix kernels, i.e. the greatest radix of EstimateTransformCost.
+   *  Lengths with a greater prime factor use Bluestein's algorithm. */
+  static uint64_t
+  GetGreatestPrimeFactor();
+
+  /** Measured or precomputed transform costs keyed by transform length.
+   *  Costs are relative and only need to be consistent within one table. */
+  using SizeCostTableType = std::map<uint64_t, double>;
+
+  /** Largest prime factor of n, or 1 for n <= 1. */
+  static uint64_t
+  GetLargestPrimeFactor(uint64_t n);
+
+  /** Smallest length of at least n with no prime factor greater than
+   *  `greatestPrimeFactor`. */
+  static uint64_t
+  GetNextSupportedSize(uint64_t n, uint64_t greatestPrimeFactor = GetGreatestPrimeFactor());
+
+  /** Cost in floating point operations of a 1-D transform of length n,
+   *  from the radix passes VkFFT would use and the number of shared-memory
+   *  uploads. A radix-2 pass costs 5 operations per element, as in the
+   *  common 5 N log2(N) estimate. Lengths with a prime factor greater than
+   *  `greatestPrimeFactor` fall back on Bluestein's algorithm. This is the
+   *  transform cost of VkFFTCostModel, VkBlurringCostModel and padding. */
+  static double
+  EstimateTransformCost(uint64_t      n,
+                        PrecisionEnum precision,
+                        FFTEnum       fft,
+                        uint64_t      greatestPrimeFactor = GetGreatestPrimeFactor());
+
+  /** Fastest transform length of at least n. Lengths present in
+   *  `measuredCosts` use the tabulated cost in place of the estimate. */
+  static uint64_t
+  GetOptimalFFTSize(uint64_t                  n,
+                    PrecisionEnum             precision,
+                    FFTEnum                   fft,
+                    const SizeCostTableType * measuredCosts = nullptr);
+
+  /** Whether the instance holds a plan for the transforms of
+   *  `vkParameters`, so that a run of them on the device of the last
+   *  run only copies the CPU buffers. */
+  bool
+  HasPlanFor(const VkParameters & vkParameters) const
+  {
+    const std::lock_guard<std::mutex> lock(m_RunMutex);
+    return m_HasPlan && !(vkParameters != m_VkParametersPrevious);
+  }
+
+  /** Whether any instance in the process holds a plan for the
+   *  transforms of `vkParameters`, so that the filter owning it
+   *  skips planning when it runs them again. */
+  static bool
+  HasAnyPlanFor(const VkParameters & vkParameters);
+
+  /** Whether the instance holds a plan for the transforms of
+   *  `vkParameters`, and if so, the device it was made on. */
+  bool
+  GetPlanDeviceID(const VkParameters & vkParameters, uint64_t & deviceID) const
   {
-    return 13UL;
+    const std::lock_guard<std::mutex> lock(m_RunMutex);
+    deviceID = m_VkGPUPrevious.device_id;
+    return m_HasPlan && !(vkParameters != m_VkParametersPrevious);
   }
 
+  /** Whether `resFFT` reports that no device could be set up,
+   *  as opposed to a failure of a transform on a working device. */
+  static bool
+  IsDeviceUnavailable(VkFFTResult resFFT);
+
+  /** Number of devices enumerated by the backend, in the order of
+   *  VkGPU::device_id, or 0 if none can be enumerated. */
+  static uint64_t
+  GetNumberOfDevices();
+
+  /** Global memory of an enumerated device in bytes, or 0 if unknown. */
+  static uint64_t
+  GetDeviceMemoryBytes(uint64_t deviceID);
+
+  /** Alignment in bytes that CPU buffers need for an enumerated device to
+   *  use them in place, or 0 if the device does not share memory with the
+   *  host. Only OpenCL devices that report CL_DEVICE_HOST_UNIFIED_MEMORY,
+   *  such as CPU implementations and integrated GPUs, use CPU buffers in
+   *  place. */
+  static uint64_t
+  GetDeviceHostPointerAlignment(uint64_t deviceID);
+
   VkCommon() = default;
   ~VkCommon() { this->ReleaseBackend(); }
 
 protected:
+  VkFFTResult
+  ConfigureAndPerformFFT(const VkGPU & vkGPU, const VkParameters & vkParameters);
+
   VkFFTResult
   ConfigureBackend();
 
+  /** Set up the VkFFT application and allocate its GPU buffers. */
+  VkFFTResult
+  ConfigurePlan();
+
+  void
+  ReleasePlan();
+
   VkFFTResult
   PerformFFT();
 
+  /** Whether the transform runs in a single GPU buffer that holds
+   *  both the input and the output, as for C2C and R2R. */
+  bool
+  IsInPlace() const
+  {
+    return m_VkParameters.fft == FFTEnum::C2C || m_VkParameters.fft == FFTEnum::R2R;
+  }
+
+  /** Whether the transform reads a separate real input buffer,
+   *  as for forward R2HalfH and R2FullH. */
+  bool
+  HasFormattedInput() const
+  {
+    return !this->IsInPlace() && m_VkParameters.I == DirectionEnum::FORWARD;
+  }
+
+  /** Whether the transform writes a separate real output buffer,
+   *  as for inverse R2HalfH and R2FullH, and for convolution. */
+  bool
+  HasFormattedOutput() const
+  {
+    return !this->IsInPlace() && (m_VkParameters.I == DirectionEnum::INVERSE || m_VkParameters.convolution);
+  }
+
+  /** Bytes of the main GPU buffer: complex elements except for R2R. */
+  uint64_t
+  GetBufferBytes() const
+  {
+    return (m_VkParameters.fft == FFTEnum::R2R ? 1UL : 2UL) * m_VkParameters.PSize * m_BufferSize;
+  }
+
+  /** Bytes of the CPU input and output buffers of a run of the plan. The
+   *  CPU output buffer holds the result of the output stage if there is
+   *  one, which is smaller than the GPU output buffer. */
+  uint64_t
+  GetInputBufferBytes() const
+  {
+    return this->HasFormattedInput() ? m_VkParameters.PSize * m_InputBufferSize : this->GetBufferBytes();
+  }
+
+  uint64_t
+  GetOutputBufferBytes() const
+  {
+    if (m_VkParameters.outputStage != OutputStageEnum::NONE)
+    {
+      return this->GetStageOutputBytes();
+    }
+    return this->HasFormattedOutput() ? m_VkParameters.PSize * m_OutputBufferSize : this->GetBufferBytes();
+  }
+
+  /** Bytes of an element of the CPU input and output buffers: a real
+   *  number for real buffers, and two for complex ones. */
+  uint64_t
+  GetInputElementBytes() const
+  {
+    const bool real{ this->HasFormattedInput() || m_VkParameters.fft == FFTEnum::R2R };
+    return (real ? 1UL : 2UL) * m_VkParameters.PSize;
+  }
+
+  uint64_t
+  GetOutputElementBytes() const
+  {
+    const bool real{ this->HasFormattedOutput() || m_VkParameters.fft == FFTEnum::R2R };
+    return (real ? 1UL : 2UL) * m_VkParameters.PSize;
+  }
+
+  /** Bytes of the CPU kernel buffer of a run of the plan: kernel
+   *  spectra, or real kernels that are transformed on the GPU. */
+  uint64_t
+  GetKernelBufferBytes() const
+  {
+    return m_VkParameters.transformKernel ? m_KernelInputBufferBytes : m_KernelBufferBytes;
+  }
+
+  /** Number of kernels in the kernel buffer. */
+  uint64_t
+  GetNumberOfKernelPlanes() const
+  {
+    return m_VkParameters.numberOfKernels * (m_VkParameters.kernelPerBatch ? m_VkParameters.B : 1);
+  }
+
+  /** Number of real maps that the MAXIMUM stage reduces. */
+  uint64_t
+  GetNumberOfStageMaps() const
+  {
+    return (m_VkParameters.convolution ? m_VkParameters.numberOfKernels : 1) * m_VkParameters.B * m_VkParameters.C;
+  }
+
+  /** Number of elements of the region that the output stage reads. */
+  uint64_t
+  GetStageOutputPixels() const
+  {
+    return m_VkParameters.stageOutputSize[0] * m_VkParameters.stageOutputSize[1] * m_VkParameters.stageOutputSize[2];
+  }
+
+  /** Bytes of the result of the output stage. */
+  uint64_t
+  GetStageOutputBytes() const
+  {
+    if (m_VkParameters.outputStage == OutputStageEnum::MAXIMUM)
+    {
+      return this->GetNumberOfStageMaps() * (sizeof(uint64_t) + MaximumStageValues * m_VkParameters.PSize);
+    }
+    return m_VkParameters.PSize * (this->GetStageOutputPixels() + 1);
+  }
+
+#if (VKFFT_BACKEND == CUDA)
+  using GPUBufferType = void *;
+#elif (VKFFT_BACKEND == OPENCL)
+  using GPUBufferType = cl_mem;
+#elif (VKFFT_BACKEND == LEVEL_ZERO)
+  using GPUBufferType = void *;
+#elif (VKFFT_BACKEND == METAL)
+  using GPUBufferType = MTL::Buffer *;
+#else
+  using GPUBufferType = void *;
+#endif
+
+  VkFFTResult
+  AllocateGPUBuffer(GPUBufferType & buffer, uint64_t bytes);
+
+  void
+  ReleaseGPUBuffer(GPUBufferType & buffer);
+
+  /** Blocking copies between CPU and GPU buffers. When `deviceSeconds` is
+   *  given, the device time of the copy is added to it where the backend
+   *  records one. */
+  VkFFTResult
+  CopyToGPU(GPUBufferType buffer, const void * cpuBuffer, uint64_t bytes, double * deviceSeconds);
+
+  VkFFTResult
+  CopyFromGPU(void * cpuBuffer, GPUBufferType buffer, uint64_t bytes, double * deviceSeconds);
+
+  /** Copies of the CPU input buffer to, and of the CPU output buffer from,
+   *  a GPU buffer for runs with interleaved components, which reorder the
+   *  components between pixels and planes on the way. */
+  VkFFTResult
+  CopyComponentsToGPU(GPUBufferType buffer);
+
+  VkFFTResult
+  CopyComponentsFromGPU(GPUBufferType buffer);
+
+  /** Set up the forward application that transforms real kernels into
+   *  the kernel buffer of the convolution. */
+  VkFFTResult
+  ConfigureKernelTransform();
+
+  /** Launch a transform of `application` and wait for it to complete. */
+  VkFFTResult
+  AppendAndWait(VkFFTApplication & application, DirectionEnum direction, VkFFTLaunchParams & launchParams);
+
+  /** Set up what the output stage of the plan needs besides the VkFFT
+   *  application: further applications, GPU buffers and kernels. */
+  VkFFTResult
+  ConfigureOutputStage();
+
+  void
+  ReleaseOutputStage();
+
+  /** Set up the GPU buffer through which the components are reordered in
+   *  runs with interleaved components. */
+  VkFFTResult
+  ConfigureComponentReorder();
+
+  /** Run the output stage on the transformed GPU buffers and copy its
+   *  result to the CPU output buffer. */
+  VkFFTResult
+  PerformOutputStage();
+
+  /** Run the output stage on copies of the GPU buffers, where the
+   *  backend has no stage kernels. */
+  template <typename TReal>
+  VkFFTResult
+  PerformOutputStageOnHost();
+
+#if (VKFFT_BACKEND == OPENCL)
+  /** Build the program of the stage kernels, unless it is built. */
+  VkFFTResult
+  ConfigureStageKernels();
+
+  /** Move the components of `bytes` of elements of `elementBytes` from
+   *  `source` into `destination`, from adjacent in each pixel to planes
+   *  if `toPlanes`, and back otherwise. */
+  VkFFTResult
+  ReorderComponentsOnGPU(GPUBufferType source,
+                         GPUBufferType destination,
+                         uint64_t      bytes,
+                         uint64_t      elementBytes,
+                         bool          toPlanes);
+#endif
+
 private:
   // Backend parameters
   VkGPU              m_VkGPU{};
   VkParameters       m_VkParameters{};
   VkFFTConfiguration m_VkFFTConfiguration{};
 
-  // Re-create GPU kernel if these members indicate to
+  // Element counts of the GPU buffers over all batches
+  uint64_t m_BufferSize{ 0 };
+  uint64_t m_InputBufferSize{ 0 };
+  uint64_t m_OutputBufferSize{ 0 };
+
+  // Alignment of CPU buffers used in place by the device, or 0 if none are
+  uint64_t m_HostPointerAlignment{ 0 };
+
+  // VkFFT application and the GPU buffers it was planned for. The input or
+  // output buffer is the main buffer unless the transform needs a separate one.
+  VkFFTApplication m_VkFFTApplication{};
+  bool             m_HasPlan{ false };
+  GPUBufferType    m_GPUBuffer{};
+  GPUBufferType    m_InputGPUBuffer{};
+  GPUBufferType    m_OutputGPUBuffer{};
+
+  // Kernel spectra of a convolution plan, which stay on the GPU between runs
+  // until the kernels change. The size is in bytes, as VkFFT expects.
+  GPUBufferType    m_KernelGPUBuffer{};
+  uint64_t         m_KernelBufferBytes{ 0 };
+  ModifiedTimeType m_KernelModifiedTime{ 0 };
+
+  // Real kernels of a plan that transforms them on the GPU, and the forward application that does
+  VkFFTApplication m_KernelVkFFTApplication{};
+  bool             m_HasKernelPlan{ false };
+  GPUBufferType    m_KernelInputGPUBuffer{};
+  uint64_t         m_KernelInputBufferBytes{ 0 };
+
+  // Output stage of the plan: the inverse application of the masked NCC, which transforms the products in
+  // the main buffer back into the input buffer, the GPU buffer of the stage result and the stage kernels,
+  // which also reorder interleaved components
+  VkFFTApplication m_StageVkFFTApplication{};
+  bool             m_HasStagePlan{ false };
+  GPUBufferType    m_StageGPUBuffer{};
+#if (VKFFT_BACKEND == OPENCL)
+  GPUBufferType          m_StageWeightsGPUBuffer{};
+  GPUBufferType          m_StageWeightPlanesGPUBuffer{};
+  cl_program             m_StageProgram{ nullptr };
+  std::vector<cl_kernel> m_StageKernels{};
+  size_t                 m_StageGroupSize{ 1 };
+
+  // Interleaved components of a run on their way between the CPU buffers and the planes VkFFT works on
+  GPUBufferType m_ReorderGPUBuffer{};
+#endif
+
+  // Re-create the backend or the plan if these members indicate to
   bool         m_MustConfigure{ true };
   VkGPU        m_VkGPUPrevious{};
   VkParameters m_VkParametersPrevious{};
+
+  // Serializes runs of this instance
+  mutable std::mutex m_RunMutex{};
+
+  // Accumulated and most recent per-phase timings
+  VkTimings m_VkTimings{};
+  VkTimings m_LastRunTimings{};
 };
 
 } // namespace itk
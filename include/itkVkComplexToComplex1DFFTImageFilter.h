@@ -21,8 +21,12 @@
 
 #include "itkComplexToComplex1DFFTImageFilter.h"
 #include "itkFFTImageFilterFactory.h"
+#include "itkVkAlignedImportImageContainer.h"
 #include "itkVkCommon.h"
+#include "itkVkFFTDispatcher.h"
 #include "itkVkGlobalConfiguration.h"
+#include "itkVkTimingsReporter.h"
+#include "itkVnlComplexToComplex1DFFTImageFilter.h"
 
 namespace itk
 {
@@ -46,7 +50,9 @@ namespace itk
  * \ingroup VkFFTBackend
  */
 template <typename TInputImage, typename TOutputImage = TInputImage>
-class VkComplexToComplex1DFFTImageFilter : public ComplexToComplex1DFFTImageFilter<TInputImage, TOutputImage>
+class VkComplexToComplex1DFFTImageFilter
+  : public ComplexToComplex1DFFTImageFilter<TInputImage, TOutputImage>
+  , public VkTimingsReporter
 {
 public:
   ITK_DISALLOW_COPY_AND_MOVE(VkComplexToComplex1DFFTImageFilter);
@@ -94,7 +100,9 @@ public:
   itkSetMacro(DeviceID, uint64_t);
 
   /** Return the enumerated GPU device to use for FFT
-   *  according to current filter settings. */
+   *  according to current filter settings. With the global
+   *  configuration, runs are placed on devices by its scheduling
+   *  policy, which is this device only for the FIXED policy. */
   uint64_t
   GetDeviceID() const
   {
@@ -104,20 +112,40 @@ public:
   SizeValueType
   GetSizeGreatestPrimeFactor() const override;
 
+  /** Number of updates computed with a CPU implementation in place of
+   *  VkFFT, as chosen by the cost model of VkGlobalConfiguration or
+   *  because no device was available. See VkFFTDispatcher. */
+  SizeValueType
+  GetNumberOfCPURuns() const
+  {
+    return m_FFTDispatcher.GetNumberOfCPURuns();
+  }
+
 protected:
-  VkComplexToComplex1DFFTImageFilter() = default;
+  VkComplexToComplex1DFFTImageFilter()
+    : VkTimingsReporter{ &m_VkCommon }
+  {}
   ~VkComplexToComplex1DFFTImageFilter() override = default;
 
   void
   GenerateData() override;
 
+  /** Compute the output with the CPU implementation of the dispatcher. */
+  void
+  GenerateDataOnCPU();
+
   void
   PrintSelf(std::ostream & os, Indent indent) const override;
 
 private:
   bool     m_UseVkGlobalConfiguration{ true };
   uint64_t m_DeviceID{ 0UL };
-  VkCommon m_VkCommon{};
+  using FFTDispatcherType =
+    VkFFTDispatcher<Superclass, VnlComplexToComplex1DFFTImageFilter<InputImageType, OutputImageType>>;
+  using LengthsType = typename FFTDispatcherType::LengthsType;
+
+  VkCommon          m_VkCommon{};
+  FFTDispatcherType m_FFTDispatcher{};
 };
 
 // Describe whether input/output are real- or complex-valued
@@ -21,8 +21,12 @@
 
 #include "itkComplexToComplexFFTImageFilter.h"
 #include "itkFFTImageFilterFactory.h"
+#include "itkVkAlignedImportImageContainer.h"
 #include "itkVkCommon.h"
+#include "itkVkFFTDispatcher.h"
 #include "itkVkGlobalConfiguration.h"
+#include "itkVkTimingsReporter.h"
+#include "itkVnlComplexToComplexFFTImageFilter.h"
 
 namespace itk
 {
@@ -43,7 +47,9 @@ namespace itk
  * \ingroup VkFFTBackend
  */
 template <typename TInputImage, typename TOutputImage = TInputImage>
-class VkComplexToComplexFFTImageFilter : public ComplexToComplexFFTImageFilter<TInputImage, TOutputImage>
+class VkComplexToComplexFFTImageFilter
+  : public ComplexToComplexFFTImageFilter<TInputImage, TOutputImage>
+  , public VkTimingsReporter
 {
 public:
   ITK_DISALLOW_COPY_AND_MOVE(VkComplexToComplexFFTImageFilter);
@@ -91,7 +97,9 @@ public:
   itkSetMacro(DeviceID, uint64_t);
 
   /** Return the enumerated GPU device to use for FFT
-   *  according to current filter settings. */
+   *  according to current filter settings. With the global
+   *  configuration, runs are placed on devices by its scheduling
+   *  policy, which is this device only for the FIXED policy. */
   uint64_t
   GetDeviceID() const
   {
@@ -101,6 +109,15 @@ public:
   SizeValueType
   GetSizeGreatestPrimeFactor() const;
 
+  /** Number of updates computed with a CPU implementation in place of
+   *  VkFFT, as chosen by the cost model of VkGlobalConfiguration or
+   *  because no device was available. See VkFFTDispatcher. */
+  SizeValueType
+  GetNumberOfCPURuns() const
+  {
+    return m_FFTDispatcher.GetNumberOfCPURuns();
+  }
+
 protected:
   VkComplexToComplexFFTImageFilter();
   ~VkComplexToComplexFFTImageFilter() override = default;
@@ -108,6 +125,10 @@ protected:
   void
   GenerateData() override;
 
+  /** Compute the output with the CPU implementation of the dispatcher. */
+  void
+  GenerateDataOnCPU();
+
   void
   PrintSelf(std::ostream & os, Indent indent) const override;
 
@@ -115,7 +136,11 @@ private:
   bool     m_UseVkGlobalConfiguration{ true };
   uint64_t m_DeviceID{ 0UL };
 
-  VkCommon m_VkCommon{};
+  using FFTDispatcherType = VkFFTDispatcher<Superclass, VnlComplexToComplexFFTImageFilter<InputImageType>>;
+  using LengthsType = typename FFTDispatcherType::LengthsType;
+
+  VkCommon          m_VkCommon{};
+  FFTDispatcherType m_FFTDispatcher{};
 };
 
 // Describe whether input/output are real- or complex-valued
@@ -0,0 +1,69 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         https://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkVkDST1DImageFilter_h
+#define itkVkDST1DImageFilter_h
+
+#include "itkVkRealToRealFFTImageFilter.h"
+
+namespace itk
+{
+/**
+ *\class VkDST1DImageFilter
+ *
+ * \brief Vk-based discrete sine transform of a real image along one direction.
+ *
+ * Computes the DST of the given type along the dimension given by Direction,
+ * independently for every line of the image.
+ *
+ * \ingroup FourierTransform
+ * \ingroup VkFFTBackend
+ *
+ * \sa VkRealToRealFFTImageFilter
+ */
+template <typename TImage>
+class VkDST1DImageFilter : public VkRealToRealFFTImageFilter<TImage>
+{
+public:
+  ITK_DISALLOW_COPY_AND_MOVE(VkDST1DImageFilter);
+
+  /** Standard class type aliases. */
+  using Self = VkDST1DImageFilter;
+  using Superclass = VkRealToRealFFTImageFilter<TImage>;
+  using Pointer = SmartPointer<Self>;
+  using ConstPointer = SmartPointer<const Self>;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkOverrideGetNameOfClassMacro(VkDST1DImageFilter);
+
+  /** Dimension along which the transform is computed. Defaults to 0. */
+  itkSetMacro(Direction, unsigned int);
+  itkGetConstMacro(Direction, unsigned int);
+
+protected:
+  VkDST1DImageFilter()
+    : Superclass(true, true)
+  {}
+  ~VkDST1DImageFilter() override = default;
+};
+
+} // namespace itk
+
+#endif // itkVkDST1DImageFilter_h
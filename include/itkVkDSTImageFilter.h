@@ -0,0 +1,64 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         https://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkVkDSTImageFilter_h
+#define itkVkDSTImageFilter_h
+
+#include "itkVkRealToRealFFTImageFilter.h"
+
+namespace itk
+{
+/**
+ *\class VkDSTImageFilter
+ *
+ * \brief Vk-based discrete sine transform of a real image.
+ *
+ * Computes the DST of the given type along every dimension of the image.
+ *
+ * \ingroup FourierTransform
+ * \ingroup VkFFTBackend
+ *
+ * \sa VkRealToRealFFTImageFilter
+ */
+template <typename TImage>
+class VkDSTImageFilter : public VkRealToRealFFTImageFilter<TImage>
+{
+public:
+  ITK_DISALLOW_COPY_AND_MOVE(VkDSTImageFilter);
+
+  /** Standard class type aliases. */
+  using Self = VkDSTImageFilter;
+  using Superclass = VkRealToRealFFTImageFilter<TImage>;
+  using Pointer = SmartPointer<Self>;
+  using ConstPointer = SmartPointer<const Self>;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkOverrideGetNameOfClassMacro(VkDSTImageFilter);
+
+protected:
+  VkDSTImageFilter()
+    : Superclass(true, false)
+  {}
+  ~VkDSTImageFilter() override = default;
+};
+
+} // namespace itk
+
+#endif // itkVkDSTImageFilter_h
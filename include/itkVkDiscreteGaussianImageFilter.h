@@ -21,8 +21,13 @@
 #include "itkMacro.h"
 #include "itkDiscreteGaussianImageFilter.h"
 #include "itkFFTDiscreteGaussianImageFilter.h"
+#include "itkForward1DFFTImageFilter.h"
+#include "itkInverse1DFFTImageFilter.h"
+#include "itkVkBlurringCostModel.h"
 #include "VkFFTBackendExport.h"
 
+#include <memory>
+
 namespace itk
 {
 /**
@@ -49,6 +54,34 @@ namespace itk
  * is observed to occur for the user's system. This threshold can be
  * determined via benchmarking scripts in VkFFTBackend.
  *
+ * Alternatively a VkBlurringCostModel calibrated for the user's system
+ * may be set, in which case the procedure with the lower estimated
+ * runtime in seconds is selected and the metric threshold is ignored.
+ *
+ * FFT blurring transforms the whole padded requested region at once.
+ * When an FFT memory budget is set, the output requested region is instead
+ * split into tiles along its slowest varying dimension. Each tile is blurred
+ * from the input region overlapping it by the kernel radius and copied into
+ * the output, so results match untiled blurring. Tiles are double buffered:
+ * one tile is blurred on a worker thread while the previous one is copied
+ * into the output, so the padded region of each tile fits within half of
+ * the budget.
+ *
+ * With anisotropic kernels a single spatial versus FFT decision for the
+ * whole image is often poor, e.g. when a large variance along a coarsely
+ * sampled axis calls for a wide kernel while the other axes need only a few
+ * taps. When `UseHybridBlurring` is enabled each filtered dimension is
+ * instead blurred in turn, either with the 1-D Gaussian operator or with a
+ * batch of 1-D FFT convolutions along that dimension through the
+ * Forward1DFFTImageFilter and Inverse1DFFTImageFilter object factory
+ * overrides, as selected per dimension by GetUseFFT(dimension). FFT
+ * dimensions are padded by the kernel radius with the real boundary
+ * condition and multiplied by the analytic frequency response of the
+ * kernel, so no N-dimensional transform is required. Hybrid blurring
+ * computes in the output pixel type and supports zero-flux Neumann,
+ * periodic and constant real boundary conditions; with any other
+ * boundary condition all dimensions are blurred with one procedure.
+ *
  * \sa GaussianOperator
  * \sa DiscreteGaussianImageFilter
  * \sa FFTDiscreteGaussianImageFilter
@@ -91,26 +124,70 @@ public:
   using typename Superclass::RadiusType;
   using KernelSizeType = RadiusType;
   using RegionSizeType = typename OutputImageType::SizeType;
+  using OutputRegionType = typename OutputImageType::RegionType;
+  using RealValueType = typename NumericTraits<typename OutputImageType::PixelType>::ValueType;
+  using RealImageType = Image<RealValueType, ImageDimension>;
+  using ComplexImageType = Image<std::complex<RealValueType>, ImageDimension>;
+  using HybridBoundaryConditionType = ImageBoundaryCondition<RealImageType>;
 
   /** Typedef for convolution */
   using BaseBlurringFilterType = DiscreteGaussianImageFilter<InputImageType, OutputImageType>;
   using SpatialBlurringFilterType = DiscreteGaussianImageFilter<InputImageType, OutputImageType>;
   using FFTBlurringFilterType = FFTDiscreteGaussianImageFilter<InputImageType, OutputImageType>;
+  using Forward1DFFTType = Forward1DFFTImageFilter<RealImageType, ComplexImageType>;
+  using Inverse1DFFTType = Inverse1DFFTImageFilter<ComplexImageType, RealImageType>;
+
+  /** Typedef for runtime estimation */
+  using CostModelType = VkBlurringCostModel<OutputImageType>;
 
   /** Threshold value at which spatial and FFT smoothing procedures
    *  are expected to run in approximately equivalent time. */
   itkSetMacro(AnticipatedPerformanceMetricThreshold, float);
   itkGetMacro(AnticipatedPerformanceMetricThreshold, float);
 
+  /** Optional model estimating spatial and FFT blurring runtimes.
+   *  When set, takes precedence over the performance metric threshold. */
+  itkSetObjectMacro(CostModel, CostModelType);
+  itkGetModifiableObjectMacro(CostModel, CostModelType);
+
   /** Returns whether spatial or FFT smoothing was used in
    *  the last update. */
   itkGetMacro(LastRunUsedFFT, bool);
 
+  /** Approximate bound in bytes on the memory FFT blurring may use for
+   *  one tile of the output requested region. Zero, the default, blurs
+   *  the whole requested region at once. */
+  itkSetMacro(FFTMemoryBudget, SizeValueType);
+  itkGetConstMacro(FFTMemoryBudget, SizeValueType);
+
+  /** Select spatial or FFT blurring separately for each dimension.
+   *  Defaults to false, which blurs all dimensions with one procedure. */
+  itkSetMacro(UseHybridBlurring, bool);
+  itkGetConstMacro(UseHybridBlurring, bool);
+  itkBooleanMacro(UseHybridBlurring);
+
+  /** Returns the number of tiles blurred in the last update. */
+  itkGetConstMacro(LastRunNumberOfTiles, unsigned int);
+
+  /** Estimate the memory in bytes used by FFT blurring of the given output
+   *  region, padded by the kernel radius and to a transform size: the
+   *  padded input, kernel and result, and the half-Hermitian complex
+   *  spectra of the input, the kernel, their product and the transform
+   *  buffer on the device. */
+  SizeValueType
+  EstimateFFTMemory(const OutputRegionType & region) const;
+
   /** Determine whether spatial (default) or FFT blurring gives the
    *  best anticipated performance. */
   bool
   GetUseFFT() const;
 
+  /** Determine whether spatial (default) or batched 1-D FFT blurring
+   *  gives the best anticipated performance along one dimension
+   *  when hybrid blurring is enabled. */
+  bool
+  GetUseFFT(unsigned int dimension) const;
+
   /** Check anticipated performance metric for given input */
   float
   GetAnticipatedPerformanceMetric() const;
@@ -138,12 +215,40 @@ protected:
   void
   GenerateData() override;
 
+  /** Blur each filtered dimension in turn with the procedure
+   *  selected for that dimension, on the device reserved for the run. */
+  void
+  GenerateHybridData(InputImageType * input, uint64_t deviceID);
+
+  /** Boundary condition of hybrid blurring, equivalent to the real
+   *  boundary condition of the filter for the output pixel type, or null
+   *  when the real boundary condition is not one hybrid blurring supports. */
+  std::unique_ptr<HybridBoundaryConditionType>
+  MakeHybridBoundaryCondition() const;
+
+  /** Blur along one dimension with the 1-D Gaussian operator. */
+  typename RealImageType::Pointer
+  BlurAlongDimensionSpatially(RealImageType *               image,
+                              unsigned int                  dimension,
+                              HybridBoundaryConditionType * boundaryCondition) const;
+
+  /** Blur along one dimension with batched 1-D FFT convolution. */
+  typename RealImageType::Pointer
+  BlurAlongDimensionWithFFT(RealImageType *               image,
+                            unsigned int                  dimension,
+                            HybridBoundaryConditionType * boundaryCondition) const;
+
   void
   PrintSelf(std::ostream & os, Indent indent) const override;
 
 private:
-  float m_AnticipatedPerformanceMetricThreshold = 8.0f;
-  bool  m_LastRunUsedFFT = false;
+  float         m_AnticipatedPerformanceMetricThreshold = 8.0f;
+  bool          m_LastRunUsedFFT = false;
+  bool          m_UseHybridBlurring = false;
+  SizeValueType m_FFTMemoryBudget = 0;
+  unsigned int  m_LastRunNumberOfTiles = 0;
+
+  typename CostModelType::Pointer m_CostModel{ nullptr };
 
   typename SpatialBlurringFilterType::Pointer m_SpatialBlurringFilter = SpatialBlurringFilterType::New();
   typename FFTBlurringFilterType::Pointer     m_FFTBlurringFilter = FFTBlurringFilterType::New();
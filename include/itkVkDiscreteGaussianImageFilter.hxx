@@ -19,11 +19,28 @@
 #define itkVkDiscreteGaussianImageFilter_hxx
 
 #include "itkFFTDiscreteGaussianImageFilter.h"
+#include "itkCastImageFilter.h"
+#include "itkConstantBoundaryCondition.h"
 #include "itkDiscreteGaussianImageFilter.h"
+#include "itkGaussianOperator.h"
+#include "itkImageAlgorithm.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkImageRegionSplitterSlowDimension.h"
 #include "itkImageToImageFilter.h"
+#include "itkNeighborhoodOperatorImageFilter.h"
+#include "itkPadImageFilter.h"
+#include "itkPeriodicBoundaryCondition.h"
 #include "itkVkBlurringPerformanceMetric.h"
+#include "itkVkCommon.h"
+#include "itkVkGaussianTransferFunction.h"
+#include "itkVkGlobalConfiguration.h"
+#include "itkVkTracer.h"
+#include "itkZeroFluxNeumannBoundaryCondition.h"
 #include "itkMakeFilled.h"
 
+#include <future>
+#include <sstream>
+
 namespace itk
 {
 template <typename TInputImage, typename TOutputImage>
@@ -51,6 +68,13 @@ template <typename TInputImage, typename TOutputImage>
 void
 VkDiscreteGaussianImageFilter<TInputImage, TOutputImage>::GenerateData()
 {
+  // Reserve one device for the run and pin it, so that the internal Vk FFT
+  // filters, which count their own bytes, and the trace events share it
+  const VkDeviceReservation reservation{ true, 0, 0 };
+  const uint64_t            deviceID{ reservation.GetDeviceID() };
+  const VkDevicePin         devicePin{ deviceID };
+  const VkTraceScope        traceScope{ this->GetNameOfClass(), "GenerateData", deviceID };
+
   TOutputImage * output = this->GetOutput();
 
   output->SetBufferedRegion(output->GetRequestedRegion());
@@ -62,6 +86,18 @@ VkDiscreteGaussianImageFilter<TInputImage, TOutputImage>::GenerateData()
   auto localInput = TInputImage::New();
   localInput->Graft(this->GetInput());
 
+  if (m_UseHybridBlurring)
+  {
+    if (this->MakeHybridBoundaryCondition())
+    {
+      this->GenerateHybridData(localInput, deviceID);
+      return;
+    }
+    itkWarningMacro("Hybrid blurring does not support the real boundary condition "
+                    << this->GetRealBoundaryCondition()->GetBoundaryName()
+                    << ". Blurring all dimensions with one procedure.");
+  }
+
   BaseBlurringFilterType * smoother = nullptr;
 
   if (this->GetUseFFT())
@@ -78,13 +114,94 @@ VkDiscreteGaussianImageFilter<TInputImage, TOutputImage>::GenerateData()
     m_LastRunUsedFFT = false;
   }
 
-  smoother->SetInput(localInput);
-  smoother->SetVariance(this->GetVariance());
-  smoother->SetMaximumError(this->GetMaximumError());
-  smoother->SetMaximumKernelWidth(this->GetMaximumKernelWidth());
-  smoother->SetFilterDimensionality(this->GetFilterDimensionality());
-  smoother->SetRealBoundaryCondition(this->GetRealBoundaryCondition());
-  smoother->SetUseImageSpacing(this->GetUseImageSpacing());
+  const auto configureSmoother = [this](BaseBlurringFilterType * filter, const TInputImage * input) {
+    filter->SetInput(input);
+    filter->SetVariance(this->GetVariance());
+    filter->SetMaximumError(this->GetMaximumError());
+    filter->SetMaximumKernelWidth(this->GetMaximumKernelWidth());
+    filter->SetFilterDimensionality(this->GetFilterDimensionality());
+    filter->SetRealBoundaryCondition(this->GetRealBoundaryCondition());
+    filter->SetUseImageSpacing(this->GetUseImageSpacing());
+  };
+  configureSmoother(smoother, localInput);
+
+  m_LastRunNumberOfTiles = 1;
+  if (m_LastRunUsedFFT && m_FFTMemoryBudget > 0)
+  {
+    // Split the requested region until the largest tile fits the budget
+    // or tiles cannot be split further. Once split, two tiles are in
+    // flight at a time so each gets half of the budget.
+    const OutputRegionType requestedRegion = output->GetRequestedRegion();
+    auto                   splitter = ImageRegionSplitterSlowDimension::New();
+    unsigned int           numberOfTiles = 1;
+    OutputRegionType       largestTile = requestedRegion;
+    while (this->EstimateFFTMemory(largestTile) > (numberOfTiles > 1 ? m_FFTMemoryBudget / 2 : m_FFTMemoryBudget))
+    {
+      const unsigned int numberOfSplits = splitter->GetNumberOfSplits(requestedRegion, numberOfTiles + 1);
+      if (numberOfSplits <= numberOfTiles)
+      {
+        break;
+      }
+      numberOfTiles = numberOfSplits;
+      largestTile = requestedRegion;
+      splitter->GetSplit(0, numberOfTiles, largestTile);
+    }
+    m_LastRunNumberOfTiles = numberOfTiles;
+  }
+
+  if (VkTracer::IsEnabled())
+  {
+    std::ostringstream args;
+    args << "\"useFFT\":" << (m_LastRunUsedFFT ? "true" : "false")
+         << ",\"metric\":" << VkTracer::FormatNumber(this->GetAnticipatedPerformanceMetric())
+         << ",\"tiles\":" << m_LastRunNumberOfTiles;
+    VkTracer::AddInstantEvent("BlurringDecision", this->GetNameOfClass(), deviceID, args.str());
+  }
+
+  if (m_LastRunNumberOfTiles > 1)
+  {
+    // Blur each tile from the input region overlapping it by the kernel
+    // radius, double buffered over two mini-pipelines: while one blurs a
+    // tile on a worker thread, the previous tile is copied into the output
+    // from the other. Mini-pipeline outputs are not grafted so that each
+    // holds only its current tile, and each mini-pipeline reads its own
+    // graft of the input so that their requested regions do not interfere.
+    const OutputRegionType requestedRegion = output->GetRequestedRegion();
+    auto                   splitter = ImageRegionSplitterSlowDimension::New();
+    auto                   secondInput = TInputImage::New();
+    secondInput->Graft(localInput);
+    auto secondSmoother = FFTBlurringFilterType::New();
+    configureSmoother(secondSmoother, secondInput);
+    BaseBlurringFilterType * const tileSmoothers[2]{ smoother, secondSmoother };
+    OutputRegionType               tiles[2];
+    smoother->GetOutput()->ReleaseData();
+
+    const auto copyTile = [&](const unsigned int tileIndex) {
+      BaseBlurringFilterType * const tileSmoother = tileSmoothers[tileIndex % 2];
+      ImageAlgorithm::Copy(tileSmoother->GetOutput(), output, tiles[tileIndex % 2], tiles[tileIndex % 2]);
+      tileSmoother->GetOutput()->ReleaseData();
+      this->UpdateProgress(static_cast<float>(tileIndex + 1) / m_LastRunNumberOfTiles);
+    };
+    for (unsigned int tileIndex = 0; tileIndex < m_LastRunNumberOfTiles; ++tileIndex)
+    {
+      BaseBlurringFilterType * const tileSmoother = tileSmoothers[tileIndex % 2];
+      OutputRegionType &             tile = tiles[tileIndex % 2];
+      tile = requestedRegion;
+      splitter->GetSplit(tileIndex, m_LastRunNumberOfTiles, tile);
+      tileSmoother->GetOutput()->SetRequestedRegion(tile);
+      auto blurredTile = std::async(std::launch::async, [tileSmoother, deviceID]() {
+        const VkDevicePin workerDevicePin{ deviceID };
+        tileSmoother->Update();
+      });
+      if (tileIndex > 0)
+      {
+        copyTile(tileIndex - 1);
+      }
+      blurredTile.get();
+    }
+    copyTile(m_LastRunNumberOfTiles - 1);
+    return;
+  }
 
   // Graft this filters output onto the mini-pipeline so the mini-pipeline
   // has the correct region ivars and will write to this filters bulk data
@@ -100,6 +217,189 @@ VkDiscreteGaussianImageFilter<TInputImage, TOutputImage>::GenerateData()
   this->GraftOutput(output);
 }
 
+template <typename TInputImage, typename TOutputImage>
+void
+VkDiscreteGaussianImageFilter<TInputImage, TOutputImage>::GenerateHybridData(InputImageType * input,
+                                                                             const uint64_t   deviceID)
+{
+  TOutputImage * output = this->GetOutput();
+
+  // Restrict the input to its buffered region, i.e. the output requested
+  // region padded by the kernel radius, so that each pass blurs the padding
+  // still needed by the passes along the remaining dimensions.
+  input->SetLargestPossibleRegion(input->GetBufferedRegion());
+  using CasterType = CastImageFilter<InputImageType, RealImageType>;
+  auto caster = CasterType::New();
+  caster->SetInput(input);
+  caster->Update();
+  typename RealImageType::Pointer image = caster->GetOutput();
+  image->DisconnectPipeline();
+
+  const std::unique_ptr<HybridBoundaryConditionType> boundaryCondition{ this->MakeHybridBoundaryCondition() };
+  itkAssertOrThrowMacro(boundaryCondition != nullptr, "Unsupported boundary condition for hybrid blurring");
+
+  m_LastRunUsedFFT = false;
+  m_LastRunNumberOfTiles = 1;
+  const unsigned int filterDimensionality = std::min(this->GetFilterDimensionality(), ImageDimension);
+  for (unsigned int dim = 0; dim < filterDimensionality; ++dim)
+  {
+    const bool useFFT = this->GetUseFFT(dim);
+    if (VkTracer::IsEnabled())
+    {
+      std::ostringstream args;
+      args << "\"dimension\":" << dim << ",\"useFFT\":" << (useFFT ? "true" : "false");
+      VkTracer::AddInstantEvent("BlurringDecision", this->GetNameOfClass(), deviceID, args.str());
+    }
+    if (useFFT)
+    {
+      image = this->BlurAlongDimensionWithFFT(image, dim, boundaryCondition.get());
+      m_LastRunUsedFFT = true;
+    }
+    else
+    {
+      image = this->BlurAlongDimensionSpatially(image, dim, boundaryCondition.get());
+    }
+    this->UpdateProgress(static_cast<float>(dim + 1) / filterDimensionality);
+  }
+
+  ImageAlgorithm::Copy(image.GetPointer(), output, output->GetRequestedRegion(), output->GetRequestedRegion());
+}
+
+template <typename TInputImage, typename TOutputImage>
+auto
+VkDiscreteGaussianImageFilter<TInputImage, TOutputImage>::MakeHybridBoundaryCondition() const
+  -> std::unique_ptr<HybridBoundaryConditionType>
+{
+  // The real boundary condition of the superclass is defined for its real
+  // output pixel type, which may differ from the pixel type of hybrid blurring
+  using SuperclassRealImageType = typename Superclass::RealOutputImageType;
+  const auto * const realBoundaryCondition = this->GetRealBoundaryCondition();
+  if (dynamic_cast<const ZeroFluxNeumannBoundaryCondition<SuperclassRealImageType> *>(realBoundaryCondition))
+  {
+    return std::make_unique<ZeroFluxNeumannBoundaryCondition<RealImageType>>();
+  }
+  if (dynamic_cast<const PeriodicBoundaryCondition<SuperclassRealImageType> *>(realBoundaryCondition))
+  {
+    return std::make_unique<PeriodicBoundaryCondition<RealImageType>>();
+  }
+  if (const auto * const constantBoundaryCondition =
+        dynamic_cast<const ConstantBoundaryCondition<SuperclassRealImageType> *>(realBoundaryCondition))
+  {
+    auto boundaryCondition = std::make_unique<ConstantBoundaryCondition<RealImageType>>();
+    boundaryCondition->SetConstant(static_cast<RealValueType>(constantBoundaryCondition->GetConstant()));
+    return boundaryCondition;
+  }
+  return nullptr;
+}
+
+template <typename TInputImage, typename TOutputImage>
+auto
+VkDiscreteGaussianImageFilter<TInputImage, TOutputImage>::BlurAlongDimensionSpatially(
+  RealImageType *               image,
+  unsigned int                  dimension,
+  HybridBoundaryConditionType * boundaryCondition) const -> typename RealImageType::Pointer
+{
+  GaussianOperator<RealValueType, ImageDimension> oper;
+  oper.SetDirection(dimension);
+  oper.SetVariance(this->GetKernelVarianceArray()[dimension]);
+  oper.SetMaximumError(this->GetMaximumError()[dimension]);
+  oper.SetMaximumKernelWidth(this->GetMaximumKernelWidth());
+  oper.CreateDirectional();
+
+  using SpatialFilterType = NeighborhoodOperatorImageFilter<RealImageType, RealImageType, RealValueType>;
+  auto filter = SpatialFilterType::New();
+  filter->SetOperator(oper);
+  filter->OverrideBoundaryCondition(boundaryCondition);
+  filter->SetInput(image);
+  filter->Update();
+
+  typename RealImageType::Pointer result = filter->GetOutput();
+  result->DisconnectPipeline();
+  return result;
+}
+
+template <typename TInputImage, typename TOutputImage>
+auto
+VkDiscreteGaussianImageFilter<TInputImage, TOutputImage>::BlurAlongDimensionWithFFT(
+  RealImageType *               image,
+  unsigned int                  dimension,
+  HybridBoundaryConditionType * boundaryCondition) const -> typename RealImageType::Pointer
+{
+  const auto &        region = image->GetBufferedRegion();
+  const SizeValueType radius = this->GetKernelRadius()[dimension];
+  const double        variance = this->GetKernelVarianceArray()[dimension];
+
+  auto forwardFFT = Forward1DFFTType::New();
+  forwardFFT->SetDirection(dimension);
+
+  // Pad by the kernel radius so that circular convolution does not wrap,
+  // then to a transform size supported by the FFT backend
+  const SizeValueType minimumSize = region.GetSize(dimension) + 2 * radius;
+  const SizeValueType greatestPrimeFactor = forwardFFT->GetSizeGreatestPrimeFactor();
+  SizeValueType       transformSize = minimumSize;
+  if (greatestPrimeFactor >= VkCommon::GetGreatestPrimeFactor())
+  {
+    const auto precision =
+      sizeof(RealValueType) >= 8 ? VkCommon::PrecisionEnum::DOUBLE : VkCommon::PrecisionEnum::FLOAT;
+    transformSize = VkCommon::GetOptimalFFTSize(minimumSize, precision, VkCommon::FFTEnum::R2FullH);
+  }
+  else
+  {
+    while (VkCommon::GetLargestPrimeFactor(transformSize) > greatestPrimeFactor)
+    {
+      ++transformSize;
+    }
+  }
+
+  auto lowerPad = MakeFilled<RegionSizeType>(0);
+  auto upperPad = MakeFilled<RegionSizeType>(0);
+  lowerPad[dimension] = radius + (transformSize - minimumSize) / 2;
+  upperPad[dimension] = transformSize - region.GetSize(dimension) - lowerPad[dimension];
+
+  using PadFilterType = PadImageFilter<RealImageType, RealImageType>;
+  auto padFilter = PadFilterType::New();
+  padFilter->SetBoundaryCondition(boundaryCondition);
+  padFilter->SetInput(image);
+  padFilter->SetPadLowerBound(lowerPad);
+  padFilter->SetPadUpperBound(upperPad);
+
+  forwardFFT->SetInput(padFilter->GetOutput());
+  forwardFFT->Update();
+  typename ComplexImageType::Pointer spectrum = forwardFFT->GetOutput();
+  spectrum->DisconnectPipeline();
+
+  // Multiply every line along the dimension by the kernel frequency response
+  const auto transferFunction = VkGaussianTransferFunction<RealImageType>::Compute1D(
+    variance, this->GetMaximumError()[dimension], this->GetMaximumKernelWidth(), transformSize, transformSize);
+  const auto                                     spectrumStart = spectrum->GetBufferedRegion().GetIndex(dimension);
+  ImageRegionIteratorWithIndex<ComplexImageType> spectrumIt(spectrum, spectrum->GetBufferedRegion());
+  for (; !spectrumIt.IsAtEnd(); ++spectrumIt)
+  {
+    const auto k = static_cast<SizeValueType>(spectrumIt.GetIndex()[dimension] - spectrumStart);
+    spectrumIt.Set(spectrumIt.Get() * static_cast<RealValueType>(transferFunction[k]));
+  }
+
+  auto inverseFFT = Inverse1DFFTType::New();
+  inverseFFT->SetDirection(dimension);
+  inverseFFT->SetInput(spectrum);
+  inverseFFT->Update();
+
+  // Crop the padding and restore the region of the input image
+  const auto paddedIndex = padFilter->GetOutput()->GetLargestPossibleRegion().GetIndex();
+  const auto inverseIndex = inverseFFT->GetOutput()->GetLargestPossibleRegion().GetIndex();
+  auto       cropRegion = region;
+  for (unsigned int dim = 0; dim < ImageDimension; ++dim)
+  {
+    cropRegion.SetIndex(dim, inverseIndex[dim] + (region.GetIndex(dim) - paddedIndex[dim]));
+  }
+
+  auto result = RealImageType::New();
+  result->CopyInformation(image);
+  result->SetRegions(region);
+  result->Allocate();
+  ImageAlgorithm::Copy(inverseFFT->GetOutput(), result.GetPointer(), cropRegion, region);
+  return result;
+}
 
 /** Determine whether spatial (default) or FFT blurring gives the
  *  best anticipated performance. */
@@ -108,9 +408,38 @@ template <typename TInputImage, typename TOutputImage>
 bool
 VkDiscreteGaussianImageFilter<TInputImage, TOutputImage>::GetUseFFT() const
 {
+  if (m_CostModel)
+  {
+    // If input has not been set then default to spatial blurring
+    if (this->GetInput() == nullptr || this->GetOutput() == nullptr)
+      return false;
+    return m_CostModel->GetUseFFT(this->GetOutput()->GetRequestedRegion().GetSize(), this->GetKernelSize());
+  }
   return this->GetAnticipatedPerformanceMetric() > m_AnticipatedPerformanceMetricThreshold;
 }
 
+template <typename TInputImage, typename TOutputImage>
+bool
+VkDiscreteGaussianImageFilter<TInputImage, TOutputImage>::GetUseFFT(unsigned int dimension) const
+{
+  // If input has not been set then default to spatial blurring
+  if (this->GetInput() == nullptr || this->GetOutput() == nullptr)
+    return false;
+
+  const auto regionSize = this->GetOutput()->GetRequestedRegion().GetSize();
+  const auto kernelSize = this->GetKernelSize();
+  if (m_CostModel)
+  {
+    return m_CostModel->GetUseFFT1D(regionSize, kernelSize, dimension);
+  }
+
+  // Apply the metric to the kernel along this dimension only
+  auto dimensionKernelSize = MakeFilled<KernelSizeType>(0);
+  dimensionKernelSize[dimension] = kernelSize[dimension];
+  return VkBlurringPerformanceMetric<InputImageType>::Compute(regionSize, dimensionKernelSize) >
+         m_AnticipatedPerformanceMetricThreshold;
+}
+
 template <typename TInputImage, typename TOutputImage>
 float
 VkDiscreteGaussianImageFilter<TInputImage, TOutputImage>::GetAnticipatedPerformanceMetric() const
@@ -145,6 +474,30 @@ VkDiscreteGaussianImageFilter<TInputImage, TOutputImage>::GetKernelRadius() cons
 }
 
 
+template <typename TInputImage, typename TOutputImage>
+SizeValueType
+VkDiscreteGaussianImageFilter<TInputImage, TOutputImage>::EstimateFFTMemory(const OutputRegionType & region) const
+{
+  // Real images padded by the kernel radius and to a transform size: the
+  // padded input, the padded kernel and the result before cropping
+  constexpr SizeValueType realBuffers = 3;
+  // Half-Hermitian spectra: of the input, of the kernel and their product
+  // on the host, and the complex buffer of the transform on the device
+  constexpr SizeValueType complexBuffers = 4;
+
+  const auto    radius = this->GetKernelRadius();
+  SizeValueType numberOfPaddedPixels = 1;
+  SizeValueType numberOfSpectrumPixels = 1;
+  for (unsigned int dim = 0; dim < ImageDimension; ++dim)
+  {
+    const auto paddedSize =
+      static_cast<SizeValueType>(VkCommon::GetNextSupportedSize(region.GetSize(dim) + 2 * radius[dim]));
+    numberOfPaddedPixels *= paddedSize;
+    numberOfSpectrumPixels *= dim == 0 ? paddedSize / 2 + 1 : paddedSize;
+  }
+  return (realBuffers * numberOfPaddedPixels + complexBuffers * 2 * numberOfSpectrumPixels) * sizeof(RealValueType);
+}
+
 template <typename TInputImage, typename TOutputImage>
 auto
 VkDiscreteGaussianImageFilter<TInputImage, TOutputImage>::GetKernelSize() const -> KernelSizeType
@@ -169,7 +522,11 @@ VkDiscreteGaussianImageFilter<TInputImage, TOutputImage>::PrintSelf(std::ostream
   os << indent << "Kernel radius: " << GetKernelRadius() << std::endl;
   os << indent << "Anticipated performance metric threshold: " << m_AnticipatedPerformanceMetricThreshold << std::endl;
   os << indent << "Anticipated performance metric: " << this->GetAnticipatedPerformanceMetric() << std::endl;
+  itkPrintSelfObjectMacro(CostModel);
+  os << indent << "Use hybrid blurring: " << m_UseHybridBlurring << std::endl;
   os << indent << "Last run used FFT: " << m_LastRunUsedFFT << std::endl;
+  os << indent << "FFT memory budget: " << m_FFTMemoryBudget << std::endl;
+  os << indent << "Last run number of tiles: " << m_LastRunNumberOfTiles << std::endl;
 }
 
 } // end namespace itk
@@ -0,0 +1,177 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         https://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkVkFFTCostModel_h
+#define itkVkFFTCostModel_h
+
+#include "VkFFTBackendExport.h"
+#include "itkIntTypes.h"
+#include "itkNumericTraits.h"
+#include "itkObject.h"
+#include "itkObjectFactory.h"
+
+#include <vector>
+
+namespace itk
+{
+/**
+ *\class VkFFTCostModel
+ * \brief Estimate VkFFT and CPU Fast Fourier Transform runtimes in seconds
+ *
+ * Small transforms are dominated by the fixed costs of a VkFFT run: plan
+ * creation, a dispatch, and host-device transfers of the input and output
+ * buffers. VkFFTCostModel estimates the runtime of one run of a Vk FFT
+ * filter and of its CPU counterpart so that the faster implementation can be
+ * selected per update:
+ *
+ * - A transform of `numberOfPixels` pixels along each of the given lengths
+ *   costs, along each length n, (numberOfPixels / n) 1-D transforms as
+ *   estimated by VkCommon::EstimateTransformCost, roughly 5 n log2(n) flops
+ *   plus passes through device memory. VkFFT lengths with a prime factor
+ *   greater than the greatest supported radix fall back on Bluestein's
+ *   algorithm.
+ * - The Vk run adds the transfer of its buffers, a fixed dispatch overhead
+ *   and, unless the plan is cached from the previous run of the filter,
+ *   plan creation.
+ *
+ * The per-device constants default to conservative values for a discrete
+ * GPU and a single CPU thread. They should be calibrated for a given
+ * machine, for instance with VkFFTBackendBenchmarks.
+ *
+ * Set a cost model with VkGlobalConfiguration::SetCostModel to dispatch
+ * updates of the Vk FFT filters. Override EstimateVkSeconds and
+ * EstimateCPUSeconds in a subclass to plug in a different model.
+ *
+ * \sa VkBlurringCostModel
+ * \sa VkGlobalConfiguration
+ *
+ * \ingroup FourierTransform
+ * \ingroup VkFFTBackend
+ */
+class VkFFTBackend_EXPORT VkFFTCostModel : public Object
+{
+public:
+  ITK_DISALLOW_COPY_AND_MOVE(VkFFTCostModel);
+
+  /** Standard class type aliases. */
+  using Self = VkFFTCostModel;
+  using Superclass = Object;
+  using Pointer = SmartPointer<Self>;
+  using ConstPointer = SmartPointer<const Self>;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkOverrideGetNameOfClassMacro(VkFFTCostModel);
+
+  /** Lengths of the transformed dimensions. */
+  using LengthsType = std::vector<SizeValueType>;
+
+  /** Seconds per single-precision floating point operation
+   *  in a transform on the CPU. */
+  itkSetMacro(CPUSecondsPerFlop, double);
+  itkGetConstMacro(CPUSecondsPerFlop, double);
+
+  /** Ratio of double-precision to single-precision FFT throughput on the CPU. */
+  itkSetMacro(CPUDoublePrecisionFlopFactor, double);
+  itkGetConstMacro(CPUDoublePrecisionFlopFactor, double);
+
+  /** Seconds per single-precision floating point operation
+   *  in a VkFFT transform on the device. */
+  itkSetMacro(FFTSecondsPerFlop, double);
+  itkGetConstMacro(FFTSecondsPerFlop, double);
+
+  /** Ratio of double-precision to single-precision FFT throughput
+   *  on the device. */
+  itkSetMacro(DoublePrecisionFlopFactor, double);
+  itkGetConstMacro(DoublePrecisionFlopFactor, double);
+
+  /** Host-device transfer bandwidth in bytes per second. */
+  itkSetMacro(TransferBytesPerSecond, double);
+  itkGetConstMacro(TransferBytesPerSecond, double);
+
+  /** Fixed overhead in seconds for each VkFFT run. */
+  itkSetMacro(FFTDispatchSeconds, double);
+  itkGetConstMacro(FFTDispatchSeconds, double);
+
+  /** Seconds to create a device context and VkFFT plan. */
+  itkSetMacro(FFTPlanSeconds, double);
+  itkGetConstMacro(FFTPlanSeconds, double);
+
+  /** Greatest prime factor handled by the radix kernels of VkFFT.
+   *  Larger prime factors fall back on Bluestein's algorithm.
+   *  Defaults to VkCommon::GetGreatestPrimeFactor(). */
+  itkSetClampMacro(GreatestPrimeFactor, SizeValueType, 2, NumericTraits<SizeValueType>::max());
+  itkGetConstMacro(GreatestPrimeFactor, SizeValueType);
+
+  /** Estimate the runtime in seconds of a VkFFT run transforming
+   *  `numberOfPixels` pixels along each of `lengths` and transferring
+   *  `transferBytes` bytes between host and device. */
+  virtual double
+  EstimateVkSeconds(const LengthsType & lengths,
+                    SizeValueType       numberOfPixels,
+                    SizeValueType       transferBytes,
+                    bool                doublePrecision,
+                    bool                planCached) const;
+
+  /** Estimate the runtime in seconds of the same transform on the CPU. */
+  virtual double
+  EstimateCPUSeconds(const LengthsType & lengths, SizeValueType numberOfPixels, bool doublePrecision) const;
+
+  /** Whether the VkFFT run is anticipated to be faster than the CPU. */
+  bool
+  GetUseVk(const LengthsType & lengths,
+           SizeValueType       numberOfPixels,
+           SizeValueType       transferBytes,
+           bool                doublePrecision,
+           bool                planCached) const
+  {
+    return this->EstimateVkSeconds(lengths, numberOfPixels, transferBytes, doublePrecision, planCached) <
+           this->EstimateCPUSeconds(lengths, numberOfPixels, doublePrecision);
+  }
+
+protected:
+  VkFFTCostModel();
+  ~VkFFTCostModel() override = default;
+
+  /** Approximate flops of transforming `numberOfPixels` pixels along each
+   *  of `lengths`, from VkCommon::EstimateTransformCost, with lengths whose
+   *  largest prime factor exceeds `greatestPrimeFactor` charged as Bluestein
+   *  transforms. */
+  static double
+  EstimateFlops(const LengthsType & lengths,
+                SizeValueType       numberOfPixels,
+                bool                doublePrecision,
+                SizeValueType       greatestPrimeFactor);
+
+  void
+  PrintSelf(std::ostream & os, Indent indent) const override;
+
+private:
+  double        m_CPUSecondsPerFlop{ 1.0e-9 };
+  double        m_CPUDoublePrecisionFlopFactor{ 2.0 };
+  double        m_FFTSecondsPerFlop{ 1.0e-11 };
+  double        m_DoublePrecisionFlopFactor{ 4.0 };
+  double        m_TransferBytesPerSecond{ 8.0e9 };
+  double        m_FFTDispatchSeconds{ 1.0e-4 };
+  double        m_FFTPlanSeconds{ 5.0e-3 };
+  SizeValueType m_GreatestPrimeFactor{ 0 };
+};
+} // end namespace itk
+
+#endif // itkVkFFTCostModel_h
@@ -0,0 +1,190 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         https://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkVkFFTDispatcher_h
+#define itkVkFFTDispatcher_h
+
+#include "itkObjectFactoryBase.h"
+#include "itkVkCommon.h"
+#include "itkVkFFTCostModel.h"
+#include "itkVkGlobalConfiguration.h"
+
+#include <string>
+#include <typeinfo>
+
+namespace itk
+{
+/**
+ *\class VkFFTDispatcher
+ * \brief Run updates of a Vk FFT filter with a CPU implementation
+ *     when that is anticipated to be faster or no device is available.
+ *
+ * The CPU implementation is the first implementation of `TBaseFilter`
+ * registered with the object factory that is not a Vk filter, such as the
+ * FFTW filters when ITK is built with FFTW, or `TDefaultCPUFilter` when
+ * there is none. It is created on first use and kept for later updates.
+ *
+ * A Vk FFT filter asks the dispatcher whether to run each update on the CPU
+ * according to the cost model of VkGlobalConfiguration, and again whether
+ * to repeat a failed VkFFT run on the CPU. Transforms with lengths that
+ * the CPU implementation does not support always run with VkFFT.
+ *
+ * \sa VkFFTCostModel
+ * \sa VkGlobalConfiguration
+ *
+ * \ingroup FourierTransform
+ * \ingroup VkFFTBackend
+ */
+template <typename TBaseFilter, typename TDefaultCPUFilter>
+class VkFFTDispatcher
+{
+public:
+  ITK_DISALLOW_COPY_AND_MOVE(VkFFTDispatcher);
+
+  using BaseFilterType = TBaseFilter;
+  using LengthsType = VkFFTCostModel::LengthsType;
+
+  VkFFTDispatcher() = default;
+  ~VkFFTDispatcher() = default;
+
+  /** Lengths of an N-D transform of an image of the given size. */
+  template <typename TSize>
+  static LengthsType
+  GetLengths(const TSize & size)
+  {
+    return LengthsType(size.begin(), size.end());
+  }
+
+  /** Length of a 1-D transform along `direction` of an image of the given size. */
+  template <typename TSize>
+  static LengthsType
+  GetLengths(const TSize & size, const unsigned int direction)
+  {
+    return LengthsType{ size[direction] };
+  }
+
+  /** Whether the global cost model anticipates the CPU implementation to
+   *  transform `numberOfPixels` pixels along each of `lengths` faster than
+   *  a VkFFT run. False without a cost model. */
+  bool
+  GetUseCPU(const LengthsType & lengths,
+            SizeValueType       numberOfPixels,
+            SizeValueType       transferBytes,
+            bool                doublePrecision,
+            bool                planCached)
+  {
+    const VkFFTCostModel::ConstPointer costModel{ VkGlobalConfiguration::GetCostModel() };
+    return costModel && this->SupportsLengths(lengths) &&
+           !costModel->GetUseVk(lengths, numberOfPixels, transferBytes, doublePrecision, planCached);
+  }
+
+  /** Whether to repeat a VkFFT run that failed with `resFFT` on the CPU. */
+  bool
+  GetUseCPUAfterError(VkFFTResult resFFT, const LengthsType & lengths)
+  {
+    return VkGlobalConfiguration::GetFallbackToCPU() && VkCommon::IsDeviceUnavailable(resFFT) &&
+           this->SupportsLengths(lengths);
+  }
+
+  /** The CPU implementation, for setting its parameters before Run. */
+  BaseFilterType *
+  GetCPUFilter()
+  {
+    if (!m_CPUFilter)
+    {
+      for (const LightObject::Pointer & instance : ObjectFactoryBase::CreateAllInstance(typeid(BaseFilterType).name()))
+      {
+        auto * const filter = dynamic_cast<BaseFilterType *>(instance.GetPointer());
+        if (filter != nullptr && std::string{ filter->GetNameOfClass() }.rfind("Vk", 0) != 0)
+        {
+          m_CPUFilter = filter;
+          break;
+        }
+      }
+      if (!m_CPUFilter)
+      {
+        m_CPUFilter = TDefaultCPUFilter::New();
+      }
+    }
+    return m_CPUFilter.GetPointer();
+  }
+
+  /** Compute the output of `filter` with the CPU implementation. The CPU
+   *  implementation writes into the buffer already allocated for the output
+   *  of `filter`, and its output is grafted back onto `filter` once it has
+   *  run, so that `filter` reports the regions and buffer that it computed. */
+  void
+  Run(BaseFilterType * filter)
+  {
+    BaseFilterType * const cpuFilter{ this->GetCPUFilter() };
+    cpuFilter->SetInput(filter->GetInput());
+    cpuFilter->GraftOutput(filter->GetOutput());
+    cpuFilter->ReleaseDataBeforeUpdateFlagOff();
+    cpuFilter->Update();
+    filter->GraftOutput(cpuFilter->GetOutput());
+
+    // Do not keep the input or output of `filter` alive
+    cpuFilter->SetInput(nullptr);
+    cpuFilter->GetOutput()->ReleaseData();
+    ++m_NumberOfCPURuns;
+  }
+
+  /** Number of updates computed with the CPU implementation. */
+  SizeValueType
+  GetNumberOfCPURuns() const
+  {
+    return m_NumberOfCPURuns;
+  }
+
+private:
+  bool
+  SupportsLengths(const LengthsType & lengths)
+  {
+    const SizeValueType greatestPrimeFactor{ GetSizeGreatestPrimeFactor(this->GetCPUFilter(), 0) };
+    for (const SizeValueType n : lengths)
+    {
+      if (VkCommon::GetLargestPrimeFactor(n) > greatestPrimeFactor)
+      {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  template <typename TFilter>
+  static auto
+  GetSizeGreatestPrimeFactor(const TFilter * filter, int)
+    -> decltype(SizeValueType{ filter->GetSizeGreatestPrimeFactor() })
+  {
+    return filter->GetSizeGreatestPrimeFactor();
+  }
+
+  // ComplexToComplexFFTImageFilter does not report its supported sizes;
+  // assume those of the Vnl implementation.
+  template <typename TFilter>
+  static SizeValueType
+  GetSizeGreatestPrimeFactor(const TFilter *, long)
+  {
+    return 5;
+  }
+
+  typename BaseFilterType::Pointer m_CPUFilter{ nullptr };
+  SizeValueType                    m_NumberOfCPURuns{ 0 };
+};
+} // end namespace itk
+
+#endif // itkVkFFTDispatcher_h
@@ -0,0 +1,205 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         https://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkVkFFTFilterBankImageFilter_h
+#define itkVkFFTFilterBankImageFilter_h
+
+#include "itkImage.h"
+#include "itkImageToImageFilter.h"
+#include "itkVkCommon.h"
+#include "itkVkGlobalConfiguration.h"
+#include "itkVkTimingsReporter.h"
+
+#include <complex>
+#include <vector>
+
+namespace itk
+{
+/**
+ *\class VkFFTFilterBankImageFilter
+ *
+ * \brief Convolves an image with a bank of kernels through a single forward FFT.
+ *
+ * Filter banks such as multi-scale derivatives or Gabor and steerable
+ * filters apply K kernels to one image. Rather than running K FFT
+ * convolutions, this filter pads the image once and convolves it with all
+ * kernels in a single VkFFT run, which transforms the image, multiplies its
+ * spectrum by the spectrum of each kernel and computes the K inverse
+ * transforms on the device. Output N is the convolution of the input with
+ * kernel image N.
+ *
+ * Kernels are placed in planes of the padded size at the first update,
+ * copied to the device, and transformed there by the convolution plan,
+ * whose kernel spectra never come back to the host. Later updates reuse
+ * them until a kernel image, the padded size, or Normalize changes, so
+ * that a fixed bank applied to a sequence of images only copies each image
+ * to the device and its K filtered images back.
+ *
+ * As with ConvolutionImageFilter, outputs have the size of the input, the
+ * input is extended with a zero-flux Neumann boundary condition, and the
+ * center of a kernel is at the index of half its size. When Normalize is
+ * on, each kernel is divided by the sum of its pixels.
+ *
+ * \ingroup FourierTransform
+ * \ingroup VkFFTBackend
+ *
+ * \sa ConvolutionImageFilter
+ * \sa FFTConvolutionImageFilter
+ * \sa VkGlobalConfiguration
+ */
+template <typename TInputImage, typename TOutputImage = TInputImage, typename TKernelImage = TInputImage>
+class VkFFTFilterBankImageFilter
+  : public ImageToImageFilter<TInputImage, TOutputImage>
+  , public VkTimingsReporter
+{
+public:
+  ITK_DISALLOW_COPY_AND_MOVE(VkFFTFilterBankImageFilter);
+
+  using InputImageType = TInputImage;
+  using OutputImageType = TOutputImage;
+  using KernelImageType = TKernelImage;
+  static_assert(std::is_same<typename TOutputImage::PixelType, float>::value ||
+                  std::is_same<typename TOutputImage::PixelType, double>::value,
+                "Unsupported pixel type");
+  static_assert(TInputImage::ImageDimension >= 1 && TInputImage::ImageDimension <= 3, "Unsupported image dimension");
+
+  /** Standard class type aliases. */
+  using Self = VkFFTFilterBankImageFilter;
+  using Superclass = ImageToImageFilter<InputImageType, OutputImageType>;
+  using Pointer = SmartPointer<Self>;
+  using ConstPointer = SmartPointer<const Self>;
+
+  using RealType = typename OutputImageType::PixelType;
+  using ComplexType = std::complex<RealType>;
+  using SizeType = typename OutputImageType::SizeType;
+  using SizeValueType = typename OutputImageType::SizeValueType;
+  using RegionType = typename OutputImageType::RegionType;
+
+  static constexpr unsigned int ImageDimension{ InputImageType::ImageDimension };
+
+  using RealImageType = Image<RealType, ImageDimension>;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkOverrideGetNameOfClassMacro(VkFFTFilterBankImageFilter);
+
+  /** Set kernel image N, which gives output N. Outputs are added as
+   *  kernels are. */
+  void
+  SetKernelImage(unsigned int n, const KernelImageType * kernel);
+
+  const KernelImageType *
+  GetKernelImage(unsigned int n) const;
+
+  /** Number of kernel images, and of outputs. Reducing it removes the
+   *  last kernel images and outputs. */
+  void
+  SetNumberOfKernelImages(unsigned int numberOfKernels);
+
+  unsigned int
+  GetNumberOfKernelImages() const;
+
+  /** Divide each kernel by the sum of its pixels. Off by default. */
+  itkSetMacro(Normalize, bool);
+  itkGetConstMacro(Normalize, bool);
+  itkBooleanMacro(Normalize);
+
+  /** Number of forward transforms of kernel images since construction.
+   *  It does not increase while the kernel spectra on the device are reused. */
+  itkGetConstMacro(NumberOfKernelTransforms, SizeValueType);
+
+  /** Determine whether local or global properties will be
+   *  referenced for setting up GPU acceleration. */
+  itkSetMacro(UseVkGlobalConfiguration, bool);
+  itkGetMacro(UseVkGlobalConfiguration, bool);
+
+  /** Local setting for enumerated GPU device to use for FFT.
+   *  Ignored if `UseVkGlobalConfiguration` is true. */
+  itkSetMacro(DeviceID, uint64_t);
+
+  /** Return the enumerated GPU device to use for FFT
+   *  according to current filter settings. With the global
+   *  configuration, runs are placed on devices by its scheduling
+   *  policy, which is this device only for the FIXED policy. */
+  uint64_t
+  GetDeviceID() const
+  {
+    return uint64_t{ m_UseVkGlobalConfiguration ? VkGlobalConfiguration::GetDeviceID() : m_DeviceID };
+  }
+
+protected:
+  VkFFTFilterBankImageFilter()
+    : VkTimingsReporter{ &m_VkCommon }
+  {}
+  ~VkFFTFilterBankImageFilter() override = default;
+
+  /** The whole input and kernel images are needed. */
+  void
+  GenerateInputRequestedRegion() override;
+
+  void
+  EnlargeOutputRequestedRegion(DataObject * output) override;
+
+  /** Kernel images need not occupy the physical space of the input. */
+  void
+  VerifyInputInformation() const override
+  {}
+
+  void
+  GenerateData() override;
+
+  void
+  PrintSelf(std::ostream & os, Indent indent) const override;
+
+  /** Pad `image` to a size fast for VkFFT that holds a kernel radius on
+   *  either side. The padded region is returned in `paddedRegion`. */
+  typename RealImageType::Pointer
+  PadImage(const RealImageType * image, RegionType & paddedRegion);
+
+  /** Place the kernel images, centered at the origin, in planes of
+   *  `paddedSize` unless those of a previous update still apply. */
+  void
+  UpdateKernelPlanes(const SizeType & paddedSize);
+
+private:
+  bool          m_Normalize{ false };
+  SizeValueType m_NumberOfKernelTransforms{ 0 };
+
+  // Kernel images in padded planes one after the other, as the kernel buffer
+  // that a VkFFT convolution transforms on the device, and the kernel images
+  // and settings they were made from
+  std::vector<RealType>                m_KernelPlanes{};
+  std::vector<const KernelImageType *> m_KernelPlanesKernels{};
+  SizeType                             m_KernelPlanesPaddedSize{};
+  bool                                 m_KernelPlanesNormalize{ false };
+  TimeStamp                            m_KernelPlanesTime{};
+
+  bool     m_UseVkGlobalConfiguration{ true };
+  uint64_t m_DeviceID{ 0UL };
+
+  VkCommon m_VkCommon{};
+};
+
+} // namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#  include "itkVkFFTFilterBankImageFilter.hxx"
+#endif
+
+#endif // itkVkFFTFilterBankImageFilter_h
@@ -0,0 +1,326 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         https://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkVkFFTFilterBankImageFilter_hxx
+#define itkVkFFTFilterBankImageFilter_hxx
+
+#include "itkVkFFTFilterBankImageFilter.h"
+#include "itkVkFFTPadImageFilter.h"
+#include "itkVkTracer.h"
+#include "itkCastImageFilter.h"
+#include "itkImageAlgorithm.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
+#include "itkIndent.h"
+#include "itkProgressReporter.h"
+
+#include <algorithm>
+#include <iostream>
+
+namespace itk
+{
+
+template <typename TInputImage, typename TOutputImage, typename TKernelImage>
+void
+VkFFTFilterBankImageFilter<TInputImage, TOutputImage, TKernelImage>::SetKernelImage(unsigned int            n,
+                                                                                   const KernelImageType * kernel)
+{
+  if (n >= this->GetNumberOfKernelImages())
+  {
+    this->SetNumberOfKernelImages(n + 1);
+  }
+  this->SetNthInput(n + 1, const_cast<KernelImageType *>(kernel));
+}
+
+template <typename TInputImage, typename TOutputImage, typename TKernelImage>
+auto
+VkFFTFilterBankImageFilter<TInputImage, TOutputImage, TKernelImage>::GetKernelImage(unsigned int n) const
+  -> const KernelImageType *
+{
+  if (n >= this->GetNumberOfKernelImages())
+  {
+    return nullptr;
+  }
+  return itkDynamicCastInDebugMode<const KernelImageType *>(this->ProcessObject::GetInput(n + 1));
+}
+
+template <typename TInputImage, typename TOutputImage, typename TKernelImage>
+void
+VkFFTFilterBankImageFilter<TInputImage, TOutputImage, TKernelImage>::SetNumberOfKernelImages(
+  unsigned int numberOfKernels)
+{
+  if (numberOfKernels == this->GetNumberOfKernelImages())
+  {
+    return;
+  }
+  this->SetNumberOfIndexedInputs(numberOfKernels + 1);
+
+  // The primary output is kept without kernels
+  const unsigned int numberOfOutputs{ std::max(numberOfKernels, 1u) };
+  const unsigned int previousNumberOfOutputs{ static_cast<unsigned int>(this->GetNumberOfIndexedOutputs()) };
+  this->SetNumberOfIndexedOutputs(numberOfOutputs);
+  for (unsigned int n{ previousNumberOfOutputs }; n < numberOfOutputs; ++n)
+  {
+    this->SetNthOutput(n, this->MakeOutput(n));
+  }
+  this->Modified();
+}
+
+template <typename TInputImage, typename TOutputImage, typename TKernelImage>
+unsigned int
+VkFFTFilterBankImageFilter<TInputImage, TOutputImage, TKernelImage>::GetNumberOfKernelImages() const
+{
+  const auto numberOfInputs{ static_cast<unsigned int>(this->GetNumberOfIndexedInputs()) };
+  return numberOfInputs > 1 ? numberOfInputs - 1 : 0;
+}
+
+template <typename TInputImage, typename TOutputImage, typename TKernelImage>
+void
+VkFFTFilterBankImageFilter<TInputImage, TOutputImage, TKernelImage>::GenerateInputRequestedRegion()
+{
+  // Unlike ImageToImageFilter, do not request the output region of
+  // kernel images, which are smaller than the input
+  for (DataObjectPointerArraySizeType n{ 0 }; n < this->GetNumberOfIndexedInputs(); ++n)
+  {
+    DataObject * const input{ this->ProcessObject::GetInput(n) };
+    if (input)
+    {
+      input->SetRequestedRegionToLargestPossibleRegion();
+    }
+  }
+}
+
+template <typename TInputImage, typename TOutputImage, typename TKernelImage>
+void
+VkFFTFilterBankImageFilter<TInputImage, TOutputImage, TKernelImage>::EnlargeOutputRequestedRegion(DataObject * output)
+{
+  Superclass::EnlargeOutputRequestedRegion(output);
+  output->SetRequestedRegionToLargestPossibleRegion();
+}
+
+template <typename TInputImage, typename TOutputImage, typename TKernelImage>
+void
+VkFFTFilterBankImageFilter<TInputImage, TOutputImage, TKernelImage>::GenerateData()
+{
+  const VkTraceScope traceScope{ this->GetNameOfClass(), "GenerateData", this->GetDeviceID() };
+
+  const InputImageType * const input{ this->GetInput() };
+  const unsigned int           numberOfKernels{ this->GetNumberOfKernelImages() };
+
+  if (!input)
+  {
+    return;
+  }
+  itkAssertOrThrowMacro(numberOfKernels > 0, "No kernel images");
+  for (unsigned int n{ 0 }; n < numberOfKernels; ++n)
+  {
+    itkAssertOrThrowMacro(this->GetKernelImage(n) != nullptr, "Missing kernel image");
+  }
+
+  // we don't have a nice progress to report, but at least this simple line
+  // reports the beginning and the end of the process
+  const ProgressReporter progress(this, 0, 1);
+
+  // Pad the input once for all kernels
+  using CastFilterType = CastImageFilter<InputImageType, RealImageType>;
+  auto caster = CastFilterType::New();
+  caster->SetInput(input);
+  caster->Update();
+  RegionType                                 paddedRegion;
+  const typename RealImageType::ConstPointer padded{ this->PadImage(caster->GetOutput(), paddedRegion) };
+  const SizeType &                           paddedSize{ paddedRegion.GetSize() };
+  this->UpdateKernelPlanes(paddedSize);
+
+  // Convolve with all kernels in one run into consecutive batches
+  const SizeValueType   paddedPixels{ paddedRegion.GetNumberOfPixels() };
+  std::vector<RealType> batchImages(numberOfKernels * paddedPixels);
+  const SizeValueType   inBytes{ paddedPixels * sizeof(RealType) };
+  const SizeValueType   outBytes{ batchImages.size() * sizeof(RealType) };
+
+  // Describe the convolution in VkCommon::VkParameters
+  typename VkCommon::VkParameters vkParameters;
+  if (ImageDimension > 0)
+    vkParameters.X = paddedSize[0];
+  if (ImageDimension > 1)
+    vkParameters.Y = paddedSize[1];
+  if (ImageDimension > 2)
+    vkParameters.Z = paddedSize[2];
+  if (std::is_same<RealType, float>::value)
+    vkParameters.P = VkCommon::PrecisionEnum::FLOAT;
+  else if (std::is_same<RealType, double>::value)
+    vkParameters.P = VkCommon::PrecisionEnum::DOUBLE;
+  else
+    itkAssertOrThrowMacro(false, "Unsupported type for real numbers.");
+  vkParameters.fft = VkCommon::FFTEnum::R2HalfH;
+  vkParameters.PSize = sizeof(RealType);
+  vkParameters.I = VkCommon::DirectionEnum::FORWARD;
+  vkParameters.normalized = VkCommon::NormalizationEnum::NORMALIZED;
+  vkParameters.convolution = true;
+  vkParameters.numberOfKernels = numberOfKernels;
+
+  vkParameters.inputCPUBuffer = padded->GetBufferPointer();
+  vkParameters.inputBufferBytes = inBytes;
+  vkParameters.outputCPUBuffer = batchImages.data();
+  vkParameters.outputBufferBytes = outBytes;
+  vkParameters.transformKernel = true;
+  vkParameters.kernelCPUBuffer = m_KernelPlanes.data();
+  vkParameters.kernelBufferBytes = m_KernelPlanes.size() * sizeof(RealType);
+  vkParameters.kernelModifiedTime = m_KernelPlanesTime.GetMTime();
+
+  // Count this run as outstanding on the device of the plan it reuses,
+  // or else on a device chosen by the scheduling policy
+  const VkDeviceReservation deviceReservation{
+    m_UseVkGlobalConfiguration, m_DeviceID, inBytes + outBytes, m_VkCommon, vkParameters
+  };
+
+  // Mostly use defaults for VkCommon::VkGPU
+  typename VkCommon::VkGPU vkGPU;
+  vkGPU.device_id = deviceReservation.GetDeviceID();
+  vkGPU.profiling = VkGlobalConfiguration::GetProfiling();
+
+  const VkFFTResult resFFT{ m_VkCommon.Run(vkGPU, vkParameters) };
+  if (resFFT != VKFFT_SUCCESS)
+  {
+    std::ostringstream mesg;
+    mesg << "VkFFT third-party library failed with error code " << resFFT << ".";
+    itkAssertOrThrowMacro(false, mesg.str());
+  }
+
+  // Crop each filtered image to the input region, which
+  // has the same indices in the padded region
+  for (unsigned int n{ 0 }; n < numberOfKernels; ++n)
+  {
+    OutputImageType * const output{ this->GetOutput(n) };
+    output->SetBufferedRegion(output->GetRequestedRegion());
+    output->Allocate();
+
+    auto filtered = RealImageType::New();
+    filtered->SetRegions(paddedRegion);
+    filtered->GetPixelContainer()->SetImportPointer(&batchImages[n * paddedPixels], paddedPixels, false);
+    ImageAlgorithm::Copy(filtered.GetPointer(), output, output->GetRequestedRegion(), output->GetRequestedRegion());
+  }
+}
+
+template <typename TInputImage, typename TOutputImage, typename TKernelImage>
+auto
+VkFFTFilterBankImageFilter<TInputImage, TOutputImage, TKernelImage>::PadImage(const RealImageType * image,
+                                                                             RegionType &          paddedRegion)
+  -> typename RealImageType::Pointer
+{
+  // Pad by the largest kernel radius on either side, up to the fastest VkFFT size
+  SizeType padRadius;
+  for (unsigned int dim{ 0 }; dim < ImageDimension; ++dim)
+  {
+    padRadius[dim] = 0;
+    for (unsigned int n{ 0 }; n < this->GetNumberOfKernelImages(); ++n)
+    {
+      padRadius[dim] = std::max(padRadius[dim], this->GetKernelImage(n)->GetBufferedRegion().GetSize(dim) / 2);
+    }
+  }
+
+  using BoundaryPadType = VkFFTPadImageFilter<RealImageType, RealImageType>;
+  auto boundaryPad = BoundaryPadType::New();
+  boundaryPad->SetInput(image);
+  boundaryPad->SetPadRadius(padRadius);
+  boundaryPad->SetTransformType(VkCommon::FFTEnum::R2HalfH);
+
+  boundaryPad->Update();
+
+  typename RealImageType::Pointer padded{ boundaryPad->GetOutput() };
+  padded->DisconnectPipeline();
+  paddedRegion = padded->GetLargestPossibleRegion();
+  return padded;
+}
+
+template <typename TInputImage, typename TOutputImage, typename TKernelImage>
+void
+VkFFTFilterBankImageFilter<TInputImage, TOutputImage, TKernelImage>::UpdateKernelPlanes(const SizeType & paddedSize)
+{
+  const unsigned int numberOfKernels{ this->GetNumberOfKernelImages() };
+  bool               upToDate{ m_KernelPlanesKernels.size() == numberOfKernels &&
+                  m_KernelPlanesPaddedSize == paddedSize && m_KernelPlanesNormalize == m_Normalize };
+  for (unsigned int n{ 0 }; upToDate && n < numberOfKernels; ++n)
+  {
+    const KernelImageType * const kernel{ this->GetKernelImage(n) };
+    upToDate = kernel == m_KernelPlanesKernels[n] && kernel->GetMTime() < m_KernelPlanesTime.GetMTime();
+  }
+  if (upToDate)
+  {
+    return;
+  }
+
+  const SizeValueType paddedPixels{ RegionType(paddedSize).GetNumberOfPixels() };
+  m_KernelPlanes.assign(numberOfKernels * paddedPixels, RealType{});
+  m_KernelPlanesKernels.assign(numberOfKernels, nullptr);
+  for (unsigned int n{ 0 }; n < numberOfKernels; ++n)
+  {
+    const KernelImageType * const kernel{ this->GetKernelImage(n) };
+    const RegionType              kernelRegion{ kernel->GetBufferedRegion() };
+
+    double scale{ 1.0 };
+    if (m_Normalize)
+    {
+      double sum{ 0.0 };
+      for (ImageRegionConstIterator<KernelImageType> it(kernel, kernelRegion); !it.IsAtEnd(); ++it)
+      {
+        sum += static_cast<double>(it.Get());
+      }
+      itkAssertOrThrowMacro(sum != 0.0, "Cannot normalize a kernel image that sums to zero");
+      scale = 1.0 / sum;
+    }
+
+    // Place the kernel center at the origin of plane n, wrapping around
+    RealType * const plane{ &m_KernelPlanes[n * paddedPixels] };
+    for (ImageRegionConstIteratorWithIndex<KernelImageType> it(kernel, kernelRegion); !it.IsAtEnd(); ++it)
+    {
+      SizeValueType offset{ 0 };
+      SizeValueType stride{ 1 };
+      for (unsigned int dim{ 0 }; dim < ImageDimension; ++dim)
+      {
+        const IndexValueType shift{ it.GetIndex()[dim] - kernelRegion.GetIndex(dim) -
+                                    static_cast<IndexValueType>(kernelRegion.GetSize(dim) / 2) };
+        const auto           length{ static_cast<IndexValueType>(paddedSize[dim]) };
+        offset += static_cast<SizeValueType>((shift + length) % length) * stride;
+        stride *= paddedSize[dim];
+      }
+      plane[offset] = static_cast<RealType>(scale * static_cast<double>(it.Get()));
+    }
+    m_KernelPlanesKernels[n] = kernel;
+    ++m_NumberOfKernelTransforms;
+  }
+  m_KernelPlanesPaddedSize = paddedSize;
+  m_KernelPlanesNormalize = m_Normalize;
+  m_KernelPlanesTime.Modified();
+}
+
+template <typename TInputImage, typename TOutputImage, typename TKernelImage>
+void
+VkFFTFilterBankImageFilter<TInputImage, TOutputImage, TKernelImage>::PrintSelf(std::ostream & os, Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+  os << indent << "NumberOfKernelImages: " << this->GetNumberOfKernelImages() << std::endl;
+  os << indent << "Normalize: " << m_Normalize << std::endl;
+  os << indent << "NumberOfKernelTransforms: " << m_NumberOfKernelTransforms << std::endl;
+  os << indent << "UseVkGlobalConfiguration: " << m_UseVkGlobalConfiguration << std::endl;
+  os << indent << "Local DeviceID: " << m_DeviceID << std::endl;
+  os << indent << "Global DeviceID: " << VkGlobalConfiguration::GetDeviceID() << std::endl;
+  os << indent << "Preferred DeviceID: " << this->GetDeviceID() << std::endl;
+}
+
+} // end namespace itk
+
+#endif // itkVkFFTFilterBankImageFilter_hxx
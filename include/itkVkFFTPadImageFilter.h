@@ -0,0 +1,140 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         https://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkVkFFTPadImageFilter_h
+#define itkVkFFTPadImageFilter_h
+
+#include "itkFFTPadImageFilter.h"
+#include "itkNumericTraits.h"
+#include "itkVkCommon.h"
+
+namespace itk
+{
+/**
+ *\class VkFFTPadImageFilter
+ *
+ * \brief Pad an image to the sizes that VkFFT transforms fastest.
+ *
+ * FFTPadImageFilter pads each dimension to the next size whose greatest
+ * prime factor does not exceed a fixed value, regardless of the cost of
+ * transforming that size. VkFFTPadImageFilter instead pads each dimension
+ * to the size of at least the input size plus twice `PadRadius` with the
+ * lowest anticipated transform cost, as returned by
+ * VkCommon::GetOptimalFFTSize. The cost accounts for the radix passes VkFFT
+ * uses, the number of shared-memory uploads for the given precision, the
+ * transform type, and the Bluestein fallback for sizes with prime factors
+ * greater than VkCommon::GetGreatestPrimeFactor(). A table of
+ * measured per-size costs for the target device may be supplied to
+ * override the estimates.
+ *
+ * The padded region is centered on the input region as in FFTPadImageFilter
+ * and the boundary condition is applied in the same way.
+ *
+ * \ingroup FourierTransform
+ * \ingroup ITKFFT
+ * \ingroup VkFFTBackend
+ *
+ * \sa FFTPadImageFilter
+ * \sa VkCommon
+ */
+template <typename TInputImage, typename TOutputImage = TInputImage>
+class VkFFTPadImageFilter : public FFTPadImageFilter<TInputImage, TOutputImage>
+{
+public:
+  ITK_DISALLOW_COPY_AND_MOVE(VkFFTPadImageFilter);
+
+  /** Standard class type aliases. */
+  using Self = VkFFTPadImageFilter;
+  using Superclass = FFTPadImageFilter<TInputImage, TOutputImage>;
+  using Pointer = SmartPointer<Self>;
+  using ConstPointer = SmartPointer<const Self>;
+
+  using InputImageType = TInputImage;
+  using OutputImageType = TOutputImage;
+  using RegionType = typename OutputImageType::RegionType;
+  using IndexType = typename OutputImageType::IndexType;
+  using SizeType = typename OutputImageType::SizeType;
+  using RealType = typename NumericTraits<typename OutputImageType::PixelType>::ValueType;
+  using SizeCostTableType = VkCommon::SizeCostTableType;
+
+  static constexpr unsigned int ImageDimension = TInputImage::ImageDimension;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkOverrideGetNameOfClassMacro(VkFFTPadImageFilter);
+
+  /** Transform the padded image is destined for. For real-to-Hermitian
+   *  transforms only the first dimension is real, so the remaining
+   *  dimensions are sized for complex transforms. Defaults to R2HalfH. */
+  void
+  SetTransformType(const VkCommon::FFTEnum transformType)
+  {
+    if (m_TransformType != transformType)
+    {
+      m_TransformType = transformType;
+      this->Modified();
+    }
+  }
+  VkCommon::FFTEnum
+  GetTransformType() const
+  {
+    return m_TransformType;
+  }
+
+  /** Minimum padding on either side of each dimension, e.g. the radius of
+   *  a kernel the padded image is convolved with. Defaults to zero. */
+  itkSetMacro(PadRadius, SizeType);
+  itkGetConstReferenceMacro(PadRadius, SizeType);
+
+  /** Measured per-size transform costs for the target device.
+   *  Sizes absent from the table use the VkCommon estimate. */
+  void
+  SetSizeCostTable(const SizeCostTableType & sizeCostTable)
+  {
+    m_SizeCostTable = sizeCostTable;
+    this->Modified();
+  }
+  const SizeCostTableType &
+  GetSizeCostTable() const
+  {
+    return m_SizeCostTable;
+  }
+
+protected:
+  VkFFTPadImageFilter() = default;
+  ~VkFFTPadImageFilter() override = default;
+
+  void
+  GenerateOutputInformation() override;
+
+  void
+  PrintSelf(std::ostream & os, Indent indent) const override;
+
+private:
+  VkCommon::FFTEnum m_TransformType{ VkCommon::FFTEnum::R2HalfH };
+  SizeCostTableType m_SizeCostTable{};
+  SizeType          m_PadRadius{};
+};
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#  include "itkVkFFTPadImageFilter.hxx"
+#endif
+
+#endif // itkVkFFTPadImageFilter_h
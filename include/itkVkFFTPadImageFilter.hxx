@@ -0,0 +1,70 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         https://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkVkFFTPadImageFilter_hxx
+#define itkVkFFTPadImageFilter_hxx
+
+#include "itkVkFFTPadImageFilter.h"
+
+namespace itk
+{
+
+template <typename TInputImage, typename TOutputImage>
+void
+VkFFTPadImageFilter<TInputImage, TOutputImage>::GenerateOutputInformation()
+{
+  // Set up spacing, origin, direction etc. as in FFTPadImageFilter
+  Superclass::GenerateOutputInformation();
+
+  const InputImageType * input{ this->GetInput() };
+  OutputImageType *      output{ this->GetOutput() };
+  if (!input || !output)
+  {
+    return;
+  }
+
+  const VkCommon::PrecisionEnum precision{ sizeof(RealType) >= 8 ? VkCommon::PrecisionEnum::DOUBLE
+                                                                  : VkCommon::PrecisionEnum::FLOAT };
+  const SizeCostTableType * const sizeCostTable{ m_SizeCostTable.empty() ? nullptr : &m_SizeCostTable };
+
+  const auto & inputRegion = input->GetLargestPossibleRegion();
+  IndexType    index;
+  SizeType     size;
+  for (unsigned int dim = 0; dim < ImageDimension; ++dim)
+  {
+    const VkCommon::FFTEnum transformType{ dim == 0 ? m_TransformType : VkCommon::FFTEnum::C2C };
+    const auto              inputSize = inputRegion.GetSize()[dim];
+    size[dim] = VkCommon::GetOptimalFFTSize(inputSize + 2 * m_PadRadius[dim], precision, transformType, sizeCostTable);
+    const auto padSize = size[dim] - inputSize;
+    index[dim] = inputRegion.GetIndex()[dim] - static_cast<IndexValueType>(padSize / 2);
+  }
+  output->SetLargestPossibleRegion(RegionType(index, size));
+}
+
+template <typename TInputImage, typename TOutputImage>
+void
+VkFFTPadImageFilter<TInputImage, TOutputImage>::PrintSelf(std::ostream & os, Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+  os << indent << "TransformType: " << static_cast<int>(m_TransformType) << std::endl;
+  os << indent << "PadRadius: " << m_PadRadius << std::endl;
+  os << indent << "SizeCostTable entries: " << m_SizeCostTable.size() << std::endl;
+}
+
+} // end namespace itk
+
+#endif // itkVkFFTPadImageFilter_hxx
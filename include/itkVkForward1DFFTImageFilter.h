@@ -20,8 +20,12 @@
 
 #include "itkFFTImageFilterFactory.h"
 #include "itkForward1DFFTImageFilter.h"
+#include "itkVkAlignedImportImageContainer.h"
 #include "itkVkCommon.h"
+#include "itkVkFFTDispatcher.h"
 #include "itkVkGlobalConfiguration.h"
+#include "itkVkTimingsReporter.h"
+#include "itkVnlForward1DFFTImageFilter.h"
 
 namespace itk
 {
@@ -49,7 +53,9 @@ namespace itk
  */
 template <typename TInputImage,
           typename TOutputImage = Image<std::complex<typename TInputImage::PixelType>, TInputImage::ImageDimension>>
-class VkForward1DFFTImageFilter : public Forward1DFFTImageFilter<TInputImage, TOutputImage>
+class VkForward1DFFTImageFilter
+  : public Forward1DFFTImageFilter<TInputImage, TOutputImage>
+  , public VkTimingsReporter
 {
 public:
   ITK_DISALLOW_COPY_AND_MOVE(VkForward1DFFTImageFilter);
@@ -98,7 +104,9 @@ public:
   itkSetMacro(DeviceID, uint64_t);
 
   /** Return the enumerated GPU device to use for FFT
-   *  according to current filter settings. */
+   *  according to current filter settings. With the global
+   *  configuration, runs are placed on devices by its scheduling
+   *  policy, which is this device only for the FIXED policy. */
   uint64_t
   GetDeviceID() const
   {
@@ -108,13 +116,28 @@ public:
   SizeValueType
   GetSizeGreatestPrimeFactor() const override;
 
+  /** Number of updates computed with a CPU implementation in place of
+   *  VkFFT, as chosen by the cost model of VkGlobalConfiguration or
+   *  because no device was available. See VkFFTDispatcher. */
+  SizeValueType
+  GetNumberOfCPURuns() const
+  {
+    return m_FFTDispatcher.GetNumberOfCPURuns();
+  }
+
 protected:
-  VkForward1DFFTImageFilter() = default;
+  VkForward1DFFTImageFilter()
+    : VkTimingsReporter{ &m_VkCommon }
+  {}
   ~VkForward1DFFTImageFilter() override = default;
 
   void
   GenerateData() override;
 
+  /** Compute the output with the CPU implementation of the dispatcher. */
+  void
+  GenerateDataOnCPU();
+
   void
   PrintSelf(std::ostream & os, Indent indent) const override;
 
@@ -122,7 +145,11 @@ private:
   bool     m_UseVkGlobalConfiguration{ true };
   uint64_t m_DeviceID{ 0UL };
 
-  VkCommon m_VkCommon{};
+  using FFTDispatcherType = VkFFTDispatcher<Superclass, VnlForward1DFFTImageFilter<InputImageType, OutputImageType>>;
+  using LengthsType = typename FFTDispatcherType::LengthsType;
+
+  VkCommon          m_VkCommon{};
+  FFTDispatcherType m_FFTDispatcher{};
 };
 
 // Describe whether input/output are real- or complex-valued
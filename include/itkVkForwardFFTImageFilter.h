@@ -21,8 +21,12 @@
 #include "itkFFTImageFilterFactory.h"
 #include "itkForwardFFTImageFilter.h"
 #include "itkImage.h"
+#include "itkVkAlignedImportImageContainer.h"
 #include "itkVkCommon.h"
+#include "itkVkFFTDispatcher.h"
 #include "itkVkGlobalConfiguration.h"
+#include "itkVkTimingsReporter.h"
+#include "itkVnlForwardFFTImageFilter.h"
 
 namespace itk
 {
@@ -47,7 +51,9 @@ namespace itk
  */
 template <typename TInputImage,
           typename TOutputImage = Image<std::complex<typename TInputImage::PixelType>, TInputImage::ImageDimension>>
-class VkForwardFFTImageFilter : public ForwardFFTImageFilter<TInputImage, TOutputImage>
+class VkForwardFFTImageFilter
+  : public ForwardFFTImageFilter<TInputImage, TOutputImage>
+  , public VkTimingsReporter
 {
 public:
   ITK_DISALLOW_COPY_AND_MOVE(VkForwardFFTImageFilter);
@@ -96,7 +102,9 @@ public:
   itkSetMacro(DeviceID, uint64_t);
 
   /** Return the enumerated GPU device to use for FFT
-   *  according to current filter settings. */
+   *  according to current filter settings. With the global
+   *  configuration, runs are placed on devices by its scheduling
+   *  policy, which is this device only for the FIXED policy. */
   uint64_t
   GetDeviceID() const
   {
@@ -106,6 +114,15 @@ public:
   SizeValueType
   GetSizeGreatestPrimeFactor() const override;
 
+  /** Number of updates computed with a CPU implementation in place of
+   *  VkFFT, as chosen by the cost model of VkGlobalConfiguration or
+   *  because no device was available. See VkFFTDispatcher. */
+  SizeValueType
+  GetNumberOfCPURuns() const
+  {
+    return m_FFTDispatcher.GetNumberOfCPURuns();
+  }
+
 protected:
   VkForwardFFTImageFilter();
   ~VkForwardFFTImageFilter() override = default;
@@ -113,6 +130,10 @@ protected:
   void
   GenerateData() override;
 
+  /** Compute the output with the CPU implementation of the dispatcher. */
+  void
+  GenerateDataOnCPU();
+
   void
   PrintSelf(std::ostream & os, Indent indent) const override;
 
@@ -120,7 +141,11 @@ private:
   bool     m_UseVkGlobalConfiguration{ true };
   uint64_t m_DeviceID{ 0UL };
 
-  VkCommon m_VkCommon{};
+  using FFTDispatcherType = VkFFTDispatcher<Superclass, VnlForwardFFTImageFilter<InputImageType, OutputImageType>>;
+  using LengthsType = typename FFTDispatcherType::LengthsType;
+
+  VkCommon          m_VkCommon{};
+  FFTDispatcherType m_FFTDispatcher{};
 };
 
 // Describe whether input/output are real- or complex-valued
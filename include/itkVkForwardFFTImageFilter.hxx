@@ -20,6 +20,7 @@
 
 #include "itkHalfToFullHermitianImageFilter.h"
 #include "itkVkForwardFFTImageFilter.h"
+#include "itkVkTracer.h"
 #include "itkIndent.h"
 #include "itkMetaDataObject.h"
 #include "itkProgressReporter.h"
@@ -32,12 +33,15 @@ namespace itk
 
 template <typename TInputImage, typename TOutputImage>
 VkForwardFFTImageFilter<TInputImage, TOutputImage>::VkForwardFFTImageFilter()
+  : VkTimingsReporter{ &m_VkCommon }
 {}
 
 template <typename TInputImage, typename TOutputImage>
 void
 VkForwardFFTImageFilter<TInputImage, TOutputImage>::GenerateData()
 {
+  const VkTraceScope traceScope{ this->GetNameOfClass(), "GenerateData", this->GetDeviceID() };
+
   // get pointers to the input and output
   const InputImageType * const input{ this->GetInput() };
   OutputImageType * const      output{ this->GetOutput() };
@@ -51,9 +55,8 @@ VkForwardFFTImageFilter<TInputImage, TOutputImage>::GenerateData()
   // reports the beginning and the end of the process
   const ProgressReporter progress(this, 0, 1);
 
-  // allocate output buffer memory
-  output->SetBufferedRegion(output->GetRequestedRegion());
-  output->Allocate();
+  // allocate output buffer memory, aligned for use in place by the device
+  AllocateVkAlignedBuffer(output, this->GetDeviceID());
 
   const SizeType & inputSize{ input->GetLargestPossibleRegion().GetSize() };
 
@@ -64,10 +67,6 @@ VkForwardFFTImageFilter<TInputImage, TOutputImage>::GenerateData()
   const SizeValueType inBytes{ input->GetLargestPossibleRegion().GetNumberOfPixels() * sizeof(InputPixelType) };
   const SizeValueType outBytes{ output->GetLargestPossibleRegion().GetNumberOfPixels() * sizeof(OutputPixelType) };
 
-  // Mostly use defaults for VkCommon::VkGPU
-  typename VkCommon::VkGPU vkGPU;
-  vkGPU.device_id = this->GetDeviceID();
-
   // Describe this filter in VkCommon::VkParameters
   typename VkCommon::VkParameters vkParameters;
   if (ImageDimension > 0)
@@ -92,15 +91,50 @@ VkForwardFFTImageFilter<TInputImage, TOutputImage>::GenerateData()
   vkParameters.outputCPUBuffer = outputCPUBuffer;
   vkParameters.outputBufferBytes = outBytes;
 
+  // Run on the CPU when the cost model anticipates that to be faster
+  const LengthsType lengths{ FFTDispatcherType::GetLengths(inputSize) };
+  if (m_FFTDispatcher.GetUseCPU(lengths,
+                                input->GetLargestPossibleRegion().GetNumberOfPixels(),
+                                inBytes + outBytes,
+                                std::is_same<RealType, double>::value,
+                                m_VkCommon.HasPlanFor(vkParameters)))
+  {
+    this->GenerateDataOnCPU();
+    return;
+  }
+
+  // Count this run as outstanding on the device of the plan it reuses,
+  // or else on a device chosen by the scheduling policy
+  const VkDeviceReservation deviceReservation{
+    m_UseVkGlobalConfiguration, m_DeviceID, inBytes + outBytes, m_VkCommon, vkParameters
+  };
+
+  // Mostly use defaults for VkCommon::VkGPU
+  typename VkCommon::VkGPU vkGPU;
+  vkGPU.device_id = deviceReservation.GetDeviceID();
+  vkGPU.profiling = VkGlobalConfiguration::GetProfiling();
+
   const VkFFTResult resFFT{ m_VkCommon.Run(vkGPU, vkParameters) };
   if (resFFT != VKFFT_SUCCESS)
   {
+    if (m_FFTDispatcher.GetUseCPUAfterError(resFFT, lengths))
+    {
+      this->GenerateDataOnCPU();
+      return;
+    }
     std::ostringstream mesg;
     mesg << "VkFFT third-party library failed with error code " << resFFT << ".";
     itkAssertOrThrowMacro(false, mesg.str());
   }
 }
 
+template <typename TInputImage, typename TOutputImage>
+void
+VkForwardFFTImageFilter<TInputImage, TOutputImage>::GenerateDataOnCPU()
+{
+  m_FFTDispatcher.Run(this);
+}
+
 template <typename TInputImage, typename TOutputImage>
 void
 VkForwardFFTImageFilter<TInputImage, TOutputImage>::PrintSelf(std::ostream & os, Indent indent) const
@@ -110,6 +144,7 @@ VkForwardFFTImageFilter<TInputImage, TOutputImage>::PrintSelf(std::ostream & os,
   os << indent << "Local DeviceID: " << m_DeviceID << std::endl;
   os << indent << "Global DeviceID: " << VkGlobalConfiguration::GetDeviceID() << std::endl;
   os << indent << "Preferred DeviceID: " << this->GetDeviceID() << std::endl;
+  os << indent << "NumberOfCPURuns: " << m_FFTDispatcher.GetNumberOfCPURuns() << std::endl;
 }
 
 template <typename TInputImage, typename TOutputImage>
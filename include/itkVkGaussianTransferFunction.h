@@ -0,0 +1,161 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         https://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkVkGaussianTransferFunction_h
+#define itkVkGaussianTransferFunction_h
+
+#include "itkGaussianOperator.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
+#include "itkImageRegionIterator.h"
+#include "itkLightObject.h"
+#include "itkMath.h"
+
+#include <array>
+#include <cmath>
+#include <vector>
+
+namespace itk
+{
+/**
+ *\class VkGaussianTransferFunction
+ * \brief Frequency response of the discrete Gaussian kernels used by
+ *     DiscreteGaussianImageFilter and FFTDiscreteGaussianImageFilter
+ *
+ * A symmetric kernel h of radius r applied by circular convolution over
+ * a transform of length N has the real-valued frequency response
+ *
+ * H(k) = h_0 + 2 * sum_{j=1..r} h_j cos(2 pi k j / N)
+ *
+ * The kernel coefficients are obtained from GaussianOperator with the same
+ * variance, maximum error and maximum kernel width as the ITK Gaussian
+ * smoothing filters, so that multiplying a spectrum by the separable
+ * product of H along each dimension is equivalent to FFT smoothing of the
+ * transformed image with the same parameters.
+ *
+ * \sa GaussianOperator
+ * \sa VkMultiResolutionPyramidImageFilter
+ *
+ * \ingroup ITKFFT
+ * \ingroup VkFFTBackend
+ */
+template <typename TImage>
+class VkGaussianTransferFunction : public LightObject
+{
+public:
+  ITK_DISALLOW_COPY_AND_MOVE(VkGaussianTransferFunction);
+
+  /** Standard class type aliases. */
+  using Self = VkGaussianTransferFunction;
+  using Superclass = LightObject;
+  using Pointer = SmartPointer<Self>;
+  using ConstPointer = SmartPointer<const Self>;
+
+  /** Method for class instantiation. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkOverrideGetNameOfClassMacro(VkGaussianTransferFunction);
+
+  using ImageType = TImage;
+  using SizeValueType = typename ImageType::SizeValueType;
+
+  static constexpr unsigned int ImageDimension = ImageType::ImageDimension;
+
+  using OperatorType = GaussianOperator<double, ImageDimension>;
+  using TransferFunctionType = std::vector<double>;
+  using SeparableTransferFunctionType = std::array<TransferFunctionType, ImageDimension>;
+
+  /** Radius of the Gaussian kernel along one dimension. */
+  static SizeValueType
+  GetKernelRadius(const double variance, const double maximumError, const unsigned int maximumKernelWidth)
+  {
+    return CreateOperator(variance, maximumError, maximumKernelWidth).GetRadius(0);
+  }
+
+  /** Frequency response for frequency indices 0 to `length - 1` of the
+   *  Gaussian kernel along one dimension of a transform of `transformSize`
+   *  samples. `length` is `transformSize` for complex dimensions and
+   *  `transformSize / 2 + 1` for the half-Hermitian dimension. */
+  static TransferFunctionType
+  Compute1D(const double        variance,
+            const double        maximumError,
+            const unsigned int  maximumKernelWidth,
+            const SizeValueType transformSize,
+            const SizeValueType length)
+  {
+    const OperatorType  oper{ CreateOperator(variance, maximumError, maximumKernelWidth) };
+    const SizeValueType radius{ oper.GetRadius(0) };
+    const double        center{ oper[radius] };
+
+    TransferFunctionType transferFunction(length);
+    for (SizeValueType k = 0; k < length; ++k)
+    {
+      double value{ center };
+      for (SizeValueType j = 1; j <= radius; ++j)
+      {
+        // Reduce k * j modulo N before scaling to keep the phase accurate
+        const double phase{ 2.0 * itk::Math::pi * static_cast<double>((k * j) % transformSize) / transformSize };
+        value += 2.0 * oper[radius + j] * std::cos(phase);
+      }
+      transferFunction[k] = value;
+    }
+    return transferFunction;
+  }
+
+  /** Multiply each pixel of `spectrum` by the separable transfer function
+   *  and write the result to `output`, which must be allocated over the
+   *  same buffered region. Tables are indexed relative to the start of
+   *  the buffered region. */
+  template <typename TSpectrumImage>
+  static void
+  Apply(const TSpectrumImage * spectrum, TSpectrumImage * output, const SeparableTransferFunctionType & transferFunction)
+  {
+    const auto &                                      region = spectrum->GetBufferedRegion();
+    const auto                                        start = region.GetIndex();
+    ImageRegionConstIteratorWithIndex<TSpectrumImage> inputIt(spectrum, region);
+    ImageRegionIterator<TSpectrumImage>               outputIt(output, region);
+    for (; !inputIt.IsAtEnd(); ++inputIt, ++outputIt)
+    {
+      const auto index = inputIt.GetIndex();
+      double     factor{ 1.0 };
+      for (unsigned int dim = 0; dim < ImageDimension; ++dim)
+      {
+        factor *= transferFunction[dim][index[dim] - start[dim]];
+      }
+      outputIt.Set(inputIt.Get() * static_cast<typename TSpectrumImage::PixelType::value_type>(factor));
+    }
+  }
+
+protected:
+  VkGaussianTransferFunction() = default;
+  ~VkGaussianTransferFunction() override = default;
+
+  static OperatorType
+  CreateOperator(const double variance, const double maximumError, const unsigned int maximumKernelWidth)
+  {
+    OperatorType oper;
+    oper.SetDirection(0);
+    oper.SetVariance(variance);
+    oper.SetMaximumError(maximumError);
+    oper.SetMaximumKernelWidth(maximumKernelWidth);
+    oper.CreateDirectional();
+    return oper;
+  }
+};
+} // end namespace itk
+
+#endif // itkVkGaussianTransferFunction_h
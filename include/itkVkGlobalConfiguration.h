@@ -20,8 +20,15 @@
 
 #include "VkFFTBackendExport.h"
 #include "itkLightObject.h"
+#include "itkVkCommon.h"
+#include "itkVkFFTCostModel.h"
 #include "itkMacro.h"
 
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
 namespace itk
 {
 
@@ -37,6 +44,12 @@ struct VkGlobalConfigurationGlobals;
  *
  *  \brief Implements a singleton instance for setting global VkFFT default parameters.
  *
+ * Filters that use the global configuration pick a device for each run
+ * according to the scheduling policy. The default FIXED policy runs
+ * everything on the device given with SetDeviceID. The other policies
+ * spread runs over the enumerated devices, using the number of runs and
+ * bytes of image data that are outstanding on each device.
+ *
  * \ingroup VkFFTBackend
  */
 class VkFFTBackend_EXPORT VkGlobalConfiguration : public LightObject
@@ -53,6 +66,20 @@ public:
   /** Run-time type information (and related methods). */
   itkOverrideGetNameOfClassMacro(VkGlobalConfiguration);
 
+  /** How filters that use the global configuration choose a device.
+   *  FIXED: always the device given with SetDeviceID.
+   *  ROUND_ROBIN: cycle over the devices, one run at a time.
+   *  LEAST_OUTSTANDING_WORK: the device with the fewest outstanding runs.
+   *  MEMORY_AWARE: the device with the most global memory left after
+   *  the bytes of its outstanding runs. */
+  enum class SchedulingPolicyEnum : uint8_t
+  {
+    FIXED,
+    ROUND_ROBIN,
+    LEAST_OUTSTANDING_WORK,
+    MEMORY_AWARE
+  };
+
   /** Default accelerated platform identifier */
   static void
   SetDeviceID(const uint64_t id);
@@ -61,6 +88,97 @@ public:
   static uint64_t
   GetDeviceID();
 
+  /** Policy for choosing the device of each run. Defaults to FIXED. */
+  static void
+  SetSchedulingPolicy(const SchedulingPolicyEnum policy);
+
+  static SchedulingPolicyEnum
+  GetSchedulingPolicy();
+
+  /** Number of devices that runs are spread over, enumerated as 0, 1, ...
+   *  Zero, the default, uses all devices enumerated by the backend. */
+  static void
+  SetNumberOfDevices(const uint64_t numberOfDevices);
+
+  /** Number of devices that runs are spread over, at least 1. */
+  static uint64_t
+  GetNumberOfDevices();
+
+  /** Global memory of a device as seen by the MEMORY_AWARE policy.
+   *  Defaults to the size reported by the backend; setting it caps the
+   *  share of a device used by this process. Zero means unknown. */
+  static void
+  SetDeviceMemoryBytes(const uint64_t id, const uint64_t bytes);
+
+  static uint64_t
+  GetDeviceMemoryBytes(const uint64_t id);
+
+  /** Choose a device for a run on `workBytes` bytes of image data according
+   *  to the scheduling policy and count the run as outstanding on it.
+   *  A device pinned on the calling thread by VkDevicePin is chosen
+   *  regardless of the policy.
+   *  Each call must be matched by ReleaseDevice. See VkDeviceReservation. */
+  static uint64_t
+  AcquireDevice(const uint64_t workBytes);
+
+  /** As AcquireDevice, but keep the run on `planDeviceID`, the device of
+   *  the plan that it reuses, so that repeated runs of one geometry are
+   *  not moved between devices. Only a pinned device, the FIXED policy, or
+   *  a plan device beyond GetNumberOfDevices, leads to another choice. */
+  static uint64_t
+  AcquireDevice(const uint64_t workBytes, const uint64_t planDeviceID);
+
+  /** Count a run on a device chosen by the caller as outstanding on it. */
+  static void
+  ReserveDevice(const uint64_t id, const uint64_t workBytes);
+
+  /** Finish a run counted by AcquireDevice or ReserveDevice. */
+  static void
+  ReleaseDevice(const uint64_t id, const uint64_t workBytes);
+
+  /** Queue depth of a device: runs acquired and not yet released. */
+  static uint64_t
+  GetNumberOfOutstandingRuns(const uint64_t id);
+
+  /** Bytes of image data of the outstanding runs of a device. */
+  static uint64_t
+  GetNumberOfOutstandingBytes(const uint64_t id);
+
+  /** Whether VkFFT filters record device-side timestamps of copies and
+   *  transforms. See VkCommon::VkTimings. Defaults to false. */
+  static void
+  SetProfiling(const bool profiling);
+
+  static bool
+  GetProfiling();
+
+  /** Cost model used by the Vk FFT filters to run each update with VkFFT
+   *  or with the next registered CPU implementation. Without a cost model,
+   *  the default, every update runs with VkFFT. */
+  static void
+  SetCostModel(const VkFFTCostModel * costModel);
+
+  static VkFFTCostModel::ConstPointer
+  GetCostModel();
+
+  /** Whether the Vk FFT filters run an update with the next registered CPU
+   *  implementation when no device can be set up, rather than throwing.
+   *  Defaults to true. */
+  static void
+  SetFallbackToCPU(const bool fallbackToCPU);
+
+  static bool
+  GetFallbackToCPU();
+
+  /** Write a Chrome trace-event JSON file of VkFFT filter activity.
+   *  An empty file name, the default unless the ITK_VKFFT_TRACE_FILE
+   *  environment variable is set, disables tracing. See VkTracer. */
+  static void
+  SetTraceFileName(const std::string & fileName);
+
+  static std::string
+  GetTraceFileName();
+
 private:
   VkGlobalConfiguration() = default;
   ~VkGlobalConfiguration() override = default;
@@ -79,7 +197,96 @@ private:
 
   static VkGlobalConfigurationGlobals * m_PimplGlobals;
 
-  uint64_t m_DeviceID{ 0 };
+  /** Grow the per-device state to hold device `id`. Requires m_SchedulingMutex. */
+  void
+  ResizeDeviceState(const uint64_t id);
+
+  uint64_t                     m_DeviceID{ 0 };
+  bool                         m_Profiling{ false };
+  VkFFTCostModel::ConstPointer m_CostModel{ nullptr };
+  bool                         m_FallbackToCPU{ true };
+  std::mutex                   m_CostModelMutex{};
+
+  SchedulingPolicyEnum  m_SchedulingPolicy{ SchedulingPolicyEnum::FIXED };
+  uint64_t              m_NumberOfDevices{ 0 };
+  uint64_t              m_NumberOfEnumeratedDevices{ 0 };
+  uint64_t              m_NextDevice{ 0 };
+  std::vector<uint64_t> m_OutstandingRuns{};
+  std::vector<uint64_t> m_OutstandingBytes{};
+  std::vector<uint64_t> m_DeviceMemoryBytes{};
+  std::vector<bool>     m_DeviceMemoryKnown{};
+  std::mutex            m_SchedulingMutex{};
+};
+
+/** Define how to print enumerations */
+extern VkFFTBackend_EXPORT std::ostream &
+                           operator<<(std::ostream & out, const VkGlobalConfiguration::SchedulingPolicyEnum value);
+
+/**
+ *\class VkDeviceReservation
+ *
+ *  \brief Holds a device for the duration of one run of a VkFFT filter.
+ *
+ * With the global configuration, the device is chosen by
+ * VkGlobalConfiguration::AcquireDevice; otherwise it is the filter's own
+ * device. Either way the run counts as outstanding on the device until
+ * the reservation is destroyed.
+ *
+ * Given the VkCommon of the run, a run that reuses its plan stays on the
+ * device of the plan. The scheduling policy places only runs that need a
+ * new plan, such as those of a new image size, so that a filter updated
+ * repeatedly does not set up its backend on each device in turn.
+ *
+ * \ingroup VkFFTBackend
+ */
+class VkFFTBackend_EXPORT VkDeviceReservation
+{
+public:
+  ITK_DISALLOW_COPY_AND_MOVE(VkDeviceReservation);
+
+  VkDeviceReservation(const bool useGlobalConfiguration, const uint64_t localDeviceID, const uint64_t workBytes);
+  VkDeviceReservation(const bool                    useGlobalConfiguration,
+                      const uint64_t                localDeviceID,
+                      const uint64_t                workBytes,
+                      const VkCommon &              vkCommon,
+                      const VkCommon::VkParameters & vkParameters);
+  ~VkDeviceReservation();
+
+  uint64_t
+  GetDeviceID() const
+  {
+    return m_DeviceID;
+  }
+
+private:
+  uint64_t m_DeviceID;
+  uint64_t m_WorkBytes;
+};
+
+/**
+ *\class VkDevicePin
+ *
+ *  \brief Keeps the runs of the calling thread on one device.
+ *
+ * While a pin exists, VkGlobalConfiguration::AcquireDevice returns its
+ * device to every run on the thread that created it. A composite filter
+ * pins the device that it reserved so that the runs of its internal
+ * filters, including those it cannot configure, and its trace events
+ * share one device. Pins nest; the innermost applies.
+ *
+ * \ingroup VkFFTBackend
+ */
+class VkFFTBackend_EXPORT VkDevicePin
+{
+public:
+  ITK_DISALLOW_COPY_AND_MOVE(VkDevicePin);
+
+  explicit VkDevicePin(const uint64_t id);
+  ~VkDevicePin();
+
+  /** Whether a device is pinned on the calling thread, and which. */
+  static bool
+  GetPinnedDevice(uint64_t & id);
 };
 } // namespace itk
 
@@ -20,6 +20,7 @@
 
 #include "itkHalfToFullHermitianImageFilter.h"
 #include "itkVkHalfHermitianToRealInverseFFTImageFilter.h"
+#include "itkVkTracer.h"
 #include "itkIndent.h"
 #include "itkMetaDataObject.h"
 #include "itkProgressReporter.h"
@@ -32,12 +33,15 @@ namespace itk
 
 template <typename TInputImage, typename TOutputImage>
 VkHalfHermitianToRealInverseFFTImageFilter<TInputImage, TOutputImage>::VkHalfHermitianToRealInverseFFTImageFilter()
+  : VkTimingsReporter{ &m_VkCommon }
 {}
 
 template <typename TInputImage, typename TOutputImage>
 void
 VkHalfHermitianToRealInverseFFTImageFilter<TInputImage, TOutputImage>::GenerateData()
 {
+  const VkTraceScope traceScope{ this->GetNameOfClass(), "GenerateData", this->GetDeviceID() };
+
   // get pointers to the input and output
   const InputImageType * const input{ this->GetInput() };
   OutputImageType * const      output{ this->GetOutput() };
@@ -51,9 +55,9 @@ VkHalfHermitianToRealInverseFFTImageFilter<TInputImage, TOutputImage>::GenerateD
   // reports the beginning and the end of the process
   const ProgressReporter progress(this, 0, 1);
 
-  // allocate output buffer memory
+  // allocate output buffer memory, aligned for use in place by the device
   output->SetRegions(output->GetRequestedRegion());
-  output->Allocate();
+  AllocateVkAlignedBuffer(output, this->GetDeviceID());
 
   const SizeType & outputSize{ output->GetBufferedRegion().GetSize() };
 
@@ -67,10 +71,6 @@ VkHalfHermitianToRealInverseFFTImageFilter<TInputImage, TOutputImage>::GenerateD
   itkAssertOrThrowMacro(input->GetBufferedRegion().GetSize()[0] == outputSize[0] / 2 + 1,
                         "Input image's first dimension must equal floor((output image's first dimension)/2) + 1");
 
-  // Mostly use defaults for VkCommon::VkGPU
-  typename VkCommon::VkGPU vkGPU;
-  vkGPU.device_id = this->GetDeviceID();
-
   // Describe this filter in VkCommon::VkParameters
   typename VkCommon::VkParameters vkParameters;
   if (ImageDimension > 0)
@@ -95,15 +95,52 @@ VkHalfHermitianToRealInverseFFTImageFilter<TInputImage, TOutputImage>::GenerateD
   vkParameters.outputCPUBuffer = outputCPUBuffer;
   vkParameters.outputBufferBytes = outBytes;
 
+  // Run on the CPU when the cost model anticipates that to be faster
+  const LengthsType lengths{ FFTDispatcherType::GetLengths(outputSize) };
+  if (m_FFTDispatcher.GetUseCPU(lengths,
+                                output->GetBufferedRegion().GetNumberOfPixels(),
+                                inBytes + outBytes,
+                                std::is_same<RealType, double>::value,
+                                m_VkCommon.HasPlanFor(vkParameters)))
+  {
+    this->GenerateDataOnCPU();
+    return;
+  }
+
+  // Count this run as outstanding on the device of the plan it reuses,
+  // or else on a device chosen by the scheduling policy
+  const VkDeviceReservation deviceReservation{
+    m_UseVkGlobalConfiguration, m_DeviceID, inBytes + outBytes, m_VkCommon, vkParameters
+  };
+
+  // Mostly use defaults for VkCommon::VkGPU
+  typename VkCommon::VkGPU vkGPU;
+  vkGPU.device_id = deviceReservation.GetDeviceID();
+  vkGPU.profiling = VkGlobalConfiguration::GetProfiling();
+
   const VkFFTResult resFFT{ m_VkCommon.Run(vkGPU, vkParameters) };
   if (resFFT != VKFFT_SUCCESS)
   {
+    if (m_FFTDispatcher.GetUseCPUAfterError(resFFT, lengths))
+    {
+      this->GenerateDataOnCPU();
+      return;
+    }
     std::ostringstream mesg;
     mesg << "VkFFT third-party library failed with error code " << resFFT << ".";
     itkAssertOrThrowMacro(false, mesg.str());
   }
 }
 
+template <typename TInputImage, typename TOutputImage>
+void
+VkHalfHermitianToRealInverseFFTImageFilter<TInputImage, TOutputImage>::GenerateDataOnCPU()
+{
+  auto * const cpuFilter{ m_FFTDispatcher.GetCPUFilter() };
+  cpuFilter->SetActualXDimensionIsOdd(this->GetActualXDimensionIsOdd());
+  m_FFTDispatcher.Run(this);
+}
+
 template <typename TInputImage, typename TOutputImage>
 void
 VkHalfHermitianToRealInverseFFTImageFilter<TInputImage, TOutputImage>::PrintSelf(std::ostream & os, Indent indent) const
@@ -113,6 +150,7 @@ VkHalfHermitianToRealInverseFFTImageFilter<TInputImage, TOutputImage>::PrintSelf
   os << indent << "Local DeviceID: " << m_DeviceID << std::endl;
   os << indent << "Global DeviceID: " << VkGlobalConfiguration::GetDeviceID() << std::endl;
   os << indent << "Preferred DeviceID: " << this->GetDeviceID() << std::endl;
+  os << indent << "NumberOfCPURuns: " << m_FFTDispatcher.GetNumberOfCPURuns() << std::endl;
 }
 
 template <typename TInputImage, typename TOutputImage>
@@ -21,8 +21,12 @@
 #include "itkFFTImageFilterFactory.h"
 #include "itkImage.h"
 #include "itkInverse1DFFTImageFilter.h"
+#include "itkVkAlignedImportImageContainer.h"
 #include "itkVkCommon.h"
+#include "itkVkFFTDispatcher.h"
 #include "itkVkGlobalConfiguration.h"
+#include "itkVkTimingsReporter.h"
+#include "itkVnlInverse1DFFTImageFilter.h"
 
 namespace itk
 {
@@ -50,7 +54,9 @@ namespace itk
  */
 template <typename TInputImage,
           typename TOutputImage = Image<typename TInputImage::PixelType::value_type, TInputImage::ImageDimension>>
-class VkInverse1DFFTImageFilter : public Inverse1DFFTImageFilter<TInputImage, TOutputImage>
+class VkInverse1DFFTImageFilter
+  : public Inverse1DFFTImageFilter<TInputImage, TOutputImage>
+  , public VkTimingsReporter
 {
 public:
   ITK_DISALLOW_COPY_AND_MOVE(VkInverse1DFFTImageFilter);
@@ -99,7 +105,9 @@ public:
   itkSetMacro(DeviceID, uint64_t);
 
   /** Return the enumerated GPU device to use for FFT
-   *  according to current filter settings. */
+   *  according to current filter settings. With the global
+   *  configuration, runs are placed on devices by its scheduling
+   *  policy, which is this device only for the FIXED policy. */
   uint64_t
   GetDeviceID() const
   {
@@ -109,13 +117,28 @@ public:
   SizeValueType
   GetSizeGreatestPrimeFactor() const override;
 
+  /** Number of updates computed with a CPU implementation in place of
+   *  VkFFT, as chosen by the cost model of VkGlobalConfiguration or
+   *  because no device was available. See VkFFTDispatcher. */
+  SizeValueType
+  GetNumberOfCPURuns() const
+  {
+    return m_FFTDispatcher.GetNumberOfCPURuns();
+  }
+
 protected:
-  VkInverse1DFFTImageFilter() = default;
+  VkInverse1DFFTImageFilter()
+    : VkTimingsReporter{ &m_VkCommon }
+  {}
   ~VkInverse1DFFTImageFilter() override = default;
 
   void
   GenerateData() override;
 
+  /** Compute the output with the CPU implementation of the dispatcher. */
+  void
+  GenerateDataOnCPU();
+
   void
   PrintSelf(std::ostream & os, Indent indent) const override;
 
@@ -123,7 +146,11 @@ private:
   bool     m_UseVkGlobalConfiguration{ true };
   uint64_t m_DeviceID{ 0UL };
 
-  VkCommon m_VkCommon{};
+  using FFTDispatcherType = VkFFTDispatcher<Superclass, VnlInverse1DFFTImageFilter<InputImageType, OutputImageType>>;
+  using LengthsType = typename FFTDispatcherType::LengthsType;
+
+  VkCommon          m_VkCommon{};
+  FFTDispatcherType m_FFTDispatcher{};
 };
 
 // Describe whether input/output are real- or complex-valued
@@ -0,0 +1,187 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         https://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkVkMaskedFFTNormalizedCorrelationImageFilter_h
+#define itkVkMaskedFFTNormalizedCorrelationImageFilter_h
+
+#include "itkImage.h"
+#include "itkImageToImageFilter.h"
+#include "itkVkCommon.h"
+#include "itkVkGlobalConfiguration.h"
+#include "itkVkTimingsReporter.h"
+
+#include <complex>
+#include <vector>
+
+namespace itk
+{
+/**
+ *\class VkMaskedFFTNormalizedCorrelationImageFilter
+ *
+ * \brief Masked normalized cross correlation in one batched VkFFT run.
+ *
+ * Computes the masked normalized cross correlation of a moving image over
+ * a fixed image with the method of Padfield, as
+ * MaskedFFTNormalizedCorrelationImageFilter does, with the same inputs,
+ * parameters and output size, the sum of the input sizes minus one.
+ *
+ * The six images that the correlation is made of (the masks, the masked
+ * images and the masked squared images of each side) are forward
+ * transformed in one batched VkFFT run. Its MASKED_NCC output stage
+ * multiplies their spectra into the six correlation maps, transforms those
+ * back and normalizes them on the device, where all buffers stay, so that
+ * only the correlation is copied back. The plan and its buffers are reused
+ * by later updates of the same sizes.
+ *
+ * Masks are optional; pixels where a mask is nonzero are used. The
+ * correlation is set to 0 where fewer pixels overlap than required by
+ * RequiredNumberOfOverlappingPixels and RequiredFractionOfOverlappingPixels
+ * of the largest overlap, or where the variance of either image over the
+ * overlap vanishes.
+ *
+ * Transforms run in the precision of the output pixel type. Choose a double
+ * output for correlations of images whose mean is large relative to their
+ * variation.
+ *
+ * \ingroup FourierTransform
+ * \ingroup VkFFTBackend
+ *
+ * \sa MaskedFFTNormalizedCorrelationImageFilter
+ * \sa VkGlobalConfiguration
+ */
+template <typename TInputImage,
+          typename TOutputImage,
+          typename TMaskImage = Image<unsigned char, TInputImage::ImageDimension>>
+class VkMaskedFFTNormalizedCorrelationImageFilter
+  : public ImageToImageFilter<TInputImage, TOutputImage>
+  , public VkTimingsReporter
+{
+public:
+  ITK_DISALLOW_COPY_AND_MOVE(VkMaskedFFTNormalizedCorrelationImageFilter);
+
+  using InputImageType = TInputImage;
+  using OutputImageType = TOutputImage;
+  using MaskImageType = TMaskImage;
+  static_assert(std::is_same<typename TOutputImage::PixelType, float>::value ||
+                  std::is_same<typename TOutputImage::PixelType, double>::value,
+                "Unsupported pixel type");
+  static_assert(TInputImage::ImageDimension >= 1 && TInputImage::ImageDimension <= 3, "Unsupported image dimension");
+
+  /** Standard class type aliases. */
+  using Self = VkMaskedFFTNormalizedCorrelationImageFilter;
+  using Superclass = ImageToImageFilter<InputImageType, OutputImageType>;
+  using Pointer = SmartPointer<Self>;
+  using ConstPointer = SmartPointer<const Self>;
+
+  using RealType = typename OutputImageType::PixelType;
+  using ComplexType = std::complex<RealType>;
+  using SizeType = typename OutputImageType::SizeType;
+  using SizeValueType = typename OutputImageType::SizeValueType;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkOverrideGetNameOfClassMacro(VkMaskedFFTNormalizedCorrelationImageFilter);
+
+  static constexpr unsigned int ImageDimension{ InputImageType::ImageDimension };
+
+  /** Images to correlate, and optional masks of their valid pixels. */
+  itkSetInputMacro(FixedImage, InputImageType);
+  itkGetInputMacro(FixedImage, InputImageType);
+  itkSetInputMacro(MovingImage, InputImageType);
+  itkGetInputMacro(MovingImage, InputImageType);
+  itkSetInputMacro(FixedImageMask, MaskImageType);
+  itkGetInputMacro(FixedImageMask, MaskImageType);
+  itkSetInputMacro(MovingImageMask, MaskImageType);
+  itkGetInputMacro(MovingImageMask, MaskImageType);
+
+  /** Least number of overlapping pixels for the correlation to be computed. */
+  itkSetMacro(RequiredNumberOfOverlappingPixels, SizeValueType);
+  itkGetConstMacro(RequiredNumberOfOverlappingPixels, SizeValueType);
+
+  /** Least fraction of the largest overlap for the correlation to be computed. */
+  itkSetClampMacro(RequiredFractionOfOverlappingPixels, RealType, 0.0, 1.0);
+  itkGetConstMacro(RequiredFractionOfOverlappingPixels, RealType);
+
+  /** Largest number of overlapping pixels of the last update. */
+  itkGetConstMacro(MaximumNumberOfOverlappingPixels, SizeValueType);
+
+  /** Determine whether local or global properties will be
+   *  referenced for setting up GPU acceleration. */
+  itkSetMacro(UseVkGlobalConfiguration, bool);
+  itkGetMacro(UseVkGlobalConfiguration, bool);
+
+  /** Local setting for enumerated GPU device to use for FFT.
+   *  Ignored if `UseVkGlobalConfiguration` is true. */
+  itkSetMacro(DeviceID, uint64_t);
+
+  /** Return the enumerated GPU device to use for FFT
+   *  according to current filter settings. With the global
+   *  configuration, runs are placed on devices by its scheduling
+   *  policy, which is this device only for the FIXED policy. */
+  uint64_t
+  GetDeviceID() const
+  {
+    return uint64_t{ m_UseVkGlobalConfiguration ? VkGlobalConfiguration::GetDeviceID() : m_DeviceID };
+  }
+
+protected:
+  VkMaskedFFTNormalizedCorrelationImageFilter();
+  ~VkMaskedFFTNormalizedCorrelationImageFilter() override = default;
+
+  /** The output size is the sum of the input sizes minus one. */
+  void
+  GenerateOutputInformation() override;
+
+  /** The whole inputs are needed. */
+  void
+  GenerateInputRequestedRegion() override;
+
+  void
+  EnlargeOutputRequestedRegion(DataObject * output) override;
+
+  /** The fixed and moving images need not occupy the same physical space. */
+  void
+  VerifyInputInformation() const override
+  {}
+
+  void
+  GenerateData() override;
+
+  void
+  PrintSelf(std::ostream & os, Indent indent) const override;
+
+private:
+  SizeValueType m_RequiredNumberOfOverlappingPixels{ 0 };
+  RealType      m_RequiredFractionOfOverlappingPixels{ 0 };
+  SizeValueType m_MaximumNumberOfOverlappingPixels{ 0 };
+
+  bool     m_UseVkGlobalConfiguration{ true };
+  uint64_t m_DeviceID{ 0UL };
+
+  // Keeps the plan, its GPU buffers and the stage kernels between updates
+  VkCommon m_VkCommon{};
+};
+
+} // namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#  include "itkVkMaskedFFTNormalizedCorrelationImageFilter.hxx"
+#endif
+
+#endif // itkVkMaskedFFTNormalizedCorrelationImageFilter_h
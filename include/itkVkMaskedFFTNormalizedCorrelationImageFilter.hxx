@@ -0,0 +1,266 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         https://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkVkMaskedFFTNormalizedCorrelationImageFilter_hxx
+#define itkVkMaskedFFTNormalizedCorrelationImageFilter_hxx
+
+#include "itkVkMaskedFFTNormalizedCorrelationImageFilter.h"
+#include "itkVkTracer.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
+#include "itkIndent.h"
+#include "itkProgressReporter.h"
+
+#include <algorithm>
+#include <iostream>
+#include <sstream>
+
+namespace itk
+{
+
+template <typename TInputImage, typename TOutputImage, typename TMaskImage>
+VkMaskedFFTNormalizedCorrelationImageFilter<TInputImage, TOutputImage, TMaskImage>::
+  VkMaskedFFTNormalizedCorrelationImageFilter()
+  : VkTimingsReporter{ &m_VkCommon }
+{
+  this->AddRequiredInputName("FixedImage", 0);
+  this->AddRequiredInputName("MovingImage", 1);
+  this->AddOptionalInputName("FixedImageMask", 2);
+  this->AddOptionalInputName("MovingImageMask", 3);
+}
+
+template <typename TInputImage, typename TOutputImage, typename TMaskImage>
+void
+VkMaskedFFTNormalizedCorrelationImageFilter<TInputImage, TOutputImage, TMaskImage>::GenerateOutputInformation()
+{
+  Superclass::GenerateOutputInformation();
+
+  const InputImageType * const fixedImage{ this->GetFixedImage() };
+  const InputImageType * const movingImage{ this->GetMovingImage() };
+  OutputImageType * const      output{ this->GetOutput() };
+  if (!fixedImage || !movingImage || !output)
+  {
+    return;
+  }
+
+  typename OutputImageType::RegionType outputRegion{ fixedImage->GetLargestPossibleRegion() };
+  for (unsigned int dim{ 0 }; dim < ImageDimension; ++dim)
+  {
+    outputRegion.SetSize(dim,
+                         fixedImage->GetLargestPossibleRegion().GetSize(dim) +
+                           movingImage->GetLargestPossibleRegion().GetSize(dim) - 1);
+  }
+  output->SetLargestPossibleRegion(outputRegion);
+}
+
+template <typename TInputImage, typename TOutputImage, typename TMaskImage>
+void
+VkMaskedFFTNormalizedCorrelationImageFilter<TInputImage, TOutputImage, TMaskImage>::GenerateInputRequestedRegion()
+{
+  Superclass::GenerateInputRequestedRegion();
+
+  for (const auto & inputName : this->GetInputNames())
+  {
+    auto * const input{ dynamic_cast<ImageBase<ImageDimension> *>(this->ProcessObject::GetInput(inputName)) };
+    if (input)
+    {
+      input->SetRequestedRegionToLargestPossibleRegion();
+    }
+  }
+}
+
+template <typename TInputImage, typename TOutputImage, typename TMaskImage>
+void
+VkMaskedFFTNormalizedCorrelationImageFilter<TInputImage, TOutputImage, TMaskImage>::EnlargeOutputRequestedRegion(
+  DataObject * output)
+{
+  Superclass::EnlargeOutputRequestedRegion(output);
+  output->SetRequestedRegionToLargestPossibleRegion();
+}
+
+template <typename TInputImage, typename TOutputImage, typename TMaskImage>
+void
+VkMaskedFFTNormalizedCorrelationImageFilter<TInputImage, TOutputImage, TMaskImage>::GenerateData()
+{
+  const VkTraceScope traceScope{ this->GetNameOfClass(), "GenerateData", this->GetDeviceID() };
+
+  const InputImageType * const fixedImage{ this->GetFixedImage() };
+  const InputImageType * const movingImage{ this->GetMovingImage() };
+  const MaskImageType * const  fixedMask{ this->GetFixedImageMask() };
+  const MaskImageType * const  movingMask{ this->GetMovingImageMask() };
+  OutputImageType * const      output{ this->GetOutput() };
+
+  if (!fixedImage || !movingImage || !output)
+  {
+    return;
+  }
+
+  const ProgressReporter progress(this, 0, 1);
+
+  output->SetBufferedRegion(output->GetRequestedRegion());
+  output->Allocate();
+
+  const SizeType fixedSize{ fixedImage->GetLargestPossibleRegion().GetSize() };
+  const SizeType movingSize{ movingImage->GetLargestPossibleRegion().GetSize() };
+  itkAssertOrThrowMacro(!fixedMask || fixedMask->GetLargestPossibleRegion().GetSize() == fixedSize,
+                        "Fixed image mask and fixed image differ in size");
+  itkAssertOrThrowMacro(!movingMask || movingMask->GetLargestPossibleRegion().GetSize() == movingSize,
+                        "Moving image mask and moving image differ in size");
+
+  // Pad to the fastest VkFFT size that holds the full linear correlation
+  const VkCommon::PrecisionEnum precision{ std::is_same<RealType, double>::value ? VkCommon::PrecisionEnum::DOUBLE
+                                                                                  : VkCommon::PrecisionEnum::FLOAT };
+  SizeType                      paddedSize;
+  SizeValueType                 strides[ImageDimension];
+  SizeValueType                 paddedPixels{ 1 };
+  for (unsigned int dim{ 0 }; dim < ImageDimension; ++dim)
+  {
+    paddedSize[dim] = VkCommon::GetOptimalFFTSize(fixedSize[dim] + movingSize[dim] - 1,
+                                                  precision,
+                                                  dim == 0 ? VkCommon::FFTEnum::R2HalfH : VkCommon::FFTEnum::C2C);
+    strides[dim] = paddedPixels;
+    paddedPixels *= paddedSize[dim];
+  }
+  const SizeValueType spectrumPixels{ paddedPixels / paddedSize[0] * (paddedSize[0] / 2 + 1) };
+
+  // Masked image, mask and masked squared image of each side, with the
+  // moving side rotated by 180 degrees so that products of spectra correlate
+  enum : unsigned int
+  {
+    FixedMaskPlane,
+    FixedPlane,
+    FixedSquaredPlane,
+    MovingMaskPlane,
+    MovingPlane,
+    MovingSquaredPlane,
+    NumberOfPlanes
+  };
+  std::vector<RealType> planes(NumberOfPlanes * paddedPixels);
+  const auto            fillPlanes =
+    [&](const InputImageType * image, const MaskImageType * mask, const unsigned int firstPlane, const bool rotate) {
+      const auto & region{ image->GetLargestPossibleRegion() };
+      const auto & size{ region.GetSize() };
+      RealType *   maskPlane{ &planes[firstPlane * paddedPixels] };
+      RealType *   imagePlane{ maskPlane + paddedPixels };
+      RealType *   squaredPlane{ imagePlane + paddedPixels };
+
+      ImageRegionConstIteratorWithIndex<InputImageType> imageIt(image, region);
+      ImageRegionConstIteratorWithIndex<MaskImageType>  maskIt;
+      if (mask)
+      {
+        maskIt = ImageRegionConstIteratorWithIndex<MaskImageType>(mask, mask->GetLargestPossibleRegion());
+      }
+      for (; !imageIt.IsAtEnd(); ++imageIt)
+      {
+        SizeValueType offset{ 0 };
+        for (unsigned int dim{ 0 }; dim < ImageDimension; ++dim)
+        {
+          const auto position{ static_cast<SizeValueType>(imageIt.GetIndex()[dim] - region.GetIndex(dim)) };
+          offset += (rotate ? size[dim] - 1 - position : position) * strides[dim];
+        }
+        RealType maskValue{ 1 };
+        if (mask)
+        {
+          maskValue = maskIt.Get() != NumericTraits<typename MaskImageType::PixelType>::ZeroValue() ? 1 : 0;
+          ++maskIt;
+        }
+        const auto value{ static_cast<RealType>(imageIt.Get()) * maskValue };
+        maskPlane[offset] = maskValue;
+        imagePlane[offset] = value;
+        squaredPlane[offset] = value * value;
+      }
+    };
+  fillPlanes(fixedImage, fixedMask, FixedMaskPlane, false);
+  fillPlanes(movingImage, movingMask, MovingMaskPlane, true);
+
+  // The six planes are forward transformed in one batched run. Their spectra are multiplied into the six
+  // correlation maps, transformed back and normalized on the device, and only the correlation is copied back.
+  const auto &          outputRegion{ output->GetRequestedRegion() };
+  const SizeValueType   outputPixels{ outputRegion.GetNumberOfPixels() };
+  std::vector<RealType> correlation(outputPixels + 1);
+
+  // Describe the batched transforms and the stage in VkCommon::VkParameters
+  typename VkCommon::VkParameters vkParameters;
+  if (ImageDimension > 0)
+    vkParameters.X = paddedSize[0];
+  if (ImageDimension > 1)
+    vkParameters.Y = paddedSize[1];
+  if (ImageDimension > 2)
+    vkParameters.Z = paddedSize[2];
+  vkParameters.B = NumberOfPlanes;
+  vkParameters.P = precision;
+  vkParameters.fft = VkCommon::FFTEnum::R2HalfH;
+  vkParameters.PSize = sizeof(RealType);
+  vkParameters.I = VkCommon::DirectionEnum::FORWARD;
+  vkParameters.normalized = VkCommon::NormalizationEnum::UNNORMALIZED;
+  vkParameters.inputCPUBuffer = planes.data();
+  vkParameters.inputBufferBytes = planes.size() * sizeof(RealType);
+  vkParameters.outputCPUBuffer = correlation.data();
+  vkParameters.outputBufferBytes = correlation.size() * sizeof(RealType);
+  vkParameters.outputStage = VkCommon::OutputStageEnum::MASKED_NCC;
+  for (unsigned int dim{ 0 }; dim < ImageDimension; ++dim)
+  {
+    vkParameters.stageOutputSize[dim] = outputRegion.GetSize(dim);
+  }
+  vkParameters.requiredOverlap = m_RequiredNumberOfOverlappingPixels;
+  vkParameters.requiredOverlapFraction = m_RequiredFractionOfOverlappingPixels;
+
+  // Count this run as outstanding on the device of the plan it reuses,
+  // or else on a device chosen by the scheduling policy
+  const VkDeviceReservation deviceReservation{ m_UseVkGlobalConfiguration,
+                                               m_DeviceID,
+                                               vkParameters.inputBufferBytes +
+                                                 NumberOfPlanes * spectrumPixels * sizeof(ComplexType) +
+                                                 vkParameters.outputBufferBytes,
+                                               m_VkCommon,
+                                               vkParameters };
+
+  // Mostly use defaults for VkCommon::VkGPU
+  typename VkCommon::VkGPU vkGPU;
+  vkGPU.device_id = deviceReservation.GetDeviceID();
+  vkGPU.profiling = VkGlobalConfiguration::GetProfiling();
+
+  const VkFFTResult resFFT{ m_VkCommon.Run(vkGPU, vkParameters) };
+  if (resFFT != VKFFT_SUCCESS)
+  {
+    std::ostringstream mesg;
+    mesg << "VkFFT third-party library failed with error code " << resFFT << ".";
+    itkAssertOrThrowMacro(false, mesg.str());
+  }
+
+  // The requested region is the largest possible region, whose buffer is laid out as the correlation
+  std::copy_n(correlation.cbegin(), outputPixels, output->GetBufferPointer());
+  m_MaximumNumberOfOverlappingPixels = static_cast<SizeValueType>(correlation[outputPixels]);
+}
+
+template <typename TInputImage, typename TOutputImage, typename TMaskImage>
+void
+VkMaskedFFTNormalizedCorrelationImageFilter<TInputImage, TOutputImage, TMaskImage>::PrintSelf(std::ostream & os,
+                                                                                              Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+  os << indent << "RequiredNumberOfOverlappingPixels: " << m_RequiredNumberOfOverlappingPixels << std::endl;
+  os << indent << "RequiredFractionOfOverlappingPixels: " << m_RequiredFractionOfOverlappingPixels << std::endl;
+  os << indent << "MaximumNumberOfOverlappingPixels: " << m_MaximumNumberOfOverlappingPixels << std::endl;
+  os << indent << "UseVkGlobalConfiguration: " << m_UseVkGlobalConfiguration << std::endl;
+  os << indent << "Local DeviceID: " << m_DeviceID << std::endl;
+  os << indent << "Global DeviceID: " << VkGlobalConfiguration::GetDeviceID() << std::endl;
+  os << indent << "Preferred DeviceID: " << this->GetDeviceID() << std::endl;
+}
+
+} // end namespace itk
+
+#endif // itkVkMaskedFFTNormalizedCorrelationImageFilter_hxx
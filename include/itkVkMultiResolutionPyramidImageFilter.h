@@ -22,6 +22,10 @@
 
 #include "itkDiscreteGaussianImageFilter.h"
 #include "itkFFTDiscreteGaussianImageFilter.h"
+#include "itkHalfHermitianToRealInverseFFTImageFilter.h"
+#include "itkRealToHalfHermitianForwardFFTImageFilter.h"
+#include "itkVkBlurringCostModel.h"
+#include "itkVkGaussianTransferFunction.h"
 #include "itkVector.h"
 #include "itkMacro.h"
 #include "VkFFTBackendExport.h"
@@ -58,6 +62,26 @@ namespace itk
  * VkMultiResolutionPyramidImageFilter has been observed to run in
  * as little as 50% of the time of its base class.
  *
+ * When UseSharedSpectrum is enabled the input is padded and transformed
+ * only once for all levels selected for FFT smoothing. Each of those
+ * levels then multiplies the shared spectrum by the frequency response
+ * of its Gaussian kernel and runs a single inverse transform, rather than
+ * repeating the forward transform of the full resolution input.
+ * With UseSpectralDownsampling also enabled, those levels are decimated in
+ * the frequency domain: the filtered spectrum is folded to the level size
+ * and inverse transformed at the reduced size, so neither a full resolution
+ * inverse transform nor a shrink pass is run.
+ *
+ * When UseConcurrentLevels is enabled, levels selected for FFT smoothing are
+ * generated on a worker thread that submits them to the device while levels
+ * selected for spatial smoothing are generated on the calling thread, so
+ * that CPU and GPU work overlap.
+ *
+ * When UseCascadedLevels is enabled and the schedule allows it, only the
+ * finest level is smoothed from the input. Each coarser level is smoothed
+ * from the next finer level with the difference of their variances, so
+ * that both kernel and image sizes shrink from level to level.
+ *
  * See documentation of MultiResolutionPyramidImageFilter
  * for information on how to specify a multi-resolution schedule.
  *
@@ -102,6 +126,8 @@ public:
   using InputSizeType = typename InputImageType::SizeType;
   using OutputPixelType = typename OutputImageType::PixelType;
   using OutputSizeType = typename OutputImageType::SizeType;
+  using OutputRegionType = typename OutputImageType::RegionType;
+  using SizeValueType = typename OutputSizeType::SizeValueType;
   using typename Superclass::ScheduleType;
 
   using VarianceType = itk::Vector<double, ImageDimension>;
@@ -112,6 +138,14 @@ public:
   using BaseSmootherType = DiscreteGaussianImageFilter<OutputImageType, OutputImageType>;
   using SpatialSmootherType = DiscreteGaussianImageFilter<OutputImageType, OutputImageType>;
   using FFTSmootherType = FFTDiscreteGaussianImageFilter<OutputImageType, OutputImageType>;
+  using CostModelType = VkBlurringCostModel<OutputImageType>;
+
+  /** Types for smoothing from a shared spectrum. */
+  using ForwardFFTType = RealToHalfHermitianForwardFFTImageFilter<OutputImageType>;
+  using SpectrumImageType = typename ForwardFFTType::OutputImageType;
+  using SpectrumImagePointer = typename SpectrumImageType::Pointer;
+  using InverseFFTType = HalfHermitianToRealInverseFFTImageFilter<SpectrumImageType, OutputImageType>;
+  using TransferFunctionType = VkGaussianTransferFunction<OutputImageType>;
 
   /** Set the metric threshold to decide between
    *  accelerated methods such as CPU-based separable smoothing
@@ -155,10 +189,74 @@ public:
     this->SetMetricThreshold(ComputeMetricValue(inputSize, kernelRadius));
   }
 
+  /** Optional model estimating spatial and FFT smoothing runtimes
+   *  for each pyramid level. When set, takes precedence over the
+   *  metric threshold.
+   *
+   * \sa VkBlurringCostModel
+   */
+  itkSetObjectMacro(CostModel, CostModelType);
+  itkGetModifiableObjectMacro(CostModel, CostModelType);
+
+  /** Transform the input once and smooth each FFT level by multiplying
+   *  the shared spectrum with the level's Gaussian frequency response.
+   *  Levels selected for spatial smoothing are unaffected. Off by default. */
+  itkSetMacro(UseSharedSpectrum, bool);
+  itkGetConstMacro(UseSharedSpectrum, bool);
+  itkBooleanMacro(UseSharedSpectrum);
+
+  /** Fuse smoothing and shrinking of levels that are smoothed from the
+   *  shared spectrum by decimating in the frequency domain, then inverse
+   *  transforming at the level size. Sample positions follow the shrink or
+   *  resample filter selected by UseShrinkImageFilter; with resampling,
+   *  samples between input pixels are interpolated spectrally rather than
+   *  linearly. Has an effect only when UseSharedSpectrum is enabled and the
+   *  shrink factors have no prime factor greater than the FFT backend
+   *  supports. Off by default. */
+  itkSetMacro(UseSpectralDownsampling, bool);
+  itkGetConstMacro(UseSpectralDownsampling, bool);
+  itkBooleanMacro(UseSpectralDownsampling);
+
+  /** Generate FFT-smoothed and spatially smoothed levels concurrently.
+   *  Each level uses its own smoothing and shrinking filters. FFT levels
+   *  are submitted to the device in order from one worker thread while
+   *  spatial levels run on the calling thread, as the device runs them
+   *  one after the other anyway and a worker per level would set up a
+   *  device context and plan per level. Progress is reported as each
+   *  level finishes. Off by default. */
+  itkSetMacro(UseConcurrentLevels, bool);
+  itkGetConstMacro(UseConcurrentLevels, bool);
+  itkBooleanMacro(UseConcurrentLevels);
+
+  /** Derive each level from the next finer level rather than from the
+   *  input. The finer level is smoothed with the incremental variance
+   *  (v_i - v_{i+1}) / f_{i+1}^2 in its own pixels and shrunk by
+   *  f_i / f_{i+1}. Since the finer level is already sampled, results
+   *  approximate rather than reproduce the non-cascaded levels.
+   *  Requires a schedule that IsScheduleCascadable and takes precedence
+   *  over UseSharedSpectrum and UseConcurrentLevels. Off by default. */
+  itkSetMacro(UseCascadedLevels, bool);
+  itkGetConstMacro(UseCascadedLevels, bool);
+  itkBooleanMacro(UseCascadedLevels);
+
+  /** Whether shrink factors do not decrease from each level to the next
+   *  coarser level and, when UseShrinkImageFilter is enabled, divide
+   *  evenly, as required for cascaded smoothing. */
+  bool
+  IsScheduleCascadable() const;
+
   /** Compute the metric value for a given set of inputs */
   float
   ComputeMetricValue(const InputSizeType & inputSize, const KernelSizeType & kernelRadius) const;
 
+  /** Maximum kernel width of the smoothing filters, which keep the
+   *  DiscreteGaussianImageFilter default. */
+  static unsigned int
+  GetSmootherMaximumKernelWidth()
+  {
+    return BaseSmootherType::New()->GetMaximumKernelWidth();
+  }
+
   /** Estimate the kernel radius from ilevel settings */
   KernelSizeType
   GetKernelRadius(unsigned int ilevel) const;
@@ -173,6 +271,11 @@ public:
   bool
   GetUseFFT(const KernelSizeType & kernelRadius) const;
 
+  /** Get whether FFT smoothing will be used for a
+   *  region of the given size */
+  bool
+  GetUseFFT(const InputSizeType & requestedSize, const KernelSizeType & kernelRadius) const;
+
 protected:
   VkMultiResolutionPyramidImageFilter() = default;
   ~VkMultiResolutionPyramidImageFilter() override = default;
@@ -181,13 +284,67 @@ protected:
   void
   GenerateData() override;
 
+  /** Smooth and shrink `image` for one level with filters private to the
+   *  level, so that it may run concurrently with other levels. Levels
+   *  smoothed from the shared spectrum must not run concurrently with
+   *  each other. GenerateData makes every level that is not cascaded
+   *  with it, whether levels run one after the other or concurrently. */
+  OutputImagePointer
+  GenerateLevel(unsigned int              ilevel,
+                const OutputImageType *   image,
+                bool                      useFFT,
+                const SpectrumImageType * spectrum,
+                const OutputRegionType &  paddedRegion,
+                bool                      useSpectralDownsampling);
+
+  /** Generate the finest level from `image`, then each coarser
+   *  level from the next finer level. */
+  void
+  GenerateCascadedLevels(const OutputImageType * image);
+
+  /** Record the spatial or FFT smoothing decision for a level with VkTracer. */
+  void
+  TraceBlurringDecision(unsigned int ilevel, bool useFFT) const;
+
+  /** Pad the image by at least `padRadius` and to a fast transform size
+   *  that is a multiple of `sizeMultiple`, then compute its forward
+   *  transform. The padded region is returned in `paddedRegion`. */
+  SpectrumImagePointer
+  ComputeSharedSpectrum(const OutputImageType * image,
+                        const KernelSizeType &  padRadius,
+                        const OutputSizeType &  sizeMultiple,
+                        OutputRegionType &      paddedRegion);
+
+  /** Smooth `image` for the given level by filtering its shared spectrum
+   *  and returning the inverse transform cropped to the image region. */
+  OutputImagePointer
+  SmoothFromSharedSpectrum(const SpectrumImageType * spectrum,
+                           const OutputRegionType &  paddedRegion,
+                           const OutputImageType *   image,
+                           unsigned int              ilevel);
+
+  /** Smooth and shrink `image` for the given level by filtering and
+   *  decimating its shared spectrum, writing the result to the buffered
+   *  region of `levelImage`. */
+  void
+  DownsampleFromSharedSpectrum(const SpectrumImageType * spectrum,
+                               const OutputRegionType &  paddedRegion,
+                               const OutputImageType *   image,
+                               unsigned int              ilevel,
+                               OutputImageType *         levelImage);
+
   void
   PrintSelf(std::ostream & os, Indent indent) const override;
 
 private:
-  float                                 m_MetricThreshold = 8.0f;
-  typename SpatialSmootherType::Pointer spatialSmoother = SpatialSmootherType::New();
-  typename FFTSmootherType::Pointer     fftSmoother = FFTSmootherType::New();
+  float                            m_MetricThreshold = 8.0f;
+  bool                             m_UseSharedSpectrum = false;
+  bool                             m_UseSpectralDownsampling = false;
+  bool                             m_UseConcurrentLevels = false;
+  bool                             m_UseCascadedLevels = false;
+  typename CostModelType::Pointer  m_CostModel{ nullptr };
+  SpectrumImagePointer             m_LevelSpectrum{ nullptr };
+  typename InverseFFTType::Pointer m_InverseFFT{ nullptr };
 };
 } // namespace itk
 
@@ -21,115 +21,535 @@
 #include "itkCastImageFilter.h"
 #include "itkDiscreteGaussianImageFilter.h"
 #include "itkGaussianOperator.h"
+#include "itkImageAlgorithm.h"
+#include "itkImageRegionIteratorWithIndex.h"
 #include "itkMacro.h"
+#include "itkMultiThreaderBase.h"
 #include "itkResampleImageFilter.h"
 #include "itkShrinkImageFilter.h"
 #include "itkIdentityTransform.h"
 #include "itkVkBlurringPerformanceMetric.h"
+#include "itkVkCommon.h"
+#include "itkVkGlobalConfiguration.h"
+#include "itkVkTracer.h"
+#include "itkZeroFluxNeumannPadImageFilter.h"
 #include "itkMath.h"
 
+#include <algorithm>
+#include <complex>
+#include <future>
+#include <numeric>
+#include <sstream>
+#include <vector>
+
 namespace itk
 {
 template <typename TInputImage, typename TOutputImage>
 void
 VkMultiResolutionPyramidImageFilter<TInputImage, TOutputImage>::GenerateData()
 {
+  // Reserve one device for the run and pin it, so that the internal Vk FFT
+  // filters, which count their own bytes, and the trace events share it
+  const VkDeviceReservation reservation{ true, 0, 0 };
+  const uint64_t            deviceID{ reservation.GetDeviceID() };
+  const VkDevicePin         devicePin{ deviceID };
+  const VkTraceScope        traceScope{ this->GetNameOfClass(), "GenerateData", deviceID };
+
   // Mostly reimplements MultiResolutionPyramidImageFilter::GenerateData
 
   // Get the input and output pointers
   InputImageConstPointer inputPtr = this->GetInput();
 
-  // Create caster, smoother and resampleShrinker filters
+  // Create the caster; the filters of each level are created by GenerateLevel
   using CasterType = CastImageFilter<TInputImage, TOutputImage>;
+  auto caster = CasterType::New();
+  caster->SetInput(inputPtr);
+
+  unsigned int ilevel, idim;
+  VarianceType variance;
+
+  // Release the level buffers held for reuse across levels however this
+  // method exits, including by an exception from a level
+  struct LevelBuffersReleaser
+  {
+    Self * filter;
+
+    ~LevelBuffersReleaser()
+    {
+      filter->m_LevelSpectrum = nullptr;
+      filter->m_InverseFFT = nullptr;
+    }
+  };
+  const LevelBuffersReleaser levelBuffersReleaser{ this };
+
+  if (m_UseCascadedLevels)
+  {
+    if (this->IsScheduleCascadable())
+    {
+      caster->Update();
+      this->GenerateCascadedLevels(caster->GetOutput());
+      return;
+    }
+    itkWarningMacro("Schedule does not allow cascaded smoothing. Generating each level from the input.");
+  }
+
+  // Transform the input once for all levels selected for FFT smoothing,
+  // padding by the largest kernel radius among those levels. For spectral
+  // downsampling each padded size must also be a multiple of the shrink
+  // factors of those levels.
+  SpectrumImagePointer spectrum;
+  OutputRegionType     paddedRegion;
+  OutputSizeType       sizeMultiple;
+  sizeMultiple.Fill(1);
+  bool useSpectralDownsampling = false;
+  if (m_UseSharedSpectrum)
+  {
+    KernelSizeType padRadius;
+    padRadius.Fill(0);
+    bool anyFFTLevel = false;
+    for (ilevel = 0; ilevel < this->m_NumberOfLevels; ++ilevel)
+    {
+      if (!GetUseFFT(this->GetKernelRadius(ilevel)))
+      {
+        continue;
+      }
+      anyFFTLevel = true;
+      variance = this->GetVariance(ilevel);
+      for (idim = 0; idim < ImageDimension; ++idim)
+      {
+        padRadius[idim] = std::max<typename KernelSizeType::SizeValueType>(
+          padRadius[idim],
+          TransferFunctionType::GetKernelRadius(
+            variance[idim], this->m_MaximumError, GetSmootherMaximumKernelWidth()));
+        sizeMultiple[idim] = std::lcm(sizeMultiple[idim], static_cast<SizeValueType>(this->m_Schedule[ilevel][idim]));
+      }
+    }
+
+    // Padded sizes must remain supported by the FFT backend
+    const SizeValueType greatestPrimeFactor = ForwardFFTType::New()->GetSizeGreatestPrimeFactor();
+    useSpectralDownsampling = m_UseSpectralDownsampling;
+    for (idim = 0; idim < ImageDimension; ++idim)
+    {
+      useSpectralDownsampling =
+        useSpectralDownsampling && VkCommon::GetLargestPrimeFactor(sizeMultiple[idim]) <= greatestPrimeFactor;
+    }
+    if (!useSpectralDownsampling)
+    {
+      sizeMultiple.Fill(1);
+    }
+
+    if (anyFFTLevel)
+    {
+      caster->Update();
+      spectrum = this->ComputeSharedSpectrum(caster->GetOutput(), padRadius, sizeMultiple, paddedRegion);
+    }
+  }
+
+  // Levels only read the cast input, so bring it up to date once before
+  // any level runs, possibly on another thread
+  caster->Update();
+  const OutputImageType * image = caster->GetOutput();
+
+  if (m_UseConcurrentLevels)
+  {
+    std::vector<bool> useFFT(this->m_NumberOfLevels);
+    for (ilevel = 0; ilevel < this->m_NumberOfLevels; ++ilevel)
+    {
+      useFFT[ilevel] = GetUseFFT(this->GetKernelRadius(ilevel));
+      this->TraceBlurringDecision(ilevel, useFFT[ilevel]);
+    }
+
+    // FFT levels are submitted to the device in order from a single worker
+    // thread while spatial levels run on the calling thread, where they are
+    // parallelized over the ITK thread pool. One worker rather than one per
+    // level: the device runs the transforms of a queue one after the other,
+    // and further workers would each set up a device context and plan,
+    // while levels on one worker reuse the level spectrum and inverse FFT.
+    // Each finished level reports its share of the progress, which ITK
+    // forwards to observers from the calling thread only.
+    const float                     levelProgress = 1.0f / static_cast<float>(this->m_NumberOfLevels);
+    std::vector<OutputImagePointer> levels(this->m_NumberOfLevels);
+    auto                            fftLevels = std::async(std::launch::async, [&]() {
+      const VkDevicePin workerDevicePin{ deviceID };
+      for (unsigned int fftLevel = 0; fftLevel < this->m_NumberOfLevels; ++fftLevel)
+      {
+        if (useFFT[fftLevel])
+        {
+          levels[fftLevel] =
+            this->GenerateLevel(fftLevel, image, true, spectrum, paddedRegion, useSpectralDownsampling);
+          this->IncrementProgress(levelProgress);
+        }
+      }
+    });
+    for (ilevel = 0; ilevel < this->m_NumberOfLevels; ++ilevel)
+    {
+      if (!useFFT[ilevel])
+      {
+        levels[ilevel] = this->GenerateLevel(ilevel, image, false, spectrum, paddedRegion, useSpectralDownsampling);
+        this->IncrementProgress(levelProgress);
+      }
+    }
+    fftLevels.get();
+
+    for (ilevel = 0; ilevel < this->m_NumberOfLevels; ++ilevel)
+    {
+      this->GraftNthOutput(ilevel, levels[ilevel]);
+    }
+    return;
+  }
 
-  using ImageToImageType = ImageToImageFilter<TOutputImage, TOutputImage>;
+  // Otherwise generate the levels one after the other on the calling thread
+  for (ilevel = 0; ilevel < this->m_NumberOfLevels; ++ilevel)
+  {
+    this->UpdateProgress(static_cast<float>(ilevel) / static_cast<float>(this->m_NumberOfLevels));
+
+    // select spatial or FFT smoothing based on user threshold settings
+    // to maximize anticipated performance
+    const bool useFFT = GetUseFFT(this->GetKernelRadius(ilevel));
+    this->TraceBlurringDecision(ilevel, useFFT);
+    this->GraftNthOutput(ilevel,
+                         this->GenerateLevel(ilevel, image, useFFT, spectrum, paddedRegion, useSpectralDownsampling));
+  }
+}
+
+template <typename TInputImage, typename TOutputImage>
+auto
+VkMultiResolutionPyramidImageFilter<TInputImage, TOutputImage>::GenerateLevel(
+  unsigned int              ilevel,
+  const OutputImageType *   image,
+  bool                      useFFT,
+  const SpectrumImageType * spectrum,
+  const OutputRegionType &  paddedRegion,
+  bool                      useSpectralDownsampling) -> OutputImagePointer
+{
   using ResampleShrinkerType = ResampleImageFilter<TOutputImage, TOutputImage>;
   using ShrinkerType = ShrinkImageFilter<TOutputImage, TOutputImage>;
 
-  auto                               caster = CasterType::New();
-  typename BaseSmootherType::Pointer smoother;
+  // Filters are private to this level so that levels may run concurrently.
+  // The input is grafted so that updating a level never updates the source
+  // of the shared cast image.
+  OutputImagePointer levelInput = OutputImageType::New();
+  levelInput->Graft(image);
 
-  typename ImageToImageType::Pointer shrinkerFilter;
-  //
-  // only one of these pointers is going to be valid, depending on the
-  // value of UseShrinkImageFilter flag
-  typename ResampleShrinkerType::Pointer resampleShrinker;
-  typename ShrinkerType::Pointer         shrinker;
+  const OutputImageType * outputPtr = this->GetOutput(ilevel);
 
+  typename ShrinkerType::Pointer         shrinker;
+  typename ResampleShrinkerType::Pointer resampleShrinker;
   if (this->GetUseShrinkImageFilter())
   {
     shrinker = ShrinkerType::New();
-    shrinkerFilter = shrinker.GetPointer();
+    unsigned int factors[ImageDimension];
+    for (unsigned int dim = 0; dim < ImageDimension; ++dim)
+    {
+      factors[dim] = this->m_Schedule[ilevel][dim];
+    }
+    shrinker->SetShrinkFactors(factors);
   }
   else
   {
     resampleShrinker = ResampleShrinkerType::New();
     using LinearInterpolatorType = itk::LinearInterpolateImageFunction<OutputImageType, double>;
-    auto interpolator = LinearInterpolatorType::New();
-    resampleShrinker->SetInterpolator(interpolator);
+    using IdentityTransformType = itk::IdentityTransform<double, OutputImageType::ImageDimension>;
+    resampleShrinker->SetInterpolator(LinearInterpolatorType::New());
     resampleShrinker->SetDefaultPixelValue(0);
+    resampleShrinker->SetOutputParametersFromImage(outputPtr);
+    resampleShrinker->SetTransform(IdentityTransformType::New());
+  }
+
+  if (useFFT && spectrum && useSpectralDownsampling)
+  {
+    OutputImagePointer levelImage = OutputImageType::New();
+    if (shrinker)
+    {
+      shrinker->SetInput(levelInput);
+      shrinker->UpdateOutputInformation();
+      levelImage->CopyInformation(shrinker->GetOutput());
+      levelImage->SetRegions(shrinker->GetOutput()->GetLargestPossibleRegion());
+    }
+    else
+    {
+      levelImage->CopyInformation(outputPtr);
+      levelImage->SetRegions(outputPtr->GetRequestedRegion());
+    }
+    levelImage->Allocate();
+    this->DownsampleFromSharedSpectrum(spectrum, paddedRegion, levelInput, ilevel, levelImage);
+    return levelImage;
+  }
+
+  OutputImagePointer smoothed;
+  if (useFFT && spectrum)
+  {
+    smoothed = this->SmoothFromSharedSpectrum(spectrum, paddedRegion, levelInput, ilevel);
+  }
+  else
+  {
+    typename BaseSmootherType::Pointer smoother;
+    if (useFFT)
+    {
+      smoother = FFTSmootherType::New();
+    }
+    else
+    {
+      smoother = SpatialSmootherType::New();
+    }
+    smoother->SetUseImageSpacing(false);
+    smoother->SetInput(levelInput);
+    smoother->SetMaximumError(this->m_MaximumError);
+    smoother->SetVariance(this->GetVariance(ilevel));
+    smoother->Update();
+    smoothed = smoother->GetOutput();
+    smoothed->DisconnectPipeline();
+  }
+
+  typename ImageToImageFilter<TOutputImage, TOutputImage>::Pointer shrinkerFilter;
+  if (shrinker)
+  {
+    shrinkerFilter = shrinker.GetPointer();
+  }
+  else
+  {
     shrinkerFilter = resampleShrinker.GetPointer();
   }
-  // Setup the filters
-  caster->SetInput(inputPtr);
+  shrinkerFilter->SetInput(smoothed);
+  shrinkerFilter->UpdateLargestPossibleRegion();
+  OutputImagePointer levelImage = shrinkerFilter->GetOutput();
+  levelImage->DisconnectPipeline();
+  return levelImage;
+}
 
-  unsigned int ilevel, idim;
-  unsigned int factors[ImageDimension];
-  VarianceType variance;
+template <typename TInputImage, typename TOutputImage>
+bool
+VkMultiResolutionPyramidImageFilter<TInputImage, TOutputImage>::IsScheduleCascadable() const
+{
+  // Each level must be at least as coarse as the next finer level and,
+  // when shrinking by whole pixels, coarser by an integer factor
+  for (unsigned int ilevel = 0; ilevel + 1 < this->m_NumberOfLevels; ++ilevel)
+  {
+    for (unsigned int dim = 0; dim < ImageDimension; ++dim)
+    {
+      const unsigned int factor = this->m_Schedule[ilevel][dim];
+      const unsigned int finerFactor = this->m_Schedule[ilevel + 1][dim];
+      if (finerFactor == 0 || factor < finerFactor ||
+          (this->GetUseShrinkImageFilter() && factor % finerFactor != 0))
+      {
+        return false;
+      }
+    }
+  }
+  return true;
+}
 
-  for (ilevel = 0; ilevel < this->m_NumberOfLevels; ++ilevel)
+template <typename TInputImage, typename TOutputImage>
+void
+VkMultiResolutionPyramidImageFilter<TInputImage, TOutputImage>::GenerateCascadedLevels(const OutputImageType * image)
+{
+  using ResampleShrinkerType = ResampleImageFilter<TOutputImage, TOutputImage>;
+  using ShrinkerType = ShrinkImageFilter<TOutputImage, TOutputImage>;
+
+  // The finest level is generated from the input as usual
+  const unsigned int finestLevel = this->m_NumberOfLevels - 1;
+  const bool         useFFT = GetUseFFT(this->GetKernelRadius(finestLevel));
+  this->TraceBlurringDecision(finestLevel, useFFT);
+  OutputImagePointer finerImage = this->GenerateLevel(finestLevel, image, useFFT, nullptr, OutputRegionType(), false);
+  this->GraftNthOutput(finestLevel, finerImage);
+
+  // Each coarser level smooths the next finer level by the difference of
+  // the level variances, expressed in pixels of the finer level, and
+  // shrinks it by the ratio of the shrink factors
+  for (int ilevel = static_cast<int>(finestLevel) - 1; ilevel >= 0; --ilevel)
   {
-    this->UpdateProgress(static_cast<float>(ilevel) / static_cast<float>(this->m_NumberOfLevels));
+    this->UpdateProgress(static_cast<float>(finestLevel - ilevel) / static_cast<float>(this->m_NumberOfLevels));
 
-    // Allocate memory for each output
-    OutputImagePointer outputPtr = this->GetOutput(ilevel);
-    outputPtr->SetBufferedRegion(outputPtr->GetRequestedRegion());
-    outputPtr->Allocate();
+    const VarianceType variance = this->GetVariance(ilevel);
+    const VarianceType finerVariance = this->GetVariance(ilevel + 1);
+    VarianceType       incrementalVariance;
+    KernelSizeType     incrementalRadius;
+    bool               useSmoothing = false;
+    for (unsigned int dim = 0; dim < ImageDimension; ++dim)
+    {
+      const double finerFactor = this->m_Schedule[ilevel + 1][dim];
+      incrementalVariance[dim] = (variance[dim] - finerVariance[dim]) / itk::Math::sqr(finerFactor);
+      incrementalRadius[dim] = TransferFunctionType::GetKernelRadius(
+        incrementalVariance[dim], this->m_MaximumError, GetSmootherMaximumKernelWidth());
+      useSmoothing = useSmoothing || incrementalVariance[dim] > 0.0;
+    }
 
-    // compute shrink factors
-    for (idim = 0; idim < ImageDimension; ++idim)
+    OutputImagePointer smoothed = finerImage;
+    if (useSmoothing)
     {
-      factors[idim] = this->m_Schedule[ilevel][idim];
+      typename BaseSmootherType::Pointer smoother;
+      const bool useIncrementalFFT = GetUseFFT(finerImage->GetBufferedRegion().GetSize(), incrementalRadius);
+      this->TraceBlurringDecision(ilevel, useIncrementalFFT);
+      if (useIncrementalFFT)
+      {
+        smoother = FFTSmootherType::New();
+      }
+      else
+      {
+        smoother = SpatialSmootherType::New();
+      }
+      smoother->SetUseImageSpacing(false);
+      smoother->SetInput(finerImage);
+      smoother->SetMaximumError(this->m_MaximumError);
+      smoother->SetVariance(incrementalVariance);
+      smoother->Update();
+      smoothed = smoother->GetOutput();
+      smoothed->DisconnectPipeline();
     }
 
-    if (!this->GetUseShrinkImageFilter())
+    typename ImageToImageFilter<TOutputImage, TOutputImage>::Pointer shrinkerFilter;
+    if (this->GetUseShrinkImageFilter())
     {
-      using IdentityTransformType = itk::IdentityTransform<double, OutputImageType::ImageDimension>;
-      auto identityTransform = IdentityTransformType::New();
-      resampleShrinker->SetOutputParametersFromImage(outputPtr);
-      resampleShrinker->SetTransform(identityTransform);
+      auto         shrinker = ShrinkerType::New();
+      unsigned int factors[ImageDimension];
+      for (unsigned int dim = 0; dim < ImageDimension; ++dim)
+      {
+        factors[dim] = this->m_Schedule[ilevel][dim] / this->m_Schedule[ilevel + 1][dim];
+      }
+      shrinker->SetShrinkFactors(factors);
+      shrinkerFilter = shrinker.GetPointer();
     }
     else
     {
-      shrinker->SetShrinkFactors(factors);
+      // Resample onto the level grid computed from the input
+      auto resampleShrinker = ResampleShrinkerType::New();
+      using LinearInterpolatorType = itk::LinearInterpolateImageFunction<OutputImageType, double>;
+      using IdentityTransformType = itk::IdentityTransform<double, OutputImageType::ImageDimension>;
+      resampleShrinker->SetInterpolator(LinearInterpolatorType::New());
+      resampleShrinker->SetDefaultPixelValue(0);
+      resampleShrinker->SetOutputParametersFromImage(this->GetOutput(ilevel));
+      resampleShrinker->SetTransform(IdentityTransformType::New());
+      shrinkerFilter = resampleShrinker.GetPointer();
     }
+    shrinkerFilter->SetInput(smoothed);
+    shrinkerFilter->UpdateLargestPossibleRegion();
 
-    // select spatial or FFT smoothing based on user threshold settings
-    // to maximize anticipated performance
-    if (GetUseFFT(this->GetKernelRadius(ilevel)))
+    finerImage = shrinkerFilter->GetOutput();
+    finerImage->DisconnectPipeline();
+    this->GraftNthOutput(ilevel, finerImage);
+  }
+}
+
+template <typename TInputImage, typename TOutputImage>
+auto
+VkMultiResolutionPyramidImageFilter<TInputImage, TOutputImage>::ComputeSharedSpectrum(
+  const OutputImageType * image,
+  const KernelSizeType &  padRadius,
+  const OutputSizeType &  sizeMultiple,
+  OutputRegionType &      paddedRegion) -> SpectrumImagePointer
+{
+  auto forwardFFT = ForwardFFTType::New();
+
+  // Pad to the fastest VkFFT size when the backend supports all VkFFT
+  // radices, otherwise to the sizes the selected FFT backend supports
+  const SizeValueType           greatestPrimeFactor = forwardFFT->GetSizeGreatestPrimeFactor();
+  const bool                    useVkFFTSizes = greatestPrimeFactor >= VkCommon::GetGreatestPrimeFactor();
+  const VkCommon::PrecisionEnum precision = sizeof(typename NumericTraits<OutputPixelType>::ValueType) >= 8
+                                              ? VkCommon::PrecisionEnum::DOUBLE
+                                              : VkCommon::PrecisionEnum::FLOAT;
+
+  const OutputSizeType & imageSize = image->GetBufferedRegion().GetSize();
+  OutputSizeType         lowerPad;
+  OutputSizeType         upperPad;
+  for (unsigned int dim = 0; dim < ImageDimension; ++dim)
+  {
+    // Choose the number of multiples of `sizeMultiple` so that
+    // the padded size holds the image and the kernel radius
+    const SizeValueType minimumSize = imageSize[dim] + 2 * padRadius[dim];
+    SizeValueType       count = (minimumSize + sizeMultiple[dim] - 1) / sizeMultiple[dim];
+    if (useVkFFTSizes)
     {
-      smoother = static_cast<BaseSmootherType *>(fftSmoother);
+      count = VkCommon::GetOptimalFFTSize(
+        count, precision, dim == 0 ? VkCommon::FFTEnum::R2HalfH : VkCommon::FFTEnum::C2C);
     }
     else
     {
-      smoother = static_cast<BaseSmootherType *>(spatialSmoother);
+      while (VkCommon::GetLargestPrimeFactor(count) > greatestPrimeFactor)
+      {
+        ++count;
+      }
     }
+    const SizeValueType extra = count * sizeMultiple[dim] - minimumSize;
+    lowerPad[dim] = padRadius[dim] + extra / 2;
+    upperPad[dim] = padRadius[dim] + extra - extra / 2;
+  }
 
-    // Set up smoothing filter
-    smoother->SetUseImageSpacing(false);
-    smoother->SetInput(caster->GetOutput());
-    smoother->SetMaximumError(this->m_MaximumError);
-    variance = this->GetVariance(ilevel);
-    smoother->SetVariance(variance);
-    shrinkerFilter->SetInput(smoother->GetOutput());
+  // Pad with the same boundary condition as
+  // FFTDiscreteGaussianImageFilter so that results match
+  using BoundaryPadType = ZeroFluxNeumannPadImageFilter<OutputImageType, OutputImageType>;
+  auto boundaryPad = BoundaryPadType::New();
+  boundaryPad->SetInput(image);
+  boundaryPad->SetPadLowerBound(lowerPad);
+  boundaryPad->SetPadUpperBound(upperPad);
 
-    shrinkerFilter->GraftOutput(outputPtr);
+  forwardFFT->SetInput(boundaryPad->GetOutput());
+  forwardFFT->Update();
 
-    // force to always update in case shrink factors are the same
-    shrinkerFilter->Modified();
-    shrinkerFilter->UpdateLargestPossibleRegion();
-    this->GraftNthOutput(ilevel, shrinkerFilter->GetOutput());
+  paddedRegion = boundaryPad->GetOutput()->GetLargestPossibleRegion();
+
+  SpectrumImagePointer spectrum = forwardFFT->GetOutput();
+  spectrum->DisconnectPipeline();
+  return spectrum;
+}
+
+template <typename TInputImage, typename TOutputImage>
+auto
+VkMultiResolutionPyramidImageFilter<TInputImage, TOutputImage>::SmoothFromSharedSpectrum(
+  const SpectrumImageType * spectrum,
+  const OutputRegionType &  paddedRegion,
+  const OutputImageType *   image,
+  unsigned int              ilevel) -> OutputImagePointer
+{
+  // Tabulate the separable frequency response of the level's Gaussian kernel
+  const VarianceType                                           variance = this->GetVariance(ilevel);
+  const auto &                                                 spectrumSize = spectrum->GetBufferedRegion().GetSize();
+  typename TransferFunctionType::SeparableTransferFunctionType transferFunction;
+  for (unsigned int dim = 0; dim < ImageDimension; ++dim)
+  {
+    transferFunction[dim] = TransferFunctionType::Compute1D(variance[dim],
+                                                            this->m_MaximumError,
+                                                            GetSmootherMaximumKernelWidth(),
+                                                            paddedRegion.GetSize()[dim],
+                                                            spectrumSize[dim]);
+  }
+
+  if (!m_LevelSpectrum)
+  {
+    // Each level filters a copy of the shared spectrum into this buffer
+    m_LevelSpectrum = SpectrumImageType::New();
+    m_LevelSpectrum->CopyInformation(spectrum);
+    m_LevelSpectrum->SetRegions(spectrum->GetBufferedRegion());
+    m_LevelSpectrum->Allocate();
+
+    // A single inverse transform instance reuses its plan across levels
+    m_InverseFFT = InverseFFTType::New();
+    m_InverseFFT->SetActualXDimensionIsOdd(paddedRegion.GetSize()[0] % 2 == 1);
+    m_InverseFFT->SetInput(m_LevelSpectrum);
   }
+
+  TransferFunctionType::Apply(spectrum, m_LevelSpectrum.GetPointer(), transferFunction);
+  m_LevelSpectrum->Modified();
+  m_InverseFFT->Update();
+
+  // Crop the inverse transform to the unpadded image region. The inverse
+  // output region may be re-indexed by the FFT backend, so locate the
+  // image region relative to the start of the padded region.
+  const OutputImageType * blurred = m_InverseFFT->GetOutput();
+  const OutputRegionType  imageRegion = image->GetBufferedRegion();
+  OutputRegionType        blurredRegion = imageRegion;
+  for (unsigned int dim = 0; dim < ImageDimension; ++dim)
+  {
+    blurredRegion.SetIndex(dim,
+                           blurred->GetLargestPossibleRegion().GetIndex(dim) + imageRegion.GetIndex(dim) -
+                             paddedRegion.GetIndex(dim));
+  }
+
+  OutputImagePointer smoothed = OutputImageType::New();
+  smoothed->CopyInformation(image);
+  smoothed->SetRegions(imageRegion);
+  smoothed->Allocate();
+  ImageAlgorithm::Copy(blurred, smoothed.GetPointer(), blurredRegion, imageRegion);
+  return smoothed;
 }
 
 template <typename TInputImage, typename TOutputImage>
@@ -146,11 +566,44 @@ VkMultiResolutionPyramidImageFilter<TInputImage, TOutputImage>::ComputeMetricVal
   return VkBlurringPerformanceMetric<InputImageType, OutputImageType>::Compute(inputSize, kernelSize);
 }
 
+template <typename TInputImage, typename TOutputImage>
+void
+VkMultiResolutionPyramidImageFilter<TInputImage, TOutputImage>::TraceBlurringDecision(unsigned int ilevel,
+                                                                                      bool         useFFT) const
+{
+  if (!VkTracer::IsEnabled())
+  {
+    return;
+  }
+  // GenerateData pins its reserved device on every thread that generates levels
+  uint64_t deviceID{ 0 };
+  VkDevicePin::GetPinnedDevice(deviceID);
+  std::ostringstream args;
+  args << "\"level\":" << ilevel << ",\"useFFT\":" << (useFFT ? "true" : "false");
+  VkTracer::AddInstantEvent("BlurringDecision", this->GetNameOfClass(), deviceID, args.str());
+}
+
 template <typename TInputImage, typename TOutputImage>
 bool
 VkMultiResolutionPyramidImageFilter<TInputImage, TOutputImage>::GetUseFFT(const KernelSizeType & kernelRadius) const
 {
-  auto requestedSize = this->GetInput()->GetRequestedRegion().GetSize();
+  return this->GetUseFFT(this->GetInput()->GetRequestedRegion().GetSize(), kernelRadius);
+}
+
+template <typename TInputImage, typename TOutputImage>
+bool
+VkMultiResolutionPyramidImageFilter<TInputImage, TOutputImage>::GetUseFFT(const InputSizeType &  requestedSize,
+                                                                         const KernelSizeType & kernelRadius) const
+{
+  if (m_CostModel)
+  {
+    KernelSizeType kernelSize;
+    for (unsigned int dim = 0; dim < ImageDimension; ++dim)
+    {
+      kernelSize[dim] = kernelRadius[dim] * 2 + 1;
+    }
+    return m_CostModel->GetUseFFT(requestedSize, kernelSize);
+  }
   auto metricValue = this->ComputeMetricValue(requestedSize, kernelRadius);
   return metricValue > m_MetricThreshold;
 }
@@ -185,6 +638,141 @@ VkMultiResolutionPyramidImageFilter<TInputImage, TOutputImage>::GetVariance(unsi
   return variance;
 }
 
+template <typename TInputImage, typename TOutputImage>
+void
+VkMultiResolutionPyramidImageFilter<TInputImage, TOutputImage>::DownsampleFromSharedSpectrum(
+  const SpectrumImageType * spectrum,
+  const OutputRegionType &  paddedRegion,
+  const OutputImageType *   image,
+  unsigned int              ilevel,
+  OutputImageType *         levelImage)
+{
+  using ComplexType = std::complex<double>;
+  using SpectrumPixelType = typename SpectrumImageType::PixelType;
+  using SpectrumIndexType = typename SpectrumImageType::IndexType;
+
+  const OutputSizeType &   paddedSize = paddedRegion.GetSize();
+  const OutputRegionType & levelRegion = levelImage->GetBufferedRegion();
+  const VarianceType       variance = this->GetVariance(ilevel);
+
+  // Position of the first level sample in the padded image. ShrinkImageFilter
+  // takes the nearest input pixel while ResampleImageFilter interpolates, in
+  // which case the spectrum is evaluated between pixels.
+  typename OutputImageType::PointType firstPoint;
+  levelImage->TransformIndexToPhysicalPoint(levelRegion.GetIndex(), firstPoint);
+  auto firstSample = image->template TransformPhysicalPointToContinuousIndex<double>(firstPoint);
+  if (this->GetUseShrinkImageFilter())
+  {
+    const auto nearestIndex = image->TransformPhysicalPointToIndex(firstPoint);
+    for (unsigned int dim = 0; dim < ImageDimension; ++dim)
+    {
+      firstSample[dim] = nearestIndex[dim];
+    }
+  }
+
+  // Decimating by f samples every f-th value of the smoothed padded image,
+  // whose spectrum of length N / f is the sum of the f aliases of the full
+  // spectrum. Tabulate the Gaussian frequency response of each alias
+  // together with the phase ramp that shifts the first sample to the origin.
+  OutputSizeType           factors;
+  OutputSizeType           reducedSize;
+  std::vector<ComplexType> alias[ImageDimension];
+  double                   scale = 1.0;
+  for (unsigned int dim = 0; dim < ImageDimension; ++dim)
+  {
+    factors[dim] = this->m_Schedule[ilevel][dim];
+    reducedSize[dim] = paddedSize[dim] / factors[dim];
+    itkAssertOrThrowMacro(paddedSize[dim] % factors[dim] == 0 && levelRegion.GetSize(dim) <= reducedSize[dim],
+                          "Padded spectrum does not support spectral downsampling for this level");
+    scale /= factors[dim];
+
+    const double shift = firstSample[dim] - paddedRegion.GetIndex(dim);
+    const auto   transferFunction = TransferFunctionType::Compute1D(
+      variance[dim], this->m_MaximumError, GetSmootherMaximumKernelWidth(), paddedSize[dim], paddedSize[dim]);
+    alias[dim].resize(paddedSize[dim]);
+    for (SizeValueType k = 0; k < paddedSize[dim]; ++k)
+    {
+      // Signed frequency keeps fractional shifts consistent with a real signal
+      const double frequency = (2 * k <= paddedSize[dim]) ? static_cast<double>(k)
+                                                          : static_cast<double>(k) - paddedSize[dim];
+      alias[dim][k] = transferFunction[k] * std::polar(1.0, 2.0 * itk::Math::pi * frequency * shift / paddedSize[dim]);
+    }
+  }
+
+  typename SpectrumImageType::RegionType reducedRegion;
+  reducedRegion.SetSize(reducedSize);
+  reducedRegion.SetSize(0, reducedSize[0] / 2 + 1);
+  auto reducedSpectrum = SpectrumImageType::New();
+  reducedSpectrum->SetRegions(reducedRegion);
+  reducedSpectrum->Allocate();
+
+  // Each reduced frequency sums its aliases read straight from the buffer
+  // of the full spectrum, in parallel over chunks of the reduced spectrum
+  const SpectrumPixelType * const spectrumBuffer = spectrum->GetBufferPointer();
+  const OffsetValueType * const   offsetTable = spectrum->GetOffsetTable();
+  this->GetMultiThreader()->template ParallelizeImageRegion<ImageDimension>(
+    reducedRegion,
+    [&](const typename SpectrumImageType::RegionType & chunk) {
+      for (ImageRegionIteratorWithIndex<SpectrumImageType> it(reducedSpectrum, chunk); !it.IsAtEnd(); ++it)
+      {
+        const SpectrumIndexType q = it.GetIndex();
+        ComplexType             sum{ 0.0, 0.0 };
+        SizeValueType           aliasIndex[ImageDimension]{};
+        bool                    done = false;
+        while (!done)
+        {
+          // Full spectrum frequency of this alias and its filtered value
+          SizeValueType k[ImageDimension];
+          ComplexType   weight{ 1.0, 0.0 };
+          for (unsigned int dim = 0; dim < ImageDimension; ++dim)
+          {
+            k[dim] = q[dim] + aliasIndex[dim] * reducedSize[dim];
+            weight *= alias[dim][k[dim]];
+          }
+
+          // Frequencies past the stored half are the conjugate of their mirror
+          const bool      mirrored = 2 * k[0] > paddedSize[0];
+          OffsetValueType offset = 0;
+          for (unsigned int dim = 0; dim < ImageDimension; ++dim)
+          {
+            const SizeValueType storedK = mirrored ? (paddedSize[dim] - k[dim]) % paddedSize[dim] : k[dim];
+            offset += static_cast<OffsetValueType>(storedK) * offsetTable[dim];
+          }
+          const SpectrumPixelType stored = spectrumBuffer[offset];
+          const ComplexType       value{ stored.real(), mirrored ? -stored.imag() : stored.imag() };
+          sum += value * weight;
+
+          // Advance to the next alias
+          done = true;
+          for (unsigned int dim = 0; dim < ImageDimension && done; ++dim)
+          {
+            if (++aliasIndex[dim] < factors[dim])
+            {
+              done = false;
+            }
+            else
+            {
+              aliasIndex[dim] = 0;
+            }
+          }
+        }
+        sum *= scale;
+        it.Set(SpectrumPixelType(sum.real(), sum.imag()));
+      }
+    },
+    nullptr);
+
+  // Inverse transform at the reduced size and crop to the level region
+  auto inverseFFT = InverseFFTType::New();
+  inverseFFT->SetActualXDimensionIsOdd(reducedSize[0] % 2 == 1);
+  inverseFFT->SetInput(reducedSpectrum);
+  inverseFFT->Update();
+
+  const OutputImageType * reduced = inverseFFT->GetOutput();
+  OutputRegionType        reducedLevelRegion(reduced->GetLargestPossibleRegion().GetIndex(), levelRegion.GetSize());
+  ImageAlgorithm::Copy(reduced, levelImage, reducedLevelRegion, levelRegion);
+}
+
 /**
  * PrintSelf method
  */
@@ -195,6 +783,11 @@ VkMultiResolutionPyramidImageFilter<TInputImage, TOutputImage>::PrintSelf(std::o
   Superclass::PrintSelf(os, indent);
 
   os << indent << "Kernel/image size metric threshold: " << m_MetricThreshold << std::endl;
+  os << indent << "UseSharedSpectrum: " << m_UseSharedSpectrum << std::endl;
+  os << indent << "UseSpectralDownsampling: " << m_UseSpectralDownsampling << std::endl;
+  os << indent << "UseConcurrentLevels: " << m_UseConcurrentLevels << std::endl;
+  os << indent << "UseCascadedLevels: " << m_UseCascadedLevels << std::endl;
+  itkPrintSelfObjectMacro(CostModel);
 }
 } // namespace itk
 
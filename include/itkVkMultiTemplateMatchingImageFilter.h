@@ -0,0 +1,238 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         https://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkVkMultiTemplateMatchingImageFilter_h
+#define itkVkMultiTemplateMatchingImageFilter_h
+
+#include "itkImage.h"
+#include "itkMath.h"
+#include "itkNumericTraits.h"
+#include "itkProcessObject.h"
+#include "itkSimpleDataObjectDecorator.h"
+#include "itkVkCommon.h"
+#include "itkVkGlobalConfiguration.h"
+#include "itkVkTimingsReporter.h"
+
+#include <complex>
+#include <vector>
+
+namespace itk
+{
+/**
+ *\class VkMultiTemplateMatchingImageFilter
+ *
+ * \brief Finds the best match of each of many templates in one image.
+ *
+ * For every template image, the zero-normalized cross correlation with the
+ * input image is computed at all placements of the template inside the
+ * image, and the placement of highest correlation is reported. The result
+ * is a table with, for each template, the image index of the template
+ * origin at its best placement and the correlation there, in [-1, 1].
+ *
+ * The templates are matched in chunks of at most MaximumBatchSize, each in
+ * one VkFFT convolution run: the image and the templates, less their
+ * means, are transformed on the device, multiplied with the conjugate
+ * template spectra and transformed back. A MAXIMUM output stage then
+ * weights each correlation map by the inverse local standard deviation of
+ * the image under its template and reduces it to its best placement on the
+ * device, so that only a score and an index per template are copied back.
+ * The local variances come from windowed sums on the host, for the template
+ * sizes of one chunk at a time, so that host memory is bounded by the image
+ * and one chunk. When all templates fit in one chunk, their spectra stay on
+ * the device while the templates and the image size stay the same.
+ *
+ * Placements where the image is constant under the template, and
+ * constant templates, have a correlation of 0.
+ *
+ * \ingroup FourierTransform
+ * \ingroup VkFFTBackend
+ *
+ * \sa FFTNormalizedCorrelationImageFilter
+ * \sa VkMaskedFFTNormalizedCorrelationImageFilter
+ * \sa VkGlobalConfiguration
+ */
+template <typename TInputImage, typename TTemplateImage = TInputImage>
+class VkMultiTemplateMatchingImageFilter
+  : public ProcessObject
+  , public VkTimingsReporter
+{
+public:
+  ITK_DISALLOW_COPY_AND_MOVE(VkMultiTemplateMatchingImageFilter);
+
+  using InputImageType = TInputImage;
+  using TemplateImageType = TTemplateImage;
+  static_assert(std::is_same<typename TInputImage::PixelType, float>::value ||
+                  std::is_same<typename TInputImage::PixelType, double>::value,
+                "Unsupported pixel type");
+  static_assert(TInputImage::ImageDimension >= 1 && TInputImage::ImageDimension <= 3, "Unsupported image dimension");
+
+  /** Standard class type aliases. */
+  using Self = VkMultiTemplateMatchingImageFilter;
+  using Superclass = ProcessObject;
+  using Pointer = SmartPointer<Self>;
+  using ConstPointer = SmartPointer<const Self>;
+
+  using RealType = typename InputImageType::PixelType;
+  using ComplexType = std::complex<RealType>;
+  using IndexType = typename InputImageType::IndexType;
+  using SizeType = typename InputImageType::SizeType;
+  using SizeValueType = typename InputImageType::SizeValueType;
+
+  /** Best placement of one template. */
+  struct TemplateMatch
+  {
+    IndexType index{}; // Image index of the template origin
+    RealType  score{ 0 };
+
+    bool
+    operator==(const TemplateMatch & other) const
+    {
+      return index == other.index && Math::ExactlyEquals(score, other.score);
+    }
+  };
+  using MatchTableType = std::vector<TemplateMatch>;
+  using MatchTableObjectType = SimpleDataObjectDecorator<MatchTableType>;
+
+  static constexpr unsigned int ImageDimension{ InputImageType::ImageDimension };
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkOverrideGetNameOfClassMacro(VkMultiTemplateMatchingImageFilter);
+
+  /** Image to search for the templates. */
+  void
+  SetInput(const InputImageType * image)
+  {
+    this->SetNthInput(0, const_cast<InputImageType *>(image));
+  }
+
+  const InputImageType *
+  GetInput() const
+  {
+    return itkDynamicCastInDebugMode<const InputImageType *>(this->ProcessObject::GetInput(0));
+  }
+
+  /** Set template image N, which gives entry N of the match table. No
+   *  template may be larger than the input image. */
+  void
+  SetTemplateImage(unsigned int n, const TemplateImageType * templateImage);
+
+  const TemplateImageType *
+  GetTemplateImage(unsigned int n) const;
+
+  /** Number of template images. Reducing it removes the last ones. */
+  void
+  SetNumberOfTemplateImages(unsigned int numberOfTemplates);
+
+  unsigned int
+  GetNumberOfTemplateImages() const;
+
+  /** Best match of each template of the last update. */
+  const MatchTableType &
+  GetMatches() const
+  {
+    return this->GetMatchesOutput()->Get();
+  }
+
+  const MatchTableObjectType *
+  GetMatchesOutput() const
+  {
+    return itkDynamicCastInDebugMode<const MatchTableObjectType *>(this->ProcessObject::GetOutput(0));
+  }
+
+  /** Largest number of templates matched in one VkFFT run. Device
+   *  memory grows by about three padded images per template of a chunk,
+   *  and host memory by one. */
+  itkSetClampMacro(MaximumBatchSize, SizeValueType, 1, NumericTraits<SizeValueType>::max());
+  itkGetConstMacro(MaximumBatchSize, SizeValueType);
+
+  /** Number of templates forward transformed since construction.
+   *  It does not increase while the template spectra are reused. */
+  itkGetConstMacro(NumberOfTemplateTransforms, SizeValueType);
+
+  /** Determine whether local or global properties will be
+   *  referenced for setting up GPU acceleration. */
+  itkSetMacro(UseVkGlobalConfiguration, bool);
+  itkGetMacro(UseVkGlobalConfiguration, bool);
+
+  /** Local setting for enumerated GPU device to use for FFT.
+   *  Ignored if `UseVkGlobalConfiguration` is true. */
+  itkSetMacro(DeviceID, uint64_t);
+
+  /** Return the enumerated GPU device to use for FFT
+   *  according to current filter settings. With the global
+   *  configuration, runs are placed on devices by its scheduling
+   *  policy, which is this device only for the FIXED policy. */
+  uint64_t
+  GetDeviceID() const
+  {
+    return uint64_t{ m_UseVkGlobalConfiguration ? VkGlobalConfiguration::GetDeviceID() : m_DeviceID };
+  }
+
+protected:
+  VkMultiTemplateMatchingImageFilter();
+  ~VkMultiTemplateMatchingImageFilter() override = default;
+
+  using Superclass::MakeOutput;
+  DataObjectPointer
+  MakeOutput(DataObjectPointerArraySizeType idx) override;
+
+  void
+  GenerateData() override;
+
+  void
+  PrintSelf(std::ostream & os, Indent indent) const override;
+
+  /** Place the zero-mean templates from `firstTemplate` on, `batchSize`
+   *  of them or the remaining ones, in planes of `paddedSize`, unless those
+   *  of the previous chunk are the same. Planes beyond the last template
+   *  stay zero. */
+  void
+  UpdateTemplatePlanes(unsigned int firstTemplate, SizeValueType batchSize, const SizeType & paddedSize);
+
+  /** Sums of `values`, an image of `size`, over every placement of a
+   *  window of `windowSize` inside it, indexed by the window origin. */
+  static std::vector<double>
+  ComputeWindowSums(std::vector<double> values, SizeType size, const SizeType & windowSize);
+
+private:
+  SizeValueType m_MaximumBatchSize{ 16 };
+  SizeValueType m_NumberOfTemplateTransforms{ 0 };
+
+  // Zero-mean templates of the last chunk, their norms, and the templates they were made of
+  std::vector<RealType>                  m_TemplatePlanes{};
+  std::vector<double>                    m_TemplateNorms{};
+  std::vector<const TemplateImageType *> m_TemplatePlanesTemplates{};
+  SizeType                               m_TemplatePlanesPaddedSize{};
+  TimeStamp                              m_TemplatePlanesTime{};
+
+  bool     m_UseVkGlobalConfiguration{ true };
+  uint64_t m_DeviceID{ 0UL };
+
+  // Keeps the plan of the chunks, and the template spectra of a single chunk, between updates
+  VkCommon m_VkCommon{};
+};
+
+} // namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#  include "itkVkMultiTemplateMatchingImageFilter.hxx"
+#endif
+
+#endif // itkVkMultiTemplateMatchingImageFilter_h
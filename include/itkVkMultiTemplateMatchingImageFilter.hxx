@@ -0,0 +1,461 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         https://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkVkMultiTemplateMatchingImageFilter_hxx
+#define itkVkMultiTemplateMatchingImageFilter_hxx
+
+#include "itkVkMultiTemplateMatchingImageFilter.h"
+#include "itkVkTracer.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
+#include "itkIndent.h"
+#include "itkProgressReporter.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <numeric>
+#include <sstream>
+
+namespace itk
+{
+
+template <typename TInputImage, typename TTemplateImage>
+VkMultiTemplateMatchingImageFilter<TInputImage, TTemplateImage>::VkMultiTemplateMatchingImageFilter()
+  : VkTimingsReporter{ &m_VkCommon }
+{
+  this->SetNumberOfRequiredInputs(1);
+  this->SetNumberOfRequiredOutputs(1);
+  this->ProcessObject::SetNthOutput(0, this->MakeOutput(0));
+}
+
+template <typename TInputImage, typename TTemplateImage>
+void
+VkMultiTemplateMatchingImageFilter<TInputImage, TTemplateImage>::SetTemplateImage(
+  unsigned int              n,
+  const TemplateImageType * templateImage)
+{
+  if (n >= this->GetNumberOfTemplateImages())
+  {
+    this->SetNumberOfTemplateImages(n + 1);
+  }
+  this->SetNthInput(n + 1, const_cast<TemplateImageType *>(templateImage));
+}
+
+template <typename TInputImage, typename TTemplateImage>
+auto
+VkMultiTemplateMatchingImageFilter<TInputImage, TTemplateImage>::GetTemplateImage(unsigned int n) const
+  -> const TemplateImageType *
+{
+  if (n >= this->GetNumberOfTemplateImages())
+  {
+    return nullptr;
+  }
+  return itkDynamicCastInDebugMode<const TemplateImageType *>(this->ProcessObject::GetInput(n + 1));
+}
+
+template <typename TInputImage, typename TTemplateImage>
+void
+VkMultiTemplateMatchingImageFilter<TInputImage, TTemplateImage>::SetNumberOfTemplateImages(
+  unsigned int numberOfTemplates)
+{
+  if (numberOfTemplates == this->GetNumberOfTemplateImages())
+  {
+    return;
+  }
+  this->SetNumberOfIndexedInputs(numberOfTemplates + 1);
+  this->Modified();
+}
+
+template <typename TInputImage, typename TTemplateImage>
+unsigned int
+VkMultiTemplateMatchingImageFilter<TInputImage, TTemplateImage>::GetNumberOfTemplateImages() const
+{
+  const auto numberOfInputs{ static_cast<unsigned int>(this->GetNumberOfIndexedInputs()) };
+  return numberOfInputs > 1 ? numberOfInputs - 1 : 0;
+}
+
+template <typename TInputImage, typename TTemplateImage>
+auto
+VkMultiTemplateMatchingImageFilter<TInputImage, TTemplateImage>::MakeOutput(DataObjectPointerArraySizeType)
+  -> DataObjectPointer
+{
+  return MatchTableObjectType::New().GetPointer();
+}
+
+template <typename TInputImage, typename TTemplateImage>
+void
+VkMultiTemplateMatchingImageFilter<TInputImage, TTemplateImage>::GenerateData()
+{
+  const VkTraceScope traceScope{ this->GetNameOfClass(), "GenerateData", this->GetDeviceID() };
+
+  const InputImageType * const input{ this->GetInput() };
+  const unsigned int           numberOfTemplates{ this->GetNumberOfTemplateImages() };
+
+  if (!input)
+  {
+    return;
+  }
+  itkAssertOrThrowMacro(numberOfTemplates > 0, "No template images");
+  const SizeType imageSize{ input->GetLargestPossibleRegion().GetSize() };
+  for (unsigned int n{ 0 }; n < numberOfTemplates; ++n)
+  {
+    const TemplateImageType * const templateImage{ this->GetTemplateImage(n) };
+    itkAssertOrThrowMacro(templateImage != nullptr, "Missing template image");
+    for (unsigned int dim{ 0 }; dim < ImageDimension; ++dim)
+    {
+      itkAssertOrThrowMacro(templateImage->GetLargestPossibleRegion().GetSize(dim) <= imageSize[dim],
+                            "Template image larger than the input image");
+    }
+  }
+
+  const ProgressReporter progress(this, 0, 1);
+
+  // Correlations at placements inside the image do not wrap around in
+  // transforms of the image size, which is padded only for speed
+  const VkCommon::PrecisionEnum precision{ std::is_same<RealType, double>::value ? VkCommon::PrecisionEnum::DOUBLE
+                                                                                  : VkCommon::PrecisionEnum::FLOAT };
+  SizeType                      paddedSize;
+  SizeValueType                 strides[ImageDimension];
+  SizeValueType                 paddedPixels{ 1 };
+  for (unsigned int dim{ 0 }; dim < ImageDimension; ++dim)
+  {
+    paddedSize[dim] = VkCommon::GetOptimalFFTSize(
+      imageSize[dim], precision, dim == 0 ? VkCommon::FFTEnum::R2HalfH : VkCommon::FFTEnum::C2C);
+    strides[dim] = paddedPixels;
+    paddedPixels *= paddedSize[dim];
+  }
+  const SizeValueType spectrumPixels{ paddedPixels / paddedSize[0] * (paddedSize[0] / 2 + 1) };
+
+  // Remove the image mean, which the zero-mean templates ignore, to keep
+  // the windowed variances accurate
+  const auto &        imageRegion{ input->GetLargestPossibleRegion() };
+  const SizeValueType imagePixels{ imageRegion.GetNumberOfPixels() };
+  std::vector<double> values;
+  values.reserve(imagePixels);
+  for (ImageRegionConstIterator<InputImageType> it(input, imageRegion); !it.IsAtEnd(); ++it)
+  {
+    values.push_back(static_cast<double>(it.Get()));
+  }
+  const double        mean{ std::accumulate(values.cbegin(), values.cend(), 0.0) / static_cast<double>(imagePixels) };
+  std::vector<double> squares(imagePixels);
+  for (SizeValueType i{ 0 }; i < imagePixels; ++i)
+  {
+    values[i] -= mean;
+    squares[i] = values[i] * values[i];
+  }
+
+  // Offset in a padded plane of a position relative to the region origin
+  const auto paddedOffset = [&strides](const SizeType & position) {
+    SizeValueType offset{ 0 };
+    for (unsigned int dim{ 0 }; dim < ImageDimension; ++dim)
+    {
+      offset += position[dim] * strides[dim];
+    }
+    return offset;
+  };
+  const auto nextPosition = [](SizeType & position, const SizeType & extent) {
+    for (unsigned int dim{ 0 }; dim < ImageDimension && ++position[dim] == extent[dim]; ++dim)
+    {
+      if (dim + 1 < ImageDimension)
+      {
+        position[dim] = 0;
+      }
+    }
+  };
+
+  std::vector<RealType> imagePlane(paddedPixels);
+  SizeType              position;
+  position.Fill(0);
+  for (SizeValueType i{ 0 }; i < imagePixels; ++i, nextPosition(position, imageSize))
+  {
+    imagePlane[paddedOffset(position)] = static_cast<RealType>(values[i]);
+  }
+
+  // All chunks have the size of the first one, so that they share a plan
+  const SizeValueType batchSize{ std::min<SizeValueType>(m_MaximumBatchSize, numberOfTemplates) };
+  const SizeValueType stageBytes{ batchSize * (sizeof(uint64_t) + VkCommon::MaximumStageValues * sizeof(RealType)) };
+  std::vector<uint64_t> stageOutput((stageBytes + sizeof(uint64_t) - 1) / sizeof(uint64_t));
+  const uint64_t * const indices{ stageOutput.data() };
+  const RealType * const maxima{ reinterpret_cast<const RealType *>(indices + batchSize) };
+
+  MatchTableType matches(numberOfTemplates);
+  for (unsigned int firstTemplate{ 0 }; firstTemplate < numberOfTemplates;
+       firstTemplate += static_cast<unsigned int>(batchSize))
+  {
+    this->UpdateTemplatePlanes(firstTemplate, batchSize, paddedSize);
+    const unsigned int chunkTemplates{ std::min(static_cast<unsigned int>(batchSize),
+                                                numberOfTemplates - firstTemplate) };
+
+    // Weight planes of the template sizes of the chunk: the inverse standard deviation of the image under the
+    // template at each of its placements, and 0 at placements where the image is constant and beyond the last
+    std::vector<SizeType> windowSizes;
+    std::vector<uint64_t> weightPlanes(batchSize, 0);
+    std::vector<RealType> weights;
+    for (unsigned int k{ 0 }; k < chunkTemplates; ++k)
+    {
+      const SizeType templateSize{ this->GetTemplateImage(firstTemplate + k)->GetLargestPossibleRegion().GetSize() };
+      const auto     windowIt{ std::find(windowSizes.cbegin(), windowSizes.cend(), templateSize) };
+      weightPlanes[k] = static_cast<uint64_t>(windowIt - windowSizes.cbegin());
+      if (windowIt != windowSizes.cend())
+      {
+        continue;
+      }
+      windowSizes.push_back(templateSize);
+      const std::vector<double> sums{ ComputeWindowSums(values, imageSize, templateSize) };
+      const std::vector<double> sumsOfSquares{ ComputeWindowSums(squares, imageSize, templateSize) };
+
+      SizeType placements;
+      for (unsigned int dim{ 0 }; dim < ImageDimension; ++dim)
+      {
+        placements[dim] = imageSize[dim] - templateSize[dim] + 1;
+      }
+      const auto          templatePixels{ static_cast<double>(templateSize.CalculateProductOfElements()) };
+      const double        tolerance{ 1000 * std::numeric_limits<RealType>::epsilon() };
+      const SizeValueType planeStart{ weights.size() };
+      weights.resize(planeStart + imagePixels, RealType{ 0 });
+      RealType * const weightPlane{ &weights[planeStart] };
+      position.Fill(0);
+      for (SizeValueType i{ 0 }; i < sums.size(); ++i, nextPosition(position, placements))
+      {
+        const double variance{ sumsOfSquares[i] - sums[i] * sums[i] / templatePixels };
+        if (variance > tolerance * sumsOfSquares[i])
+        {
+          SizeValueType offset{ 0 };
+          for (unsigned int dim{ ImageDimension }; dim > 0; --dim)
+          {
+            offset = offset * imageSize[dim - 1] + position[dim - 1];
+          }
+          weightPlane[offset] = static_cast<RealType>(1.0 / std::sqrt(variance));
+        }
+      }
+    }
+
+    // Describe the correlation of the image with the chunk in VkCommon::VkParameters
+    typename VkCommon::VkParameters vkParameters;
+    if (ImageDimension > 0)
+      vkParameters.X = paddedSize[0];
+    if (ImageDimension > 1)
+      vkParameters.Y = paddedSize[1];
+    if (ImageDimension > 2)
+      vkParameters.Z = paddedSize[2];
+    vkParameters.P = precision;
+    vkParameters.fft = VkCommon::FFTEnum::R2HalfH;
+    vkParameters.PSize = sizeof(RealType);
+    vkParameters.I = VkCommon::DirectionEnum::FORWARD;
+    vkParameters.normalized = VkCommon::NormalizationEnum::NORMALIZED;
+    vkParameters.convolution = true;
+    vkParameters.numberOfKernels = batchSize;
+    vkParameters.conjugateKernel = true;
+    vkParameters.transformKernel = true;
+    vkParameters.kernelCPUBuffer = m_TemplatePlanes.data();
+    vkParameters.kernelBufferBytes = m_TemplatePlanes.size() * sizeof(RealType);
+    vkParameters.kernelModifiedTime = m_TemplatePlanesTime.GetMTime();
+    vkParameters.inputCPUBuffer = imagePlane.data();
+    vkParameters.inputBufferBytes = imagePlane.size() * sizeof(RealType);
+    vkParameters.outputCPUBuffer = stageOutput.data();
+    vkParameters.outputBufferBytes = stageBytes;
+    vkParameters.outputStage = VkCommon::OutputStageEnum::MAXIMUM;
+    for (unsigned int dim{ 0 }; dim < ImageDimension; ++dim)
+    {
+      vkParameters.stageOutputSize[dim] = imageSize[dim];
+    }
+    vkParameters.stageWeightsCPUBuffer = weights.data();
+    vkParameters.stageWeightsBufferBytes = weights.size() * sizeof(RealType);
+    vkParameters.stageWeightPlanes = weightPlanes.data();
+
+    // Count this run as outstanding on the device of the plan it reuses, or else on a device chosen by the
+    // scheduling policy. The device holds the image, the real and transformed templates, the products and
+    // the correlations.
+    const VkDeviceReservation deviceReservation{ m_UseVkGlobalConfiguration,
+                                                 m_DeviceID,
+                                                 (1 + 2 * batchSize) * paddedPixels * sizeof(RealType) +
+                                                   2 * batchSize * spectrumPixels * sizeof(ComplexType) +
+                                                   vkParameters.stageWeightsBufferBytes,
+                                                 m_VkCommon,
+                                                 vkParameters };
+
+    // Mostly use defaults for VkCommon::VkGPU
+    typename VkCommon::VkGPU vkGPU;
+    vkGPU.device_id = deviceReservation.GetDeviceID();
+    vkGPU.profiling = VkGlobalConfiguration::GetProfiling();
+
+    const VkFFTResult resFFT{ m_VkCommon.Run(vkGPU, vkParameters) };
+    if (resFFT != VKFFT_SUCCESS)
+    {
+      std::ostringstream mesg;
+      mesg << "VkFFT third-party library failed with error code " << resFFT << ".";
+      itkAssertOrThrowMacro(false, mesg.str());
+    }
+
+    // Scores are the weighted maxima over the template norms; the index is that of the template origin
+    for (unsigned int k{ 0 }; k < chunkTemplates; ++k)
+    {
+      TemplateMatch & match{ matches[firstTemplate + k] };
+      match.index = imageRegion.GetIndex();
+      const double templateNorm{ m_TemplateNorms[k] };
+      if (templateNorm <= 0.0 || indices[k] == std::numeric_limits<uint64_t>::max())
+      {
+        continue;
+      }
+      const double score{ static_cast<double>(maxima[k * VkCommon::MaximumStageValues]) / templateNorm };
+      match.score = static_cast<RealType>(std::min(std::max(score, -1.0), 1.0));
+      SizeValueType index{ indices[k] };
+      for (unsigned int dim{ 0 }; dim < ImageDimension; ++dim)
+      {
+        match.index[dim] = imageRegion.GetIndex(dim) + static_cast<IndexValueType>(index % imageSize[dim]);
+        index /= imageSize[dim];
+      }
+    }
+  }
+  itkDynamicCastInDebugMode<MatchTableObjectType *>(this->ProcessObject::GetOutput(0))->Set(matches);
+}
+
+template <typename TInputImage, typename TTemplateImage>
+void
+VkMultiTemplateMatchingImageFilter<TInputImage, TTemplateImage>::UpdateTemplatePlanes(unsigned int     firstTemplate,
+                                                                                      SizeValueType    batchSize,
+                                                                                      const SizeType & paddedSize)
+{
+  const unsigned int chunkTemplates{ std::min(static_cast<unsigned int>(batchSize),
+                                              this->GetNumberOfTemplateImages() - firstTemplate) };
+  SizeValueType      paddedPixels{ 1 };
+  SizeValueType      strides[ImageDimension];
+  for (unsigned int dim{ 0 }; dim < ImageDimension; ++dim)
+  {
+    strides[dim] = paddedPixels;
+    paddedPixels *= paddedSize[dim];
+  }
+
+  bool upToDate{ m_TemplatePlanesTemplates.size() == chunkTemplates && m_TemplatePlanesPaddedSize == paddedSize &&
+                 m_TemplatePlanes.size() == batchSize * paddedPixels };
+  for (unsigned int k{ 0 }; upToDate && k < chunkTemplates; ++k)
+  {
+    const TemplateImageType * const templateImage{ this->GetTemplateImage(firstTemplate + k) };
+    upToDate = templateImage == m_TemplatePlanesTemplates[k] &&
+               templateImage->GetMTime() < m_TemplatePlanesTime.GetMTime();
+  }
+  if (upToDate)
+  {
+    return;
+  }
+
+  // Place each zero-mean template at the origin of its plane
+  m_TemplatePlanes.assign(batchSize * paddedPixels, RealType{ 0 });
+  m_TemplateNorms.assign(chunkTemplates, 0.0);
+  m_TemplatePlanesTemplates.assign(chunkTemplates, nullptr);
+  for (unsigned int k{ 0 }; k < chunkTemplates; ++k)
+  {
+    const TemplateImageType * const templateImage{ this->GetTemplateImage(firstTemplate + k) };
+    const auto &                    templateRegion{ templateImage->GetLargestPossibleRegion() };
+
+    double mean{ 0.0 };
+    for (ImageRegionConstIterator<TemplateImageType> it(templateImage, templateRegion); !it.IsAtEnd(); ++it)
+    {
+      mean += static_cast<double>(it.Get());
+    }
+    mean /= static_cast<double>(templateRegion.GetNumberOfPixels());
+
+    double sumOfSquares{ 0.0 };
+    for (ImageRegionConstIteratorWithIndex<TemplateImageType> it(templateImage, templateRegion); !it.IsAtEnd(); ++it)
+    {
+      SizeValueType offset{ 0 };
+      for (unsigned int dim{ 0 }; dim < ImageDimension; ++dim)
+      {
+        offset += static_cast<SizeValueType>(it.GetIndex()[dim] - templateRegion.GetIndex(dim)) * strides[dim];
+      }
+      const double value{ static_cast<double>(it.Get()) - mean };
+      m_TemplatePlanes[k * paddedPixels + offset] = static_cast<RealType>(value);
+      sumOfSquares += value * value;
+    }
+    m_TemplateNorms[k] = std::sqrt(sumOfSquares);
+    m_TemplatePlanesTemplates[k] = templateImage;
+  }
+
+  // The planes are transformed on the device by the next run, which sees their new time
+  m_NumberOfTemplateTransforms += chunkTemplates;
+  m_TemplatePlanesPaddedSize = paddedSize;
+  m_TemplatePlanesTime.Modified();
+}
+
+template <typename TInputImage, typename TTemplateImage>
+std::vector<double>
+VkMultiTemplateMatchingImageFilter<TInputImage, TTemplateImage>::ComputeWindowSums(std::vector<double> values,
+                                                                                   SizeType            size,
+                                                                                   const SizeType &    windowSize)
+{
+  // Running sums along one dimension at a time shrink it to the placements
+  for (unsigned int dim{ 0 }; dim < ImageDimension; ++dim)
+  {
+    SizeValueType inner{ 1 };
+    SizeValueType outer{ 1 };
+    for (unsigned int other{ 0 }; other < dim; ++other)
+    {
+      inner *= size[other];
+    }
+    for (unsigned int other{ dim + 1 }; other < ImageDimension; ++other)
+    {
+      outer *= size[other];
+    }
+    const SizeValueType length{ size[dim] };
+    const SizeValueType width{ windowSize[dim] };
+    const SizeValueType placements{ length - width + 1 };
+
+    std::vector<double> sums(outer * placements * inner);
+    for (SizeValueType o{ 0 }; o < outer; ++o)
+    {
+      for (SizeValueType i{ 0 }; i < inner; ++i)
+      {
+        const double * const line{ &values[o * length * inner + i] };
+        double * const       sumLine{ &sums[o * placements * inner + i] };
+        double               sum{ 0.0 };
+        for (SizeValueType k{ 0 }; k < width; ++k)
+        {
+          sum += line[k * inner];
+        }
+        sumLine[0] = sum;
+        for (SizeValueType p{ 1 }; p < placements; ++p)
+        {
+          sum += line[(p + width - 1) * inner] - line[(p - 1) * inner];
+          sumLine[p * inner] = sum;
+        }
+      }
+    }
+    values = std::move(sums);
+    size[dim] = placements;
+  }
+  return values;
+}
+
+template <typename TInputImage, typename TTemplateImage>
+void
+VkMultiTemplateMatchingImageFilter<TInputImage, TTemplateImage>::PrintSelf(std::ostream & os, Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+  os << indent << "NumberOfTemplateImages: " << this->GetNumberOfTemplateImages() << std::endl;
+  os << indent << "MaximumBatchSize: " << m_MaximumBatchSize << std::endl;
+  os << indent << "NumberOfTemplateTransforms: " << m_NumberOfTemplateTransforms << std::endl;
+  os << indent << "UseVkGlobalConfiguration: " << m_UseVkGlobalConfiguration << std::endl;
+  os << indent << "Local DeviceID: " << m_DeviceID << std::endl;
+  os << indent << "Global DeviceID: " << VkGlobalConfiguration::GetDeviceID() << std::endl;
+  os << indent << "Preferred DeviceID: " << this->GetDeviceID() << std::endl;
+}
+
+} // end namespace itk
+
+#endif // itkVkMultiTemplateMatchingImageFilter_hxx
@@ -0,0 +1,238 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         https://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkVkPhaseCorrelationImageRegistrationMethod_h
+#define itkVkPhaseCorrelationImageRegistrationMethod_h
+
+#include "itkImage.h"
+#include "itkOffset.h"
+#include "itkProcessObject.h"
+#include "itkSimpleDataObjectDecorator.h"
+#include "itkVector.h"
+#include "itkVkCommon.h"
+#include "itkVkGlobalConfiguration.h"
+#include "itkVkTimingsReporter.h"
+
+#include <complex>
+#include <vector>
+
+namespace itk
+{
+/**
+ *\class VkPhaseCorrelationImageRegistrationMethod
+ *
+ * \brief Estimates the translation between two images by phase correlation.
+ *
+ * Both images, less their means, are padded with zeros to a common size
+ * fast for VkFFT and correlated in one convolution run: VkFFT transforms
+ * both on the device, normalizes their cross-power spectrum to unit
+ * magnitude and inverse transforms it. The highest peak of the resulting
+ * phase correlation surface is found on the device, and only it and its
+ * neighbors are copied back, to be refined to subpixel precision by a
+ * parabolic fit along each dimension. VkFFT does not guard the
+ * normalization, so when a product of spectra vanishes exactly, as for
+ * periodic images that need no padding, the surface is not finite; the
+ * spectra are then copied back and normalized on the host, leaving such
+ * products out, which takes two more runs.
+ *
+ * The result is the translation that maps points of the fixed image to
+ * the corresponding points of the moving image, as for a
+ * TranslationTransform in registration, both in index units (Offset) and
+ * in physical units of the fixed image (Translation). Translations of more
+ * than half the padded size wrap around. The Confidence is the height of
+ * the peak, which is 1 for images that are circular shifts of each other
+ * and decreases as their content differs. Constant images, which have no
+ * phase to correlate, give a zero offset and a Confidence of 0 with a
+ * warning.
+ *
+ * \ingroup FourierTransform
+ * \ingroup VkFFTBackend
+ *
+ * \sa VkMaskedFFTNormalizedCorrelationImageFilter
+ * \sa VkGlobalConfiguration
+ */
+template <typename TFixedImage, typename TMovingImage = TFixedImage, typename TRealType = float>
+class VkPhaseCorrelationImageRegistrationMethod
+  : public ProcessObject
+  , public VkTimingsReporter
+{
+public:
+  ITK_DISALLOW_COPY_AND_MOVE(VkPhaseCorrelationImageRegistrationMethod);
+
+  using FixedImageType = TFixedImage;
+  using MovingImageType = TMovingImage;
+  static_assert(std::is_same<TRealType, float>::value || std::is_same<TRealType, double>::value,
+                "Unsupported precision");
+  static_assert(TFixedImage::ImageDimension >= 1 && TFixedImage::ImageDimension <= 3, "Unsupported image dimension");
+  static_assert(TFixedImage::ImageDimension == TMovingImage::ImageDimension, "Images differ in dimension");
+
+  /** Standard class type aliases. */
+  using Self = VkPhaseCorrelationImageRegistrationMethod;
+  using Superclass = ProcessObject;
+  using Pointer = SmartPointer<Self>;
+  using ConstPointer = SmartPointer<const Self>;
+
+  using RealType = TRealType;
+  using ComplexType = std::complex<RealType>;
+  using SizeType = typename FixedImageType::SizeType;
+  using SizeValueType = typename FixedImageType::SizeValueType;
+
+  static constexpr unsigned int ImageDimension{ FixedImageType::ImageDimension };
+
+  using OffsetType = Offset<ImageDimension>;
+  using VectorType = Vector<double, ImageDimension>;
+  using VectorObjectType = SimpleDataObjectDecorator<VectorType>;
+  using ConfidenceObjectType = SimpleDataObjectDecorator<double>;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkOverrideGetNameOfClassMacro(VkPhaseCorrelationImageRegistrationMethod);
+
+  /** Images to register. They may differ in size. */
+  itkSetInputMacro(FixedImage, FixedImageType);
+  itkGetInputMacro(FixedImage, FixedImageType);
+  itkSetInputMacro(MovingImage, MovingImageType);
+  itkGetInputMacro(MovingImage, MovingImageType);
+
+  /** Translation from the fixed to the moving image in physical units. */
+  const VectorType &
+  GetTranslation() const
+  {
+    return this->GetTranslationOutput()->Get();
+  }
+
+  const VectorObjectType *
+  GetTranslationOutput() const
+  {
+    return itkDynamicCastInDebugMode<const VectorObjectType *>(this->ProcessObject::GetOutput(0));
+  }
+
+  /** Translation from the fixed to the moving image in index units. */
+  const VectorType &
+  GetOffset() const
+  {
+    return this->GetOffsetOutput()->Get();
+  }
+
+  const VectorObjectType *
+  GetOffsetOutput() const
+  {
+    return itkDynamicCastInDebugMode<const VectorObjectType *>(this->ProcessObject::GetOutput(1));
+  }
+
+  /** Height of the phase correlation peak, in [0, 1]. */
+  double
+  GetConfidence() const
+  {
+    return this->GetConfidenceOutput()->Get();
+  }
+
+  const ConfidenceObjectType *
+  GetConfidenceOutput() const
+  {
+    return itkDynamicCastInDebugMode<const ConfidenceObjectType *>(this->ProcessObject::GetOutput(2));
+  }
+
+  /** Normalize the cross-power spectrum of `count` values of a fixed and a
+   *  moving spectrum to unit magnitude, leaving out frequencies at which
+   *  either image has no energy. */
+  static void
+  ComputeNormalizedCrossPower(const ComplexType * fixedSpectrum,
+                              const ComplexType * movingSpectrum,
+                              ComplexType *       crossPower,
+                              SizeValueType       count);
+
+  /** Highest value of a phase correlation `surface` of `paddedSize` over
+   *  the offsets within `searchRadius` of `searchCenter`, or over all
+   *  offsets along dimensions where the radius reaches half the size. The
+   *  offset of the peak, refined by a parabola through its neighbors along
+   *  each dimension, is returned in `offset`. */
+  static double
+  FindPeak(const RealType *   surface,
+           const SizeType &   paddedSize,
+           const OffsetType & searchCenter,
+           const SizeType &   searchRadius,
+           VectorType &       offset);
+
+  /** Subpixel offset of a peak from a parabola through it and its
+   *  neighbors along one dimension, within half a pixel, or 0 if the
+   *  values do not bend down. */
+  static double
+  RefinePeak(double previous, double peakValue, double next);
+
+  /** Determine whether local or global properties will be
+   *  referenced for setting up GPU acceleration. */
+  itkSetMacro(UseVkGlobalConfiguration, bool);
+  itkGetMacro(UseVkGlobalConfiguration, bool);
+
+  /** Local setting for enumerated GPU device to use for FFT.
+   *  Ignored if `UseVkGlobalConfiguration` is true. */
+  itkSetMacro(DeviceID, uint64_t);
+
+  /** Return the enumerated GPU device to use for FFT
+   *  according to current filter settings. With the global
+   *  configuration, runs are placed on devices by its scheduling
+   *  policy, which is this device only for the FIXED policy. */
+  uint64_t
+  GetDeviceID() const
+  {
+    return uint64_t{ m_UseVkGlobalConfiguration ? VkGlobalConfiguration::GetDeviceID() : m_DeviceID };
+  }
+
+protected:
+  VkPhaseCorrelationImageRegistrationMethod();
+  ~VkPhaseCorrelationImageRegistrationMethod() override = default;
+
+  using Superclass::MakeOutput;
+  DataObjectPointer
+  MakeOutput(DataObjectPointerArraySizeType idx) override;
+
+  void
+  GenerateData() override;
+
+  void
+  PrintSelf(std::ostream & os, Indent indent) const override;
+
+  /** Run `batches` transforms of `paddedSize` between the real and half
+   *  Hermitian buffers, in the given direction. */
+  void
+  RunBatch(VkCommon &                 vkCommon,
+           VkCommon::DirectionEnum    direction,
+           const SizeType &           paddedSize,
+           uint64_t                   batches,
+           std::vector<RealType> &    realPlanes,
+           std::vector<ComplexType> & spectra);
+
+private:
+  bool     m_UseVkGlobalConfiguration{ true };
+  uint64_t m_DeviceID{ 0UL };
+
+  VkCommon m_VkCommon{};
+  // Plans of the forward and inverse runs that replace the device normalization when it gives NaN
+  VkCommon m_ForwardVkCommon{};
+  VkCommon m_InverseVkCommon{};
+};
+
+} // namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#  include "itkVkPhaseCorrelationImageRegistrationMethod.hxx"
+#endif
+
+#endif // itkVkPhaseCorrelationImageRegistrationMethod_h
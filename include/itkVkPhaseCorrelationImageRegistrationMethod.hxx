@@ -0,0 +1,473 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         https://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkVkPhaseCorrelationImageRegistrationMethod_hxx
+#define itkVkPhaseCorrelationImageRegistrationMethod_hxx
+
+#include "itkVkPhaseCorrelationImageRegistrationMethod.h"
+#include "itkVkTracer.h"
+#include "itkContinuousIndex.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
+#include "itkIndent.h"
+#include "itkProgressReporter.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <type_traits>
+
+namespace itk
+{
+
+template <typename TFixedImage, typename TMovingImage, typename TRealType>
+VkPhaseCorrelationImageRegistrationMethod<TFixedImage, TMovingImage, TRealType>::
+  VkPhaseCorrelationImageRegistrationMethod()
+  : VkTimingsReporter{ &m_VkCommon, &m_ForwardVkCommon, &m_InverseVkCommon }
+{
+  this->AddRequiredInputName("FixedImage", 0);
+  this->AddRequiredInputName("MovingImage", 1);
+
+  this->SetNumberOfRequiredOutputs(3);
+  for (DataObjectPointerArraySizeType n{ 0 }; n < 3; ++n)
+  {
+    this->ProcessObject::SetNthOutput(n, this->MakeOutput(n));
+  }
+}
+
+template <typename TFixedImage, typename TMovingImage, typename TRealType>
+auto
+VkPhaseCorrelationImageRegistrationMethod<TFixedImage, TMovingImage, TRealType>::MakeOutput(
+  DataObjectPointerArraySizeType idx) -> DataObjectPointer
+{
+  if (idx == 2)
+  {
+    return ConfidenceObjectType::New().GetPointer();
+  }
+  return VectorObjectType::New().GetPointer();
+}
+
+template <typename TFixedImage, typename TMovingImage, typename TRealType>
+void
+VkPhaseCorrelationImageRegistrationMethod<TFixedImage, TMovingImage, TRealType>::GenerateData()
+{
+  const VkTraceScope traceScope{ this->GetNameOfClass(), "GenerateData", this->GetDeviceID() };
+
+  const FixedImageType * const  fixedImage{ this->GetFixedImage() };
+  const MovingImageType * const movingImage{ this->GetMovingImage() };
+
+  if (!fixedImage || !movingImage)
+  {
+    return;
+  }
+
+  const ProgressReporter progress(this, 0, 1);
+
+  // Pad both images to a common size fast for VkFFT
+  const auto &                  fixedRegion{ fixedImage->GetLargestPossibleRegion() };
+  const auto &                  movingRegion{ movingImage->GetLargestPossibleRegion() };
+  const VkCommon::PrecisionEnum precision{ std::is_same<RealType, double>::value ? VkCommon::PrecisionEnum::DOUBLE
+                                                                                  : VkCommon::PrecisionEnum::FLOAT };
+  SizeType                      paddedSize;
+  SizeValueType                 strides[ImageDimension];
+  SizeValueType                 paddedPixels{ 1 };
+  for (unsigned int dim{ 0 }; dim < ImageDimension; ++dim)
+  {
+    paddedSize[dim] = VkCommon::GetOptimalFFTSize(std::max(fixedRegion.GetSize(dim), movingRegion.GetSize(dim)),
+                                                  precision,
+                                                  dim == 0 ? VkCommon::FFTEnum::R2HalfH : VkCommon::FFTEnum::C2C);
+    strides[dim] = paddedPixels;
+    paddedPixels *= paddedSize[dim];
+  }
+  const SizeValueType spectrumPixels{ paddedPixels / paddedSize[0] * (paddedSize[0] / 2 + 1) };
+
+  // Copy each image less its mean, so that the zero padding adds no edge, and return its root mean square
+  std::vector<RealType> planes(2 * paddedPixels);
+  RealType * const      fixedPlane{ &planes[0] };
+  RealType * const      movingPlane{ &planes[paddedPixels] };
+  const auto            fillPlane = [&](const auto * image, RealType * plane) {
+    using ImageType = std::remove_const_t<std::remove_pointer_t<decltype(image)>>;
+    const auto & region{ image->GetLargestPossibleRegion() };
+    double       mean{ 0.0 };
+    for (ImageRegionConstIteratorWithIndex<ImageType> it(image, region); !it.IsAtEnd(); ++it)
+    {
+      mean += static_cast<double>(it.Get());
+    }
+    mean /= static_cast<double>(region.GetNumberOfPixels());
+    double sumOfSquares{ 0.0 };
+    for (ImageRegionConstIteratorWithIndex<ImageType> it(image, region); !it.IsAtEnd(); ++it)
+    {
+      SizeValueType offset{ 0 };
+      for (unsigned int dim{ 0 }; dim < ImageDimension; ++dim)
+      {
+        offset += static_cast<SizeValueType>(it.GetIndex()[dim] - region.GetIndex(dim)) * strides[dim];
+      }
+      const double value{ static_cast<double>(it.Get()) - mean };
+      plane[offset] = static_cast<RealType>(value);
+      sumOfSquares += value * value;
+    }
+    return std::sqrt(sumOfSquares / static_cast<double>(region.GetNumberOfPixels()));
+  };
+  const double fixedScale{ fillPlane(fixedImage, fixedPlane) };
+  const double movingScale{ fillPlane(movingImage, movingPlane) };
+
+  VectorType offset;
+  offset.Fill(0.0);
+  double peakValue{ 0.0 };
+  if (fixedScale <= 0.0 || movingScale <= 0.0)
+  {
+    itkWarningMacro("A constant image has no phase to correlate. The offset is 0 with a Confidence of 0.");
+  }
+  else
+  {
+    // VkFFT divides each product of spectra by its magnitude without a guard, so the zero frequency, which
+    // the means no longer fill, is set by a constant of the scale of each image over its whole padded
+    // plane. A power of two adds no rounding to images of small integers. The unit product it gives adds
+    // 1 / paddedPixels to the surface, which is taken off the peak.
+    const auto addConstant = [paddedPixels](RealType * plane, double scale) {
+      const auto constant{ static_cast<RealType>(std::exp2(std::round(std::log2(scale)))) };
+      std::for_each(plane, plane + paddedPixels, [constant](RealType & value) { value += constant; });
+    };
+    addConstant(fixedPlane, fixedScale);
+    addConstant(movingPlane, movingScale);
+    const double constantTerm{ 1.0 / static_cast<double>(paddedPixels) };
+
+    // The index of the peak of the phase correlation surface, and the peak and its neighbors along each
+    // dimension
+    const SizeValueType    stageBytes{ sizeof(uint64_t) + VkCommon::MaximumStageValues * sizeof(RealType) };
+    std::vector<uint64_t>  stageOutput((stageBytes + sizeof(uint64_t) - 1) / sizeof(uint64_t));
+    const uint64_t * const peakIndex{ stageOutput.data() };
+    const RealType * const peakValues{ reinterpret_cast<const RealType *>(peakIndex + 1) };
+
+    // Describe the correlation of the moving image with the fixed image in VkCommon::VkParameters: the
+    // fixed image is transformed on the GPU as a kernel, and the products with its conjugate spectrum are
+    // normalized to unit magnitude before they are transformed back
+    typename VkCommon::VkParameters vkParameters;
+    if (ImageDimension > 0)
+      vkParameters.X = paddedSize[0];
+    if (ImageDimension > 1)
+      vkParameters.Y = paddedSize[1];
+    if (ImageDimension > 2)
+      vkParameters.Z = paddedSize[2];
+    vkParameters.P = precision;
+    vkParameters.fft = VkCommon::FFTEnum::R2HalfH;
+    vkParameters.PSize = sizeof(RealType);
+    vkParameters.I = VkCommon::DirectionEnum::FORWARD;
+    vkParameters.normalized = VkCommon::NormalizationEnum::NORMALIZED;
+    vkParameters.convolution = true;
+    vkParameters.numberOfKernels = 1;
+    vkParameters.conjugateKernel = true;
+    vkParameters.normalizeProducts = true;
+    vkParameters.transformKernel = true;
+    vkParameters.kernelCPUBuffer = fixedPlane;
+    vkParameters.kernelBufferBytes = paddedPixels * sizeof(RealType);
+    vkParameters.inputCPUBuffer = movingPlane;
+    vkParameters.inputBufferBytes = paddedPixels * sizeof(RealType);
+    vkParameters.outputCPUBuffer = stageOutput.data();
+    vkParameters.outputBufferBytes = stageBytes;
+    vkParameters.outputStage = VkCommon::OutputStageEnum::MAXIMUM;
+    for (unsigned int dim{ 0 }; dim < ImageDimension; ++dim)
+    {
+      vkParameters.stageOutputSize[dim] = paddedSize[dim];
+    }
+
+    // Count this run as outstanding on the device of the plan it reuses, or else on a device chosen by the
+    // scheduling policy. The device holds both images, their spectra and the surface.
+    const VkDeviceReservation deviceReservation{ m_UseVkGlobalConfiguration,
+                                                 m_DeviceID,
+                                                 3 * paddedPixels * sizeof(RealType) +
+                                                   2 * spectrumPixels * sizeof(ComplexType),
+                                                 m_VkCommon,
+                                                 vkParameters };
+
+    // Mostly use defaults for VkCommon::VkGPU
+    typename VkCommon::VkGPU vkGPU;
+    vkGPU.device_id = deviceReservation.GetDeviceID();
+    vkGPU.profiling = VkGlobalConfiguration::GetProfiling();
+
+    const VkFFTResult resFFT{ m_VkCommon.Run(vkGPU, vkParameters) };
+    if (resFFT != VKFFT_SUCCESS)
+    {
+      std::ostringstream mesg;
+      mesg << "VkFFT third-party library failed with error code " << resFFT << ".";
+      itkAssertOrThrowMacro(false, mesg.str());
+    }
+
+    const auto value = [&](unsigned int i) { return static_cast<double>(peakValues[i]) - constantTerm; };
+    bool       isFinite{ *peakIndex != std::numeric_limits<uint64_t>::max() };
+    for (unsigned int i{ 0 }; i < 1 + 2 * ImageDimension; ++i)
+    {
+      isFinite = isFinite && std::isfinite(value(i));
+    }
+    if (isFinite)
+    {
+      // Offsets up to half the padded size in either direction, as for FindPeak
+      peakValue = value(0);
+      SizeValueType remainder{ *peakIndex };
+      for (unsigned int dim{ 0 }; dim < ImageDimension; ++dim)
+      {
+        const SizeValueType length{ paddedSize[dim] };
+        const SizeValueType position{ remainder % length };
+        remainder /= length;
+        offset[dim] = position <= length - 1 - (length - 1) / 2 ? static_cast<double>(position)
+                                                                 : static_cast<double>(position) - length;
+        if (length > 2)
+        {
+          offset[dim] += RefinePeak(value(1 + 2 * dim), peakValue, value(2 + 2 * dim));
+        }
+      }
+    }
+    else
+    {
+      // A product of spectra that vanishes exactly, as for periodic images that need no padding, makes the
+      // whole surface NaN. Normalize the cross-power spectrum on the host instead, leaving such products out.
+      std::vector<ComplexType> spectra(2 * spectrumPixels);
+      this->RunBatch(m_ForwardVkCommon, VkCommon::DirectionEnum::FORWARD, paddedSize, 2, planes, spectra);
+      // The zero frequency holds only the added constants, which would raise the tolerance of the normalization
+      spectra[0] = ComplexType{};
+      spectra[spectrumPixels] = ComplexType{};
+      std::vector<ComplexType> crossPower(spectrumPixels);
+      ComputeNormalizedCrossPower(&spectra[0], &spectra[spectrumPixels], crossPower.data(), spectrumPixels);
+      std::vector<RealType> surface(paddedPixels);
+      this->RunBatch(m_InverseVkCommon, VkCommon::DirectionEnum::INVERSE, paddedSize, 1, surface, crossPower);
+
+      // Search all offsets, up to half the padded size in either direction
+      OffsetType searchCenter;
+      searchCenter.Fill(0);
+      peakValue = FindPeak(surface.data(), paddedSize, searchCenter, paddedSize, offset);
+    }
+  }
+
+  // The fixed region origin corresponds to the moving region origin plus the offset
+  ContinuousIndex<double, ImageDimension> movingIndex;
+  for (unsigned int dim{ 0 }; dim < ImageDimension; ++dim)
+  {
+    movingIndex[dim] = static_cast<double>(movingRegion.GetIndex(dim)) + offset[dim];
+  }
+  typename FixedImageType::PointType fixedPoint;
+  fixedImage->TransformIndexToPhysicalPoint(fixedRegion.GetIndex(), fixedPoint);
+  typename MovingImageType::PointType movingPoint;
+  movingImage->TransformContinuousIndexToPhysicalPoint(movingIndex, movingPoint);
+  VectorType translation;
+  for (unsigned int dim{ 0 }; dim < ImageDimension; ++dim)
+  {
+    translation[dim] = movingPoint[dim] - fixedPoint[dim];
+  }
+
+  itkDynamicCastInDebugMode<VectorObjectType *>(this->ProcessObject::GetOutput(0))->Set(translation);
+  itkDynamicCastInDebugMode<VectorObjectType *>(this->ProcessObject::GetOutput(1))->Set(offset);
+  itkDynamicCastInDebugMode<ConfidenceObjectType *>(this->ProcessObject::GetOutput(2))
+    ->Set(std::min(std::max(peakValue, 0.0), 1.0));
+}
+
+template <typename TFixedImage, typename TMovingImage, typename TRealType>
+void
+VkPhaseCorrelationImageRegistrationMethod<TFixedImage, TMovingImage, TRealType>::ComputeNormalizedCrossPower(
+  const ComplexType * fixedSpectrum,
+  const ComplexType * movingSpectrum,
+  ComplexType *       crossPower,
+  SizeValueType       count)
+{
+  RealType maximumMagnitude{ 0 };
+  for (SizeValueType i{ 0 }; i < count; ++i)
+  {
+    crossPower[i] = std::conj(fixedSpectrum[i]) * movingSpectrum[i];
+    maximumMagnitude = std::max(maximumMagnitude, std::abs(crossPower[i]));
+  }
+  const RealType tolerance{ 1000 * std::numeric_limits<RealType>::epsilon() * maximumMagnitude };
+  for (SizeValueType i{ 0 }; i < count; ++i)
+  {
+    const RealType magnitude{ std::abs(crossPower[i]) };
+    crossPower[i] = magnitude > tolerance ? crossPower[i] / magnitude : ComplexType{};
+  }
+}
+
+template <typename TFixedImage, typename TMovingImage, typename TRealType>
+double
+VkPhaseCorrelationImageRegistrationMethod<TFixedImage, TMovingImage, TRealType>::FindPeak(
+  const RealType *   surface,
+  const SizeType &   paddedSize,
+  const OffsetType & searchCenter,
+  const SizeType &   searchRadius,
+  VectorType &       offset)
+{
+  // Signed offsets searched along each dimension
+  IndexValueType searchStart[ImageDimension];
+  SizeValueType  searchCount[ImageDimension];
+  SizeValueType  strides[ImageDimension];
+  SizeValueType  searchPixels{ 1 };
+  SizeValueType  paddedPixels{ 1 };
+  for (unsigned int dim{ 0 }; dim < ImageDimension; ++dim)
+  {
+    const SizeValueType length{ paddedSize[dim] };
+    if (searchRadius[dim] >= length / 2)
+    {
+      searchStart[dim] = searchCenter[dim] - static_cast<IndexValueType>((length - 1) / 2);
+      searchCount[dim] = length;
+    }
+    else
+    {
+      searchStart[dim] = searchCenter[dim] - static_cast<IndexValueType>(searchRadius[dim]);
+      searchCount[dim] = 2 * searchRadius[dim] + 1;
+    }
+    strides[dim] = paddedPixels;
+    paddedPixels *= length;
+    searchPixels *= searchCount[dim];
+  }
+  const auto wrap = [&paddedSize](const IndexValueType signedPosition, const unsigned int dim) {
+    const auto length{ static_cast<IndexValueType>(paddedSize[dim]) };
+    return static_cast<SizeValueType>((signedPosition % length + length) % length);
+  };
+
+  // Highest value over the searched offsets
+  OffsetType    peakOffset{ searchCenter };
+  SizeValueType peak{ 0 };
+  double        peakValue{ -std::numeric_limits<double>::infinity() };
+  for (SizeValueType i{ 0 }; i < searchPixels; ++i)
+  {
+    OffsetType    candidate;
+    SizeValueType position{ 0 };
+    SizeValueType remainder{ i };
+    for (unsigned int dim{ 0 }; dim < ImageDimension; ++dim)
+    {
+      candidate[dim] = searchStart[dim] + static_cast<IndexValueType>(remainder % searchCount[dim]);
+      remainder /= searchCount[dim];
+      position += wrap(candidate[dim], dim) * strides[dim];
+    }
+    if (static_cast<double>(surface[position]) > peakValue)
+    {
+      peakValue = static_cast<double>(surface[position]);
+      peakOffset = candidate;
+      peak = position;
+    }
+  }
+
+  // Refine by a parabola through the peak and its neighbors along each dimension
+  for (unsigned int dim{ 0 }; dim < ImageDimension; ++dim)
+  {
+    double refinement{ 0.0 };
+    if (paddedSize[dim] > 2)
+    {
+      const SizeValueType lineStart{ peak - wrap(peakOffset[dim], dim) * strides[dim] };
+      const double        previous{ surface[lineStart + wrap(peakOffset[dim] - 1, dim) * strides[dim]] };
+      const double        next{ surface[lineStart + wrap(peakOffset[dim] + 1, dim) * strides[dim]] };
+      refinement = RefinePeak(previous, peakValue, next);
+    }
+    offset[dim] = static_cast<double>(peakOffset[dim]) + refinement;
+  }
+  return peakValue;
+}
+
+template <typename TFixedImage, typename TMovingImage, typename TRealType>
+double
+VkPhaseCorrelationImageRegistrationMethod<TFixedImage, TMovingImage, TRealType>::RefinePeak(double previous,
+                                                                                            double peakValue,
+                                                                                            double next)
+{
+  const double curvature{ previous - 2 * peakValue + next };
+  if (curvature < 0.0)
+  {
+    return std::min(std::max(0.5 * (previous - next) / curvature, -0.5), 0.5);
+  }
+  return 0.0;
+}
+
+template <typename TFixedImage, typename TMovingImage, typename TRealType>
+void
+VkPhaseCorrelationImageRegistrationMethod<TFixedImage, TMovingImage, TRealType>::RunBatch(
+  VkCommon &                 vkCommon,
+  VkCommon::DirectionEnum    direction,
+  const SizeType &           paddedSize,
+  uint64_t                   batches,
+  std::vector<RealType> &    realPlanes,
+  std::vector<ComplexType> & spectra)
+{
+  const bool          forward{ direction == VkCommon::DirectionEnum::FORWARD };
+  const SizeValueType realBytes{ realPlanes.size() * sizeof(RealType) };
+  const SizeValueType spectrumBytes{ spectra.size() * sizeof(ComplexType) };
+
+  // Describe the batched transforms in VkCommon::VkParameters
+  typename VkCommon::VkParameters vkParameters;
+  if (ImageDimension > 0)
+    vkParameters.X = paddedSize[0];
+  if (ImageDimension > 1)
+    vkParameters.Y = paddedSize[1];
+  if (ImageDimension > 2)
+    vkParameters.Z = paddedSize[2];
+  vkParameters.B = batches;
+  if (std::is_same<RealType, float>::value)
+    vkParameters.P = VkCommon::PrecisionEnum::FLOAT;
+  else if (std::is_same<RealType, double>::value)
+    vkParameters.P = VkCommon::PrecisionEnum::DOUBLE;
+  else
+    itkAssertOrThrowMacro(false, "Unsupported type for real numbers.");
+  vkParameters.fft = VkCommon::FFTEnum::R2HalfH;
+  vkParameters.PSize = sizeof(RealType);
+  vkParameters.I = direction;
+  vkParameters.normalized =
+    forward ? VkCommon::NormalizationEnum::UNNORMALIZED : VkCommon::NormalizationEnum::NORMALIZED;
+
+  if (forward)
+  {
+    vkParameters.inputCPUBuffer = realPlanes.data();
+    vkParameters.inputBufferBytes = realBytes;
+    vkParameters.outputCPUBuffer = spectra.data();
+    vkParameters.outputBufferBytes = spectrumBytes;
+  }
+  else
+  {
+    vkParameters.inputCPUBuffer = spectra.data();
+    vkParameters.inputBufferBytes = spectrumBytes;
+    vkParameters.outputCPUBuffer = realPlanes.data();
+    vkParameters.outputBufferBytes = realBytes;
+  }
+
+  // Count this run as outstanding on the device of the plan it reuses,
+  // or else on a device chosen by the scheduling policy
+  const VkDeviceReservation deviceReservation{
+    m_UseVkGlobalConfiguration, m_DeviceID, realBytes + spectrumBytes, vkCommon, vkParameters
+  };
+
+  // Mostly use defaults for VkCommon::VkGPU
+  typename VkCommon::VkGPU vkGPU;
+  vkGPU.device_id = deviceReservation.GetDeviceID();
+  vkGPU.profiling = VkGlobalConfiguration::GetProfiling();
+
+  const VkFFTResult resFFT{ vkCommon.Run(vkGPU, vkParameters) };
+  if (resFFT != VKFFT_SUCCESS)
+  {
+    std::ostringstream mesg;
+    mesg << "VkFFT third-party library failed with error code " << resFFT << ".";
+    itkAssertOrThrowMacro(false, mesg.str());
+  }
+}
+
+template <typename TFixedImage, typename TMovingImage, typename TRealType>
+void
+VkPhaseCorrelationImageRegistrationMethod<TFixedImage, TMovingImage, TRealType>::PrintSelf(std::ostream & os,
+                                                                                           Indent         indent) const
+{
+  Superclass::PrintSelf(os, indent);
+  os << indent << "UseVkGlobalConfiguration: " << m_UseVkGlobalConfiguration << std::endl;
+  os << indent << "Local DeviceID: " << m_DeviceID << std::endl;
+  os << indent << "Global DeviceID: " << VkGlobalConfiguration::GetDeviceID() << std::endl;
+  os << indent << "Preferred DeviceID: " << this->GetDeviceID() << std::endl;
+}
+
+} // end namespace itk
+
+#endif // itkVkPhaseCorrelationImageRegistrationMethod_hxx
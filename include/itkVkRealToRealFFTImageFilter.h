@@ -0,0 +1,164 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         https://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkVkRealToRealFFTImageFilter_h
+#define itkVkRealToRealFFTImageFilter_h
+
+#include "itkComplexToComplexFFTImageFilter.h"
+#include "itkImageToImageFilter.h"
+#include "itkVkAlignedImportImageContainer.h"
+#include "itkVkCommon.h"
+#include "itkVkGlobalConfiguration.h"
+#include "itkVkTimingsReporter.h"
+
+namespace itk
+{
+/**
+ *\class VkRealToRealFFTImageFilter
+ *
+ * \brief Base class for VkFFT discrete cosine and sine transforms of real images.
+ *
+ * The transforms run as VkFFT real-to-real transforms on real buffers of
+ * the image size, without the complex padding needed to compute them from
+ * complex FFTs. Types I to IV are supported, with the unnormalized forward
+ * conventions of FFTW (REDFT00, REDFT10, REDFT01 and REDFT11 for the DCT;
+ * RODFT00, RODFT10, RODFT01 and RODFT11 for the DST). The inverse transform
+ * is normalized so that it recovers the input of the forward transform of
+ * the same type: the inverse of type II is type III and vice versa, and
+ * the other types are their own inverse.
+ *
+ * Subclasses select the family of the transform and whether it runs over all
+ * dimensions or along one direction.
+ *
+ * \ingroup FourierTransform
+ * \ingroup VkFFTBackend
+ *
+ * \sa VkDCTImageFilter
+ * \sa VkDSTImageFilter
+ * \sa VkDCT1DImageFilter
+ * \sa VkDST1DImageFilter
+ */
+template <typename TImage>
+class VkRealToRealFFTImageFilter
+  : public ImageToImageFilter<TImage, TImage>
+  , public VkTimingsReporter
+{
+public:
+  ITK_DISALLOW_COPY_AND_MOVE(VkRealToRealFFTImageFilter);
+
+  using InputImageType = TImage;
+  using OutputImageType = TImage;
+  static_assert(std::is_same<typename TImage::PixelType, float>::value ||
+                  std::is_same<typename TImage::PixelType, double>::value,
+                "Unsupported pixel type");
+  static_assert(TImage::ImageDimension >= 1 && TImage::ImageDimension <= 3, "Unsupported image dimension");
+
+  /** Standard class type aliases. */
+  using Self = VkRealToRealFFTImageFilter;
+  using Superclass = ImageToImageFilter<InputImageType, OutputImageType>;
+  using Pointer = SmartPointer<Self>;
+  using ConstPointer = SmartPointer<const Self>;
+
+  using PixelType = typename InputImageType::PixelType;
+  using SizeType = typename InputImageType::SizeType;
+  using SizeValueType = typename InputImageType::SizeValueType;
+  using TransformDirectionEnum = ComplexToComplexFFTImageFilterEnums::TransformDirection;
+
+  /** Run-time type information (and related methods). */
+  itkOverrideGetNameOfClassMacro(VkRealToRealFFTImageFilter);
+
+  static constexpr unsigned int ImageDimension{ InputImageType::ImageDimension };
+
+  /** Type of the transform, from 1 to 4. Defaults to 2. */
+  itkSetClampMacro(Type, unsigned int, 1, 4);
+  itkGetConstMacro(Type, unsigned int);
+
+  /** Whether to compute the forward transform or its normalized inverse. */
+  itkSetEnumMacro(TransformDirection, TransformDirectionEnum);
+  itkGetConstMacro(TransformDirection, TransformDirectionEnum);
+
+  /** Determine whether local or global properties will be
+   *  referenced for setting up GPU acceleration. */
+  itkSetMacro(UseVkGlobalConfiguration, bool);
+  itkGetMacro(UseVkGlobalConfiguration, bool);
+
+  /** Local setting for enumerated GPU device to use for FFT.
+   *  Ignored if `UseVkGlobalConfiguration` is true. */
+  itkSetMacro(DeviceID, uint64_t);
+
+  /** Return the enumerated GPU device to use for FFT
+   *  according to current filter settings. With the global
+   *  configuration, runs are placed on devices by its scheduling
+   *  policy, which is this device only for the FIXED policy. */
+  uint64_t
+  GetDeviceID() const
+  {
+    return uint64_t{ m_UseVkGlobalConfiguration ? VkGlobalConfiguration::GetDeviceID() : m_DeviceID };
+  }
+
+  SizeValueType
+  GetSizeGreatestPrimeFactor() const
+  {
+    return SizeValueType{ m_VkCommon.GetGreatestPrimeFactor() };
+  }
+
+protected:
+  /** `sine` selects the DST rather than the DCT family. `oneDimensional`
+   *  restricts the transform to the dimension given by m_Direction. */
+  VkRealToRealFFTImageFilter(bool sine, bool oneDimensional);
+  ~VkRealToRealFFTImageFilter() override = default;
+
+  /** The whole input is needed to compute the transform. */
+  void
+  GenerateInputRequestedRegion() override;
+
+  void
+  EnlargeOutputRequestedRegion(DataObject * output) override;
+
+  void
+  GenerateData() override;
+
+  void
+  PrintSelf(std::ostream & os, Indent indent) const override;
+
+  /** Logical size of a transform of the given length, by which the
+   *  inverse transform along that dimension is divided. */
+  double
+  GetLogicalSize(SizeValueType length) const;
+
+  /** Dimension transformed by one-dimensional subclasses. */
+  unsigned int m_Direction{ 0 };
+
+private:
+  const bool             m_Sine;
+  const bool             m_OneDimensional;
+  unsigned int           m_Type{ 2 };
+  TransformDirectionEnum m_TransformDirection{ TransformDirectionEnum::FORWARD };
+
+  bool     m_UseVkGlobalConfiguration{ true };
+  uint64_t m_DeviceID{ 0UL };
+
+  VkCommon m_VkCommon{};
+};
+
+} // namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#  include "itkVkRealToRealFFTImageFilter.hxx"
+#endif
+
+#endif // itkVkRealToRealFFTImageFilter_h
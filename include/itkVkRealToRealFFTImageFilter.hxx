@@ -0,0 +1,204 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         https://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkVkRealToRealFFTImageFilter_hxx
+#define itkVkRealToRealFFTImageFilter_hxx
+
+#include "itkVkRealToRealFFTImageFilter.h"
+#include "itkVkTracer.h"
+#include "itkIndent.h"
+#include "itkProgressReporter.h"
+
+#include <iostream>
+
+namespace itk
+{
+
+template <typename TImage>
+VkRealToRealFFTImageFilter<TImage>::VkRealToRealFFTImageFilter(bool sine, bool oneDimensional)
+  : VkTimingsReporter{ &m_VkCommon }
+  , m_Sine{ sine }
+  , m_OneDimensional{ oneDimensional }
+{}
+
+template <typename TImage>
+void
+VkRealToRealFFTImageFilter<TImage>::GenerateInputRequestedRegion()
+{
+  Superclass::GenerateInputRequestedRegion();
+
+  const typename InputImageType::Pointer input{ const_cast<InputImageType *>(this->GetInput()) };
+  if (input)
+  {
+    input->SetRequestedRegionToLargestPossibleRegion();
+  }
+}
+
+template <typename TImage>
+void
+VkRealToRealFFTImageFilter<TImage>::EnlargeOutputRequestedRegion(DataObject * output)
+{
+  Superclass::EnlargeOutputRequestedRegion(output);
+  output->SetRequestedRegionToLargestPossibleRegion();
+}
+
+template <typename TImage>
+void
+VkRealToRealFFTImageFilter<TImage>::GenerateData()
+{
+  const VkTraceScope traceScope{ this->GetNameOfClass(), "GenerateData", this->GetDeviceID() };
+
+  // get pointers to the input and output
+  const InputImageType * const input{ this->GetInput() };
+  OutputImageType * const      output{ this->GetOutput() };
+
+  if (!input || !output)
+  {
+    return;
+  }
+
+  itkAssertOrThrowMacro(!m_OneDimensional || m_Direction < ImageDimension, "Direction must be less than dimension");
+
+  // we don't have a nice progress to report, but at least this simple line
+  // reports the beginning and the end of the process
+  const ProgressReporter progress(this, 0, 1);
+
+  // allocate output buffer memory, aligned for use in place by the device
+  AllocateVkAlignedBuffer(output, this->GetDeviceID());
+
+  const SizeType & inputSize{ input->GetLargestPossibleRegion().GetSize() };
+  for (unsigned int dim{ 0 }; dim < ImageDimension; ++dim)
+  {
+    const bool transformed{ !m_OneDimensional || m_Direction == dim };
+    itkAssertOrThrowMacro(!transformed || m_Sine || m_Type != 1 || inputSize[dim] > 1,
+                          "DCT-I requires at least two samples");
+  }
+
+  const PixelType * const inputCPUBuffer{ input->GetBufferPointer() };
+  PixelType * const       outputCPUBuffer{ output->GetBufferPointer() };
+  itkAssertOrThrowMacro(inputCPUBuffer != nullptr, "No CPU input buffer");
+  itkAssertOrThrowMacro(outputCPUBuffer != nullptr, "No CPU output buffer");
+  const SizeValueType bytes{ input->GetLargestPossibleRegion().GetNumberOfPixels() * sizeof(PixelType) };
+
+  // Describe this filter in VkCommon::VkParameters
+  typename VkCommon::VkParameters vkParameters;
+  if (ImageDimension > 0)
+    vkParameters.X = inputSize[0];
+  if (ImageDimension > 1)
+    vkParameters.Y = inputSize[1];
+  if (ImageDimension > 2)
+    vkParameters.Z = inputSize[2];
+  if (std::is_same<PixelType, float>::value)
+    vkParameters.P = VkCommon::PrecisionEnum::FLOAT;
+  else if (std::is_same<PixelType, double>::value)
+    vkParameters.P = VkCommon::PrecisionEnum::DOUBLE;
+  else
+    itkAssertOrThrowMacro(false, "Unsupported type for real numbers.");
+  vkParameters.fft = VkCommon::FFTEnum::R2R;
+  vkParameters.r2r = static_cast<VkCommon::R2REnum>((m_Sine ? 10 : 0) + m_Type);
+  vkParameters.PSize = sizeof(PixelType);
+  vkParameters.I = m_TransformDirection == TransformDirectionEnum::INVERSE ? VkCommon::DirectionEnum::INVERSE
+                                                                           : VkCommon::DirectionEnum::FORWARD;
+  // The inverse is normalized below with the logical sizes of the FFTW conventions
+  vkParameters.normalized = VkCommon::NormalizationEnum::UNNORMALIZED;
+  if (m_OneDimensional)
+  {
+    for (unsigned int dim{ 0 }; dim < ImageDimension; ++dim)
+    {
+      if (m_Direction != dim)
+      {
+        vkParameters.omitDimension[dim] = 1; // omit dimensions other than in the given direction.
+      }
+    }
+  }
+
+  vkParameters.inputCPUBuffer = inputCPUBuffer;
+  vkParameters.inputBufferBytes = bytes;
+  vkParameters.outputCPUBuffer = outputCPUBuffer;
+  vkParameters.outputBufferBytes = bytes;
+
+  // Count this run as outstanding on the device of the plan it reuses,
+  // or else on a device chosen by the scheduling policy
+  const VkDeviceReservation deviceReservation{
+    m_UseVkGlobalConfiguration, m_DeviceID, 2 * bytes, m_VkCommon, vkParameters
+  };
+
+  // Mostly use defaults for VkCommon::VkGPU
+  typename VkCommon::VkGPU vkGPU;
+  vkGPU.device_id = deviceReservation.GetDeviceID();
+  vkGPU.profiling = VkGlobalConfiguration::GetProfiling();
+
+  const VkFFTResult resFFT{ m_VkCommon.Run(vkGPU, vkParameters) };
+  if (resFFT != VKFFT_SUCCESS)
+  {
+    std::ostringstream mesg;
+    mesg << "VkFFT third-party library failed with error code " << resFFT << ".";
+    itkAssertOrThrowMacro(false, mesg.str());
+  }
+
+  if (m_TransformDirection == TransformDirectionEnum::INVERSE)
+  {
+    double logicalSize{ 1.0 };
+    for (unsigned int dim{ 0 }; dim < ImageDimension; ++dim)
+    {
+      if (!m_OneDimensional || m_Direction == dim)
+      {
+        logicalSize *= this->GetLogicalSize(inputSize[dim]);
+      }
+    }
+    const PixelType     scale{ static_cast<PixelType>(1.0 / logicalSize) };
+    const SizeValueType numberOfPixels{ output->GetLargestPossibleRegion().GetNumberOfPixels() };
+    for (SizeValueType i{ 0 }; i < numberOfPixels; ++i)
+    {
+      outputCPUBuffer[i] *= scale;
+    }
+  }
+}
+
+template <typename TImage>
+double
+VkRealToRealFFTImageFilter<TImage>::GetLogicalSize(SizeValueType length) const
+{
+  // Size of the equivalent real-even or real-odd DFT, as in FFTW
+  if (m_Type == 1)
+  {
+    return 2.0 * (m_Sine ? static_cast<double>(length) + 1.0 : static_cast<double>(length) - 1.0);
+  }
+  return 2.0 * static_cast<double>(length);
+}
+
+template <typename TImage>
+void
+VkRealToRealFFTImageFilter<TImage>::PrintSelf(std::ostream & os, Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+  os << indent << "Family: " << (m_Sine ? "DST" : "DCT") << std::endl;
+  os << indent << "Type: " << m_Type << std::endl;
+  os << indent << "TransformDirection: " << m_TransformDirection << std::endl;
+  if (m_OneDimensional)
+  {
+    os << indent << "Direction: " << m_Direction << std::endl;
+  }
+  os << indent << "UseVkGlobalConfiguration: " << m_UseVkGlobalConfiguration << std::endl;
+  os << indent << "Local DeviceID: " << m_DeviceID << std::endl;
+  os << indent << "Global DeviceID: " << VkGlobalConfiguration::GetDeviceID() << std::endl;
+  os << indent << "Preferred DeviceID: " << this->GetDeviceID() << std::endl;
+}
+
+} // end namespace itk
+
+#endif // itkVkRealToRealFFTImageFilter_hxx
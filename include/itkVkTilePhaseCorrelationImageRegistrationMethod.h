@@ -0,0 +1,245 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         https://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkVkTilePhaseCorrelationImageRegistrationMethod_h
+#define itkVkTilePhaseCorrelationImageRegistrationMethod_h
+
+#include "itkImage.h"
+#include "itkMath.h"
+#include "itkProcessObject.h"
+#include "itkSimpleDataObjectDecorator.h"
+#include "itkVkCommon.h"
+#include "itkVkGlobalConfiguration.h"
+#include "itkVkPhaseCorrelationImageRegistrationMethod.h"
+#include "itkVkTimingsReporter.h"
+
+#include <complex>
+#include <vector>
+
+namespace itk
+{
+/**
+ *\class VkTilePhaseCorrelationImageRegistrationMethod
+ *
+ * \brief Estimates the translations of many pairs of tiles by phase correlation.
+ *
+ * Mosaics are stitched from the translations between overlapping tiles of
+ * one size. The pairs are correlated in batches of MaximumBatchSize, each
+ * in one VkFFT convolution run that shares a plan with the others: the
+ * tiles of the pairs, less their means and padded to a size fast for
+ * VkFFT, are transformed on the device, their cross-power spectra are
+ * normalized to unit magnitude and inverse transformed, and the peak of
+ * each phase correlation surface is found within its search window. Only
+ * the peaks and their neighbors are copied back, and the memory taken on
+ * the host and on the device is bounded by the batch size rather than by
+ * the number of tiles.
+ *
+ * Each pair names a fixed and a moving tile and the nominal offset of
+ * their overlap, such as given by the stage positions, as the translation
+ * in pixels from points of the fixed tile to the corresponding points of
+ * the moving tile. For a moving tile that starts D pixels into the fixed
+ * tile, the nominal offset is -D. The peak of the phase correlation
+ * surface is searched within SearchRadius of the nominal offset, which
+ * resolves the wrap-around ambiguity of phase correlation, and refined to
+ * subpixel precision as by VkPhaseCorrelationImageRegistrationMethod,
+ * along the dimensions where its neighbors lie within the window. Pairs
+ * whose surface is not finite, because a product of their spectra
+ * vanishes exactly, are correlated again with the cross-power spectrum
+ * normalized on the host, and pairs with a constant tile keep their
+ * nominal offset with a confidence of 0.
+ *
+ * The result is a table with, for each pair, the offset in pixels and the
+ * height of the phase correlation peak as a confidence.
+ *
+ * \ingroup FourierTransform
+ * \ingroup VkFFTBackend
+ *
+ * \sa VkPhaseCorrelationImageRegistrationMethod
+ * \sa VkGlobalConfiguration
+ */
+template <typename TImage, typename TRealType = float>
+class VkTilePhaseCorrelationImageRegistrationMethod
+  : public ProcessObject
+  , public VkTimingsReporter
+{
+public:
+  ITK_DISALLOW_COPY_AND_MOVE(VkTilePhaseCorrelationImageRegistrationMethod);
+
+  using ImageType = TImage;
+  static_assert(std::is_same<TRealType, float>::value || std::is_same<TRealType, double>::value,
+                "Unsupported precision");
+  static_assert(TImage::ImageDimension >= 1 && TImage::ImageDimension <= 3, "Unsupported image dimension");
+
+  /** Standard class type aliases. */
+  using Self = VkTilePhaseCorrelationImageRegistrationMethod;
+  using Superclass = ProcessObject;
+  using Pointer = SmartPointer<Self>;
+  using ConstPointer = SmartPointer<const Self>;
+
+  using PairRegistrationType = VkPhaseCorrelationImageRegistrationMethod<ImageType, ImageType, TRealType>;
+  using RealType = typename PairRegistrationType::RealType;
+  using ComplexType = typename PairRegistrationType::ComplexType;
+  using SizeType = typename PairRegistrationType::SizeType;
+  using SizeValueType = typename PairRegistrationType::SizeValueType;
+  using OffsetType = typename PairRegistrationType::OffsetType;
+  using VectorType = typename PairRegistrationType::VectorType;
+
+  static constexpr unsigned int ImageDimension{ ImageType::ImageDimension };
+
+  /** Tiles to register and the nominal offset of their overlap. */
+  struct TilePair
+  {
+    unsigned int fixedTile{ 0 };
+    unsigned int movingTile{ 0 };
+    OffsetType   nominalOffset{};
+  };
+
+  /** Estimated translation of one pair. */
+  struct TilePairResult
+  {
+    VectorType offset{}; // Translation in pixels from the fixed to the moving tile
+    double     confidence{ 0.0 };
+
+    bool
+    operator==(const TilePairResult & other) const
+    {
+      return offset == other.offset && Math::ExactlyEquals(confidence, other.confidence);
+    }
+  };
+  using ResultTableType = std::vector<TilePairResult>;
+  using ResultTableObjectType = SimpleDataObjectDecorator<ResultTableType>;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkOverrideGetNameOfClassMacro(VkTilePhaseCorrelationImageRegistrationMethod);
+
+  /** Set tile image N. All tiles have the same size. */
+  void
+  SetTileImage(unsigned int n, const ImageType * tile);
+
+  const ImageType *
+  GetTileImage(unsigned int n) const;
+
+  /** Number of tile images. Reducing it removes the last ones. */
+  void
+  SetNumberOfTileImages(unsigned int numberOfTiles);
+
+  unsigned int
+  GetNumberOfTileImages() const;
+
+  /** Pairs of tiles to register, which give the entries of the result table. */
+  void
+  AddTilePair(unsigned int fixedTile, unsigned int movingTile, const OffsetType & nominalOffset);
+
+  void
+  ClearTilePairs();
+
+  const std::vector<TilePair> &
+  GetTilePairs() const
+  {
+    return m_TilePairs;
+  }
+
+  /** Largest difference in pixels along each dimension between the nominal
+   *  and the estimated offset of a pair. By default, all offsets up to half
+   *  the padded tile size are searched. */
+  itkSetMacro(SearchRadius, SizeType);
+  itkGetConstReferenceMacro(SearchRadius, SizeType);
+
+  /** Largest number of pairs in one VkFFT run. 64 by default. */
+  itkSetClampMacro(MaximumBatchSize, SizeValueType, 1, NumericTraits<SizeValueType>::max());
+  itkGetConstMacro(MaximumBatchSize, SizeValueType);
+
+  /** Estimated translation of each pair of the last update. */
+  const ResultTableType &
+  GetResults() const
+  {
+    return this->GetResultsOutput()->Get();
+  }
+
+  const ResultTableObjectType *
+  GetResultsOutput() const
+  {
+    return itkDynamicCastInDebugMode<const ResultTableObjectType *>(this->ProcessObject::GetOutput(0));
+  }
+
+  /** Determine whether local or global properties will be
+   *  referenced for setting up GPU acceleration. */
+  itkSetMacro(UseVkGlobalConfiguration, bool);
+  itkGetMacro(UseVkGlobalConfiguration, bool);
+
+  /** Local setting for enumerated GPU device to use for FFT.
+   *  Ignored if `UseVkGlobalConfiguration` is true. */
+  itkSetMacro(DeviceID, uint64_t);
+
+  /** Return the enumerated GPU device to use for FFT
+   *  according to current filter settings. With the global
+   *  configuration, runs are placed on devices by its scheduling
+   *  policy, which is this device only for the FIXED policy. */
+  uint64_t
+  GetDeviceID() const
+  {
+    return uint64_t{ m_UseVkGlobalConfiguration ? VkGlobalConfiguration::GetDeviceID() : m_DeviceID };
+  }
+
+protected:
+  VkTilePhaseCorrelationImageRegistrationMethod();
+  ~VkTilePhaseCorrelationImageRegistrationMethod() override = default;
+
+  using Superclass::MakeOutput;
+  DataObjectPointer
+  MakeOutput(DataObjectPointerArraySizeType idx) override;
+
+  void
+  GenerateData() override;
+
+  void
+  PrintSelf(std::ostream & os, Indent indent) const override;
+
+  /** Run `batches` transforms of `paddedSize` between the real and half
+   *  Hermitian buffers, in the given direction. */
+  void
+  RunBatch(VkCommon &              vkCommon,
+           VkCommon::DirectionEnum direction,
+           const SizeType &        paddedSize,
+           uint64_t                batches,
+           RealType *              realPlanes,
+           ComplexType *           spectra);
+
+private:
+  std::vector<TilePair> m_TilePairs{};
+  SizeType              m_SearchRadius{};
+  SizeValueType         m_MaximumBatchSize{ 64 };
+
+  bool     m_UseVkGlobalConfiguration{ true };
+  uint64_t m_DeviceID{ 0UL };
+
+  VkCommon m_VkCommon{};
+  // Plans of the forward and inverse runs of the pairs whose device normalization gives NaN
+  VkCommon m_ForwardVkCommon{};
+  VkCommon m_InverseVkCommon{};
+};
+
+} // namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#  include "itkVkTilePhaseCorrelationImageRegistrationMethod.hxx"
+#endif
+
+#endif // itkVkTilePhaseCorrelationImageRegistrationMethod_h
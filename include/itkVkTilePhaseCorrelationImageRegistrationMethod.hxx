@@ -0,0 +1,540 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         https://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkVkTilePhaseCorrelationImageRegistrationMethod_hxx
+#define itkVkTilePhaseCorrelationImageRegistrationMethod_hxx
+
+#include "itkVkTilePhaseCorrelationImageRegistrationMethod.h"
+#include "itkVkTracer.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
+#include "itkIndent.h"
+#include "itkProgressReporter.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <limits>
+
+namespace itk
+{
+
+template <typename TImage, typename TRealType>
+VkTilePhaseCorrelationImageRegistrationMethod<TImage, TRealType>::VkTilePhaseCorrelationImageRegistrationMethod()
+  : VkTimingsReporter{ &m_VkCommon, &m_ForwardVkCommon, &m_InverseVkCommon }
+{
+  m_SearchRadius.Fill(NumericTraits<SizeValueType>::max());
+
+  this->SetNumberOfRequiredInputs(1);
+  this->SetNumberOfRequiredOutputs(1);
+  this->ProcessObject::SetNthOutput(0, this->MakeOutput(0));
+}
+
+template <typename TImage, typename TRealType>
+void
+VkTilePhaseCorrelationImageRegistrationMethod<TImage, TRealType>::SetTileImage(unsigned int n, const ImageType * tile)
+{
+  if (n >= this->GetNumberOfTileImages())
+  {
+    this->SetNumberOfTileImages(n + 1);
+  }
+  this->SetNthInput(n, const_cast<ImageType *>(tile));
+}
+
+template <typename TImage, typename TRealType>
+auto
+VkTilePhaseCorrelationImageRegistrationMethod<TImage, TRealType>::GetTileImage(unsigned int n) const
+  -> const ImageType *
+{
+  if (n >= this->GetNumberOfTileImages())
+  {
+    return nullptr;
+  }
+  return itkDynamicCastInDebugMode<const ImageType *>(this->ProcessObject::GetInput(n));
+}
+
+template <typename TImage, typename TRealType>
+void
+VkTilePhaseCorrelationImageRegistrationMethod<TImage, TRealType>::SetNumberOfTileImages(unsigned int numberOfTiles)
+{
+  if (numberOfTiles == this->GetNumberOfTileImages())
+  {
+    return;
+  }
+  this->SetNumberOfIndexedInputs(numberOfTiles);
+  this->Modified();
+}
+
+template <typename TImage, typename TRealType>
+unsigned int
+VkTilePhaseCorrelationImageRegistrationMethod<TImage, TRealType>::GetNumberOfTileImages() const
+{
+  return static_cast<unsigned int>(this->GetNumberOfIndexedInputs());
+}
+
+template <typename TImage, typename TRealType>
+void
+VkTilePhaseCorrelationImageRegistrationMethod<TImage, TRealType>::AddTilePair(unsigned int       fixedTile,
+                                                                       unsigned int       movingTile,
+                                                                       const OffsetType & nominalOffset)
+{
+  m_TilePairs.push_back(TilePair{ fixedTile, movingTile, nominalOffset });
+  this->Modified();
+}
+
+template <typename TImage, typename TRealType>
+void
+VkTilePhaseCorrelationImageRegistrationMethod<TImage, TRealType>::ClearTilePairs()
+{
+  if (!m_TilePairs.empty())
+  {
+    m_TilePairs.clear();
+    this->Modified();
+  }
+}
+
+template <typename TImage, typename TRealType>
+auto
+VkTilePhaseCorrelationImageRegistrationMethod<TImage, TRealType>::MakeOutput(DataObjectPointerArraySizeType)
+  -> DataObjectPointer
+{
+  return ResultTableObjectType::New().GetPointer();
+}
+
+template <typename TImage, typename TRealType>
+void
+VkTilePhaseCorrelationImageRegistrationMethod<TImage, TRealType>::GenerateData()
+{
+  const VkTraceScope traceScope{ this->GetNameOfClass(), "GenerateData", this->GetDeviceID() };
+
+  const unsigned int numberOfTiles{ this->GetNumberOfTileImages() };
+  const auto         numberOfPairs{ static_cast<SizeValueType>(m_TilePairs.size()) };
+  itkAssertOrThrowMacro(numberOfTiles > 0, "No tile images");
+  const SizeType tileSize{ this->GetTileImage(0)->GetLargestPossibleRegion().GetSize() };
+  for (unsigned int n{ 0 }; n < numberOfTiles; ++n)
+  {
+    itkAssertOrThrowMacro(this->GetTileImage(n) != nullptr, "Missing tile image");
+    itkAssertOrThrowMacro(this->GetTileImage(n)->GetLargestPossibleRegion().GetSize() == tileSize,
+                          "Tile images differ in size");
+  }
+  for (const TilePair & pair : m_TilePairs)
+  {
+    itkAssertOrThrowMacro(pair.fixedTile < numberOfTiles && pair.movingTile < numberOfTiles,
+                          "Tile pair refers to a missing tile image");
+  }
+
+  const ProgressReporter progress(this, 0, 1);
+
+  ResultTableType results(numberOfPairs);
+  if (numberOfPairs == 0)
+  {
+    itkDynamicCastInDebugMode<ResultTableObjectType *>(this->ProcessObject::GetOutput(0))->Set(results);
+    return;
+  }
+
+  const VkCommon::PrecisionEnum precision{ std::is_same<RealType, double>::value ? VkCommon::PrecisionEnum::DOUBLE
+                                                                                  : VkCommon::PrecisionEnum::FLOAT };
+  SizeType                      paddedSize;
+  SizeValueType                 strides[ImageDimension];
+  SizeValueType                 paddedPixels{ 1 };
+  for (unsigned int dim{ 0 }; dim < ImageDimension; ++dim)
+  {
+    paddedSize[dim] = VkCommon::GetOptimalFFTSize(
+      tileSize[dim], precision, dim == 0 ? VkCommon::FFTEnum::R2HalfH : VkCommon::FFTEnum::C2C);
+    strides[dim] = paddedPixels;
+    paddedPixels *= paddedSize[dim];
+  }
+  const SizeValueType spectrumPixels{ paddedPixels / paddedSize[0] * (paddedSize[0] / 2 + 1) };
+
+  // The mean of each tile, and the constant that stands in for it at the zero frequency as in
+  // VkPhaseCorrelationImageRegistrationMethod: a power of two of the scale of the tile, or 0 for a constant
+  // tile, which has no phase to correlate
+  std::vector<double> means(numberOfTiles);
+  std::vector<double> constants(numberOfTiles);
+  for (unsigned int n{ 0 }; n < numberOfTiles; ++n)
+  {
+    const ImageType * const tile{ this->GetTileImage(n) };
+    const auto &            region{ tile->GetLargestPossibleRegion() };
+    const auto              pixels{ static_cast<double>(region.GetNumberOfPixels()) };
+    for (ImageRegionConstIteratorWithIndex<ImageType> it(tile, region); !it.IsAtEnd(); ++it)
+    {
+      means[n] += static_cast<double>(it.Get());
+    }
+    means[n] /= pixels;
+    double sumOfSquares{ 0.0 };
+    for (ImageRegionConstIteratorWithIndex<ImageType> it(tile, region); !it.IsAtEnd(); ++it)
+    {
+      sumOfSquares += (static_cast<double>(it.Get()) - means[n]) * (static_cast<double>(it.Get()) - means[n]);
+    }
+    constants[n] = sumOfSquares > 0.0 ? std::exp2(std::round(std::log2(std::sqrt(sumOfSquares / pixels)))) : 0.0;
+  }
+
+  // Copy a tile less its mean, so that the zero padding adds no edge, plus its constant over the padded plane
+  const auto fillPlane = [&](unsigned int n, RealType * plane) {
+    std::fill_n(plane, paddedPixels, static_cast<RealType>(constants[n]));
+    const ImageType * const tile{ this->GetTileImage(n) };
+    const auto &            region{ tile->GetLargestPossibleRegion() };
+    for (ImageRegionConstIteratorWithIndex<ImageType> it(tile, region); !it.IsAtEnd(); ++it)
+    {
+      SizeValueType offset{ 0 };
+      for (unsigned int dim{ 0 }; dim < ImageDimension; ++dim)
+      {
+        offset += static_cast<SizeValueType>(it.GetIndex()[dim] - region.GetIndex(dim)) * strides[dim];
+      }
+      plane[offset] = static_cast<RealType>(static_cast<double>(it.Get()) - means[n] + constants[n]);
+    }
+  };
+
+  // Pairs with a constant tile keep their nominal offset; the others are correlated on the device
+  std::vector<SizeValueType> devicePairs;
+  for (SizeValueType p{ 0 }; p < numberOfPairs; ++p)
+  {
+    if (constants[m_TilePairs[p].fixedTile] > 0.0 && constants[m_TilePairs[p].movingTile] > 0.0)
+    {
+      devicePairs.push_back(p);
+    }
+    else
+    {
+      for (unsigned int dim{ 0 }; dim < ImageDimension; ++dim)
+      {
+        results[p].offset[dim] = static_cast<double>(m_TilePairs[p].nominalOffset[dim]);
+      }
+    }
+  }
+  if (devicePairs.size() < numberOfPairs)
+  {
+    itkWarningMacro("A constant tile has no phase to correlate. Its pairs keep their nominal offset with a "
+                    "Confidence of 0.");
+  }
+
+  // The signed offsets searched around a nominal offset along each dimension, as by FindPeak
+  const auto wrap = [&paddedSize](const IndexValueType signedPosition, const unsigned int dim) {
+    const auto length{ static_cast<IndexValueType>(paddedSize[dim]) };
+    return static_cast<SizeValueType>((signedPosition % length + length) % length);
+  };
+  const auto searchStart = [&](const OffsetType & nominalOffset, const unsigned int dim) {
+    return nominalOffset[dim] - static_cast<IndexValueType>(m_SearchRadius[dim] >= paddedSize[dim] / 2
+                                                              ? (paddedSize[dim] - 1) / 2
+                                                              : m_SearchRadius[dim]);
+  };
+  const auto isSearched = [&](const OffsetType & nominalOffset, const unsigned int dim, const IndexValueType position) {
+    return m_SearchRadius[dim] >= paddedSize[dim] / 2 ||
+           wrap(position - searchStart(nominalOffset, dim), dim) <= 2 * m_SearchRadius[dim];
+  };
+
+  // Correlate the pairs in batches of the same size, so that they share a plan; the last batch is completed
+  // with empty planes. Each run transforms the moving tiles as the input and the fixed tiles as a kernel for
+  // each batch, normalizes their products to unit magnitude and finds the peak of each surface within the
+  // search window on the device, so that only the peaks and their neighbors are copied back.
+  const double               constantTerm{ 1.0 / static_cast<double>(paddedPixels) };
+  std::vector<SizeValueType> fallbackPairs;
+  const SizeValueType        pairBatch{ std::min<SizeValueType>(m_MaximumBatchSize, devicePairs.size()) };
+  if (pairBatch > 0)
+  {
+    const SizeValueType stageBytes{ pairBatch * (sizeof(uint64_t) + VkCommon::MaximumStageValues * sizeof(RealType)) };
+    std::vector<uint64_t>  stageOutput((stageBytes + sizeof(uint64_t) - 1) / sizeof(uint64_t));
+    const uint64_t * const indices{ stageOutput.data() };
+    const RealType * const maxima{ reinterpret_cast<const RealType *>(indices + pairBatch) };
+    std::vector<RealType>  fixedPlanes(pairBatch * paddedPixels);
+    std::vector<RealType>  movingPlanes(pairBatch * paddedPixels);
+    for (SizeValueType first{ 0 }; first < devicePairs.size(); first += pairBatch)
+    {
+      const SizeValueType pairsInBatch{ std::min<SizeValueType>(pairBatch, devicePairs.size() - first) };
+      std::fill(fixedPlanes.begin() + pairsInBatch * paddedPixels, fixedPlanes.end(), RealType{ 0 });
+      std::fill(movingPlanes.begin() + pairsInBatch * paddedPixels, movingPlanes.end(), RealType{ 0 });
+
+      // Weight planes of the search windows of the distinct nominal offsets of the batch: 1 within the
+      // window and 0 beyond
+      std::vector<OffsetType> windowOffsets;
+      std::vector<uint64_t>   weightPlanes(pairBatch, 0);
+      std::vector<RealType>   weights;
+      for (SizeValueType k{ 0 }; k < pairsInBatch; ++k)
+      {
+        const TilePair & pair{ m_TilePairs[devicePairs[first + k]] };
+        fillPlane(pair.fixedTile, &fixedPlanes[k * paddedPixels]);
+        fillPlane(pair.movingTile, &movingPlanes[k * paddedPixels]);
+        const auto windowIt{ std::find(windowOffsets.cbegin(), windowOffsets.cend(), pair.nominalOffset) };
+        weightPlanes[k] = static_cast<uint64_t>(windowIt - windowOffsets.cbegin());
+        if (windowIt != windowOffsets.cend())
+        {
+          continue;
+        }
+        windowOffsets.push_back(pair.nominalOffset);
+        const SizeValueType planeStart{ weights.size() };
+        weights.resize(planeStart + paddedPixels, RealType{ 0 });
+        for (SizeValueType j{ 0 }; j < paddedPixels; ++j)
+        {
+          bool          searched{ true };
+          SizeValueType remainder{ j };
+          for (unsigned int dim{ 0 }; dim < ImageDimension; ++dim)
+          {
+            searched = searched && isSearched(pair.nominalOffset,
+                                              dim,
+                                              static_cast<IndexValueType>(remainder % paddedSize[dim]));
+            remainder /= paddedSize[dim];
+          }
+          weights[planeStart + j] = searched ? RealType{ 1 } : RealType{ 0 };
+        }
+      }
+
+      // Describe the correlation of the pairs in VkCommon::VkParameters
+      typename VkCommon::VkParameters vkParameters;
+      if (ImageDimension > 0)
+        vkParameters.X = paddedSize[0];
+      if (ImageDimension > 1)
+        vkParameters.Y = paddedSize[1];
+      if (ImageDimension > 2)
+        vkParameters.Z = paddedSize[2];
+      vkParameters.B = pairBatch;
+      vkParameters.P = precision;
+      vkParameters.fft = VkCommon::FFTEnum::R2HalfH;
+      vkParameters.PSize = sizeof(RealType);
+      vkParameters.I = VkCommon::DirectionEnum::FORWARD;
+      vkParameters.normalized = VkCommon::NormalizationEnum::NORMALIZED;
+      vkParameters.convolution = true;
+      vkParameters.numberOfKernels = 1;
+      vkParameters.conjugateKernel = true;
+      vkParameters.normalizeProducts = true;
+      vkParameters.transformKernel = true;
+      vkParameters.kernelPerBatch = true;
+      vkParameters.kernelCPUBuffer = fixedPlanes.data();
+      vkParameters.kernelBufferBytes = fixedPlanes.size() * sizeof(RealType);
+      vkParameters.inputCPUBuffer = movingPlanes.data();
+      vkParameters.inputBufferBytes = movingPlanes.size() * sizeof(RealType);
+      vkParameters.outputCPUBuffer = stageOutput.data();
+      vkParameters.outputBufferBytes = stageBytes;
+      vkParameters.outputStage = VkCommon::OutputStageEnum::MAXIMUM;
+      for (unsigned int dim{ 0 }; dim < ImageDimension; ++dim)
+      {
+        vkParameters.stageOutputSize[dim] = paddedSize[dim];
+      }
+      vkParameters.stageWeightsCPUBuffer = weights.data();
+      vkParameters.stageWeightsBufferBytes = weights.size() * sizeof(RealType);
+      vkParameters.stageWeightPlanes = weightPlanes.data();
+
+      // Count this run as outstanding on the device of the plan it reuses, or else on a device chosen by the
+      // scheduling policy. The device holds the real tiles, their spectra, the surfaces and the windows.
+      const VkDeviceReservation deviceReservation{ m_UseVkGlobalConfiguration,
+                                                   m_DeviceID,
+                                                   3 * pairBatch * paddedPixels * sizeof(RealType) +
+                                                     2 * pairBatch * spectrumPixels * sizeof(ComplexType) +
+                                                     vkParameters.stageWeightsBufferBytes,
+                                                   m_VkCommon,
+                                                   vkParameters };
+
+      // Mostly use defaults for VkCommon::VkGPU
+      typename VkCommon::VkGPU vkGPU;
+      vkGPU.device_id = deviceReservation.GetDeviceID();
+      vkGPU.profiling = VkGlobalConfiguration::GetProfiling();
+
+      const VkFFTResult resFFT{ m_VkCommon.Run(vkGPU, vkParameters) };
+      if (resFFT != VKFFT_SUCCESS)
+      {
+        std::ostringstream mesg;
+        mesg << "VkFFT third-party library failed with error code " << resFFT << ".";
+        itkAssertOrThrowMacro(false, mesg.str());
+      }
+
+      for (SizeValueType k{ 0 }; k < pairsInBatch; ++k)
+      {
+        const TilePair & pair{ m_TilePairs[devicePairs[first + k]] };
+        const auto       value = [&](unsigned int i) {
+          return static_cast<double>(maxima[k * VkCommon::MaximumStageValues + i]) - constantTerm;
+        };
+        bool isFinite{ indices[k] != std::numeric_limits<uint64_t>::max() };
+        for (unsigned int i{ 0 }; i < 1 + 2 * ImageDimension; ++i)
+        {
+          isFinite = isFinite && std::isfinite(value(i));
+        }
+        if (!isFinite)
+        {
+          fallbackPairs.push_back(devicePairs[first + k]);
+          continue;
+        }
+
+        // The searched offset at the peak, refined by a parabola through its neighbors along each dimension
+        // that lie within the search window
+        TilePairResult & result{ results[devicePairs[first + k]] };
+        const double     peakValue{ value(0) };
+        SizeValueType    remainder{ indices[k] };
+        for (unsigned int dim{ 0 }; dim < ImageDimension; ++dim)
+        {
+          const auto position{ static_cast<IndexValueType>(remainder % paddedSize[dim]) };
+          remainder /= paddedSize[dim];
+          const IndexValueType start{ searchStart(pair.nominalOffset, dim) };
+          result.offset[dim] = static_cast<double>(start + static_cast<IndexValueType>(wrap(position - start, dim)));
+          if (paddedSize[dim] > 2 && isSearched(pair.nominalOffset, dim, position - 1) &&
+              isSearched(pair.nominalOffset, dim, position + 1))
+          {
+            result.offset[dim] += PairRegistrationType::RefinePeak(value(1 + 2 * dim), peakValue, value(2 + 2 * dim));
+          }
+        }
+        result.confidence = std::min(std::max(peakValue, 0.0), 1.0);
+      }
+    }
+  }
+
+  // A product of spectra that vanishes exactly makes the whole surface of its pair NaN. Such pairs are
+  // correlated again with the cross-power spectrum normalized on the host, leaving those products out.
+  const SizeValueType fallbackBatch{ std::min<SizeValueType>(m_MaximumBatchSize, fallbackPairs.size()) };
+  if (fallbackBatch > 0)
+  {
+    std::vector<RealType>    planes(2 * fallbackBatch * paddedPixels);
+    std::vector<ComplexType> spectra(2 * fallbackBatch * spectrumPixels);
+    std::vector<ComplexType> crossPower(fallbackBatch * spectrumPixels);
+    std::vector<RealType>    surfaces(fallbackBatch * paddedPixels);
+    for (SizeValueType first{ 0 }; first < fallbackPairs.size(); first += fallbackBatch)
+    {
+      const SizeValueType pairsInBatch{ std::min<SizeValueType>(fallbackBatch, fallbackPairs.size() - first) };
+      std::fill(planes.begin() + 2 * pairsInBatch * paddedPixels, planes.end(), RealType{ 0 });
+      for (SizeValueType k{ 0 }; k < pairsInBatch; ++k)
+      {
+        fillPlane(m_TilePairs[fallbackPairs[first + k]].fixedTile, &planes[2 * k * paddedPixels]);
+        fillPlane(m_TilePairs[fallbackPairs[first + k]].movingTile, &planes[(2 * k + 1) * paddedPixels]);
+      }
+      this->RunBatch(m_ForwardVkCommon,
+                     VkCommon::DirectionEnum::FORWARD,
+                     paddedSize,
+                     2 * fallbackBatch,
+                     planes.data(),
+                     spectra.data());
+
+      std::fill(crossPower.begin() + pairsInBatch * spectrumPixels, crossPower.end(), ComplexType{});
+      for (SizeValueType k{ 0 }; k < pairsInBatch; ++k)
+      {
+        // The zero frequency holds only the added constants
+        spectra[2 * k * spectrumPixels] = ComplexType{};
+        spectra[(2 * k + 1) * spectrumPixels] = ComplexType{};
+        PairRegistrationType::ComputeNormalizedCrossPower(&spectra[2 * k * spectrumPixels],
+                                                          &spectra[(2 * k + 1) * spectrumPixels],
+                                                          &crossPower[k * spectrumPixels],
+                                                          spectrumPixels);
+      }
+      this->RunBatch(m_InverseVkCommon,
+                     VkCommon::DirectionEnum::INVERSE,
+                     paddedSize,
+                     fallbackBatch,
+                     surfaces.data(),
+                     crossPower.data());
+      for (SizeValueType k{ 0 }; k < pairsInBatch; ++k)
+      {
+        TilePairResult & result{ results[fallbackPairs[first + k]] };
+        const double     peakValue{ PairRegistrationType::FindPeak(&surfaces[k * paddedPixels],
+                                                               paddedSize,
+                                                               m_TilePairs[fallbackPairs[first + k]].nominalOffset,
+                                                               m_SearchRadius,
+                                                               result.offset) };
+        result.confidence = std::min(std::max(peakValue, 0.0), 1.0);
+      }
+    }
+  }
+
+  itkDynamicCastInDebugMode<ResultTableObjectType *>(this->ProcessObject::GetOutput(0))->Set(results);
+}
+
+template <typename TImage, typename TRealType>
+void
+VkTilePhaseCorrelationImageRegistrationMethod<TImage, TRealType>::RunBatch(VkCommon &              vkCommon,
+                                                                    VkCommon::DirectionEnum direction,
+                                                                    const SizeType &        paddedSize,
+                                                                    uint64_t                batches,
+                                                                    RealType *              realPlanes,
+                                                                    ComplexType *           spectra)
+{
+  const bool          forward{ direction == VkCommon::DirectionEnum::FORWARD };
+  SizeValueType       paddedPixels{ 1 };
+  for (unsigned int dim{ 0 }; dim < ImageDimension; ++dim)
+  {
+    paddedPixels *= paddedSize[dim];
+  }
+  const SizeValueType spectrumPixels{ paddedPixels / paddedSize[0] * (paddedSize[0] / 2 + 1) };
+  const SizeValueType realBytes{ batches * paddedPixels * sizeof(RealType) };
+  const SizeValueType spectrumBytes{ batches * spectrumPixels * sizeof(ComplexType) };
+
+  // Describe the batched transforms in VkCommon::VkParameters
+  typename VkCommon::VkParameters vkParameters;
+  if (ImageDimension > 0)
+    vkParameters.X = paddedSize[0];
+  if (ImageDimension > 1)
+    vkParameters.Y = paddedSize[1];
+  if (ImageDimension > 2)
+    vkParameters.Z = paddedSize[2];
+  vkParameters.B = batches;
+  if (std::is_same<RealType, float>::value)
+    vkParameters.P = VkCommon::PrecisionEnum::FLOAT;
+  else if (std::is_same<RealType, double>::value)
+    vkParameters.P = VkCommon::PrecisionEnum::DOUBLE;
+  else
+    itkAssertOrThrowMacro(false, "Unsupported type for real numbers.");
+  vkParameters.fft = VkCommon::FFTEnum::R2HalfH;
+  vkParameters.PSize = sizeof(RealType);
+  vkParameters.I = direction;
+  vkParameters.normalized =
+    forward ? VkCommon::NormalizationEnum::UNNORMALIZED : VkCommon::NormalizationEnum::NORMALIZED;
+
+  if (forward)
+  {
+    vkParameters.inputCPUBuffer = realPlanes;
+    vkParameters.inputBufferBytes = realBytes;
+    vkParameters.outputCPUBuffer = spectra;
+    vkParameters.outputBufferBytes = spectrumBytes;
+  }
+  else
+  {
+    vkParameters.inputCPUBuffer = spectra;
+    vkParameters.inputBufferBytes = spectrumBytes;
+    vkParameters.outputCPUBuffer = realPlanes;
+    vkParameters.outputBufferBytes = realBytes;
+  }
+
+  // Count this run as outstanding on the device of the plan it reuses,
+  // or else on a device chosen by the scheduling policy
+  const VkDeviceReservation deviceReservation{
+    m_UseVkGlobalConfiguration, m_DeviceID, realBytes + spectrumBytes, vkCommon, vkParameters
+  };
+
+  // Mostly use defaults for VkCommon::VkGPU
+  typename VkCommon::VkGPU vkGPU;
+  vkGPU.device_id = deviceReservation.GetDeviceID();
+  vkGPU.profiling = VkGlobalConfiguration::GetProfiling();
+
+  const VkFFTResult resFFT{ vkCommon.Run(vkGPU, vkParameters) };
+  if (resFFT != VKFFT_SUCCESS)
+  {
+    std::ostringstream mesg;
+    mesg << "VkFFT third-party library failed with error code " << resFFT << ".";
+    itkAssertOrThrowMacro(false, mesg.str());
+  }
+}
+
+template <typename TImage, typename TRealType>
+void
+VkTilePhaseCorrelationImageRegistrationMethod<TImage, TRealType>::PrintSelf(std::ostream & os, Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+  os << indent << "NumberOfTileImages: " << this->GetNumberOfTileImages() << std::endl;
+  os << indent << "NumberOfTilePairs: " << m_TilePairs.size() << std::endl;
+  os << indent << "SearchRadius: " << m_SearchRadius << std::endl;
+  os << indent << "MaximumBatchSize: " << m_MaximumBatchSize << std::endl;
+  os << indent << "UseVkGlobalConfiguration: " << m_UseVkGlobalConfiguration << std::endl;
+  os << indent << "Local DeviceID: " << m_DeviceID << std::endl;
+  os << indent << "Global DeviceID: " << VkGlobalConfiguration::GetDeviceID() << std::endl;
+  os << indent << "Preferred DeviceID: " << this->GetDeviceID() << std::endl;
+}
+
+} // end namespace itk
+
+#endif // itkVkTilePhaseCorrelationImageRegistrationMethod_hxx
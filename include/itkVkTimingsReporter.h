@@ -0,0 +1,96 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         https://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkVkTimingsReporter_h
+#define itkVkTimingsReporter_h
+
+#include "itkVkCommon.h"
+
+#include <initializer_list>
+#include <vector>
+
+namespace itk
+{
+/**
+ *\class VkTimingsReporter
+ *
+ * \brief Reports the VkFFT backend timings of the VkCommon instances of a filter.
+ *
+ * Vk filters derive from this class in addition to their ITK superclass and
+ * pass the VkCommon instances that run their transforms to its constructor.
+ * The timings are copied from each VkCommon under its run lock, so they may
+ * be read while another thread updates the filter.
+ *
+ * \ingroup FourierTransform
+ * \ingroup VkFFTBackend
+ */
+class VkTimingsReporter
+{
+public:
+  ITK_DISALLOW_COPY_AND_MOVE(VkTimingsReporter);
+
+  /** Wall-clock time spent in each phase of the VkFFT backend by all runs
+   *  of the filter, accumulated since construction or the last
+   *  ResetVkTimings. */
+  VkCommon::VkTimings
+  GetVkTimings() const
+  {
+    VkCommon::VkTimings timings{};
+    for (const VkCommon * const vkCommon : m_VkCommons)
+    {
+      timings += vkCommon->GetTimings();
+    }
+    return timings;
+  }
+
+  /** Timings of the most recent run of each VkCommon instance of the
+   *  filter. An update that runs an instance several times, such as for
+   *  batches, reports its last run only. */
+  VkCommon::VkTimings
+  GetLastRunVkTimings() const
+  {
+    VkCommon::VkTimings timings{};
+    for (const VkCommon * const vkCommon : m_VkCommons)
+    {
+      timings += vkCommon->GetLastRunTimings();
+    }
+    return timings;
+  }
+
+  void
+  ResetVkTimings()
+  {
+    for (VkCommon * const vkCommon : m_VkCommons)
+    {
+      vkCommon->ResetTimings();
+    }
+  }
+
+protected:
+  /** The instances are members of the derived filter, and are only
+   *  dereferenced once it is constructed. */
+  VkTimingsReporter(std::initializer_list<VkCommon *> vkCommons)
+    : m_VkCommons{ vkCommons }
+  {}
+  ~VkTimingsReporter() = default;
+
+private:
+  std::vector<VkCommon *> m_VkCommons;
+};
+} // namespace itk
+
+#endif // itkVkTimingsReporter_h
@@ -0,0 +1,131 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         https://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkVkTracer_h
+#define itkVkTracer_h
+
+#include "VkFFTBackendExport.h"
+#include "itkMacro.h"
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+namespace itk
+{
+/**
+ *\class VkTracer
+ *
+ * \brief Records VkFFT backend activity as a Chrome trace-event JSON file.
+ *
+ * When enabled, Vk filters record a span for each GenerateData call, VkCommon
+ * records a span for each phase of each run together with plan cache hits and
+ * misses, and the Vk smoothing filters record their spatial versus FFT
+ * blurring decisions. Every event carries the ID of the calling thread and
+ * the VkFFT device ID so that overlapping work is visible.
+ *
+ * Tracing is enabled by setting a file name, either with
+ * VkGlobalConfiguration::SetTraceFileName or with the ITK_VKFFT_TRACE_FILE
+ * environment variable, which is read on first use. Events are written in
+ * the JSON array format, which chrome://tracing and Perfetto load even when
+ * the process ends before the file is closed.
+ *
+ * \ingroup VkFFTBackend
+ */
+class VkFFTBackend_EXPORT VkTracer
+{
+public:
+  using ClockType = std::chrono::steady_clock;
+
+  /** Start tracing to the given file, closing any previous trace.
+   *  An empty file name disables tracing. */
+  static void
+  SetFileName(const std::string & fileName);
+
+  static std::string
+  GetFileName();
+
+  /** Whether events are currently recorded. */
+  static bool
+  IsEnabled();
+
+  /** Record a span from `start` to `end`. `args` holds additional
+   *  comma-separated JSON members, e.g. "\"level\":2". */
+  static void
+  AddCompleteEvent(const char *          name,
+                   const char *          category,
+                   ClockType::time_point start,
+                   ClockType::time_point end,
+                   uint64_t              deviceID,
+                   const std::string &   args = "");
+
+  /** Record an instant event at the current time. */
+  static void
+  AddInstantEvent(const char * name, const char * category, uint64_t deviceID, const std::string & args = "");
+
+  /** Format a number as a JSON value for `args`. JSON has no infinity or
+   *  NaN, so these are written as the strings "inf", "-inf" and "nan". */
+  static std::string
+  FormatNumber(double value);
+
+  /** Write buffered events to the trace file. */
+  static void
+  Flush();
+};
+
+/**
+ *\class VkTraceScope
+ *
+ * \brief Records a VkTracer span over the lifetime of the object.
+ *
+ * \ingroup VkFFTBackend
+ */
+class VkTraceScope
+{
+public:
+  ITK_DISALLOW_COPY_AND_MOVE(VkTraceScope);
+
+  VkTraceScope(const char * name, const char * category, uint64_t deviceID)
+    : m_Name(name)
+    , m_Category(category)
+    , m_DeviceID(deviceID)
+    , m_Enabled(VkTracer::IsEnabled())
+  {
+    if (m_Enabled)
+    {
+      m_Start = VkTracer::ClockType::now();
+    }
+  }
+
+  ~VkTraceScope()
+  {
+    if (m_Enabled)
+    {
+      VkTracer::AddCompleteEvent(m_Name, m_Category, m_Start, VkTracer::ClockType::now(), m_DeviceID);
+    }
+  }
+
+private:
+  const char *                    m_Name;
+  const char *                    m_Category;
+  uint64_t                        m_DeviceID;
+  bool                            m_Enabled;
+  VkTracer::ClockType::time_point m_Start{};
+};
+} // namespace itk
+
+#endif // itkVkTracer_h
@@ -0,0 +1,114 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         https://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkVkVectorFFTRun_h
+#define itkVkVectorFFTRun_h
+
+#include "itkMacro.h"
+#include "itkVkCommon.h"
+#include "itkVkGlobalConfiguration.h"
+
+#include <complex>
+#include <sstream>
+#include <type_traits>
+
+namespace itk
+{
+/** Transform each component of the largest possible region of `input`
+ *  into the allocated `output` with a single R2FullH run of `vkCommon`,
+ *  forward from real to complex components or inverse from complex to
+ *  real ones, as VkVectorForwardFFTImageFilter and
+ *  VkVectorInverseFFTImageFilter do. The components are submitted as
+ *  coordinate features and reordered between interleaved pixels and
+ *  planes on the device. */
+template <typename TRealType, typename TInputImage, typename TOutputImage>
+void
+RunVkVectorFFT(const TInputImage *     input,
+               TOutputImage *          output,
+               VkCommon::DirectionEnum direction,
+               bool                    useVkGlobalConfiguration,
+               uint64_t                deviceID,
+               VkCommon &              vkCommon)
+{
+  constexpr unsigned int ImageDimension{ TInputImage::ImageDimension };
+
+  const unsigned int numberOfComponents{ input->GetNumberOfComponentsPerPixel() };
+  itkAssertOrThrowMacro(output->GetNumberOfComponentsPerPixel() == numberOfComponents,
+                        "Input and output images have different numbers of components.");
+  const typename TInputImage::SizeType & inputSize{ input->GetLargestPossibleRegion().GetSize() };
+  const uint64_t                         numberOfPixels{ input->GetLargestPossibleRegion().GetNumberOfPixels() };
+  itkAssertOrThrowMacro(input->GetBufferPointer() != nullptr, "No CPU input buffer");
+  itkAssertOrThrowMacro(output->GetBufferPointer() != nullptr, "No CPU output buffer");
+
+  // The real side of the transform has real components, the other complex ones
+  const bool     forward{ direction == VkCommon::DirectionEnum::FORWARD };
+  const uint64_t realBytes{ numberOfComponents * numberOfPixels * sizeof(TRealType) };
+  const uint64_t complexBytes{ numberOfComponents * numberOfPixels * sizeof(std::complex<TRealType>) };
+  const uint64_t inBytes{ forward ? realBytes : complexBytes };
+  const uint64_t outBytes{ forward ? complexBytes : realBytes };
+
+  // Describe the transform in VkCommon::VkParameters
+  typename VkCommon::VkParameters vkParameters;
+  if (ImageDimension > 0)
+    vkParameters.X = inputSize[0];
+  if (ImageDimension > 1)
+    vkParameters.Y = inputSize[1];
+  if (ImageDimension > 2)
+    vkParameters.Z = inputSize[2];
+  vkParameters.C = numberOfComponents;
+  if (std::is_same<TRealType, float>::value)
+    vkParameters.P = VkCommon::PrecisionEnum::FLOAT;
+  else if (std::is_same<TRealType, double>::value)
+    vkParameters.P = VkCommon::PrecisionEnum::DOUBLE;
+  else
+    itkAssertOrThrowMacro(false, "Unsupported type for real numbers.");
+  vkParameters.fft = VkCommon::FFTEnum::R2FullH;
+  vkParameters.PSize = sizeof(TRealType);
+  vkParameters.I = direction;
+  vkParameters.normalized =
+    forward ? VkCommon::NormalizationEnum::UNNORMALIZED : VkCommon::NormalizationEnum::NORMALIZED;
+
+  // Components of a pixel are adjacent in ITK images, whereas VkFFT
+  // expects each coordinate feature as a plane after the previous one
+  vkParameters.interleavedComponents = true;
+  vkParameters.inputCPUBuffer = input->GetBufferPointer();
+  vkParameters.inputBufferBytes = inBytes;
+  vkParameters.outputCPUBuffer = output->GetBufferPointer();
+  vkParameters.outputBufferBytes = outBytes;
+
+  // Count this run as outstanding on the device of the plan it reuses,
+  // or else on a device chosen by the scheduling policy
+  const VkDeviceReservation deviceReservation{
+    useVkGlobalConfiguration, deviceID, inBytes + outBytes, vkCommon, vkParameters
+  };
+
+  // Mostly use defaults for VkCommon::VkGPU
+  typename VkCommon::VkGPU vkGPU;
+  vkGPU.device_id = deviceReservation.GetDeviceID();
+  vkGPU.profiling = VkGlobalConfiguration::GetProfiling();
+
+  const VkFFTResult resFFT{ vkCommon.Run(vkGPU, vkParameters) };
+  if (resFFT != VKFFT_SUCCESS)
+  {
+    std::ostringstream mesg;
+    mesg << "VkFFT third-party library failed with error code " << resFFT << ".";
+    itkAssertOrThrowMacro(false, mesg.str());
+  }
+}
+} // namespace itk
+
+#endif // itkVkVectorFFTRun_h
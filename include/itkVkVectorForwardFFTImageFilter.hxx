@@ -0,0 +1,106 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         https://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkVkVectorForwardFFTImageFilter_hxx
+#define itkVkVectorForwardFFTImageFilter_hxx
+
+#include "itkVkVectorForwardFFTImageFilter.h"
+#include "itkVkVectorFFTRun.h"
+#include "itkVkTracer.h"
+#include "itkIndent.h"
+#include "itkProgressReporter.h"
+
+#include <iostream>
+
+namespace itk
+{
+
+template <typename TInputImage, typename TOutputImage>
+void
+VkVectorForwardFFTImageFilter<TInputImage, TOutputImage>::GenerateOutputInformation()
+{
+  Superclass::GenerateOutputInformation();
+
+  const InputImageType * const input{ this->GetInput() };
+  OutputImageType * const      output{ this->GetOutput() };
+  if (input && output)
+  {
+    output->SetNumberOfComponentsPerPixel(input->GetNumberOfComponentsPerPixel());
+  }
+}
+
+template <typename TInputImage, typename TOutputImage>
+void
+VkVectorForwardFFTImageFilter<TInputImage, TOutputImage>::GenerateInputRequestedRegion()
+{
+  Superclass::GenerateInputRequestedRegion();
+
+  const typename InputImageType::Pointer input{ const_cast<InputImageType *>(this->GetInput()) };
+  if (input)
+  {
+    input->SetRequestedRegionToLargestPossibleRegion();
+  }
+}
+
+template <typename TInputImage, typename TOutputImage>
+void
+VkVectorForwardFFTImageFilter<TInputImage, TOutputImage>::EnlargeOutputRequestedRegion(DataObject * output)
+{
+  Superclass::EnlargeOutputRequestedRegion(output);
+  output->SetRequestedRegionToLargestPossibleRegion();
+}
+
+template <typename TInputImage, typename TOutputImage>
+void
+VkVectorForwardFFTImageFilter<TInputImage, TOutputImage>::GenerateData()
+{
+  const VkTraceScope traceScope{ this->GetNameOfClass(), "GenerateData", this->GetDeviceID() };
+
+  // get pointers to the input and output
+  const InputImageType * const input{ this->GetInput() };
+  OutputImageType * const      output{ this->GetOutput() };
+
+  if (!input || !output)
+  {
+    return;
+  }
+
+  // we don't have a nice progress to report, but at least this simple line
+  // reports the beginning and the end of the process
+  const ProgressReporter progress(this, 0, 1);
+
+  output->SetBufferedRegion(output->GetRequestedRegion());
+  output->Allocate();
+
+  RunVkVectorFFT<RealType>(
+    input, output, VkCommon::DirectionEnum::FORWARD, m_UseVkGlobalConfiguration, m_DeviceID, m_VkCommon);
+}
+
+template <typename TInputImage, typename TOutputImage>
+void
+VkVectorForwardFFTImageFilter<TInputImage, TOutputImage>::PrintSelf(std::ostream & os, Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+  os << indent << "UseVkGlobalConfiguration: " << m_UseVkGlobalConfiguration << std::endl;
+  os << indent << "Local DeviceID: " << m_DeviceID << std::endl;
+  os << indent << "Global DeviceID: " << VkGlobalConfiguration::GetDeviceID() << std::endl;
+  os << indent << "Preferred DeviceID: " << this->GetDeviceID() << std::endl;
+}
+
+} // end namespace itk
+
+#endif // itkVkVectorForwardFFTImageFilter_hxx
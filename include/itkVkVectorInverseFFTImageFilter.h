@@ -0,0 +1,152 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         https://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkVkVectorInverseFFTImageFilter_h
+#define itkVkVectorInverseFFTImageFilter_h
+
+#include "itkImageToImageFilter.h"
+#include "itkNumericTraits.h"
+#include "itkVectorImage.h"
+#include "itkVkCommon.h"
+#include "itkVkGlobalConfiguration.h"
+#include "itkVkTimingsReporter.h"
+
+#include <complex>
+
+namespace itk
+{
+/**
+ *\class VkVectorInverseFFTImageFilter
+ *
+ * \brief Vk-based inverse Fast Fourier Transform of each component of a vector image.
+ *
+ * Each component of the complex input pixels, a full spectrum, is
+ * transformed as by VkInverseFFTImageFilter to the real output component.
+ * All components are submitted to VkFFT in a single run as coordinate
+ * features, rather than extracting and transforming each component on its
+ * own.
+ *
+ * The input may be an Image of Vector pixels or a VectorImage, and the
+ * output has the same number of components. Components are reordered
+ * from interleaved pixels to consecutive planes and back on the device.
+ *
+ * \ingroup FourierTransform
+ * \ingroup VkFFTBackend
+ *
+ * \sa VkInverseFFTImageFilter
+ * \sa VkVectorForwardFFTImageFilter
+ * \sa VkGlobalConfiguration
+ */
+template <typename TInputImage,
+          typename TOutputImage =
+            VectorImage<typename NumericTraits<typename TInputImage::PixelType>::ValueType::value_type,
+                        TInputImage::ImageDimension>>
+class VkVectorInverseFFTImageFilter
+  : public ImageToImageFilter<TInputImage, TOutputImage>
+  , public VkTimingsReporter
+{
+public:
+  ITK_DISALLOW_COPY_AND_MOVE(VkVectorInverseFFTImageFilter);
+
+  using InputImageType = TInputImage;
+  using OutputImageType = TOutputImage;
+  using ComplexType = typename NumericTraits<typename InputImageType::PixelType>::ValueType;
+  using RealType = typename NumericTraits<typename OutputImageType::PixelType>::ValueType;
+  static_assert(std::is_same<RealType, float>::value || std::is_same<RealType, double>::value,
+                "Unsupported pixel component type");
+  static_assert(std::is_same<ComplexType, std::complex<RealType>>::value, "Unsupported pixel component type");
+  static_assert(TInputImage::ImageDimension >= 1 && TInputImage::ImageDimension <= 3, "Unsupported image dimension");
+
+  /** Standard class type aliases. */
+  using Self = VkVectorInverseFFTImageFilter;
+  using Superclass = ImageToImageFilter<InputImageType, OutputImageType>;
+  using Pointer = SmartPointer<Self>;
+  using ConstPointer = SmartPointer<const Self>;
+
+  using SizeType = typename InputImageType::SizeType;
+  using SizeValueType = typename InputImageType::SizeValueType;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkOverrideGetNameOfClassMacro(VkVectorInverseFFTImageFilter);
+
+  static constexpr unsigned int ImageDimension{ InputImageType::ImageDimension };
+
+  /** Determine whether local or global properties will be
+   *  referenced for setting up GPU acceleration. */
+  itkSetMacro(UseVkGlobalConfiguration, bool);
+  itkGetMacro(UseVkGlobalConfiguration, bool);
+
+  /** Local setting for enumerated GPU device to use for FFT.
+   *  Ignored if `UseVkGlobalConfiguration` is true. */
+  itkSetMacro(DeviceID, uint64_t);
+
+  /** Return the enumerated GPU device to use for FFT
+   *  according to current filter settings. With the global
+   *  configuration, runs are placed on devices by its scheduling
+   *  policy, which is this device only for the FIXED policy. */
+  uint64_t
+  GetDeviceID() const
+  {
+    return uint64_t{ m_UseVkGlobalConfiguration ? VkGlobalConfiguration::GetDeviceID() : m_DeviceID };
+  }
+
+  SizeValueType
+  GetSizeGreatestPrimeFactor() const
+  {
+    return SizeValueType{ m_VkCommon.GetGreatestPrimeFactor() };
+  }
+
+protected:
+  VkVectorInverseFFTImageFilter()
+    : VkTimingsReporter{ &m_VkCommon }
+  {}
+  ~VkVectorInverseFFTImageFilter() override = default;
+
+  /** The output has as many components as the input. */
+  void
+  GenerateOutputInformation() override;
+
+  /** The whole input is needed to compute the transforms. */
+  void
+  GenerateInputRequestedRegion() override;
+
+  void
+  EnlargeOutputRequestedRegion(DataObject * output) override;
+
+  void
+  GenerateData() override;
+
+  void
+  PrintSelf(std::ostream & os, Indent indent) const override;
+
+private:
+  bool     m_UseVkGlobalConfiguration{ true };
+  uint64_t m_DeviceID{ 0UL };
+
+  VkCommon m_VkCommon{};
+};
+
+} // namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#  include "itkVkVectorInverseFFTImageFilter.hxx"
+#endif
+
+#endif // itkVkVectorInverseFFTImageFilter_h
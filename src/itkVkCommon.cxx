@@ -25,72 +25,74 @@
 #  include "QuartzCore/QuartzCore.hpp"
 #endif
 #include "itkVkCommon.h"
+#include "itkVkTracer.h"
 #include "vkFFT.h"
 #include "itkMacro.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cmath>
 #include <complex>
 #include <cstring>
 #include <iostream>
+#include <iterator>
+#include <limits>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
 
 namespace itk
 {
 
-VkFFTResult
-VkCommon::Run(const VkGPU & vkGPU, const VkParameters & vkParameters)
+namespace
 {
-  VkFFTResult resFFT{ VKFFT_SUCCESS };
-
-  m_VkGPU = vkGPU;
-  m_VkParameters = vkParameters;
-  if (m_MustConfigure || m_VkGPU != m_VkGPUPrevious || m_VkParameters != m_VkParametersPrevious)
-  {
-    resFFT = this->ReleaseBackend();
-    if (resFFT != VKFFT_SUCCESS)
-    {
-      return resFFT;
-    }
-    resFFT = this->ConfigureBackend();
-    if (resFFT != VKFFT_SUCCESS)
-    {
-      return resFFT;
-    }
-    this->m_MustConfigure = false;
-  }
+using ClockType = VkTracer::ClockType;
 
-  resFFT = this->PerformFFT();
-  if (resFFT != VKFFT_SUCCESS)
-  {
-    return resFFT;
-  }
+// Add the time elapsed since phaseStart to seconds, trace the phase
+// and start the next phase
+void
+AccumulatePhase(double & seconds, ClockType::time_point & phaseStart, const char * phaseName, uint64_t deviceID)
+{
+  const ClockType::time_point now{ ClockType::now() };
+  seconds += std::chrono::duration<double>(now - phaseStart).count();
+  VkTracer::AddCompleteEvent(phaseName, "VkCommon", phaseStart, now, deviceID);
+  phaseStart = now;
+}
 
-  return resFFT;
+#if (VKFFT_BACKEND == CUDA)
+// Seconds between two recorded CUDA events
+double
+GetElapsedSeconds(cudaEvent_t start, cudaEvent_t end)
+{
+  float milliseconds{ 0.0f };
+  cudaEventElapsedTime(&milliseconds, start, end);
+  return 1.0e-3 * milliseconds;
+}
+#elif (VKFFT_BACKEND == OPENCL)
+// Seconds between the end of `start` and the end of `end` on a profiling queue.
+// Passing the same event twice gives the duration of that command.
+double
+GetElapsedSeconds(cl_event start, cl_event end)
+{
+  cl_ulong startNanoseconds{ 0 };
+  cl_ulong endNanoseconds{ 0 };
+  clGetEventProfilingInfo(start,
+                          start == end ? CL_PROFILING_COMMAND_START : CL_PROFILING_COMMAND_END,
+                          sizeof(cl_ulong),
+                          &startNanoseconds,
+                          nullptr);
+  clGetEventProfilingInfo(end, CL_PROFILING_COMMAND_END, sizeof(cl_ulong), &endNanoseconds, nullptr);
+  return 1.0e-9 * static_cast<double>(endNanoseconds - startNanoseconds);
 }
 
+// Find the OpenCL platform and device enumerated as deviceID over all platforms
 VkFFTResult
-VkCommon::ConfigureBackend()
+FindDevice(uint64_t deviceID, cl_platform_id & platform, cl_device_id & device)
 {
-  VkFFTResult resFFT{ VKFFT_SUCCESS };
-#if (VKFFT_BACKEND == CUDA)
-  CUresult    res{ CUDA_SUCCESS };
-  cudaError_t res2{ cudaSuccess };
-  res = cuInit(0);
-  if (res != CUDA_SUCCESS)
-    return VkFFTResult{ VKFFT_ERROR_FAILED_TO_INITIALIZE };
-  res2 = cudaSetDevice((int)m_VkGPU.device_id);
-  if (res2 != cudaSuccess)
-    return VkFFTResult{ VKFFT_ERROR_FAILED_TO_SET_DEVICE_ID };
-  res = cuDeviceGet(&m_VkGPU.device, (int)m_VkGPU.device_id);
-  if (res != CUDA_SUCCESS)
-    return VkFFTResult{ VKFFT_ERROR_FAILED_TO_GET_DEVICE };
-#  if CUDA_VERSION >= 13000
-  res = cuCtxCreate(&m_VkGPU.context, nullptr, 0, (int)m_VkGPU.device);
-#  else
-  res = cuCtxCreate(&m_VkGPU.context, 0, (int)m_VkGPU.device);
-#  endif
-  if (res != CUDA_SUCCESS)
-    return VkFFTResult{ VKFFT_ERROR_FAILED_TO_CREATE_CONTEXT };
-
-#elif (VKFFT_BACKEND == OPENCL)
   cl_int resCL{ CL_SUCCESS };
 
   // Begin code that mimics launchVkFFT from VkFFT/Vulkan_FFT.cpp, though just the OpenCL part.
@@ -140,742 +142,2701 @@ VkCommon::ConfigureBackend()
       std::cerr << __FILE__ "(" << __LINE__ << "): clGetDeviceIDs returned " << resCL << std::endl;
       return VkFFTResult{ VKFFT_ERROR_FAILED_TO_GET_DEVICE };
     }
-    for (uint64_t i{ 0 }; i < numDevices; i++)
+    if (deviceID < k + numDevices)
     {
-      if (k == m_VkGPU.device_id)
-      {
-        m_VkGPU.platform = platforms[j];
-        m_VkGPU.device = deviceList[i];
-        const cl_context_properties contextProperties[]{ CL_CONTEXT_PLATFORM,
-                                                         reinterpret_cast<cl_context_properties>(m_VkGPU.platform),
-                                                         0 };
-        m_VkGPU.context = clCreateContext(contextProperties, 1, &m_VkGPU.device, NULL, NULL, &resCL);
-        if (resCL != CL_SUCCESS)
-        {
-          std::cerr << __FILE__ "(" << __LINE__ << "): clCreateContext returned " << resCL << std::endl;
-          return VkFFTResult{ VKFFT_ERROR_FAILED_TO_CREATE_CONTEXT };
-        }
-        m_VkGPU.commandQueue = clCreateCommandQueue(m_VkGPU.context, m_VkGPU.device, 0, &resCL);
-        if (resCL != CL_SUCCESS)
-        {
-          std::cerr << __FILE__ "(" << __LINE__ << "): clCreateCommandQueue returned " << resCL << std::endl;
-          return VkFFTResult{ VKFFT_ERROR_FAILED_TO_CREATE_COMMAND_QUEUE };
-        }
-        k++;
-      }
-      else
-      {
-        k++;
-      }
+      platform = platforms[j];
+      device = deviceList[deviceID - k];
+      return VkFFTResult{ VKFFT_SUCCESS };
     }
+    k += numDevices;
   }
-#elif (VKFFT_BACKEND == LEVEL_ZERO)
-  ze_result_t resZE{ ZE_RESULT_SUCCESS };
-  resZE = zeInit(0);
-  if (resZE != ZE_RESULT_SUCCESS)
-  {
-    std::cerr << __FILE__ "(" << __LINE__ << "): zeInit returned " << resZE << std::endl;
-    return VkFFTResult{ VKFFT_ERROR_FAILED_TO_INITIALIZE };
-  }
-  uint32_t numDrivers{ 0 };
-  resZE = zeDriverGet(&numDrivers, nullptr);
-  if (resZE != ZE_RESULT_SUCCESS || numDrivers == 0)
-    return VkFFTResult{ VKFFT_ERROR_FAILED_TO_INITIALIZE };
-  std::unique_ptr<ze_driver_handle_t[]> drivers{ std::make_unique<ze_driver_handle_t[]>(numDrivers) };
-  resZE = zeDriverGet(&numDrivers, drivers.get());
-  if (resZE != ZE_RESULT_SUCCESS)
-    return VkFFTResult{ VKFFT_ERROR_FAILED_TO_INITIALIZE };
-  uint64_t k{ 0 };
-  bool     found{ false };
-  for (uint32_t j{ 0 }; j < numDrivers && !found; ++j)
-  {
-    uint32_t numDevices{ 0 };
-    resZE = zeDeviceGet(drivers[j], &numDevices, nullptr);
-    if (resZE != ZE_RESULT_SUCCESS)
-      return VkFFTResult{ VKFFT_ERROR_FAILED_TO_GET_DEVICE };
-    std::unique_ptr<ze_device_handle_t[]> deviceList{ std::make_unique<ze_device_handle_t[]>(numDevices) };
-    resZE = zeDeviceGet(drivers[j], &numDevices, deviceList.get());
-    if (resZE != ZE_RESULT_SUCCESS)
-      return VkFFTResult{ VKFFT_ERROR_FAILED_TO_GET_DEVICE };
-    for (uint32_t i{ 0 }; i < numDevices && !found; ++i)
-    {
-      if (k == m_VkGPU.device_id)
-      {
-        m_VkGPU.driver = drivers[j];
-        m_VkGPU.device = deviceList[i];
-
-        ze_context_desc_t contextDescription{};
-        contextDescription.stype = ZE_STRUCTURE_TYPE_CONTEXT_DESC;
-        resZE = zeContextCreate(m_VkGPU.driver, &contextDescription, &m_VkGPU.context);
-        if (resZE != ZE_RESULT_SUCCESS)
-          return VkFFTResult{ VKFFT_ERROR_FAILED_TO_CREATE_CONTEXT };
-
-        uint32_t queueGroupCount{ 0 };
-        resZE = zeDeviceGetCommandQueueGroupProperties(m_VkGPU.device, &queueGroupCount, nullptr);
-        if (resZE != ZE_RESULT_SUCCESS || queueGroupCount == 0)
-          return VkFFTResult{ VKFFT_ERROR_FAILED_TO_CREATE_COMMAND_QUEUE };
-        std::unique_ptr<ze_command_queue_group_properties_t[]> queueGroupProps{
-          std::make_unique<ze_command_queue_group_properties_t[]>(queueGroupCount)
-        };
-        resZE = zeDeviceGetCommandQueueGroupProperties(m_VkGPU.device, &queueGroupCount, queueGroupProps.get());
-        if (resZE != ZE_RESULT_SUCCESS)
-          return VkFFTResult{ VKFFT_ERROR_FAILED_TO_CREATE_COMMAND_QUEUE };
-        uint32_t commandQueueID{ static_cast<uint32_t>(-1) };
-        for (uint32_t g{ 0 }; g < queueGroupCount; ++g)
-        {
-          if ((queueGroupProps[g].flags & ZE_COMMAND_QUEUE_GROUP_PROPERTY_FLAG_COMPUTE) &&
-              (queueGroupProps[g].flags & ZE_COMMAND_QUEUE_GROUP_PROPERTY_FLAG_COPY))
-          {
-            commandQueueID = g;
-            break;
-          }
-        }
-        if (commandQueueID == static_cast<uint32_t>(-1))
-          return VkFFTResult{ VKFFT_ERROR_FAILED_TO_CREATE_COMMAND_QUEUE };
-        m_VkGPU.commandQueueID = commandQueueID;
+  std::cerr << __FILE__ "(" << __LINE__ << "): OpenCL device_id " << deviceID << " not found" << std::endl;
+  return VkFFTResult{ VKFFT_ERROR_FAILED_TO_GET_DEVICE };
+}
 
-        ze_command_queue_desc_t commandQueueDescription{};
-        commandQueueDescription.stype = ZE_STRUCTURE_TYPE_COMMAND_QUEUE_DESC;
-        commandQueueDescription.ordinal = commandQueueID;
-        commandQueueDescription.priority = ZE_COMMAND_QUEUE_PRIORITY_NORMAL;
-        commandQueueDescription.mode = ZE_COMMAND_QUEUE_MODE_DEFAULT;
-        resZE = zeCommandQueueCreate(m_VkGPU.context, m_VkGPU.device, &commandQueueDescription, &m_VkGPU.commandQueue);
-        if (resZE != ZE_RESULT_SUCCESS)
-          return VkFFTResult{ VKFFT_ERROR_FAILED_TO_CREATE_COMMAND_QUEUE };
-        found = true;
-      }
-      else
-      {
-        ++k;
-      }
-    }
+// Alignment in bytes of CPU buffers that `device` uses in place with
+// CL_MEM_USE_HOST_PTR, or 0 if it does not share memory with the host
+uint64_t
+GetHostPointerAlignment(cl_device_id device)
+{
+  cl_bool hostUnifiedMemory{ CL_FALSE };
+  if (clGetDeviceInfo(device, CL_DEVICE_HOST_UNIFIED_MEMORY, sizeof(cl_bool), &hostUnifiedMemory, nullptr) !=
+        CL_SUCCESS ||
+      hostUnifiedMemory != CL_TRUE)
+  {
+    return 0;
   }
-  if (!found)
+  // CL_DEVICE_MEM_BASE_ADDR_ALIGN is in bits
+  cl_uint alignmentBits{ 0 };
+  if (clGetDeviceInfo(device, CL_DEVICE_MEM_BASE_ADDR_ALIGN, sizeof(cl_uint), &alignmentBits, nullptr) != CL_SUCCESS)
   {
-    std::cerr << __FILE__ "(" << __LINE__ << "): Level Zero device_id " << m_VkGPU.device_id << " not found"
-              << std::endl;
-    return VkFFTResult{ VKFFT_ERROR_FAILED_TO_GET_DEVICE };
+    return 0;
   }
-#elif (VKFFT_BACKEND == METAL)
-  // Enumerate Metal devices and pick by device_id.
-  NS::Array * devices = MTL::CopyAllDevices();
-  if (devices == nullptr || devices->count() == 0)
+  return std::max<uint64_t>(alignmentBits / 8, 1);
+}
+
+// Number of OpenCL devices over all platforms, enumerated as by FindDevice
+uint64_t
+CountDevices()
+{
+  cl_uint numPlatforms{ 0 };
+  if (clGetPlatformIDs(0, nullptr, &numPlatforms) != CL_SUCCESS || numPlatforms == 0)
   {
-    std::cerr << __FILE__ "(" << __LINE__ << "): no Metal devices found" << std::endl;
-    if (devices != nullptr)
-      devices->release();
-    return VkFFTResult{ VKFFT_ERROR_FAILED_TO_INITIALIZE };
+    return 0;
   }
-  if (m_VkGPU.device_id >= devices->count())
+  std::unique_ptr<cl_platform_id[]> platforms{ std::make_unique<cl_platform_id[]>(numPlatforms) };
+  if (clGetPlatformIDs(numPlatforms, platforms.get(), nullptr) != CL_SUCCESS)
   {
-    std::cerr << __FILE__ "(" << __LINE__ << "): Metal device_id " << m_VkGPU.device_id << " out of range (have "
-              << devices->count() << ")" << std::endl;
-    devices->release();
-    return VkFFTResult{ VKFFT_ERROR_FAILED_TO_GET_DEVICE };
+    return 0;
   }
-  m_VkGPU.device = devices->object<MTL::Device>(m_VkGPU.device_id);
-  m_VkGPU.device->retain();
-  devices->release();
-  m_VkGPU.queue = m_VkGPU.device->newCommandQueue();
-  if (m_VkGPU.queue == nullptr)
+  uint64_t numberOfDevices{ 0 };
+  for (cl_uint j{ 0 }; j < numPlatforms; ++j)
   {
-    std::cerr << __FILE__ "(" << __LINE__ << "): newCommandQueue failed" << std::endl;
-    return VkFFTResult{ VKFFT_ERROR_FAILED_TO_CREATE_COMMAND_QUEUE };
+    cl_uint numDevices{ 0 };
+    if (clGetDeviceIDs(platforms[j], CL_DEVICE_TYPE_ALL, 0, nullptr, &numDevices) == CL_SUCCESS)
+    {
+      numberOfDevices += numDevices;
+    }
   }
-#endif
+  return numberOfDevices;
+}
 
-  // Proceed by doing something similar to user_benchmark_VkFFT from
-  // VkFFT/benchmark_scripts/vkFFT_scripts/src/user_benchmark_VkFFT.cpp, but without file_output and
-  // output.
+// One context per device is shared by all VkCommon instances. Each
+// instance creates its own command queue on it, so pipelines on different
+// threads submit independently without each creating a context.
+struct SharedContext
+{
+  cl_platform_id platform{ nullptr };
+  cl_device_id   device{ nullptr };
+  cl_context     context{ nullptr };
+  uint64_t       numberOfUsers{ 0 };
+};
 
-  m_VkFFTConfiguration.size[0] = std::max(m_VkParameters.X, (decltype(m_VkParameters.X))1);
-  m_VkFFTConfiguration.size[1] = std::max(m_VkParameters.Y, (decltype(m_VkParameters.Y))1);
-  m_VkFFTConfiguration.size[2] = std::max(m_VkParameters.Z, (decltype(m_VkParameters.Z))1);
-  m_VkFFTConfiguration.FFTdim = 3;
-  if (m_VkFFTConfiguration.size[2] == 1)
+std::mutex &
+GetSharedContextMutex()
+{
+  static std::mutex sharedContextMutex;
+  return sharedContextMutex;
+}
+
+std::map<uint64_t, SharedContext> &
+GetSharedContexts()
+{
+  static std::map<uint64_t, SharedContext> sharedContexts;
+  return sharedContexts;
+}
+
+VkFFTResult
+AcquireSharedContext(uint64_t deviceID, cl_platform_id & platform, cl_device_id & device, cl_context & context)
+{
+  const std::lock_guard<std::mutex> lock(GetSharedContextMutex());
+  SharedContext &                   sharedContext{ GetSharedContexts()[deviceID] };
+  if (sharedContext.context == nullptr)
   {
-    --m_VkFFTConfiguration.FFTdim;
-    if (m_VkFFTConfiguration.size[1] == 1)
+    const VkFFTResult resFFT{ FindDevice(deviceID, sharedContext.platform, sharedContext.device) };
+    if (resFFT != VKFFT_SUCCESS)
     {
-      --m_VkFFTConfiguration.FFTdim;
+      GetSharedContexts().erase(deviceID);
+      return resFFT;
+    }
+    cl_int                      resCL{ CL_SUCCESS };
+    const cl_context_properties contextProperties[]{ CL_CONTEXT_PLATFORM,
+                                                     reinterpret_cast<cl_context_properties>(sharedContext.platform),
+                                                     0 };
+    sharedContext.context = clCreateContext(contextProperties, 1, &sharedContext.device, NULL, NULL, &resCL);
+    if (resCL != CL_SUCCESS)
+    {
+      std::cerr << __FILE__ "(" << __LINE__ << "): clCreateContext returned " << resCL << std::endl;
+      GetSharedContexts().erase(deviceID);
+      return VkFFTResult{ VKFFT_ERROR_FAILED_TO_CREATE_CONTEXT };
     }
   }
-  m_VkFFTConfiguration.numberBatches = m_VkParameters.B;
-  m_VkFFTConfiguration.performR2C = m_VkParameters.fft == FFTEnum::C2C ? 0 : 1;
-  if (m_VkParameters.P == PrecisionEnum::DOUBLE)
+  ++sharedContext.numberOfUsers;
+  platform = sharedContext.platform;
+  device = sharedContext.device;
+  context = sharedContext.context;
+  return VkFFTResult{ VKFFT_SUCCESS };
+}
+
+// Release the context when its last user releases it
+cl_int
+ReleaseSharedContext(uint64_t deviceID)
+{
+  const std::lock_guard<std::mutex> lock(GetSharedContextMutex());
+  const auto                        sharedContext = GetSharedContexts().find(deviceID);
+  if (sharedContext == GetSharedContexts().end() || --sharedContext->second.numberOfUsers > 0)
   {
-    m_VkFFTConfiguration.doublePrecision = 1;
+    return CL_SUCCESS;
   }
-  for (size_t dim{ 0 }; dim < 3; ++dim)
+  const cl_int resCL{ clReleaseContext(sharedContext->second.context) };
+  GetSharedContexts().erase(sharedContext);
+  return resCL;
+}
+
+// Releases a memory object, if any, at the end of a scope
+struct MemObjectReleaser
+{
+  cl_mem memObject{ nullptr };
+
+  ~MemObjectReleaser()
   {
-    m_VkFFTConfiguration.omitDimension[dim] = m_VkParameters.omitDimension[dim];
+    if (memObject)
+    {
+      clReleaseMemObject(memObject);
+    }
   }
-  // if (m_VkParameters.P == HALF)
-  //   m_VkFFTConfiguration.halfPrecision = 1;
-  m_VkFFTConfiguration.normalize = m_VkParameters.normalized == NormalizationEnum::NORMALIZED ? 1 : 0;
-  // After this, configuration file contains pointers to Vulkan objects needed to work with the GPU: VkDevice* device
-  // - created device, [uint64_t *bufferSize, VkBuffer *buffer, VkDeviceMemory* bufferDeviceMemory] - allocated GPU
-  // memory FFT is performed on. [uint64_t *kernelSize, VkBuffer *kernel, VkDeviceMemory* kernelDeviceMemory] -
-  // allocated GPU memory, where kernel for convolution is stored.
-#if (VKFFT_BACKEND == CUDA)
-  m_VkFFTConfiguration.device = &m_VkGPU.device;
-#elif (VKFFT_BACKEND == OPENCL)
-  m_VkFFTConfiguration.device = &m_VkGPU.device;
-  m_VkFFTConfiguration.platform = &m_VkGPU.platform;
-  m_VkFFTConfiguration.context = &m_VkGPU.context;
-#elif (VKFFT_BACKEND == LEVEL_ZERO)
-  m_VkFFTConfiguration.device = &m_VkGPU.device;
-  m_VkFFTConfiguration.context = &m_VkGPU.context;
-  m_VkFFTConfiguration.commandQueue = &m_VkGPU.commandQueue;
-  m_VkFFTConfiguration.commandQueueID = m_VkGPU.commandQueueID;
-#elif (VKFFT_BACKEND == METAL)
-  // Metal's VkFFTConfiguration takes single pointers, not pointer-to-pointer.
-  m_VkFFTConfiguration.device = m_VkGPU.device;
-  m_VkFFTConfiguration.queue = m_VkGPU.queue;
+};
 #endif
 
-  m_VkFFTConfiguration.makeInversePlanOnly = (m_VkParameters.I == DirectionEnum::INVERSE);
-  m_VkFFTConfiguration.makeForwardPlanOnly = (m_VkParameters.I == DirectionEnum::FORWARD);
+// Masked NCC maps as products of a fixed side plane spectrum with a moving side one: the overlap, the sums
+// of the fixed and moving images, their sums of squares and the cross-correlation
+constexpr unsigned int maskedNCCFactors[6][2]{ { 0, 3 }, { 1, 3 }, { 0, 4 }, { 2, 3 }, { 0, 5 }, { 1, 4 } };
 
-  if (m_VkParameters.fft == FFTEnum::C2C)
-  {
-    // For C2C computation we can do everything in the in-place-computation buffer.
-    m_VkFFTConfiguration.bufferNum = 1;
-    m_VkFFTConfiguration.bufferStride[0] = m_VkFFTConfiguration.size[0];
-    m_VkFFTConfiguration.bufferStride[1] = m_VkFFTConfiguration.bufferStride[0] * m_VkFFTConfiguration.size[1];
-    m_VkFFTConfiguration.bufferStride[2] = m_VkFFTConfiguration.bufferStride[1] * m_VkFFTConfiguration.size[2];
-    m_VkFFTConfiguration.bufferSize = &m_VkFFTConfiguration.bufferStride[2];
-    const uint64_t bufferBytes{ 2UL * m_VkParameters.PSize * *m_VkFFTConfiguration.bufferSize };
-    itkAssertOrThrowMacro(bufferBytes == m_VkParameters.inputBufferBytes,
-                          "CPU and GPU input buffers are of different sizes.");
-    itkAssertOrThrowMacro(bufferBytes == m_VkParameters.outputBufferBytes,
-                          "CPU and GPU output buffers are of different sizes.");
-  }
-  else
+template <typename TReal>
+void
+MultiplyMaskedNCCSpectra(std::complex<TReal> * spectra, uint64_t spectrumPixels)
+{
+  for (uint64_t i{ 0 }; i < spectrumPixels; ++i)
   {
-    // Either R2HalfH or R2FullH computation. Either forward or inverse.
-    m_VkFFTConfiguration.bufferNum = 1;
-    if (m_VkParameters.fft == FFTEnum::R2HalfH)
-    {
-      // R2HalfH computation, either forward or inverse.
-      m_VkFFTConfiguration.bufferStride[0] = m_VkFFTConfiguration.size[0] / 2 + 1;
-    }
-    else
+    std::complex<TReal> planes[6];
+    for (unsigned int plane{ 0 }; plane < 6; ++plane)
     {
-      // R2FullH computation, either forward or inverse.
-      m_VkFFTConfiguration.bufferStride[0] = m_VkFFTConfiguration.size[0];
-    }
-    m_VkFFTConfiguration.bufferStride[1] = m_VkFFTConfiguration.bufferStride[0] * m_VkFFTConfiguration.size[1];
-    m_VkFFTConfiguration.bufferStride[2] = m_VkFFTConfiguration.bufferStride[1] * m_VkFFTConfiguration.size[2];
-    m_VkFFTConfiguration.bufferSize = &m_VkFFTConfiguration.bufferStride[2];
-    const uint64_t bufferBytes{ 2UL * m_VkParameters.PSize * *m_VkFFTConfiguration.bufferSize };
-
-    if (m_VkParameters.I == DirectionEnum::FORWARD)
-    {
-      // Either R2FullH or R2HalfH.  For forward computation, we have a smaller input buffer.
-      m_VkFFTConfiguration.isInputFormatted = 1;
-      m_VkFFTConfiguration.inputBufferNum = 1;
-      m_VkFFTConfiguration.inputBufferStride[0] = m_VkFFTConfiguration.size[0];
-      m_VkFFTConfiguration.inputBufferStride[1] =
-        m_VkFFTConfiguration.inputBufferStride[0] * m_VkFFTConfiguration.size[1];
-      m_VkFFTConfiguration.inputBufferStride[2] =
-        m_VkFFTConfiguration.inputBufferStride[1] * m_VkFFTConfiguration.size[2];
-      m_VkFFTConfiguration.inputBufferSize = &m_VkFFTConfiguration.inputBufferStride[2];
-      const uint64_t inputBufferBytes{ 1UL * m_VkParameters.PSize * *m_VkFFTConfiguration.inputBufferSize };
-      itkAssertOrThrowMacro(inputBufferBytes == m_VkParameters.inputBufferBytes,
-                            "CPU and GPU input buffers are of different sizes.");
-      itkAssertOrThrowMacro(bufferBytes == m_VkParameters.outputBufferBytes,
-                            "CPU and GPU output buffers are of different sizes.");
+      planes[plane] = spectra[plane * spectrumPixels + i];
     }
-    else
+    for (unsigned int map{ 0 }; map < 6; ++map)
     {
-      // Either R2FullH or R2HalfH.  For inverse computation, we have a smaller output buffer.
-      m_VkFFTConfiguration.isOutputFormatted = 1;
-      m_VkFFTConfiguration.outputBufferNum = 1;
-      m_VkFFTConfiguration.outputBufferStride[0] = m_VkFFTConfiguration.size[0];
-      m_VkFFTConfiguration.outputBufferStride[1] =
-        m_VkFFTConfiguration.outputBufferStride[0] * m_VkFFTConfiguration.size[1];
-      m_VkFFTConfiguration.outputBufferStride[2] =
-        m_VkFFTConfiguration.outputBufferStride[1] * m_VkFFTConfiguration.size[2];
-      m_VkFFTConfiguration.outputBufferSize = &m_VkFFTConfiguration.outputBufferStride[2];
-      uint64_t outputBufferBytes{ 1UL * m_VkParameters.PSize * *m_VkFFTConfiguration.outputBufferSize };
-      itkAssertOrThrowMacro(bufferBytes == m_VkParameters.inputBufferBytes,
-                            "CPU and GPU input buffers are of different sizes.");
-      itkAssertOrThrowMacro(outputBufferBytes == m_VkParameters.outputBufferBytes,
-                            "CPU and GPU output buffers are of different sizes.");
+      spectra[map * spectrumPixels + i] = planes[maskedNCCFactors[map][0]] * planes[maskedNCCFactors[map][1]];
     }
   }
-
-  return resFFT;
 }
 
-VkFFTResult
-VkCommon::PerformFFT()
+// Product of the standard deviations of both images over the overlap at `offset` of the masked NCC maps
+template <typename TReal>
+TReal
+GetMaskedNCCDenominator(const TReal * maps, uint64_t planePixels, uint64_t offset, TReal overlap)
 {
-  VkFFTResult resFFT{ VKFFT_SUCCESS };
+  const TReal fixedSum{ maps[planePixels + offset] };
+  const TReal movingSum{ maps[2 * planePixels + offset] };
+  const TReal fixedVariance{ maps[3 * planePixels + offset] - fixedSum * fixedSum / overlap };
+  const TReal movingVariance{ maps[4 * planePixels + offset] - movingSum * movingSum / overlap };
+  return std::sqrt(std::max(fixedVariance, TReal{ 0 }) * std::max(movingVariance, TReal{ 0 }));
+}
 
-#if (VKFFT_BACKEND == CUDA)
-  cudaError resCu{ cudaSuccess };
+// Offset in a map of `planeStrides` of element `j` of the region of `outputSize` at its lowest indices
+uint64_t
+GetMapOffset(uint64_t j, const uint64_t planeStrides[3], const uint64_t outputSize[3])
+{
+  const uint64_t x{ j % outputSize[0] };
+  const uint64_t y{ j / outputSize[0] % outputSize[1] };
+  const uint64_t z{ j / (outputSize[0] * outputSize[1]) };
+  return x + y * planeStrides[0] + z * planeStrides[1];
+}
 
-  cuFloatComplex * inputGPUBuffer{ nullptr };
-  cuFloatComplex * GPUBuffer{ nullptr };
-  cuFloatComplex * outputGPUBuffer{ nullptr };
+// Correlation over `outputSize` at the lowest indices of the masked NCC maps, followed by the largest
+// overlap. Denominators within rounding error of zero come from constant overlaps and give 0.
+template <typename TReal>
+void
+NormalizeMaskedNCC(const TReal *  maps,
+                   const uint64_t planeStrides[3],
+                   const uint64_t outputSize[3],
+                   uint64_t       requiredOverlap,
+                   double         requiredOverlapFraction,
+                   TReal *        output)
+{
+  const uint64_t outputPixels{ outputSize[0] * outputSize[1] * outputSize[2] };
+  const auto     mapOffset = [&](const uint64_t j) { return GetMapOffset(j, planeStrides, outputSize); };
 
-  // Allocate the in-place-computation buffer
-  const uint64_t bufferBytes{ 2UL * m_VkParameters.PSize * *m_VkFFTConfiguration.bufferSize };
-  resCu = cudaMalloc((void **)&GPUBuffer, bufferBytes);
+  TReal maximumOverlap{ 0 };
+  TReal maximumDenominator{ 0 };
+  for (uint64_t j{ 0 }; j < outputPixels; ++j)
+  {
+    const uint64_t offset{ mapOffset(j) };
+    const TReal    overlap{ std::round(maps[offset]) };
+    if (overlap > 0)
+    {
+      maximumOverlap = std::max(maximumOverlap, overlap);
+      maximumDenominator =
+        std::max(maximumDenominator, GetMaskedNCCDenominator(maps, planeStrides[2], offset, overlap));
+    }
+  }
+
+  const TReal tolerance{ 1000 * std::numeric_limits<TReal>::epsilon() * maximumDenominator };
+  const TReal required{ std::max(static_cast<TReal>(requiredOverlap),
+                                 std::ceil(static_cast<TReal>(requiredOverlapFraction) * maximumOverlap)) };
+  for (uint64_t j{ 0 }; j < outputPixels; ++j)
+  {
+    const uint64_t offset{ mapOffset(j) };
+    const TReal    overlap{ std::round(maps[offset]) };
+    TReal          correlation{ 0 };
+    if (overlap > 0 && overlap >= required)
+    {
+      const TReal denominator{ GetMaskedNCCDenominator(maps, planeStrides[2], offset, overlap) };
+      if (denominator > tolerance)
+      {
+        const TReal numerator{ maps[5 * planeStrides[2] + offset] -
+                               maps[planeStrides[2] + offset] * maps[2 * planeStrides[2] + offset] / overlap };
+        correlation = std::min(std::max(numerator / denominator, TReal{ -1 }), TReal{ 1 });
+      }
+    }
+    output[j] = correlation;
+  }
+  output[outputPixels] = maximumOverlap;
+}
+
+// Weighted maximum over `outputSize` of each of `numberOfMaps` maps, its index and the weighted values of its
+// neighbours, laid out as the result of the MAXIMUM stage. Ties go to the lowest index.
+template <typename TReal>
+void
+FindMaxima(const TReal *    maps,
+           const uint64_t   planeStrides[3],
+           const uint64_t   outputSize[3],
+           uint64_t         numberOfMaps,
+           const TReal *    weights,
+           const uint64_t * weightPlanes,
+           void *           output)
+{
+  const uint64_t   outputPixels{ outputSize[0] * outputSize[1] * outputSize[2] };
+  uint64_t * const indices{ static_cast<uint64_t *>(output) };
+  TReal * const    values{ reinterpret_cast<TReal *>(indices + numberOfMaps) };
+  for (uint64_t map{ 0 }; map < numberOfMaps; ++map)
+  {
+    const TReal * const plane{ maps + map * planeStrides[2] };
+    const TReal * const planeWeights{ weights ? weights + (weightPlanes ? weightPlanes[map] : 0) * outputPixels
+                                              : nullptr };
+    const auto          weightedValue = [&](const uint64_t j) {
+      return plane[GetMapOffset(j, planeStrides, outputSize)] * (planeWeights ? planeWeights[j] : TReal{ 1 });
+    };
+
+    uint64_t best{ std::numeric_limits<uint64_t>::max() };
+    TReal    maximum{ 0 };
+    for (uint64_t j{ 0 }; j < outputPixels; ++j)
+    {
+      if (planeWeights && planeWeights[j] == TReal{ 0 })
+      {
+        continue;
+      }
+      const TReal value{ weightedValue(j) };
+      if (best == std::numeric_limits<uint64_t>::max() || value > maximum)
+      {
+        best = j;
+        maximum = value;
+      }
+    }
+
+    indices[map] = best;
+    TReal * const result{ values + map * VkCommon::MaximumStageValues };
+    std::fill_n(result, VkCommon::MaximumStageValues, TReal{ 0 });
+    if (best == std::numeric_limits<uint64_t>::max())
+    {
+      continue;
+    }
+    result[0] = maximum;
+    const uint64_t position[3]{ best % outputSize[0],
+                                best / outputSize[0] % outputSize[1],
+                                best / (outputSize[0] * outputSize[1]) };
+    for (unsigned int dim{ 0 }; dim < 3; ++dim)
+    {
+      for (unsigned int side{ 0 }; side < 2; ++side)
+      {
+        uint64_t neighbour[3]{ position[0], position[1], position[2] };
+        neighbour[dim] = (position[dim] + (side == 0 ? outputSize[dim] - 1 : 1)) % outputSize[dim];
+        result[1 + 2 * dim + side] =
+          weightedValue(neighbour[0] + outputSize[0] * (neighbour[1] + outputSize[1] * neighbour[2]));
+      }
+    }
+  }
+}
+
+// Offset, with the components of each pixel adjacent, of the element at `offset` in planes of `planeElements`,
+// where the `components` planes of each batch follow one another
+uint64_t
+GetInterleavedOffset(uint64_t offset, uint64_t components, uint64_t planeElements)
+{
+  const uint64_t plane{ offset / planeElements };
+  return (plane / components * planeElements + offset % planeElements) * components + plane % components;
+}
+
+#if (VKFFT_BACKEND != OPENCL)
+// Move the components of `bytes` of elements of `elementBytes` in `components` planes per batch from adjacent
+// in each pixel to planes if `toPlanes`, and back otherwise, as the reorderComponents kernel does with OpenCL
+void
+ReorderComponents(const void * source,
+                  void *       destination,
+                  uint64_t     bytes,
+                  uint64_t     elementBytes,
+                  uint64_t     components,
+                  uint64_t     planeElements,
+                  bool         toPlanes)
+{
+  const auto * const from{ static_cast<const char *>(source) };
+  auto * const       to{ static_cast<char *>(destination) };
+  for (uint64_t offset{ 0 }; offset < bytes / elementBytes; ++offset)
+  {
+    const uint64_t interleaved{ GetInterleavedOffset(offset, components, planeElements) };
+    if (toPlanes)
+    {
+      std::memcpy(to + offset * elementBytes, from + interleaved * elementBytes, elementBytes);
+    }
+    else
+    {
+      std::memcpy(to + interleaved * elementBytes, from + offset * elementBytes, elementBytes);
+    }
+  }
+}
+#endif
+
+#if (VKFFT_BACKEND == OPENCL)
+// Kernels of the output stages and of the component reorder, as the host functions above. REAL, REAL2,
+// REAL_EPSILON, GROUP_SIZE and MAXIMUM_STAGE_VALUES are defined when the program is built.
+constexpr const char * stageSource{ R"(
+__constant uint maskedNCCFactors[6][2] = { { 0, 3 }, { 1, 3 }, { 0, 4 }, { 2, 3 }, { 0, 5 }, { 1, 4 } };
+
+__kernel void
+maskedNCCMultiply(__global REAL2 * spectra, const ulong spectrumPixels)
+{
+  const ulong i = get_global_id(0);
+  if (i >= spectrumPixels)
+    return;
+  REAL2 planes[6];
+  for (uint plane = 0; plane < 6; ++plane)
+    planes[plane] = spectra[plane * spectrumPixels + i];
+  for (uint map = 0; map < 6; ++map)
+  {
+    const REAL2 a = planes[maskedNCCFactors[map][0]];
+    const REAL2 b = planes[maskedNCCFactors[map][1]];
+    spectra[map * spectrumPixels + i] = (REAL2)(a.x * b.x - a.y * b.y, a.x * b.y + a.y * b.x);
+  }
+}
+
+ulong
+mapOffset(const ulong j, const ulong strideY, const ulong strideZ, const ulong outputX, const ulong outputY)
+{
+  return j % outputX + j / outputX % outputY * strideY + j / (outputX * outputY) * strideZ;
+}
+
+REAL
+maskedNCCDenominator(__global const REAL * maps, const ulong planePixels, const ulong offset, const REAL overlap)
+{
+  const REAL fixedSum = maps[planePixels + offset];
+  const REAL movingSum = maps[2 * planePixels + offset];
+  const REAL fixedVariance = maps[3 * planePixels + offset] - fixedSum * fixedSum / overlap;
+  const REAL movingVariance = maps[4 * planePixels + offset] - movingSum * movingSum / overlap;
+  return sqrt(fmax(fixedVariance, (REAL)0) * fmax(movingVariance, (REAL)0));
+}
+
+// Run as one work group: the largest overlap and denominator, stored after the correlation
+__kernel void
+maskedNCCMaximum(__global const REAL * maps,
+                 __global REAL *       stage,
+                 const ulong           strideY,
+                 const ulong           strideZ,
+                 const ulong           planePixels,
+                 const ulong           outputX,
+                 const ulong           outputY,
+                 const ulong           outputPixels)
+{
+  __local REAL overlaps[GROUP_SIZE];
+  __local REAL denominators[GROUP_SIZE];
+  const uint   lid = get_local_id(0);
+  REAL         maximumOverlap = 0;
+  REAL         maximumDenominator = 0;
+  for (ulong j = lid; j < outputPixels; j += GROUP_SIZE)
+  {
+    const ulong offset = mapOffset(j, strideY, strideZ, outputX, outputY);
+    const REAL  overlap = round(maps[offset]);
+    if (overlap > 0)
+    {
+      maximumOverlap = fmax(maximumOverlap, overlap);
+      maximumDenominator = fmax(maximumDenominator, maskedNCCDenominator(maps, planePixels, offset, overlap));
+    }
+  }
+  overlaps[lid] = maximumOverlap;
+  denominators[lid] = maximumDenominator;
+  for (uint width = GROUP_SIZE / 2; width > 0; width /= 2)
+  {
+    barrier(CLK_LOCAL_MEM_FENCE);
+    if (lid < width)
+    {
+      overlaps[lid] = fmax(overlaps[lid], overlaps[lid + width]);
+      denominators[lid] = fmax(denominators[lid], denominators[lid + width]);
+    }
+  }
+  if (lid == 0)
+  {
+    stage[outputPixels] = overlaps[0];
+    stage[outputPixels + 1] = denominators[0];
+  }
+}
+
+__kernel void
+maskedNCCNormalize(__global const REAL * maps,
+                   __global REAL *       stage,
+                   const ulong           strideY,
+                   const ulong           strideZ,
+                   const ulong           planePixels,
+                   const ulong           outputX,
+                   const ulong           outputY,
+                   const ulong           outputPixels,
+                   const ulong           requiredOverlap,
+                   const REAL            requiredOverlapFraction)
+{
+  const ulong j = get_global_id(0);
+  if (j >= outputPixels)
+    return;
+  const REAL  tolerance = 1000 * REAL_EPSILON * stage[outputPixels + 1];
+  const REAL  required = fmax((REAL)requiredOverlap, ceil(requiredOverlapFraction * stage[outputPixels]));
+  const ulong offset = mapOffset(j, strideY, strideZ, outputX, outputY);
+  const REAL  overlap = round(maps[offset]);
+  REAL        correlation = 0;
+  if (overlap > 0 && overlap >= required)
+  {
+    const REAL denominator = maskedNCCDenominator(maps, planePixels, offset, overlap);
+    if (denominator > tolerance)
+    {
+      const REAL numerator =
+        maps[5 * planePixels + offset] - maps[planePixels + offset] * maps[2 * planePixels + offset] / overlap;
+      correlation = clamp(numerator / denominator, (REAL)-1, (REAL)1);
+    }
+  }
+  stage[j] = correlation;
+}
+
+// Run as one work group per map: the weighted maximum of each map, its index and the weighted values of its
+// neighbours, laid out as the result of the MAXIMUM stage. Ties go to the lowest index.
+__kernel void
+findMaxima(__global const REAL *  maps,
+           __global const REAL *  weights,
+           __global const ulong * weightPlanes,
+           const ulong            weighted,
+           __global ulong *       stage,
+           const ulong            strideY,
+           const ulong            strideZ,
+           const ulong            planePixels,
+           const ulong            outputX,
+           const ulong            outputY,
+           const ulong            outputZ)
+{
+  __local REAL  maxima[GROUP_SIZE];
+  __local ulong indices[GROUP_SIZE];
+  const uint    lid = get_local_id(0);
+  const ulong   map = get_group_id(0);
+  const ulong   outputPixels = outputX * outputY * outputZ;
+  __global const REAL * plane = maps + map * planePixels;
+  __global const REAL * planeWeights = weights + weightPlanes[map] * outputPixels;
+  REAL  maximum = 0;
+  ulong best = ULONG_MAX;
+  for (ulong j = lid; j < outputPixels; j += GROUP_SIZE)
+  {
+    if (weighted && planeWeights[j] == 0)
+      continue;
+    const REAL value = plane[mapOffset(j, strideY, strideZ, outputX, outputY)] * (weighted ? planeWeights[j] : 1);
+    if (best == ULONG_MAX || value > maximum)
+    {
+      best = j;
+      maximum = value;
+    }
+  }
+  maxima[lid] = maximum;
+  indices[lid] = best;
+  for (uint width = GROUP_SIZE / 2; width > 0; width /= 2)
+  {
+    barrier(CLK_LOCAL_MEM_FENCE);
+    if (lid < width && indices[lid + width] != ULONG_MAX &&
+        (indices[lid] == ULONG_MAX || maxima[lid + width] > maxima[lid] ||
+         (maxima[lid + width] == maxima[lid] && indices[lid + width] < indices[lid])))
+    {
+      maxima[lid] = maxima[lid + width];
+      indices[lid] = indices[lid + width];
+    }
+  }
+  if (lid != 0)
+    return;
+
+  __global REAL * result = (__global REAL *)(stage + get_num_groups(0)) + map * MAXIMUM_STAGE_VALUES;
+  stage[map] = indices[0];
+  for (uint k = 0; k < MAXIMUM_STAGE_VALUES; ++k)
+    result[k] = 0;
+  if (indices[0] == ULONG_MAX)
+    return;
+  result[0] = maxima[0];
+  const ulong size[3] = { outputX, outputY, outputZ };
+  const ulong position[3] = { indices[0] % outputX, indices[0] / outputX % outputY, indices[0] / (outputX * outputY) };
+  for (uint dim = 0; dim < 3; ++dim)
+  {
+    for (uint side = 0; side < 2; ++side)
+    {
+      ulong neighbour[3] = { position[0], position[1], position[2] };
+      neighbour[dim] = (position[dim] + (side == 0 ? size[dim] - 1 : 1)) % size[dim];
+      const ulong j = neighbour[0] + outputX * (neighbour[1] + outputY * neighbour[2]);
+      result[1 + 2 * dim + side] =
+        plane[mapOffset(j, strideY, strideZ, outputX, outputY)] * (weighted ? planeWeights[j] : 1);
+    }
+  }
+}
+
+// Run over the REAL words of the planes: move the components of each pixel from adjacent to planes if
+// toPlanes, and back otherwise
+__kernel void
+reorderComponents(__global const REAL * source,
+                  __global REAL *       destination,
+                  const ulong           words,
+                  const ulong           elementWords,
+                  const ulong           components,
+                  const ulong           planeElements,
+                  const uint            toPlanes)
+{
+  const ulong i = get_global_id(0);
+  if (i >= words)
+    return;
+  const ulong offset = i / elementWords;
+  const ulong plane = offset / planeElements;
+  const ulong interleaved =
+    ((plane / components * planeElements + offset % planeElements) * components + plane % components) * elementWords +
+    i % elementWords;
+  if (toPlanes)
+    destination[i] = source[interleaved];
+  else
+    destination[interleaved] = source[i];
+}
+)" };
+
+// Kernels of stageSource, in the order of VkCommon::m_StageKernels
+enum StageKernel : size_t
+{
+  MaskedNCCMultiplyKernel,
+  MaskedNCCMaximumKernel,
+  MaskedNCCNormalizeKernel,
+  FindMaximaKernel,
+  ReorderComponentsKernel
+};
+constexpr const char * stageKernelNames[]{
+  "maskedNCCMultiply", "maskedNCCMaximum", "maskedNCCNormalize", "findMaxima", "reorderComponents"
+};
+
+// Set the arguments of `kernel` in order
+template <typename... TArguments>
+cl_int
+SetKernelArguments(cl_kernel kernel, const TArguments &... arguments)
+{
+  cl_uint   index{ 0 };
+  cl_int    resCL{ CL_SUCCESS };
+  const int expand[]{ 0,
+                      (resCL = resCL == CL_SUCCESS ? clSetKernelArg(kernel, index++, sizeof(TArguments), &arguments)
+                                                   : resCL,
+                       0)... };
+  (void)expand;
+  return resCL;
+}
+
+// Enqueue `kernel` over at least `workItems` work items, in work groups of `groupSize`
+cl_int
+EnqueueKernel(cl_command_queue commandQueue, cl_kernel kernel, uint64_t workItems, size_t groupSize)
+{
+  const size_t globalSize{ static_cast<size_t>((workItems + groupSize - 1) / groupSize * groupSize) };
+  return clEnqueueNDRangeKernel(commandQueue, kernel, 1, nullptr, &globalSize, &groupSize, 0, nullptr, nullptr);
+}
+#endif
+
+// Transforms of the plans held by all VkCommon instances, one entry per plan.
+// Instances lock their run mutex before this one, never the other way around.
+std::mutex                          planRegistryMutex;
+std::vector<VkCommon::VkParameters> planRegistry;
+
+void
+RegisterPlan(const VkCommon::VkParameters & vkParameters)
+{
+  const std::lock_guard<std::mutex> lock(planRegistryMutex);
+  planRegistry.push_back(vkParameters);
+}
+
+void
+UnregisterPlan(const VkCommon::VkParameters & vkParameters)
+{
+  const std::lock_guard<std::mutex> lock(planRegistryMutex);
+  const auto                        found{ std::find_if(
+    planRegistry.begin(), planRegistry.end(), [&vkParameters](const VkCommon::VkParameters & registered) {
+      return !(registered != vkParameters);
+    }) };
+  if (found != planRegistry.end())
+  {
+    planRegistry.erase(found);
+  }
+}
+
+// Operations per element of one radix pass of the transform cost estimate.
+// VkFFT merges powers of two into radix-4 and radix-8 kernels, so each factor
+// of 2 is cheaper than a standalone radix-2 pass would suggest; greater
+// radices cost about 3 operations per element per unit of radix.
+constexpr std::pair<uint64_t, double> radixCosts[]{ { 2, 5.0 },   { 3, 11.3 },  { 5, 16.7 },
+                                                     { 7, 22.7 }, { 11, 34.7 }, { 13, 40.0 } };
+// Operations per element worth one round trip through device memory.
+constexpr double uploadCost{ 26.7 };
+} // namespace
+
+VkFFTResult
+VkCommon::Run(const VkGPU & vkGPU, const VkParameters & vkParameters)
+{
+  const std::lock_guard<std::mutex> lock(m_RunMutex);
+  const VkTraceScope                traceScope{ "VkCommon::Run", "VkCommon", vkGPU.device_id };
+  m_LastRunTimings = VkTimings{};
+  m_LastRunTimings.numberOfRuns = 1;
+  const VkFFTResult resFFT{ this->ConfigureAndPerformFFT(vkGPU, vkParameters) };
+  m_VkTimings += m_LastRunTimings;
+  return resFFT;
+}
+
+VkFFTResult
+VkCommon::ConfigureAndPerformFFT(const VkGPU & vkGPU, const VkParameters & vkParameters)
+{
+  VkFFTResult resFFT{ VKFFT_SUCCESS };
+
+  itkAssertOrThrowMacro(vkParameters.outputStage != OutputStageEnum::MASKED_NCC ||
+                          (vkParameters.fft == FFTEnum::R2HalfH && vkParameters.I == DirectionEnum::FORWARD &&
+                           vkParameters.B == 6 && vkParameters.C == 1 && !vkParameters.convolution),
+                        "The masked NCC stage follows a forward R2HalfH run of six planes.");
+  itkAssertOrThrowMacro(vkParameters.outputStage == OutputStageEnum::NONE ||
+                          (vkParameters.stageOutputSize[0] <= vkParameters.X &&
+                           vkParameters.stageOutputSize[1] <= std::max(vkParameters.Y, uint64_t{ 1 }) &&
+                           vkParameters.stageOutputSize[2] <= std::max(vkParameters.Z, uint64_t{ 1 })),
+                        "The output stage reads beyond the transform.");
+  itkAssertOrThrowMacro(vkParameters.outputStage != OutputStageEnum::MAXIMUM ||
+                          (vkParameters.fft == FFTEnum::R2HalfH &&
+                           (vkParameters.I == DirectionEnum::INVERSE || vkParameters.convolution)),
+                        "The maximum stage follows a run with real output maps.");
+  itkAssertOrThrowMacro(!vkParameters.transformKernel ||
+                          (vkParameters.convolution && vkParameters.fft == FFTEnum::R2HalfH),
+                        "Kernels are transformed on the GPU only for R2HalfH convolution.");
+  itkAssertOrThrowMacro(!vkParameters.kernelPerBatch || vkParameters.convolution,
+                        "Kernels are given for each batch only for convolution.");
+  itkAssertOrThrowMacro(!vkParameters.interleavedComponents ||
+                          (!vkParameters.convolution && vkParameters.outputStage == OutputStageEnum::NONE),
+                        "Components are interleaved only for runs without convolution or output stage.");
+
+  if (m_MustConfigure || vkGPU != m_VkGPUPrevious)
+  {
+    ClockType::time_point phaseStart{ ClockType::now() };
+    // Release the plan and the handles of the previous device before replacing them
+    resFFT = this->ReleaseBackend();
+    if (resFFT != VKFFT_SUCCESS)
+    {
+      return resFFT;
+    }
+    m_VkGPU = vkGPU;
+    m_VkGPUPrevious = vkGPU;
+    resFFT = this->ConfigureBackend();
+    AccumulatePhase(m_LastRunTimings.setupSeconds, phaseStart, "Setup", m_VkGPU.device_id);
+    if (resFFT != VKFFT_SUCCESS)
+    {
+      // Do not reuse a partial configuration
+      this->m_MustConfigure = true;
+      return resFFT;
+    }
+    this->m_MustConfigure = false;
+  }
+
+  if (!m_HasPlan || vkParameters != m_VkParametersPrevious)
+  {
+    VkTracer::AddInstantEvent("PlanCacheMiss", "VkCommon", m_VkGPU.device_id);
+    m_LastRunTimings.numberOfConfigurations = 1;
+    this->ReleasePlan();
+    m_VkParameters = vkParameters;
+    m_VkParametersPrevious = vkParameters;
+    resFFT = this->ConfigurePlan();
+    if (resFFT != VKFFT_SUCCESS)
+    {
+      return resFFT;
+    }
+  }
+  else
+  {
+    VkTracer::AddInstantEvent("PlanCacheHit", "VkCommon", m_VkGPU.device_id);
+    // Only the CPU buffers differ from the run that made the plan
+    m_VkParameters = vkParameters;
+  }
+  itkAssertOrThrowMacro(this->GetInputBufferBytes() == m_VkParameters.inputBufferBytes,
+                        "CPU and GPU input buffers are of different sizes.");
+  itkAssertOrThrowMacro(this->GetOutputBufferBytes() == m_VkParameters.outputBufferBytes,
+                        "CPU and GPU output buffers are of different sizes.");
+  itkAssertOrThrowMacro(this->GetKernelBufferBytes() ==
+                          (m_VkParameters.convolution ? m_VkParameters.kernelBufferBytes : 0),
+                        "CPU and GPU kernel buffers are of different sizes.");
+  if (m_VkParameters.outputStage == OutputStageEnum::MAXIMUM && m_VkParameters.stageWeightsCPUBuffer)
+  {
+    const uint64_t planeBytes{ m_VkParameters.PSize * this->GetStageOutputPixels() };
+    const uint64_t numberOfPlanes{ m_VkParameters.stageWeightsBufferBytes / planeBytes };
+    itkAssertOrThrowMacro(m_VkParameters.stageWeightsBufferBytes == numberOfPlanes * planeBytes &&
+                            numberOfPlanes >= 1 && numberOfPlanes <= this->GetNumberOfStageMaps(),
+                          "Weights of the maximum stage are not whole planes of its region.");
+    for (uint64_t map{ 0 }; m_VkParameters.stageWeightPlanes && map < this->GetNumberOfStageMaps(); ++map)
+    {
+      itkAssertOrThrowMacro(m_VkParameters.stageWeightPlanes[map] < numberOfPlanes,
+                            "Weight plane of the maximum stage out of range.");
+    }
+  }
+
+  return this->PerformFFT();
+}
+
+VkFFTResult
+VkCommon::ConfigureBackend()
+{
+  VkFFTResult resFFT{ VKFFT_SUCCESS };
+#if (VKFFT_BACKEND == CUDA)
+  CUresult    res{ CUDA_SUCCESS };
+  cudaError_t res2{ cudaSuccess };
+  res = cuInit(0);
+  if (res != CUDA_SUCCESS)
+    return VkFFTResult{ VKFFT_ERROR_FAILED_TO_INITIALIZE };
+  res2 = cudaSetDevice((int)m_VkGPU.device_id);
+  if (res2 != cudaSuccess)
+    return VkFFTResult{ VKFFT_ERROR_FAILED_TO_SET_DEVICE_ID };
+  res = cuDeviceGet(&m_VkGPU.device, (int)m_VkGPU.device_id);
+  if (res != CUDA_SUCCESS)
+    return VkFFTResult{ VKFFT_ERROR_FAILED_TO_GET_DEVICE };
+  // Share the device's primary context with all other users in the process
+  res = cuDevicePrimaryCtxRetain(&m_VkGPU.context, m_VkGPU.device);
+  if (res != CUDA_SUCCESS)
+    return VkFFTResult{ VKFFT_ERROR_FAILED_TO_CREATE_CONTEXT };
+  // Submit copies and transforms to a stream of this instance, which does not synchronize with the default
+  // stream, so that runs of other instances in the shared context overlap with them
+  res2 = cudaStreamCreateWithFlags(&m_VkGPU.stream, cudaStreamNonBlocking);
+  if (res2 != cudaSuccess)
+  {
+    std::cerr << __FILE__ "(" << __LINE__ << "): cudaStreamCreateWithFlags returned " << res2 << std::endl;
+    return VkFFTResult{ VKFFT_ERROR_FAILED_TO_CREATE_COMMAND_QUEUE };
+  }
+
+#elif (VKFFT_BACKEND == OPENCL)
+  cl_int resCL{ CL_SUCCESS };
+
+  resFFT = AcquireSharedContext(m_VkGPU.device_id, m_VkGPU.platform, m_VkGPU.device, m_VkGPU.context);
+  if (resFFT != VKFFT_SUCCESS)
+  {
+    return resFFT;
+  }
+  const cl_command_queue_properties queueProperties{ m_VkGPU.profiling ? CL_QUEUE_PROFILING_ENABLE
+                                                                        : cl_command_queue_properties{ 0 } };
+  m_VkGPU.commandQueue = clCreateCommandQueue(m_VkGPU.context, m_VkGPU.device, queueProperties, &resCL);
+  if (resCL != CL_SUCCESS)
+  {
+    std::cerr << __FILE__ "(" << __LINE__ << "): clCreateCommandQueue returned " << resCL << std::endl;
+    return VkFFTResult{ VKFFT_ERROR_FAILED_TO_CREATE_COMMAND_QUEUE };
+  }
+  m_HostPointerAlignment = GetHostPointerAlignment(m_VkGPU.device);
+#elif (VKFFT_BACKEND == LEVEL_ZERO)
+  ze_result_t resZE{ ZE_RESULT_SUCCESS };
+  resZE = zeInit(0);
+  if (resZE != ZE_RESULT_SUCCESS)
+  {
+    std::cerr << __FILE__ "(" << __LINE__ << "): zeInit returned " << resZE << std::endl;
+    return VkFFTResult{ VKFFT_ERROR_FAILED_TO_INITIALIZE };
+  }
+  uint32_t numDrivers{ 0 };
+  resZE = zeDriverGet(&numDrivers, nullptr);
+  if (resZE != ZE_RESULT_SUCCESS || numDrivers == 0)
+    return VkFFTResult{ VKFFT_ERROR_FAILED_TO_INITIALIZE };
+  std::unique_ptr<ze_driver_handle_t[]> drivers{ std::make_unique<ze_driver_handle_t[]>(numDrivers) };
+  resZE = zeDriverGet(&numDrivers, drivers.get());
+  if (resZE != ZE_RESULT_SUCCESS)
+    return VkFFTResult{ VKFFT_ERROR_FAILED_TO_INITIALIZE };
+  uint64_t k{ 0 };
+  bool     found{ false };
+  for (uint32_t j{ 0 }; j < numDrivers && !found; ++j)
+  {
+    uint32_t numDevices{ 0 };
+    resZE = zeDeviceGet(drivers[j], &numDevices, nullptr);
+    if (resZE != ZE_RESULT_SUCCESS)
+      return VkFFTResult{ VKFFT_ERROR_FAILED_TO_GET_DEVICE };
+    std::unique_ptr<ze_device_handle_t[]> deviceList{ std::make_unique<ze_device_handle_t[]>(numDevices) };
+    resZE = zeDeviceGet(drivers[j], &numDevices, deviceList.get());
+    if (resZE != ZE_RESULT_SUCCESS)
+      return VkFFTResult{ VKFFT_ERROR_FAILED_TO_GET_DEVICE };
+    for (uint32_t i{ 0 }; i < numDevices && !found; ++i)
+    {
+      if (k == m_VkGPU.device_id)
+      {
+        m_VkGPU.driver = drivers[j];
+        m_VkGPU.device = deviceList[i];
+
+        ze_context_desc_t contextDescription{};
+        contextDescription.stype = ZE_STRUCTURE_TYPE_CONTEXT_DESC;
+        resZE = zeContextCreate(m_VkGPU.driver, &contextDescription, &m_VkGPU.context);
+        if (resZE != ZE_RESULT_SUCCESS)
+          return VkFFTResult{ VKFFT_ERROR_FAILED_TO_CREATE_CONTEXT };
+
+        uint32_t queueGroupCount{ 0 };
+        resZE = zeDeviceGetCommandQueueGroupProperties(m_VkGPU.device, &queueGroupCount, nullptr);
+        if (resZE != ZE_RESULT_SUCCESS || queueGroupCount == 0)
+          return VkFFTResult{ VKFFT_ERROR_FAILED_TO_CREATE_COMMAND_QUEUE };
+        std::unique_ptr<ze_command_queue_group_properties_t[]> queueGroupProps{
+          std::make_unique<ze_command_queue_group_properties_t[]>(queueGroupCount)
+        };
+        resZE = zeDeviceGetCommandQueueGroupProperties(m_VkGPU.device, &queueGroupCount, queueGroupProps.get());
+        if (resZE != ZE_RESULT_SUCCESS)
+          return VkFFTResult{ VKFFT_ERROR_FAILED_TO_CREATE_COMMAND_QUEUE };
+        uint32_t commandQueueID{ static_cast<uint32_t>(-1) };
+        for (uint32_t g{ 0 }; g < queueGroupCount; ++g)
+        {
+          if ((queueGroupProps[g].flags & ZE_COMMAND_QUEUE_GROUP_PROPERTY_FLAG_COMPUTE) &&
+              (queueGroupProps[g].flags & ZE_COMMAND_QUEUE_GROUP_PROPERTY_FLAG_COPY))
+          {
+            commandQueueID = g;
+            break;
+          }
+        }
+        if (commandQueueID == static_cast<uint32_t>(-1))
+          return VkFFTResult{ VKFFT_ERROR_FAILED_TO_CREATE_COMMAND_QUEUE };
+        m_VkGPU.commandQueueID = commandQueueID;
+
+        ze_command_queue_desc_t commandQueueDescription{};
+        commandQueueDescription.stype = ZE_STRUCTURE_TYPE_COMMAND_QUEUE_DESC;
+        commandQueueDescription.ordinal = commandQueueID;
+        commandQueueDescription.priority = ZE_COMMAND_QUEUE_PRIORITY_NORMAL;
+        commandQueueDescription.mode = ZE_COMMAND_QUEUE_MODE_DEFAULT;
+        resZE = zeCommandQueueCreate(m_VkGPU.context, m_VkGPU.device, &commandQueueDescription, &m_VkGPU.commandQueue);
+        if (resZE != ZE_RESULT_SUCCESS)
+          return VkFFTResult{ VKFFT_ERROR_FAILED_TO_CREATE_COMMAND_QUEUE };
+        found = true;
+      }
+      else
+      {
+        ++k;
+      }
+    }
+  }
+  if (!found)
+  {
+    std::cerr << __FILE__ "(" << __LINE__ << "): Level Zero device_id " << m_VkGPU.device_id << " not found"
+              << std::endl;
+    return VkFFTResult{ VKFFT_ERROR_FAILED_TO_GET_DEVICE };
+  }
+#elif (VKFFT_BACKEND == METAL)
+  // Enumerate Metal devices and pick by device_id.
+  NS::Array * devices = MTL::CopyAllDevices();
+  if (devices == nullptr || devices->count() == 0)
+  {
+    std::cerr << __FILE__ "(" << __LINE__ << "): no Metal devices found" << std::endl;
+    if (devices != nullptr)
+      devices->release();
+    return VkFFTResult{ VKFFT_ERROR_FAILED_TO_INITIALIZE };
+  }
+  if (m_VkGPU.device_id >= devices->count())
+  {
+    std::cerr << __FILE__ "(" << __LINE__ << "): Metal device_id " << m_VkGPU.device_id << " out of range (have "
+              << devices->count() << ")" << std::endl;
+    devices->release();
+    return VkFFTResult{ VKFFT_ERROR_FAILED_TO_GET_DEVICE };
+  }
+  m_VkGPU.device = devices->object<MTL::Device>(m_VkGPU.device_id);
+  m_VkGPU.device->retain();
+  devices->release();
+  m_VkGPU.queue = m_VkGPU.device->newCommandQueue();
+  if (m_VkGPU.queue == nullptr)
+  {
+    std::cerr << __FILE__ "(" << __LINE__ << "): newCommandQueue failed" << std::endl;
+    return VkFFTResult{ VKFFT_ERROR_FAILED_TO_CREATE_COMMAND_QUEUE };
+  }
+#endif
+
+  return resFFT;
+}
+
+VkFFTResult
+VkCommon::ConfigurePlan()
+{
+  VkFFTResult           resFFT{ VKFFT_SUCCESS };
+  ClockType::time_point phaseStart{ ClockType::now() };
+
+#if (VKFFT_BACKEND == CUDA)
+  // The calling thread may differ from the one that configured the backend
+  if (cuCtxSetCurrent(m_VkGPU.context) != CUDA_SUCCESS)
+  {
+    return VkFFTResult{ VKFFT_ERROR_FAILED_TO_SET_DEVICE_ID };
+  }
+#endif
+
+  // Start from a clean configuration so that no setting of a previous one remains
+  m_VkFFTConfiguration = VkFFTConfiguration{};
+
+  // Proceed by doing something similar to user_benchmark_VkFFT from
+  // VkFFT/benchmark_scripts/vkFFT_scripts/src/user_benchmark_VkFFT.cpp, but without file_output and
+  // output.
+
+  m_VkFFTConfiguration.size[0] = std::max(m_VkParameters.X, (decltype(m_VkParameters.X))1);
+  m_VkFFTConfiguration.size[1] = std::max(m_VkParameters.Y, (decltype(m_VkParameters.Y))1);
+  m_VkFFTConfiguration.size[2] = std::max(m_VkParameters.Z, (decltype(m_VkParameters.Z))1);
+  m_VkFFTConfiguration.FFTdim = 3;
+  if (m_VkFFTConfiguration.size[2] == 1)
+  {
+    --m_VkFFTConfiguration.FFTdim;
+    if (m_VkFFTConfiguration.size[1] == 1)
+    {
+      --m_VkFFTConfiguration.FFTdim;
+    }
+  }
+  m_VkFFTConfiguration.numberBatches = m_VkParameters.B;
+  m_VkFFTConfiguration.coordinateFeatures = m_VkParameters.C;
+  m_VkFFTConfiguration.performR2C = this->IsInPlace() ? 0 : 1;
+  if (m_VkParameters.fft == FFTEnum::R2R)
+  {
+    const auto r2r = static_cast<uint64_t>(m_VkParameters.r2r);
+    if (r2r > 10)
+    {
+      m_VkFFTConfiguration.performDST = r2r - 10;
+    }
+    else
+    {
+      m_VkFFTConfiguration.performDCT = r2r;
+    }
+  }
+  if (m_VkParameters.P == PrecisionEnum::DOUBLE)
+  {
+    m_VkFFTConfiguration.doublePrecision = 1;
+  }
+  for (size_t dim{ 0 }; dim < 3; ++dim)
+  {
+    m_VkFFTConfiguration.omitDimension[dim] = m_VkParameters.omitDimension[dim];
+  }
+  // if (m_VkParameters.P == HALF)
+  //   m_VkFFTConfiguration.halfPrecision = 1;
+  m_VkFFTConfiguration.normalize = m_VkParameters.normalized == NormalizationEnum::NORMALIZED ? 1 : 0;
+  if (m_VkParameters.convolution)
+  {
+    // The forward transform, the products with the kernel spectra and the inverse
+    // transforms of the products run in one append of this application
+    m_VkFFTConfiguration.performConvolution = 1;
+    m_VkFFTConfiguration.numberKernels = m_VkParameters.numberOfKernels;
+    m_VkFFTConfiguration.singleKernelMultipleBatches = m_VkParameters.kernelPerBatch ? 0 : 1;
+    m_VkFFTConfiguration.conjugateConvolution = m_VkParameters.conjugateKernel ? 2 : 0;
+    m_VkFFTConfiguration.crossPowerSpectrumNormalization = m_VkParameters.normalizeProducts ? 1 : 0;
+  }
+  // After this, configuration file contains pointers to Vulkan objects needed to work with the GPU: VkDevice* device
+  // - created device, [uint64_t *bufferSize, VkBuffer *buffer, VkDeviceMemory* bufferDeviceMemory] - allocated GPU
+  // memory FFT is performed on. [uint64_t *kernelSize, VkBuffer *kernel, VkDeviceMemory* kernelDeviceMemory] -
+  // allocated GPU memory, where kernel for convolution is stored.
+#if (VKFFT_BACKEND == CUDA)
+  m_VkFFTConfiguration.device = &m_VkGPU.device;
+  m_VkFFTConfiguration.stream = &m_VkGPU.stream;
+  m_VkFFTConfiguration.num_streams = 1;
+#elif (VKFFT_BACKEND == OPENCL)
+  m_VkFFTConfiguration.device = &m_VkGPU.device;
+  m_VkFFTConfiguration.platform = &m_VkGPU.platform;
+  m_VkFFTConfiguration.context = &m_VkGPU.context;
+#elif (VKFFT_BACKEND == LEVEL_ZERO)
+  m_VkFFTConfiguration.device = &m_VkGPU.device;
+  m_VkFFTConfiguration.context = &m_VkGPU.context;
+  m_VkFFTConfiguration.commandQueue = &m_VkGPU.commandQueue;
+  m_VkFFTConfiguration.commandQueueID = m_VkGPU.commandQueueID;
+#elif (VKFFT_BACKEND == METAL)
+  // Metal's VkFFTConfiguration takes single pointers, not pointer-to-pointer.
+  m_VkFFTConfiguration.device = m_VkGPU.device;
+  m_VkFFTConfiguration.queue = m_VkGPU.queue;
+#endif
+
+  m_VkFFTConfiguration.makeInversePlanOnly = (m_VkParameters.I == DirectionEnum::INVERSE);
+  m_VkFFTConfiguration.makeForwardPlanOnly =
+    (m_VkParameters.I == DirectionEnum::FORWARD && !m_VkParameters.convolution);
+
+  // Configure the buffers.  Some of the three GPU buffers are duplicates of each other, so don't release
+  // all of them at the end.  All re-striding of data (for R2HalfH or R2FullH, regardless of forward vs.
+  // inverse) is done by VkFFT between the two GPU buffers it uses.
+  m_VkFFTConfiguration.bufferNum = 1;
+  if (this->IsInPlace())
+  {
+    // For C2C and R2R computation we can do everything in the in-place-computation buffer.
+    m_VkFFTConfiguration.bufferStride[0] = m_VkFFTConfiguration.size[0];
+  }
+  else if (m_VkParameters.fft == FFTEnum::R2HalfH)
+  {
+    // R2HalfH computation, either forward or inverse.
+    m_VkFFTConfiguration.bufferStride[0] = m_VkFFTConfiguration.size[0] / 2 + 1;
+  }
+  else
+  {
+    // R2FullH computation, either forward or inverse.
+    m_VkFFTConfiguration.bufferStride[0] = m_VkFFTConfiguration.size[0];
+  }
+  m_VkFFTConfiguration.bufferStride[1] = m_VkFFTConfiguration.bufferStride[0] * m_VkFFTConfiguration.size[1];
+  m_VkFFTConfiguration.bufferStride[2] = m_VkFFTConfiguration.bufferStride[1] * m_VkFFTConfiguration.size[2];
+  // A convolution holds the product with each kernel in the main buffer
+  const uint64_t numberOfKernels{ m_VkParameters.convolution ? m_VkParameters.numberOfKernels : 1 };
+  m_BufferSize = numberOfKernels * m_VkParameters.B * m_VkParameters.C * m_VkFFTConfiguration.bufferStride[2];
+  m_VkFFTConfiguration.bufferSize = &m_BufferSize;
+  resFFT = this->AllocateGPUBuffer(m_GPUBuffer, this->GetBufferBytes());
+  if (resFFT != VKFFT_SUCCESS)
+  {
+    return resFFT;
+  }
+  m_VkFFTConfiguration.buffer = &m_GPUBuffer;
+  m_InputGPUBuffer = m_GPUBuffer;
+  m_OutputGPUBuffer = m_GPUBuffer;
+
+  if (this->HasFormattedInput())
+  {
+    // Either R2FullH or R2HalfH.  For forward computation, we have a smaller input buffer.
+    m_VkFFTConfiguration.isInputFormatted = 1;
+    m_VkFFTConfiguration.inputBufferNum = 1;
+    m_VkFFTConfiguration.inputBufferStride[0] = m_VkFFTConfiguration.size[0];
+    m_VkFFTConfiguration.inputBufferStride[1] =
+      m_VkFFTConfiguration.inputBufferStride[0] * m_VkFFTConfiguration.size[1];
+    m_VkFFTConfiguration.inputBufferStride[2] =
+      m_VkFFTConfiguration.inputBufferStride[1] * m_VkFFTConfiguration.size[2];
+    m_InputBufferSize = m_VkParameters.B * m_VkParameters.C * m_VkFFTConfiguration.inputBufferStride[2];
+    m_VkFFTConfiguration.inputBufferSize = &m_InputBufferSize;
+    m_InputGPUBuffer = nullptr;
+    resFFT = this->AllocateGPUBuffer(m_InputGPUBuffer, this->GetInputBufferBytes());
+    if (resFFT != VKFFT_SUCCESS)
+    {
+      this->ReleasePlan();
+      return resFFT;
+    }
+    m_VkFFTConfiguration.inputBuffer = &m_InputGPUBuffer;
+  }
+  if (this->HasFormattedOutput())
+  {
+    // Either R2FullH or R2HalfH.  For inverse computation and convolution, we have a smaller output buffer.
+    m_VkFFTConfiguration.isOutputFormatted = 1;
+    m_VkFFTConfiguration.outputBufferNum = 1;
+    m_VkFFTConfiguration.outputBufferStride[0] = m_VkFFTConfiguration.size[0];
+    m_VkFFTConfiguration.outputBufferStride[1] =
+      m_VkFFTConfiguration.outputBufferStride[0] * m_VkFFTConfiguration.size[1];
+    m_VkFFTConfiguration.outputBufferStride[2] =
+      m_VkFFTConfiguration.outputBufferStride[1] * m_VkFFTConfiguration.size[2];
+    m_OutputBufferSize =
+      numberOfKernels * m_VkParameters.B * m_VkParameters.C * m_VkFFTConfiguration.outputBufferStride[2];
+    m_VkFFTConfiguration.outputBufferSize = &m_OutputBufferSize;
+    m_OutputGPUBuffer = nullptr;
+    // VkFFT writes all of its output to the GPU buffer even when an output stage copies back less
+    resFFT = this->AllocateGPUBuffer(m_OutputGPUBuffer, m_VkParameters.PSize * m_OutputBufferSize);
+    if (resFFT != VKFFT_SUCCESS)
+    {
+      this->ReleasePlan();
+      return resFFT;
+    }
+    m_VkFFTConfiguration.outputBuffer = &m_OutputGPUBuffer;
+  }
+  if (m_VkParameters.convolution)
+  {
+    // Kernel spectra are stored as the main buffer of a single product
+    m_KernelBufferBytes = this->GetNumberOfKernelPlanes() * m_VkParameters.C * 2 * m_VkParameters.PSize *
+                          m_VkFFTConfiguration.bufferStride[2];
+    m_VkFFTConfiguration.kernelNum = 1;
+    m_VkFFTConfiguration.kernelSize = &m_KernelBufferBytes;
+    resFFT = this->AllocateGPUBuffer(m_KernelGPUBuffer, m_KernelBufferBytes);
+    if (resFFT != VKFFT_SUCCESS)
+    {
+      this->ReleasePlan();
+      return resFFT;
+    }
+    m_VkFFTConfiguration.kernel = &m_KernelGPUBuffer;
+  }
+  if (m_VkParameters.transformKernel)
+  {
+    // Real kernels are copied to a buffer of their own, with the layout of the input
+    m_KernelInputBufferBytes = this->GetNumberOfKernelPlanes() * m_VkParameters.C * m_VkParameters.PSize *
+                               m_VkFFTConfiguration.size[0] * m_VkFFTConfiguration.size[1] *
+                               m_VkFFTConfiguration.size[2];
+    resFFT = this->AllocateGPUBuffer(m_KernelInputGPUBuffer, m_KernelInputBufferBytes);
+    if (resFFT != VKFFT_SUCCESS)
+    {
+      this->ReleasePlan();
+      return resFFT;
+    }
+  }
+  AccumulatePhase(m_LastRunTimings.allocationSeconds, phaseStart, "Allocation", m_VkGPU.device_id);
+
+  // Initialize applications. This function loads shaders, creates pipeline and configures FFT based on configuration
+  // file. No buffer allocations inside VkFFT library.
+  resFFT = initializeVkFFT(&m_VkFFTApplication, m_VkFFTConfiguration);
+  if (resFFT == VKFFT_SUCCESS)
+  {
+    m_HasPlan = true;
+    RegisterPlan(m_VkParameters);
+    if (m_VkParameters.transformKernel)
+    {
+      resFFT = this->ConfigureKernelTransform();
+    }
+    if (resFFT == VKFFT_SUCCESS)
+    {
+      resFFT = this->ConfigureOutputStage();
+    }
+    if (resFFT == VKFFT_SUCCESS)
+    {
+      resFFT = this->ConfigureComponentReorder();
+    }
+  }
+  AccumulatePhase(m_LastRunTimings.planSeconds, phaseStart, "Plan", m_VkGPU.device_id);
+  if (resFFT != VKFFT_SUCCESS)
+  {
+    this->ReleasePlan();
+    return resFFT;
+  }
+
+  return resFFT;
+}
+
+VkFFTResult
+VkCommon::ConfigureKernelTransform()
+{
+  // Forward transforms of the real kernels, one batch each, from their own buffer into the kernel buffer.
+  // kernelConvolution lays the spectra out as the convolution plan reads them, which differs from the
+  // layout of a plain transform for sizes that take several uploads.
+  VkFFTConfiguration configuration{ m_VkFFTConfiguration };
+  configuration.kernelConvolution = 1;
+  configuration.performConvolution = 0;
+  configuration.singleKernelMultipleBatches = 0;
+  configuration.conjugateConvolution = 0;
+  configuration.crossPowerSpectrumNormalization = 0;
+  configuration.numberKernels = 1;
+  configuration.kernelNum = 0;
+  configuration.kernelSize = nullptr;
+  configuration.kernel = nullptr;
+  configuration.makeForwardPlanOnly = 1;
+  configuration.makeInversePlanOnly = 0;
+  configuration.normalize = 0;
+  configuration.numberBatches = this->GetNumberOfKernelPlanes();
+  configuration.bufferSize = &m_KernelBufferBytes;
+  configuration.buffer = &m_KernelGPUBuffer;
+  configuration.inputBufferSize = &m_KernelInputBufferBytes;
+  configuration.inputBuffer = &m_KernelInputGPUBuffer;
+  configuration.isOutputFormatted = 0;
+  configuration.outputBufferNum = 0;
+  configuration.outputBufferSize = nullptr;
+  configuration.outputBuffer = nullptr;
+  const VkFFTResult resFFT{ initializeVkFFT(&m_KernelVkFFTApplication, configuration) };
+  if (resFFT == VKFFT_SUCCESS)
+  {
+    m_HasKernelPlan = true;
+  }
+  return resFFT;
+}
+
+VkFFTResult
+VkCommon::ConfigureOutputStage()
+{
+  if (m_VkParameters.outputStage == OutputStageEnum::NONE)
+  {
+    return VkFFTResult{ VKFFT_SUCCESS };
+  }
+
+  // The result of the masked NCC is followed by its largest denominator
+  const uint64_t stageBytes{ this->GetStageOutputBytes() +
+                             (m_VkParameters.outputStage == OutputStageEnum::MASKED_NCC ? m_VkParameters.PSize : 0) };
+  VkFFTResult    resFFT{ this->AllocateGPUBuffer(m_StageGPUBuffer, stageBytes) };
+  if (resFFT != VKFFT_SUCCESS)
+  {
+    return resFFT;
+  }
+
+  if (m_VkParameters.outputStage == OutputStageEnum::MASKED_NCC)
+  {
+    // The products in the main buffer are transformed back into the input buffer,
+    // which holds the planes only until the forward transforms are done
+    VkFFTConfiguration configuration{ m_VkFFTConfiguration };
+    configuration.makeForwardPlanOnly = 0;
+    configuration.makeInversePlanOnly = 1;
+    configuration.normalize = 1;
+    configuration.isInputFormatted = 0;
+    configuration.inputBuffer = nullptr;
+    configuration.isOutputFormatted = 1;
+    configuration.outputBufferNum = 1;
+    for (size_t dim{ 0 }; dim < 3; ++dim)
+    {
+      configuration.outputBufferStride[dim] = m_VkFFTConfiguration.inputBufferStride[dim];
+    }
+    configuration.outputBufferSize = &m_InputBufferSize;
+    configuration.outputBuffer = &m_InputGPUBuffer;
+    resFFT = initializeVkFFT(&m_StageVkFFTApplication, configuration);
+    if (resFFT != VKFFT_SUCCESS)
+    {
+      return resFFT;
+    }
+    m_HasStagePlan = true;
+  }
+
+#if (VKFFT_BACKEND == OPENCL)
+  if (m_VkParameters.outputStage == OutputStageEnum::MAXIMUM)
+  {
+    // Room for a weight plane per map, and the plane of each map
+    const uint64_t numberOfMaps{ this->GetNumberOfStageMaps() };
+    resFFT = this->AllocateGPUBuffer(m_StageWeightsGPUBuffer,
+                                     numberOfMaps * this->GetStageOutputPixels() * m_VkParameters.PSize);
+    if (resFFT == VKFFT_SUCCESS)
+    {
+      resFFT = this->AllocateGPUBuffer(m_StageWeightPlanesGPUBuffer, numberOfMaps * sizeof(cl_ulong));
+    }
+    if (resFFT != VKFFT_SUCCESS)
+    {
+      return resFFT;
+    }
+  }
+
+  resFFT = this->ConfigureStageKernels();
+#endif
+
+  return resFFT;
+}
+
+VkFFTResult
+VkCommon::ConfigureComponentReorder()
+{
+  if (!m_VkParameters.interleavedComponents)
+  {
+    return VkFFTResult{ VKFFT_SUCCESS };
+  }
+#if (VKFFT_BACKEND == OPENCL)
+  // The CPU buffers are copied to and from this buffer, and reordered between it and the buffers of VkFFT
+  VkFFTResult resFFT{ this->AllocateGPUBuffer(m_ReorderGPUBuffer,
+                                              std::max(this->GetInputBufferBytes(), this->GetOutputBufferBytes())) };
+  if (resFFT == VKFFT_SUCCESS)
+  {
+    resFFT = this->ConfigureStageKernels();
+  }
+  return resFFT;
+#else
+  // The components are reordered on the host
+  return VkFFTResult{ VKFFT_SUCCESS };
+#endif
+}
+
+#if (VKFFT_BACKEND == OPENCL)
+VkFFTResult
+VkCommon::ConfigureStageKernels()
+{
+  if (m_StageProgram)
+  {
+    return VkFFTResult{ VKFFT_SUCCESS };
+  }
+
+  // Reductions run in work groups of the largest power of two up to 256 work items that the device allows
+  size_t maximumGroupSize{ 1 };
+  clGetDeviceInfo(m_VkGPU.device, CL_DEVICE_MAX_WORK_GROUP_SIZE, sizeof(size_t), &maximumGroupSize, nullptr);
+  m_StageGroupSize = 1;
+  while (2 * m_StageGroupSize <= std::min<size_t>(maximumGroupSize, 256))
+  {
+    m_StageGroupSize *= 2;
+  }
+
+  const bool         doublePrecision{ m_VkParameters.P == PrecisionEnum::DOUBLE };
+  const std::string  source{ std::string{ doublePrecision ? "#pragma OPENCL EXTENSION cl_khr_fp64 : enable\n" : "" } +
+                            stageSource };
+  const char *       sourceText{ source.c_str() };
+  cl_int             resCL{ CL_SUCCESS };
+  std::ostringstream options;
+  options << (doublePrecision ? "-DREAL=double -DREAL2=double2 -DREAL_EPSILON=DBL_EPSILON"
+                              : "-DREAL=float -DREAL2=float2 -DREAL_EPSILON=FLT_EPSILON")
+          << " -DGROUP_SIZE=" << m_StageGroupSize << " -DMAXIMUM_STAGE_VALUES=" << MaximumStageValues;
+  m_StageProgram = clCreateProgramWithSource(m_VkGPU.context, 1, &sourceText, nullptr, &resCL);
+  if (resCL != CL_SUCCESS)
+  {
+    std::cerr << __FILE__ "(" << __LINE__ << "): clCreateProgramWithSource returned " << resCL << std::endl;
+    m_StageProgram = nullptr;
+    return VkFFTResult{ VKFFT_ERROR_FAILED_TO_CREATE_PROGRAM };
+  }
+  resCL = clBuildProgram(m_StageProgram, 1, &m_VkGPU.device, options.str().c_str(), nullptr, nullptr);
+  if (resCL != CL_SUCCESS)
+  {
+    size_t logBytes{ 0 };
+    clGetProgramBuildInfo(m_StageProgram, m_VkGPU.device, CL_PROGRAM_BUILD_LOG, 0, nullptr, &logBytes);
+    std::string log(logBytes, '\0');
+    clGetProgramBuildInfo(m_StageProgram, m_VkGPU.device, CL_PROGRAM_BUILD_LOG, logBytes, &log[0], nullptr);
+    std::cerr << __FILE__ "(" << __LINE__ << "): clBuildProgram returned " << resCL << std::endl << log << std::endl;
+    return VkFFTResult{ VKFFT_ERROR_FAILED_TO_COMPILE_PROGRAM };
+  }
+  for (const char * kernelName : stageKernelNames)
+  {
+    const cl_kernel kernel{ clCreateKernel(m_StageProgram, kernelName, &resCL) };
+    if (resCL != CL_SUCCESS)
+    {
+      std::cerr << __FILE__ "(" << __LINE__ << "): clCreateKernel returned " << resCL << std::endl;
+      return VkFFTResult{ VKFFT_ERROR_FAILED_TO_GET_FUNCTION };
+    }
+    m_StageKernels.push_back(kernel);
+  }
+  return VkFFTResult{ VKFFT_SUCCESS };
+}
+#endif
+
+void
+VkCommon::ReleaseOutputStage()
+{
+#if (VKFFT_BACKEND == OPENCL)
+  for (const cl_kernel kernel : m_StageKernels)
+  {
+    clReleaseKernel(kernel);
+  }
+  m_StageKernels.clear();
+  if (m_StageProgram)
+  {
+    clReleaseProgram(m_StageProgram);
+    m_StageProgram = nullptr;
+  }
+  this->ReleaseGPUBuffer(m_StageWeightsGPUBuffer);
+  this->ReleaseGPUBuffer(m_StageWeightPlanesGPUBuffer);
+  this->ReleaseGPUBuffer(m_ReorderGPUBuffer);
+#endif
+  if (m_HasStagePlan)
+  {
+    deleteVkFFT(&m_StageVkFFTApplication);
+    m_StageVkFFTApplication = VkFFTApplication{};
+    m_HasStagePlan = false;
+  }
+  this->ReleaseGPUBuffer(m_StageGPUBuffer);
+}
+
+void
+VkCommon::ReleasePlan()
+{
+#if (VKFFT_BACKEND == CUDA)
+  if (m_VkGPU.context)
+  {
+    cuCtxSetCurrent(m_VkGPU.context);
+  }
+#endif
+  this->ReleaseOutputStage();
+  if (m_HasKernelPlan)
+  {
+    deleteVkFFT(&m_KernelVkFFTApplication);
+    m_KernelVkFFTApplication = VkFFTApplication{};
+    m_HasKernelPlan = false;
+  }
+  if (m_HasPlan)
+  {
+    deleteVkFFT(&m_VkFFTApplication);
+    m_VkFFTApplication = VkFFTApplication{};
+    m_HasPlan = false;
+    UnregisterPlan(m_VkParameters);
+  }
+
+  // The input or output buffer is the main buffer except when it is a separate, smaller one
+  if (m_InputGPUBuffer == m_GPUBuffer)
+  {
+    m_InputGPUBuffer = nullptr;
+  }
+  if (m_OutputGPUBuffer == m_GPUBuffer)
+  {
+    m_OutputGPUBuffer = nullptr;
+  }
+  this->ReleaseGPUBuffer(m_InputGPUBuffer);
+  this->ReleaseGPUBuffer(m_OutputGPUBuffer);
+  this->ReleaseGPUBuffer(m_GPUBuffer);
+  this->ReleaseGPUBuffer(m_KernelGPUBuffer);
+  this->ReleaseGPUBuffer(m_KernelInputGPUBuffer);
+  m_KernelBufferBytes = 0;
+  m_KernelInputBufferBytes = 0;
+  m_KernelModifiedTime = 0;
+}
+
+VkFFTResult
+VkCommon::AllocateGPUBuffer(GPUBufferType & buffer, uint64_t bytes)
+{
+#if (VKFFT_BACKEND == CUDA)
+  const cudaError_t resCu{ cudaMalloc(&buffer, bytes) };
+  if (resCu != cudaSuccess)
+  {
+    std::cerr << __FILE__ "(" << __LINE__ << "): cudaMalloc returned " << resCu << std::endl;
+    return VkFFTResult{ VKFFT_ERROR_FAILED_TO_ALLOCATE };
+  }
+#elif (VKFFT_BACKEND == OPENCL)
+  cl_int resCL{ CL_SUCCESS };
+  buffer = clCreateBuffer(m_VkGPU.context, CL_MEM_READ_WRITE, bytes, nullptr, &resCL);
+  if (resCL != CL_SUCCESS)
+  {
+    std::cerr << __FILE__ "(" << __LINE__ << "): clCreateBuffer returned " << resCL << std::endl;
+    buffer = nullptr;
+    return VkFFTResult{ VKFFT_ERROR_FAILED_TO_ALLOCATE };
+  }
+#elif (VKFFT_BACKEND == LEVEL_ZERO)
+  ze_device_mem_alloc_desc_t deviceMemDesc{};
+  deviceMemDesc.stype = ZE_STRUCTURE_TYPE_DEVICE_MEM_ALLOC_DESC;
+  if (zeMemAllocDevice(m_VkGPU.context, &deviceMemDesc, bytes, m_VkParameters.PSize, m_VkGPU.device, &buffer) !=
+      ZE_RESULT_SUCCESS)
+  {
+    buffer = nullptr;
+    return VkFFTResult{ VKFFT_ERROR_FAILED_TO_ALLOCATE };
+  }
+#elif (VKFFT_BACKEND == METAL)
+  // Metal shared-storage buffers are CPU-visible on Apple unified-memory systems,
+  // so host<->device transfers reduce to memcpy into/out of MTL::Buffer::contents().
+  buffer = m_VkGPU.device->newBuffer(bytes, MTL::ResourceStorageModeShared);
+  if (buffer == nullptr)
+  {
+    return VkFFTResult{ VKFFT_ERROR_FAILED_TO_ALLOCATE };
+  }
+#endif
+  return VkFFTResult{ VKFFT_SUCCESS };
+}
+
+void
+VkCommon::ReleaseGPUBuffer(GPUBufferType & buffer)
+{
+  if (!buffer)
+  {
+    return;
+  }
+#if (VKFFT_BACKEND == CUDA)
+  cudaFree(buffer);
+#elif (VKFFT_BACKEND == OPENCL)
+  clReleaseMemObject(buffer);
+#elif (VKFFT_BACKEND == LEVEL_ZERO)
+  zeMemFree(m_VkGPU.context, buffer);
+#elif (VKFFT_BACKEND == METAL)
+  buffer->release();
+#endif
+  buffer = nullptr;
+}
+
+VkFFTResult
+VkCommon::CopyToGPU(GPUBufferType buffer, const void * cpuBuffer, uint64_t bytes, double * deviceSeconds)
+{
+#if (VKFFT_BACKEND == CUDA)
+  cudaEvent_t events[2]{};
+  if (deviceSeconds)
+  {
+    for (auto & event : events)
+    {
+      const cudaError_t resEvent{ cudaEventCreate(&event) };
+      if (resEvent != cudaSuccess)
+      {
+        std::cerr << __FILE__ "(" << __LINE__ << "): cudaEventCreate returned " << resEvent << std::endl;
+        return VkFFTResult{ VKFFT_ERROR_FAILED_TO_CREATE_EVENT };
+      }
+    }
+    cudaEventRecord(events[0], m_VkGPU.stream);
+  }
+  cudaError_t resCu{ cudaMemcpyAsync(buffer, cpuBuffer, bytes, cudaMemcpyHostToDevice, m_VkGPU.stream) };
+  if (resCu == cudaSuccess)
+  {
+    resCu = cudaStreamSynchronize(m_VkGPU.stream);
+  }
+  if (deviceSeconds)
+  {
+    cudaEventRecord(events[1], m_VkGPU.stream);
+    cudaEventSynchronize(events[1]);
+    *deviceSeconds += GetElapsedSeconds(events[0], events[1]);
+    for (auto & event : events)
+    {
+      cudaEventDestroy(event);
+    }
+  }
+  if (resCu != cudaSuccess)
+  {
+    std::cerr << __FILE__ "(" << __LINE__ << "): cudaMemcpyAsync returned " << resCu << std::endl;
+    return VkFFTResult{ VKFFT_ERROR_FAILED_TO_COPY };
+  }
+#elif (VKFFT_BACKEND == OPENCL)
+  cl_event     writeEvent{ nullptr };
+  const cl_int resCL{ clEnqueueWriteBuffer(m_VkGPU.commandQueue,
+                                           buffer,
+                                           CL_TRUE,
+                                           0,
+                                           bytes,
+                                           cpuBuffer,
+                                           0,
+                                           nullptr,
+                                           deviceSeconds ? &writeEvent : nullptr) };
+  if (resCL != CL_SUCCESS)
+  {
+    std::cerr << __FILE__ "(" << __LINE__ << "): clEnqueueWriteBuffer returned " << resCL << std::endl;
+    return VkFFTResult{ VKFFT_ERROR_FAILED_TO_COPY };
+  }
+  if (writeEvent)
+  {
+    *deviceSeconds += GetElapsedSeconds(writeEvent, writeEvent);
+    clReleaseEvent(writeEvent);
+  }
+#elif (VKFFT_BACKEND == LEVEL_ZERO)
+  // Host -> device copy via an immediate command list on the compute/copy queue group.
+  (void)deviceSeconds;
+  ze_command_queue_desc_t copyQueueDesc{};
+  copyQueueDesc.stype = ZE_STRUCTURE_TYPE_COMMAND_QUEUE_DESC;
+  copyQueueDesc.ordinal = m_VkGPU.commandQueueID;
+  copyQueueDesc.mode = ZE_COMMAND_QUEUE_MODE_DEFAULT;
+  copyQueueDesc.priority = ZE_COMMAND_QUEUE_PRIORITY_NORMAL;
+  ze_command_list_handle_t copyCommandList{ nullptr };
+  ze_result_t resZE{ zeCommandListCreateImmediate(m_VkGPU.context, m_VkGPU.device, &copyQueueDesc, &copyCommandList) };
+  if (resZE != ZE_RESULT_SUCCESS)
+    return VkFFTResult{ VKFFT_ERROR_FAILED_TO_CREATE_COMMAND_LIST };
+  resZE = zeCommandListAppendMemoryCopy(copyCommandList, buffer, cpuBuffer, bytes, nullptr, 0, nullptr);
+  if (resZE == ZE_RESULT_SUCCESS)
+    resZE = zeCommandQueueSynchronize(m_VkGPU.commandQueue, UINT32_MAX);
+  zeCommandListDestroy(copyCommandList);
+  if (resZE != ZE_RESULT_SUCCESS)
+    return VkFFTResult{ VKFFT_ERROR_FAILED_TO_COPY };
+#elif (VKFFT_BACKEND == METAL)
+  (void)deviceSeconds;
+  std::memcpy(buffer->contents(), cpuBuffer, bytes);
+#endif
+  return VkFFTResult{ VKFFT_SUCCESS };
+}
+
+VkFFTResult
+VkCommon::CopyFromGPU(void * cpuBuffer, GPUBufferType buffer, uint64_t bytes, double * deviceSeconds)
+{
+#if (VKFFT_BACKEND == CUDA)
+  cudaEvent_t events[2]{};
+  if (deviceSeconds)
+  {
+    for (auto & event : events)
+    {
+      const cudaError_t resEvent{ cudaEventCreate(&event) };
+      if (resEvent != cudaSuccess)
+      {
+        std::cerr << __FILE__ "(" << __LINE__ << "): cudaEventCreate returned " << resEvent << std::endl;
+        return VkFFTResult{ VKFFT_ERROR_FAILED_TO_CREATE_EVENT };
+      }
+    }
+    cudaEventRecord(events[0], m_VkGPU.stream);
+  }
+  cudaError_t resCu{ cudaMemcpyAsync(cpuBuffer, buffer, bytes, cudaMemcpyDeviceToHost, m_VkGPU.stream) };
+  if (resCu == cudaSuccess)
+  {
+    resCu = cudaStreamSynchronize(m_VkGPU.stream);
+  }
+  if (deviceSeconds)
+  {
+    cudaEventRecord(events[1], m_VkGPU.stream);
+    cudaEventSynchronize(events[1]);
+    *deviceSeconds += GetElapsedSeconds(events[0], events[1]);
+    for (auto & event : events)
+    {
+      cudaEventDestroy(event);
+    }
+  }
+  if (resCu != cudaSuccess)
+  {
+    std::cerr << __FILE__ "(" << __LINE__ << "): cudaMemcpyAsync returned " << resCu << std::endl;
+    return VkFFTResult{ VKFFT_ERROR_FAILED_TO_COPY };
+  }
+#elif (VKFFT_BACKEND == OPENCL)
+  cl_event     readEvent{ nullptr };
+  const cl_int resCL{ clEnqueueReadBuffer(m_VkGPU.commandQueue,
+                                          buffer,
+                                          CL_TRUE,
+                                          0,
+                                          bytes,
+                                          cpuBuffer,
+                                          0,
+                                          nullptr,
+                                          deviceSeconds ? &readEvent : nullptr) };
+  if (resCL != CL_SUCCESS)
+  {
+    std::cerr << __FILE__ "(" << __LINE__ << "): clEnqueueReadBuffer returned " << resCL << std::endl;
+    return VkFFTResult{ VKFFT_ERROR_FAILED_TO_COPY };
+  }
+  if (readEvent)
+  {
+    *deviceSeconds += GetElapsedSeconds(readEvent, readEvent);
+    clReleaseEvent(readEvent);
+  }
+#elif (VKFFT_BACKEND == LEVEL_ZERO)
+  // Device -> host copy via an immediate command list.
+  (void)deviceSeconds;
+  ze_command_queue_desc_t copyQueueDesc{};
+  copyQueueDesc.stype = ZE_STRUCTURE_TYPE_COMMAND_QUEUE_DESC;
+  copyQueueDesc.ordinal = m_VkGPU.commandQueueID;
+  copyQueueDesc.mode = ZE_COMMAND_QUEUE_MODE_DEFAULT;
+  copyQueueDesc.priority = ZE_COMMAND_QUEUE_PRIORITY_NORMAL;
+  ze_command_list_handle_t copyCommandList{ nullptr };
+  ze_result_t resZE{ zeCommandListCreateImmediate(m_VkGPU.context, m_VkGPU.device, &copyQueueDesc, &copyCommandList) };
+  if (resZE != ZE_RESULT_SUCCESS)
+    return VkFFTResult{ VKFFT_ERROR_FAILED_TO_CREATE_COMMAND_LIST };
+  resZE = zeCommandListAppendMemoryCopy(copyCommandList, cpuBuffer, buffer, bytes, nullptr, 0, nullptr);
+  if (resZE == ZE_RESULT_SUCCESS)
+    resZE = zeCommandQueueSynchronize(m_VkGPU.commandQueue, UINT32_MAX);
+  zeCommandListDestroy(copyCommandList);
+  if (resZE != ZE_RESULT_SUCCESS)
+    return VkFFTResult{ VKFFT_ERROR_FAILED_TO_COPY };
+#elif (VKFFT_BACKEND == METAL)
+  (void)deviceSeconds;
+  std::memcpy(cpuBuffer, buffer->contents(), bytes);
+#endif
+  return VkFFTResult{ VKFFT_SUCCESS };
+}
+
+VkFFTResult
+VkCommon::PerformFFT()
+{
+  VkFFTResult           resFFT{ VKFFT_SUCCESS };
+  ClockType::time_point phaseStart{ ClockType::now() };
+
+  // GPU buffers of this run: those of the plan, except for CPU buffers used in place
+  GPUBufferType inputGPUBuffer{ m_InputGPUBuffer };
+  GPUBufferType GPUBuffer{ m_GPUBuffer };
+  GPUBufferType outputGPUBuffer{ m_OutputGPUBuffer };
+
+#if (VKFFT_BACKEND == CUDA)
+  cudaError resCu{ cudaSuccess };
+
+  // The calling thread may differ from the one that configured the backend
+  if (cuCtxSetCurrent(m_VkGPU.context) != CUDA_SUCCESS)
+  {
+    return VkFFTResult{ VKFFT_ERROR_FAILED_TO_SET_DEVICE_ID };
+  }
+
+  // Events bracketing the transform
+  cudaEvent_t kernelEvents[2]{};
+  if (m_VkGPU.profiling)
+  {
+    for (auto & event : kernelEvents)
+    {
+      resCu = cudaEventCreate(&event);
+      if (resCu != cudaSuccess)
+      {
+        std::cerr << __FILE__ "(" << __LINE__ << "): cudaEventCreate returned " << resCu << std::endl;
+        return VkFFTResult{ VKFFT_ERROR_FAILED_TO_CREATE_EVENT };
+      }
+    }
+  }
+  constexpr bool zeroCopyInput{ false };
+  constexpr bool zeroCopyOutput{ false };
+#elif (VKFFT_BACKEND == OPENCL)
+  cl_int resCL{ CL_SUCCESS };
+
+  // On devices that share memory with the host, CPU buffers that are aligned as the device requires are
+  // used in place with CL_MEM_USE_HOST_PTR rather than copied. The main computation overwrites its
+  // buffer, so the const CPU input buffer is used in place only as the separate input buffer of forward
+  // R2HalfH or R2FullH computation. C2C and R2R computation runs in the CPU output buffer instead: the
+  // input is copied into it on the host before the buffer is created, since the host must not write to
+  // it afterwards, and that copy takes the place of, and is timed as, the copy to the device. The
+  // buffers created on the CPU buffers of this run replace those of the plan at launch and are released
+  // at the end of the run.
+  const auto isHostAligned = [this](const void * pointer) {
+    return m_HostPointerAlignment > 0 && reinterpret_cast<uintptr_t>(pointer) % m_HostPointerAlignment == 0;
+  };
+  // The result of an output stage is copied from a GPU buffer of its own, and interleaved components
+  // are reordered through one
+  const bool zeroCopyOutput{ m_VkParameters.outputStage == OutputStageEnum::NONE &&
+                             !m_VkParameters.interleavedComponents && isHostAligned(m_VkParameters.outputCPUBuffer) };
+  const bool zeroCopyInput{ this->IsInPlace() ? zeroCopyOutput
+                                              : m_VkParameters.I == DirectionEnum::FORWARD &&
+                                                  !m_VkParameters.interleavedComponents &&
+                                                  isHostAligned(m_VkParameters.inputCPUBuffer) };
+  MemObjectReleaser hostOutputBuffer{};
+  MemObjectReleaser hostInputBuffer{};
+  if (zeroCopyOutput)
+  {
+    if (this->IsInPlace() && m_VkParameters.inputCPUBuffer != m_VkParameters.outputCPUBuffer)
+    {
+      std::memcpy(m_VkParameters.outputCPUBuffer, m_VkParameters.inputCPUBuffer, m_VkParameters.inputBufferBytes);
+      AccumulatePhase(m_LastRunTimings.hostToDeviceSeconds, phaseStart, "HostToDevice", m_VkGPU.device_id);
+    }
+    hostOutputBuffer.memObject = clCreateBuffer(m_VkGPU.context,
+                                                CL_MEM_READ_WRITE | CL_MEM_USE_HOST_PTR,
+                                                m_VkParameters.outputBufferBytes,
+                                                m_VkParameters.outputCPUBuffer,
+                                                &resCL);
+    if (resCL != CL_SUCCESS)
+    {
+      std::cerr << __FILE__ "(" << __LINE__ << "): clCreateBuffer returned " << resCL << std::endl;
+      return VkFFTResult{ VKFFT_ERROR_FAILED_TO_ALLOCATE };
+    }
+    if (outputGPUBuffer == GPUBuffer)
+    {
+      // The main buffer holds the output for C2C, R2R and forward computation
+      GPUBuffer = hostOutputBuffer.memObject;
+    }
+    if (inputGPUBuffer == outputGPUBuffer)
+    {
+      inputGPUBuffer = hostOutputBuffer.memObject;
+    }
+    outputGPUBuffer = hostOutputBuffer.memObject;
+  }
+  if (zeroCopyInput && !this->IsInPlace())
+  {
+    hostInputBuffer.memObject = clCreateBuffer(m_VkGPU.context,
+                                               CL_MEM_READ_ONLY | CL_MEM_USE_HOST_PTR,
+                                               m_VkParameters.inputBufferBytes,
+                                               const_cast<void *>(m_VkParameters.inputCPUBuffer),
+                                               &resCL);
+    if (resCL != CL_SUCCESS)
+    {
+      std::cerr << __FILE__ "(" << __LINE__ << "): clCreateBuffer returned " << resCL << std::endl;
+      return VkFFTResult{ VKFFT_ERROR_FAILED_TO_ALLOCATE };
+    }
+    inputGPUBuffer = hostInputBuffer.memObject;
+  }
+  AccumulatePhase(m_LastRunTimings.allocationSeconds, phaseStart, "Allocation", m_VkGPU.device_id);
+#else
+  constexpr bool zeroCopyInput{ false };
+  constexpr bool zeroCopyOutput{ false };
+#endif
+
+  // Copy the kernel spectra from CPU to GPU, or the real kernels to be transformed there,
+  // unless those of a previous run still apply
+  if (m_VkParameters.convolution &&
+      (m_VkParameters.kernelModifiedTime == 0 || m_VkParameters.kernelModifiedTime != m_KernelModifiedTime))
+  {
+    resFFT = this->CopyToGPU(m_VkParameters.transformKernel ? m_KernelInputGPUBuffer : m_KernelGPUBuffer,
+                             m_VkParameters.kernelCPUBuffer,
+                             m_VkParameters.kernelBufferBytes,
+                             m_VkGPU.profiling ? &m_LastRunTimings.deviceHostToDeviceSeconds : nullptr);
+    if (resFFT == VKFFT_SUCCESS && m_VkParameters.transformKernel)
+    {
+      AccumulatePhase(m_LastRunTimings.hostToDeviceSeconds, phaseStart, "HostToDevice", m_VkGPU.device_id);
+      VkFFTLaunchParams kernelLaunchParams{};
+      kernelLaunchParams.buffer = &m_KernelGPUBuffer;
+      kernelLaunchParams.inputBuffer = &m_KernelInputGPUBuffer;
+      resFFT = this->AppendAndWait(m_KernelVkFFTApplication, DirectionEnum::FORWARD, kernelLaunchParams);
+      AccumulatePhase(m_LastRunTimings.appendSeconds, phaseStart, "KernelTransform", m_VkGPU.device_id);
+    }
+    if (resFFT != VKFFT_SUCCESS)
+    {
+      m_KernelModifiedTime = 0;
+      return resFFT;
+    }
+    m_KernelModifiedTime = m_VkParameters.kernelModifiedTime;
+  }
+
+  // Copy input from CPU to GPU
+  if (m_VkParameters.interleavedComponents)
+  {
+    resFFT = this->CopyComponentsToGPU(inputGPUBuffer);
+    if (resFFT != VKFFT_SUCCESS)
+    {
+      return resFFT;
+    }
+  }
+  else if (!zeroCopyInput)
+  {
+    resFFT = this->CopyToGPU(inputGPUBuffer,
+                             m_VkParameters.inputCPUBuffer,
+                             m_VkParameters.inputBufferBytes,
+                             m_VkGPU.profiling ? &m_LastRunTimings.deviceHostToDeviceSeconds : nullptr);
+    if (resFFT != VKFFT_SUCCESS)
+    {
+      return resFFT;
+    }
+  }
+  AccumulatePhase(m_LastRunTimings.hostToDeviceSeconds, phaseStart, "HostToDevice", m_VkGPU.device_id);
+
+  // Submit FFT or iFFT on the buffers of this run, which VkFFT binds in place of those of the plan.
+  VkFFTLaunchParams launchParams{};
+  launchParams.buffer = &GPUBuffer;
+  if (m_VkFFTConfiguration.isInputFormatted)
+  {
+    launchParams.inputBuffer = &inputGPUBuffer;
+  }
+  if (m_VkFFTConfiguration.isOutputFormatted)
+  {
+    launchParams.outputBuffer = &outputGPUBuffer;
+  }
+  if (m_VkParameters.convolution)
+  {
+    launchParams.kernel = &m_KernelGPUBuffer;
+  }
+#if (VKFFT_BACKEND == CUDA)
+  if (m_VkGPU.profiling)
+    cudaEventRecord(kernelEvents[0], m_VkGPU.stream);
+#elif (VKFFT_BACKEND == OPENCL)
+  launchParams.commandQueue = &m_VkGPU.commandQueue;
+  cl_event kernelStartEvent{ nullptr };
+  if (m_VkGPU.profiling)
+  {
+    resCL = clEnqueueMarkerWithWaitList(m_VkGPU.commandQueue, 0, nullptr, &kernelStartEvent);
+    if (resCL != CL_SUCCESS)
+    {
+      std::cerr << __FILE__ "(" << __LINE__ << "): clEnqueueMarkerWithWaitList returned " << resCL << std::endl;
+      return VkFFTResult{ VKFFT_ERROR_FAILED_TO_CREATE_EVENT };
+    }
+  }
+#elif (VKFFT_BACKEND == LEVEL_ZERO)
+  ze_result_t            resZE{ ZE_RESULT_SUCCESS };
+  ze_command_list_desc_t commandListDescription{};
+  commandListDescription.stype = ZE_STRUCTURE_TYPE_COMMAND_LIST_DESC;
+  commandListDescription.commandQueueGroupOrdinal = m_VkGPU.commandQueueID;
+  ze_command_list_handle_t launchCommandList{ nullptr };
+  resZE = zeCommandListCreate(m_VkGPU.context, m_VkGPU.device, &commandListDescription, &launchCommandList);
+  if (resZE != ZE_RESULT_SUCCESS)
+    return VkFFTResult{ VKFFT_ERROR_FAILED_TO_CREATE_COMMAND_LIST };
+  launchParams.commandList = &launchCommandList;
+#elif (VKFFT_BACKEND == METAL)
+  MTL::CommandBuffer *         metalCommandBuffer = m_VkGPU.queue->commandBuffer();
+  MTL::ComputeCommandEncoder * metalEncoder = metalCommandBuffer->computeCommandEncoder();
+  launchParams.commandBuffer = metalCommandBuffer;
+  launchParams.commandEncoder = metalEncoder;
+#endif
 
+  resFFT = VkFFTAppend(&m_VkFFTApplication, m_VkParameters.I == DirectionEnum::INVERSE ? 1 : -1, &launchParams);
+  AccumulatePhase(m_LastRunTimings.appendSeconds, phaseStart, "Append", m_VkGPU.device_id);
+  if (resFFT != VKFFT_SUCCESS)
+    return resFFT;
+
+#if (VKFFT_BACKEND == CUDA)
+  if (m_VkGPU.profiling)
+    cudaEventRecord(kernelEvents[1], m_VkGPU.stream);
+  resCu = cudaStreamSynchronize(m_VkGPU.stream);
   if (resCu != cudaSuccess)
   {
-    std::cerr << __FILE__ "(" << __LINE__ << "): cudaMalloc returned " << resCu << std::endl;
-    return VkFFTResult{ VKFFT_ERROR_FAILED_TO_ALLOCATE };
+    std::cerr << __FILE__ "(" << __LINE__ << "): cudaStreamSynchronize returned " << resCu << std::endl;
+    return VkFFTResult{ VKFFT_ERROR_FAILED_TO_SYNCHRONIZE };
+  }
+  if (m_VkGPU.profiling)
+  {
+    m_LastRunTimings.deviceKernelSeconds = GetElapsedSeconds(kernelEvents[0], kernelEvents[1]);
+    for (auto & event : kernelEvents)
+    {
+      cudaEventDestroy(event);
+    }
+  }
+#elif (VKFFT_BACKEND == OPENCL)
+  cl_event kernelEndEvent{ nullptr };
+  if (m_VkGPU.profiling)
+  {
+    resCL = clEnqueueMarkerWithWaitList(m_VkGPU.commandQueue, 0, nullptr, &kernelEndEvent);
+    if (resCL != CL_SUCCESS)
+    {
+      std::cerr << __FILE__ "(" << __LINE__ << "): clEnqueueMarkerWithWaitList returned " << resCL << std::endl;
+      return VkFFTResult{ VKFFT_ERROR_FAILED_TO_CREATE_EVENT };
+    }
+  }
+  resCL = clFinish(m_VkGPU.commandQueue);
+  if (resCL != CL_SUCCESS)
+  {
+    std::cerr << __FILE__ "(" << __LINE__ << "): clFinish returned " << resCL << std::endl;
+    return VkFFTResult{ VKFFT_ERROR_FAILED_TO_SYNCHRONIZE };
+  }
+  if (m_VkGPU.profiling)
+  {
+    m_LastRunTimings.deviceKernelSeconds = GetElapsedSeconds(kernelStartEvent, kernelEndEvent);
+    clReleaseEvent(kernelStartEvent);
+    clReleaseEvent(kernelEndEvent);
+  }
+#elif (VKFFT_BACKEND == LEVEL_ZERO)
+  resZE = zeCommandListClose(launchCommandList);
+  if (resZE != ZE_RESULT_SUCCESS)
+    return VkFFTResult{ VKFFT_ERROR_FAILED_TO_SUBMIT_QUEUE };
+  resZE = zeCommandQueueExecuteCommandLists(m_VkGPU.commandQueue, 1, &launchCommandList, nullptr);
+  if (resZE != ZE_RESULT_SUCCESS)
+    return VkFFTResult{ VKFFT_ERROR_FAILED_TO_SUBMIT_QUEUE };
+  resZE = zeCommandQueueSynchronize(m_VkGPU.commandQueue, UINT32_MAX);
+  if (resZE != ZE_RESULT_SUCCESS)
+    return VkFFTResult{ VKFFT_ERROR_FAILED_TO_SYNCHRONIZE };
+  zeCommandListDestroy(launchCommandList);
+#elif (VKFFT_BACKEND == METAL)
+  metalEncoder->endEncoding();
+  metalCommandBuffer->commit();
+  metalCommandBuffer->waitUntilCompleted();
+  if (m_VkGPU.profiling)
+  {
+    m_LastRunTimings.deviceKernelSeconds = metalCommandBuffer->GPUEndTime() - metalCommandBuffer->GPUStartTime();
   }
+#endif
+  AccumulatePhase(m_LastRunTimings.synchronizeSeconds, phaseStart, "Synchronize", m_VkGPU.device_id);
 
-  m_VkFFTConfiguration.buffer = reinterpret_cast<void **>(&GPUBuffer);
+  if (m_VkParameters.outputStage != OutputStageEnum::NONE)
+  {
+    // Only the result of the stage is copied to the CPU
+    resFFT = this->PerformOutputStage();
+    AccumulatePhase(m_LastRunTimings.outputStageSeconds, phaseStart, "OutputStage", m_VkGPU.device_id);
+    if (resFFT != VKFFT_SUCCESS)
+    {
+      return resFFT;
+    }
+  }
 
-  if (m_VkParameters.fft == FFTEnum::C2C)
+  // Copy result from GPU to CPU
+#if (VKFFT_BACKEND == OPENCL)
+  if (zeroCopyOutput)
+  {
+    // Mapping a buffer that uses the CPU output buffer in place makes its content current on the host
+    cl_event readEvent{ nullptr };
+    void *   mapped{ clEnqueueMapBuffer(m_VkGPU.commandQueue,
+                                      outputGPUBuffer,
+                                      CL_TRUE,
+                                      CL_MAP_READ,
+                                      0,
+                                      m_VkParameters.outputBufferBytes,
+                                      0,
+                                      nullptr,
+                                      m_VkGPU.profiling ? &readEvent : nullptr,
+                                      &resCL) };
+    if (resCL != CL_SUCCESS)
+    {
+      std::cerr << __FILE__ "(" << __LINE__ << "): clEnqueueMapBuffer returned " << resCL << std::endl;
+      return VkFFTResult{ VKFFT_ERROR_FAILED_TO_COPY };
+    }
+    if (readEvent)
+    {
+      m_LastRunTimings.deviceDeviceToHostSeconds += GetElapsedSeconds(readEvent, readEvent);
+      clReleaseEvent(readEvent);
+    }
+    resCL = clEnqueueUnmapMemObject(m_VkGPU.commandQueue, outputGPUBuffer, mapped, 0, nullptr, nullptr);
+    if (resCL != CL_SUCCESS)
+    {
+      std::cerr << __FILE__ "(" << __LINE__ << "): clEnqueueUnmapMemObject returned " << resCL << std::endl;
+      return VkFFTResult{ VKFFT_ERROR_FAILED_TO_COPY };
+    }
+    resCL = clFinish(m_VkGPU.commandQueue);
+    if (resCL != CL_SUCCESS)
+    {
+      std::cerr << __FILE__ "(" << __LINE__ << "): clFinish returned " << resCL << std::endl;
+      return VkFFTResult{ VKFFT_ERROR_FAILED_TO_SYNCHRONIZE };
+    }
+  }
+#endif
+  if (m_VkParameters.interleavedComponents)
   {
-    // For C2C computation we can do everything in the in-place-computation buffer.
-    inputGPUBuffer = GPUBuffer;
-    outputGPUBuffer = GPUBuffer;
+    resFFT = this->CopyComponentsFromGPU(outputGPUBuffer);
+    if (resFFT != VKFFT_SUCCESS)
+    {
+      return resFFT;
+    }
   }
-  else
+  else if (!zeroCopyOutput && m_VkParameters.outputStage == OutputStageEnum::NONE)
   {
-    if (m_VkParameters.I == DirectionEnum::FORWARD)
+    resFFT = this->CopyFromGPU(m_VkParameters.outputCPUBuffer,
+                               outputGPUBuffer,
+                               m_VkParameters.outputBufferBytes,
+                               m_VkGPU.profiling ? &m_LastRunTimings.deviceDeviceToHostSeconds : nullptr);
+    if (resFFT != VKFFT_SUCCESS)
     {
-      outputGPUBuffer = GPUBuffer;
+      return resFFT;
+    }
+  }
+  m_LastRunTimings.numberOfZeroCopyRuns = zeroCopyInput && zeroCopyOutput ? 1 : 0;
+  AccumulatePhase(m_LastRunTimings.deviceToHostSeconds, phaseStart, "DeviceToHost", m_VkGPU.device_id);
 
-      // Either R2FullH or R2HalfH.  For forward computation, we have a smaller input buffer.
-      const uint64_t inputBufferBytes{ 1UL * m_VkParameters.PSize * *m_VkFFTConfiguration.inputBufferSize };
-      resCu = cudaMalloc((void **)&inputGPUBuffer, inputBufferBytes);
-      if (resCu != cudaSuccess)
+  if (m_VkParameters.fft == FFTEnum::R2FullH && m_VkParameters.I == DirectionEnum::FORWARD)
+  {
+    // Compute complex conjugates for the R2FullH forward computation, at the offsets in the CPU output
+    // buffer of the elements of the planes
+    const auto cpuOffset = [this](const uint64_t offset) {
+      return m_VkParameters.interleavedComponents
+               ? GetInterleavedOffset(offset, m_VkParameters.C, m_VkFFTConfiguration.bufferStride[2])
+               : offset;
+    };
+    switch (m_VkParameters.P)
+    {
+      case PrecisionEnum::FLOAT:
+      {
+        using ComplexType = std::complex<float>;
+        ComplexType * const outputCPUFloat{ reinterpret_cast<ComplexType *>(m_VkParameters.outputCPUBuffer) };
+        for (uint64_t b{ 0 }; b < m_VkParameters.B * m_VkParameters.C; ++b)
+        {
+          for (uint64_t z{ 0 }; z < m_VkFFTConfiguration.size[2]; ++z)
+          {
+            for (uint64_t y{ 0 }; y < m_VkFFTConfiguration.size[1]; ++y)
+            {
+              const uint64_t offsetStart{ b * m_VkFFTConfiguration.bufferStride[2] +
+                                          z * m_VkFFTConfiguration.bufferStride[1] +
+                                          y * m_VkFFTConfiguration.bufferStride[0] };
+              const uint64_t offsetEnd{ offsetStart + m_VkFFTConfiguration.bufferStride[0] };
+              for (uint64_t x = (m_VkFFTConfiguration.size[0] - 1) / 2; x >= 1; --x)
+              {
+                outputCPUFloat[cpuOffset(offsetEnd - x)] = std::conj(outputCPUFloat[cpuOffset(offsetStart + x)]);
+              }
+            }
+          }
+        }
+      }
+      break;
+      case PrecisionEnum::DOUBLE:
       {
-        std::cerr << __FILE__ "(" << __LINE__ << "): cudaMalloc returned " << resCu << std::endl;
-        return VkFFTResult{ VKFFT_ERROR_FAILED_TO_ALLOCATE };
+        using ComplexType = std::complex<double>;
+        ComplexType * const outputCPUDouble{ reinterpret_cast<ComplexType *>(m_VkParameters.outputCPUBuffer) };
+        for (uint64_t b{ 0 }; b < m_VkParameters.B * m_VkParameters.C; ++b)
+        {
+          for (uint64_t z{ 0 }; z < m_VkFFTConfiguration.size[2]; ++z)
+          {
+            for (uint64_t y{ 0 }; y < m_VkFFTConfiguration.size[1]; ++y)
+            {
+              const uint64_t offsetStart{ b * m_VkFFTConfiguration.bufferStride[2] +
+                                          z * m_VkFFTConfiguration.bufferStride[1] +
+                                          y * m_VkFFTConfiguration.bufferStride[0] };
+              const uint64_t offsetEnd{ offsetStart + m_VkFFTConfiguration.bufferStride[0] };
+              for (uint64_t x = (m_VkFFTConfiguration.size[0] - 1) / 2; x >= 1; --x)
+              {
+                outputCPUDouble[cpuOffset(offsetEnd - x)] = std::conj(outputCPUDouble[cpuOffset(offsetStart + x)]);
+              }
+            }
+          }
+        }
       }
+      break;
+    } // end switch (m_VkParameters.P)
+  } // end if(m_VkParameters.fft == R2FullH && m_VkParameters.I == DirectionEnum::FORWARD)
+  AccumulatePhase(m_LastRunTimings.conjugateFillSeconds, phaseStart, "ConjugateFill", m_VkGPU.device_id);
+
+  if (m_VkGPU.profiling)
+  {
+    m_LastRunTimings.hostToDeviceBytes = m_VkParameters.inputBufferBytes;
+    m_LastRunTimings.deviceToHostBytes = m_VkParameters.outputBufferBytes;
 
-      m_VkFFTConfiguration.inputBuffer = reinterpret_cast<void **>(&inputGPUBuffer);
+    // 5 N log2(n_d) flops for the transforms of length n_d along each transformed
+    // dimension, halved for real-to-complex transforms
+    double numberOfElements{ static_cast<double>(m_VkParameters.B * m_VkParameters.C) };
+    for (size_t dim{ 0 }; dim < 3; ++dim)
+    {
+      numberOfElements *= m_VkFFTConfiguration.size[dim];
     }
-    else
+    double flops{ 0.0 };
+    for (size_t dim{ 0 }; dim < 3; ++dim)
     {
-      inputGPUBuffer = GPUBuffer;
-
-      // Either R2FullH or R2HalfH.  For inverse computation, we have a smaller output buffer.
-      uint64_t outputBufferBytes{ 1UL * m_VkParameters.PSize * *m_VkFFTConfiguration.outputBufferSize };
-      resCu = cudaMalloc((void **)&outputGPUBuffer, outputBufferBytes);
-      if (resCu != cudaSuccess)
+      if (m_VkFFTConfiguration.size[dim] > 1 && m_VkParameters.omitDimension[dim] == 0)
       {
-        std::cerr << __FILE__ "(" << __LINE__ << "): cudaMalloc returned " << resCu << std::endl;
-        return VkFFTResult{ VKFFT_ERROR_FAILED_TO_ALLOCATE };
+        flops += 5.0 * numberOfElements * std::log2(static_cast<double>(m_VkFFTConfiguration.size[dim]));
       }
-      m_VkFFTConfiguration.outputBuffer = reinterpret_cast<void **>(&outputGPUBuffer);
     }
+    if (m_VkParameters.fft != FFTEnum::C2C)
+    {
+      flops *= 0.5;
+    }
+    if (m_VkParameters.convolution)
+    {
+      // A forward transform of the input and an inverse transform per kernel
+      flops *= 1.0 + static_cast<double>(m_VkParameters.numberOfKernels);
+    }
+    m_LastRunTimings.transformFlops = flops;
+    m_LastRunTimings.numberOfProfiledRuns = 1;
   }
 
-  // Copy input from CPU to GPU
-  resCu =
-    cudaMemcpy(inputGPUBuffer, m_VkParameters.inputCPUBuffer, m_VkParameters.inputBufferBytes, cudaMemcpyHostToDevice);
+  return resFFT;
+}
+
+VkFFTResult
+VkCommon::AppendAndWait(VkFFTApplication & application, DirectionEnum direction, VkFFTLaunchParams & launchParams)
+{
+  VkFFTResult resFFT{ VKFFT_SUCCESS };
+  const int   inverse{ direction == DirectionEnum::INVERSE ? 1 : -1 };
+#if (VKFFT_BACKEND == CUDA)
+  resFFT = VkFFTAppend(&application, inverse, &launchParams);
+  if (resFFT != VKFFT_SUCCESS)
+  {
+    return resFFT;
+  }
+  const cudaError_t resCu{ cudaStreamSynchronize(m_VkGPU.stream) };
   if (resCu != cudaSuccess)
   {
-    std::cerr << __FILE__ "(" << __LINE__ << "): cudaMemcpy returned " << resCu << std::endl;
-    return VkFFTResult{ VKFFT_ERROR_FAILED_TO_COPY };
+    std::cerr << __FILE__ "(" << __LINE__ << "): cudaStreamSynchronize returned " << resCu << std::endl;
+    return VkFFTResult{ VKFFT_ERROR_FAILED_TO_SYNCHRONIZE };
   }
-
 #elif (VKFFT_BACKEND == OPENCL)
-  cl_int resCL{ CL_SUCCESS };
+  launchParams.commandQueue = &m_VkGPU.commandQueue;
+  resFFT = VkFFTAppend(&application, inverse, &launchParams);
+  if (resFFT != VKFFT_SUCCESS)
+  {
+    return resFFT;
+  }
+  const cl_int resCL{ clFinish(m_VkGPU.commandQueue) };
+  if (resCL != CL_SUCCESS)
+  {
+    std::cerr << __FILE__ "(" << __LINE__ << "): clFinish returned " << resCL << std::endl;
+    return VkFFTResult{ VKFFT_ERROR_FAILED_TO_SYNCHRONIZE };
+  }
+#elif (VKFFT_BACKEND == LEVEL_ZERO)
+  ze_command_list_desc_t commandListDescription{};
+  commandListDescription.stype = ZE_STRUCTURE_TYPE_COMMAND_LIST_DESC;
+  commandListDescription.commandQueueGroupOrdinal = m_VkGPU.commandQueueID;
+  ze_command_list_handle_t commandList{ nullptr };
+  if (zeCommandListCreate(m_VkGPU.context, m_VkGPU.device, &commandListDescription, &commandList) !=
+      ZE_RESULT_SUCCESS)
+    return VkFFTResult{ VKFFT_ERROR_FAILED_TO_CREATE_COMMAND_LIST };
+  launchParams.commandList = &commandList;
+  resFFT = VkFFTAppend(&application, inverse, &launchParams);
+  ze_result_t resZE{ ZE_RESULT_SUCCESS };
+  if (resFFT == VKFFT_SUCCESS)
+  {
+    resZE = zeCommandListClose(commandList);
+    if (resZE == ZE_RESULT_SUCCESS)
+      resZE = zeCommandQueueExecuteCommandLists(m_VkGPU.commandQueue, 1, &commandList, nullptr);
+    if (resZE == ZE_RESULT_SUCCESS)
+      resZE = zeCommandQueueSynchronize(m_VkGPU.commandQueue, UINT32_MAX);
+  }
+  zeCommandListDestroy(commandList);
+  if (resFFT == VKFFT_SUCCESS && resZE != ZE_RESULT_SUCCESS)
+    return VkFFTResult{ VKFFT_ERROR_FAILED_TO_SYNCHRONIZE };
+#elif (VKFFT_BACKEND == METAL)
+  MTL::CommandBuffer *         commandBuffer{ m_VkGPU.queue->commandBuffer() };
+  MTL::ComputeCommandEncoder * encoder{ commandBuffer->computeCommandEncoder() };
+  launchParams.commandBuffer = commandBuffer;
+  launchParams.commandEncoder = encoder;
+  resFFT = VkFFTAppend(&application, inverse, &launchParams);
+  encoder->endEncoding();
+  commandBuffer->commit();
+  commandBuffer->waitUntilCompleted();
+#endif
+  return resFFT;
+}
 
-  // Configure the buffers.  Some of these three pointers will be nullptr or be duplicates of each
-  // other, so don't release all of them at the end.  All re-striding of data (for R2HalfH or R2FullH,
-  // regardless of forward vs. inverse) is done by VkFFT between the two GPU buffers it uses.
-  cl_mem inputGPUBuffer{ nullptr };  // Copy from CPU input buffer to this GPU buffer
-  cl_mem GPUBuffer{ nullptr };       // GPU buffer where main computation occurs
-  cl_mem outputGPUBuffer{ nullptr }; // Copy from this GPU buffer to CPU output buffer
-  if (m_VkParameters.fft == FFTEnum::C2C)
-  {
-    // For C2C computation we can do everything in the in-place-computation buffer.
-    const uint64_t bufferBytes{ 2UL * m_VkParameters.PSize * *m_VkFFTConfiguration.bufferSize };
-    GPUBuffer = clCreateBuffer(m_VkGPU.context, CL_MEM_READ_WRITE, bufferBytes, nullptr, &resCL);
-    inputGPUBuffer = GPUBuffer;
-    outputGPUBuffer = GPUBuffer;
-    if (resCL != CL_SUCCESS)
+template <typename TReal>
+VkFFTResult
+VkCommon::PerformOutputStageOnHost()
+{
+  VkFFTResult    resFFT{ VKFFT_SUCCESS };
+  double * const hostToDeviceSeconds{ m_VkGPU.profiling ? &m_LastRunTimings.deviceHostToDeviceSeconds : nullptr };
+  double * const deviceToHostSeconds{ m_VkGPU.profiling ? &m_LastRunTimings.deviceDeviceToHostSeconds : nullptr };
+  switch (m_VkParameters.outputStage)
+  {
+    case OutputStageEnum::MASKED_NCC:
     {
-      std::cerr << __FILE__ "(" << __LINE__ << "): clCreateBuffer returned " << resCL << std::endl;
-      return VkFFTResult{ VKFFT_ERROR_FAILED_TO_ALLOCATE };
+      // Multiply the spectra on the host, transform the products back on the device and normalize on the host
+      const uint64_t                   spectrumPixels{ m_VkFFTConfiguration.bufferStride[2] };
+      std::vector<std::complex<TReal>> spectra(m_BufferSize);
+      resFFT = this->CopyFromGPU(spectra.data(), m_GPUBuffer, this->GetBufferBytes(), deviceToHostSeconds);
+      if (resFFT != VKFFT_SUCCESS)
+      {
+        return resFFT;
+      }
+      MultiplyMaskedNCCSpectra(spectra.data(), spectrumPixels);
+      resFFT = this->CopyToGPU(m_GPUBuffer, spectra.data(), this->GetBufferBytes(), hostToDeviceSeconds);
+      if (resFFT != VKFFT_SUCCESS)
+      {
+        return resFFT;
+      }
+      spectra = std::vector<std::complex<TReal>>{};
+
+      VkFFTLaunchParams launchParams{};
+      launchParams.buffer = &m_GPUBuffer;
+      launchParams.outputBuffer = &m_InputGPUBuffer;
+      resFFT = this->AppendAndWait(m_StageVkFFTApplication, DirectionEnum::INVERSE, launchParams);
+      if (resFFT != VKFFT_SUCCESS)
+      {
+        return resFFT;
+      }
+      std::vector<TReal> maps(m_InputBufferSize);
+      resFFT = this->CopyFromGPU(maps.data(), m_InputGPUBuffer, this->GetInputBufferBytes(), deviceToHostSeconds);
+      if (resFFT != VKFFT_SUCCESS)
+      {
+        return resFFT;
+      }
+      NormalizeMaskedNCC(maps.data(),
+                         m_VkFFTConfiguration.inputBufferStride,
+                         m_VkParameters.stageOutputSize,
+                         m_VkParameters.requiredOverlap,
+                         m_VkParameters.requiredOverlapFraction,
+                         static_cast<TReal *>(m_VkParameters.outputCPUBuffer));
     }
-    m_VkFFTConfiguration.buffer = &GPUBuffer;
-  }
-  else
-  {
-    // Either R2HalfH or R2FullH computation. Either forward or inverse.
-    const uint64_t bufferBytes{ 2UL * m_VkParameters.PSize * *m_VkFFTConfiguration.bufferSize };
-    GPUBuffer = clCreateBuffer(m_VkGPU.context, CL_MEM_READ_WRITE, bufferBytes, nullptr, &resCL);
-    if (resCL != CL_SUCCESS)
+    break;
+    case OutputStageEnum::MAXIMUM:
     {
-      std::cerr << __FILE__ "(" << __LINE__ << "): clCreateBuffer returned " << resCL << std::endl;
-      return VkFFTResult{ VKFFT_ERROR_FAILED_TO_ALLOCATE };
+      // Copy the maps back and reduce them on the host
+      std::vector<TReal> maps(m_OutputBufferSize);
+      resFFT = this->CopyFromGPU(maps.data(), m_OutputGPUBuffer, maps.size() * sizeof(TReal), deviceToHostSeconds);
+      if (resFFT != VKFFT_SUCCESS)
+      {
+        return resFFT;
+      }
+      FindMaxima(maps.data(),
+                 m_VkFFTConfiguration.outputBufferStride,
+                 m_VkParameters.stageOutputSize,
+                 this->GetNumberOfStageMaps(),
+                 static_cast<const TReal *>(m_VkParameters.stageWeightsCPUBuffer),
+                 m_VkParameters.stageWeightPlanes,
+                 m_VkParameters.outputCPUBuffer);
     }
-    m_VkFFTConfiguration.buffer = &GPUBuffer;
+    break;
+    case OutputStageEnum::NONE:
+      break;
+  }
+  return resFFT;
+}
 
-    if (m_VkParameters.I == DirectionEnum::FORWARD)
+VkFFTResult
+VkCommon::PerformOutputStage()
+{
+#if (VKFFT_BACKEND == OPENCL)
+  VkFFTResult    resFFT{ VKFFT_SUCCESS };
+  cl_int         resCL{ CL_SUCCESS };
+  const bool     doublePrecision{ m_VkParameters.P == PrecisionEnum::DOUBLE };
+  const cl_ulong outputX{ m_VkParameters.stageOutputSize[0] };
+  const cl_ulong outputY{ m_VkParameters.stageOutputSize[1] };
+  const cl_ulong outputPixels{ this->GetStageOutputPixels() };
+  switch (m_VkParameters.outputStage)
+  {
+    case OutputStageEnum::MASKED_NCC:
     {
-      // Either R2FullH or R2HalfH.  For forward computation, we have a smaller input buffer.
-      const uint64_t inputBufferBytes{ 1UL * m_VkParameters.PSize * *m_VkFFTConfiguration.inputBufferSize };
-      inputGPUBuffer = clCreateBuffer(m_VkGPU.context, CL_MEM_READ_WRITE, inputBufferBytes, nullptr, &resCL);
-      outputGPUBuffer = GPUBuffer;
+      const cl_ulong spectrumPixels{ m_VkFFTConfiguration.bufferStride[2] };
+      const cl_kernel multiplyKernel{ m_StageKernels[MaskedNCCMultiplyKernel] };
+      resCL = SetKernelArguments(multiplyKernel, m_GPUBuffer, spectrumPixels);
+      if (resCL == CL_SUCCESS)
+      {
+        resCL = EnqueueKernel(m_VkGPU.commandQueue, multiplyKernel, spectrumPixels, m_StageGroupSize);
+      }
+      if (resCL != CL_SUCCESS)
+      {
+        std::cerr << __FILE__ "(" << __LINE__ << "): maskedNCCMultiply returned " << resCL << std::endl;
+        return VkFFTResult{ VKFFT_ERROR_FAILED_TO_LAUNCH_KERNEL };
+      }
+
+      // The queue runs in order, so the inverse transforms follow the products
+      VkFFTLaunchParams launchParams{};
+      launchParams.buffer = &m_GPUBuffer;
+      launchParams.outputBuffer = &m_InputGPUBuffer;
+      resFFT = this->AppendAndWait(m_StageVkFFTApplication, DirectionEnum::INVERSE, launchParams);
+      if (resFFT != VKFFT_SUCCESS)
+      {
+        return resFFT;
+      }
+
+      const cl_ulong  strideY{ m_VkFFTConfiguration.inputBufferStride[0] };
+      const cl_ulong  strideZ{ m_VkFFTConfiguration.inputBufferStride[1] };
+      const cl_ulong  planePixels{ m_VkFFTConfiguration.inputBufferStride[2] };
+      const cl_ulong  requiredOverlap{ m_VkParameters.requiredOverlap };
+      const cl_kernel maximumKernel{ m_StageKernels[MaskedNCCMaximumKernel] };
+      const cl_kernel normalizeKernel{ m_StageKernels[MaskedNCCNormalizeKernel] };
+      resCL = SetKernelArguments(maximumKernel,
+                                 m_InputGPUBuffer,
+                                 m_StageGPUBuffer,
+                                 strideY,
+                                 strideZ,
+                                 planePixels,
+                                 outputX,
+                                 outputY,
+                                 outputPixels);
+      if (resCL == CL_SUCCESS)
+      {
+        resCL = EnqueueKernel(m_VkGPU.commandQueue, maximumKernel, m_StageGroupSize, m_StageGroupSize);
+      }
+      if (resCL == CL_SUCCESS)
+      {
+        resCL = doublePrecision ? SetKernelArguments(normalizeKernel,
+                                                     m_InputGPUBuffer,
+                                                     m_StageGPUBuffer,
+                                                     strideY,
+                                                     strideZ,
+                                                     planePixels,
+                                                     outputX,
+                                                     outputY,
+                                                     outputPixels,
+                                                     requiredOverlap,
+                                                     m_VkParameters.requiredOverlapFraction)
+                                : SetKernelArguments(normalizeKernel,
+                                                     m_InputGPUBuffer,
+                                                     m_StageGPUBuffer,
+                                                     strideY,
+                                                     strideZ,
+                                                     planePixels,
+                                                     outputX,
+                                                     outputY,
+                                                     outputPixels,
+                                                     requiredOverlap,
+                                                     static_cast<float>(m_VkParameters.requiredOverlapFraction));
+      }
+      if (resCL == CL_SUCCESS)
+      {
+        resCL = EnqueueKernel(m_VkGPU.commandQueue, normalizeKernel, outputPixels, m_StageGroupSize);
+      }
       if (resCL != CL_SUCCESS)
       {
-        std::cerr << __FILE__ "(" << __LINE__ << "): clCreateBuffer returned " << resCL << std::endl;
-        return VkFFTResult{ VKFFT_ERROR_FAILED_TO_ALLOCATE };
+        std::cerr << __FILE__ "(" << __LINE__ << "): masked NCC normalization returned " << resCL << std::endl;
+        return VkFFTResult{ VKFFT_ERROR_FAILED_TO_LAUNCH_KERNEL };
       }
-      m_VkFFTConfiguration.inputBuffer = &inputGPUBuffer;
     }
-    else
+    break;
+    case OutputStageEnum::MAXIMUM:
     {
-      // Either R2FullH or R2HalfH.  For inverse computation, we have a smaller output buffer.
-      uint64_t outputBufferBytes{ 1UL * m_VkParameters.PSize * *m_VkFFTConfiguration.outputBufferSize };
-      inputGPUBuffer = GPUBuffer;
-      outputGPUBuffer = clCreateBuffer(m_VkGPU.context, CL_MEM_READ_WRITE, outputBufferBytes, nullptr, &resCL);
+      // Without weights, the plane of each map is 0 and the weights are not read
+      const cl_ulong        numberOfMaps{ this->GetNumberOfStageMaps() };
+      const cl_ulong        weighted{ m_VkParameters.stageWeightsCPUBuffer ? 1U : 0U };
+      std::vector<cl_ulong> weightPlanes(numberOfMaps, 0);
+      if (m_VkParameters.stageWeightPlanes)
+      {
+        std::copy_n(m_VkParameters.stageWeightPlanes, numberOfMaps, weightPlanes.begin());
+      }
+      double * const hostToDeviceSeconds{ m_VkGPU.profiling ? &m_LastRunTimings.deviceHostToDeviceSeconds : nullptr };
+      resFFT = this->CopyToGPU(
+        m_StageWeightPlanesGPUBuffer, weightPlanes.data(), numberOfMaps * sizeof(cl_ulong), hostToDeviceSeconds);
+      if (resFFT == VKFFT_SUCCESS && weighted)
+      {
+        resFFT = this->CopyToGPU(m_StageWeightsGPUBuffer,
+                                 m_VkParameters.stageWeightsCPUBuffer,
+                                 m_VkParameters.stageWeightsBufferBytes,
+                                 hostToDeviceSeconds);
+      }
+      if (resFFT != VKFFT_SUCCESS)
+      {
+        return resFFT;
+      }
+
+      const cl_ulong  strideY{ m_VkFFTConfiguration.outputBufferStride[0] };
+      const cl_ulong  strideZ{ m_VkFFTConfiguration.outputBufferStride[1] };
+      const cl_ulong  planePixels{ m_VkFFTConfiguration.outputBufferStride[2] };
+      const cl_ulong  outputZ{ m_VkParameters.stageOutputSize[2] };
+      const cl_kernel maximaKernel{ m_StageKernels[FindMaximaKernel] };
+      resCL = SetKernelArguments(maximaKernel,
+                                 m_OutputGPUBuffer,
+                                 m_StageWeightsGPUBuffer,
+                                 m_StageWeightPlanesGPUBuffer,
+                                 weighted,
+                                 m_StageGPUBuffer,
+                                 strideY,
+                                 strideZ,
+                                 planePixels,
+                                 outputX,
+                                 outputY,
+                                 outputZ);
+      if (resCL == CL_SUCCESS)
+      {
+        resCL = EnqueueKernel(m_VkGPU.commandQueue, maximaKernel, numberOfMaps * m_StageGroupSize, m_StageGroupSize);
+      }
       if (resCL != CL_SUCCESS)
       {
-        std::cerr << __FILE__ "(" << __LINE__ << "): clCreateBuffer returned " << resCL << std::endl;
-        return VkFFTResult{ VKFFT_ERROR_FAILED_TO_ALLOCATE };
+        std::cerr << __FILE__ "(" << __LINE__ << "): findMaxima returned " << resCL << std::endl;
+        return VkFFTResult{ VKFFT_ERROR_FAILED_TO_LAUNCH_KERNEL };
       }
-      m_VkFFTConfiguration.outputBuffer = &outputGPUBuffer;
     }
+    break;
+    case OutputStageEnum::NONE:
+      break;
   }
 
-  // Copy input from CPU to GPU
-  resCL = clEnqueueWriteBuffer(m_VkGPU.commandQueue,
-                               inputGPUBuffer,
-                               CL_TRUE,
-                               0,
-                               m_VkParameters.inputBufferBytes,
-                               m_VkParameters.inputCPUBuffer,
-                               0,
-                               nullptr,
-                               nullptr);
-  if (resCL != CL_SUCCESS)
+  // The blocking copy waits for the stage kernels
+  return this->CopyFromGPU(m_VkParameters.outputCPUBuffer,
+                           m_StageGPUBuffer,
+                           m_VkParameters.outputBufferBytes,
+                           m_VkGPU.profiling ? &m_LastRunTimings.deviceDeviceToHostSeconds : nullptr);
+#else
+  return m_VkParameters.P == PrecisionEnum::DOUBLE ? this->PerformOutputStageOnHost<double>()
+                                                   : this->PerformOutputStageOnHost<float>();
+#endif
+}
+
+VkFFTResult
+VkCommon::CopyComponentsToGPU(GPUBufferType buffer)
+{
+  double * const deviceSeconds{ m_VkGPU.profiling ? &m_LastRunTimings.deviceHostToDeviceSeconds : nullptr };
+  const uint64_t bytes{ m_VkParameters.inputBufferBytes };
+#if (VKFFT_BACKEND == OPENCL)
+  // The in-order queue runs the reorder before the transform
+  const VkFFTResult resFFT{ this->CopyToGPU(m_ReorderGPUBuffer, m_VkParameters.inputCPUBuffer, bytes, deviceSeconds) };
+  if (resFFT != VKFFT_SUCCESS)
   {
-    std::cerr << __FILE__ "(" << __LINE__ << "): clEnqueueWriteBuffer returned " << resCL << std::endl;
-    return VkFFTResult{ VKFFT_ERROR_FAILED_TO_COPY };
+    return resFFT;
   }
-#elif (VKFFT_BACKEND == LEVEL_ZERO)
-  ze_result_t                resZE{ ZE_RESULT_SUCCESS };
-  void *                     inputGPUBuffer{ nullptr };
-  void *                     GPUBuffer{ nullptr };
-  void *                     outputGPUBuffer{ nullptr };
-  ze_device_mem_alloc_desc_t deviceMemDesc{};
-  deviceMemDesc.stype = ZE_STRUCTURE_TYPE_DEVICE_MEM_ALLOC_DESC;
-
-  const uint64_t bufferBytes{ 2UL * m_VkParameters.PSize * *m_VkFFTConfiguration.bufferSize };
-  resZE =
-    zeMemAllocDevice(m_VkGPU.context, &deviceMemDesc, bufferBytes, m_VkParameters.PSize, m_VkGPU.device, &GPUBuffer);
-  if (resZE != ZE_RESULT_SUCCESS)
-    return VkFFTResult{ VKFFT_ERROR_FAILED_TO_ALLOCATE };
-  m_VkFFTConfiguration.buffer = &GPUBuffer;
+  return this->ReorderComponentsOnGPU(m_ReorderGPUBuffer, buffer, bytes, this->GetInputElementBytes(), true);
+#else
+  const uint64_t    elementBytes{ this->GetInputElementBytes() };
+  std::vector<char> planes(bytes);
+  ReorderComponents(m_VkParameters.inputCPUBuffer,
+                    planes.data(),
+                    bytes,
+                    elementBytes,
+                    m_VkParameters.C,
+                    bytes / elementBytes / (m_VkParameters.B * m_VkParameters.C),
+                    true);
+  return this->CopyToGPU(buffer, planes.data(), bytes, deviceSeconds);
+#endif
+}
 
-  if (m_VkParameters.fft == FFTEnum::C2C)
+VkFFTResult
+VkCommon::CopyComponentsFromGPU(GPUBufferType buffer)
+{
+  double * const deviceSeconds{ m_VkGPU.profiling ? &m_LastRunTimings.deviceDeviceToHostSeconds : nullptr };
+  const uint64_t bytes{ m_VkParameters.outputBufferBytes };
+#if (VKFFT_BACKEND == OPENCL)
+  // The blocking copy waits for the reorder
+  const VkFFTResult resFFT{
+    this->ReorderComponentsOnGPU(buffer, m_ReorderGPUBuffer, bytes, this->GetOutputElementBytes(), false)
+  };
+  if (resFFT != VKFFT_SUCCESS)
   {
-    inputGPUBuffer = GPUBuffer;
-    outputGPUBuffer = GPUBuffer;
+    return resFFT;
   }
-  else if (m_VkParameters.I == DirectionEnum::FORWARD)
+  return this->CopyFromGPU(m_VkParameters.outputCPUBuffer, m_ReorderGPUBuffer, bytes, deviceSeconds);
+#else
+  const uint64_t    elementBytes{ this->GetOutputElementBytes() };
+  std::vector<char> planes(bytes);
+  const VkFFTResult resFFT{ this->CopyFromGPU(planes.data(), buffer, bytes, deviceSeconds) };
+  if (resFFT != VKFFT_SUCCESS)
   {
-    const uint64_t inputBufferBytes{ 1UL * m_VkParameters.PSize * *m_VkFFTConfiguration.inputBufferSize };
-    resZE = zeMemAllocDevice(
-      m_VkGPU.context, &deviceMemDesc, inputBufferBytes, m_VkParameters.PSize, m_VkGPU.device, &inputGPUBuffer);
-    if (resZE != ZE_RESULT_SUCCESS)
-      return VkFFTResult{ VKFFT_ERROR_FAILED_TO_ALLOCATE };
-    outputGPUBuffer = GPUBuffer;
-    m_VkFFTConfiguration.inputBuffer = &inputGPUBuffer;
+    return resFFT;
   }
-  else
+  ReorderComponents(planes.data(),
+                    m_VkParameters.outputCPUBuffer,
+                    bytes,
+                    elementBytes,
+                    m_VkParameters.C,
+                    bytes / elementBytes / (m_VkParameters.B * m_VkParameters.C),
+                    false);
+  return resFFT;
+#endif
+}
+
+#if (VKFFT_BACKEND == OPENCL)
+VkFFTResult
+VkCommon::ReorderComponentsOnGPU(GPUBufferType source,
+                                 GPUBufferType destination,
+                                 uint64_t      bytes,
+                                 uint64_t      elementBytes,
+                                 bool          toPlanes)
+{
+  const cl_ulong  words{ bytes / m_VkParameters.PSize };
+  const cl_ulong  elementWords{ elementBytes / m_VkParameters.PSize };
+  const cl_ulong  components{ m_VkParameters.C };
+  const cl_ulong  planeElements{ bytes / elementBytes / (m_VkParameters.B * m_VkParameters.C) };
+  const cl_uint   planes{ toPlanes ? 1U : 0U };
+  const cl_kernel reorderKernel{ m_StageKernels[ReorderComponentsKernel] };
+  cl_int          resCL{
+    SetKernelArguments(reorderKernel, source, destination, words, elementWords, components, planeElements, planes)
+  };
+  if (resCL == CL_SUCCESS)
   {
-    const uint64_t outputBufferBytes{ 1UL * m_VkParameters.PSize * *m_VkFFTConfiguration.outputBufferSize };
-    resZE = zeMemAllocDevice(
-      m_VkGPU.context, &deviceMemDesc, outputBufferBytes, m_VkParameters.PSize, m_VkGPU.device, &outputGPUBuffer);
-    if (resZE != ZE_RESULT_SUCCESS)
-      return VkFFTResult{ VKFFT_ERROR_FAILED_TO_ALLOCATE };
-    inputGPUBuffer = GPUBuffer;
-    m_VkFFTConfiguration.outputBuffer = &outputGPUBuffer;
+    resCL = EnqueueKernel(m_VkGPU.commandQueue, reorderKernel, words, m_StageGroupSize);
+  }
+  if (resCL != CL_SUCCESS)
+  {
+    std::cerr << __FILE__ "(" << __LINE__ << "): reorderComponents returned " << resCL << std::endl;
+    return VkFFTResult{ VKFFT_ERROR_FAILED_TO_LAUNCH_KERNEL };
   }
+  return VkFFTResult{ VKFFT_SUCCESS };
+}
+#endif
 
-  // Host -> device copy via an immediate command list on the compute/copy queue group.
+uint64_t
+VkCommon::GetLargestPrimeFactor(uint64_t n)
+{
+  uint64_t largest{ 1 };
+  for (uint64_t factor{ 2 }; factor * factor <= n; ++factor)
   {
-    ze_command_queue_desc_t copyQueueDesc{};
-    copyQueueDesc.stype = ZE_STRUCTURE_TYPE_COMMAND_QUEUE_DESC;
-    copyQueueDesc.ordinal = m_VkGPU.commandQueueID;
-    copyQueueDesc.mode = ZE_COMMAND_QUEUE_MODE_DEFAULT;
-    copyQueueDesc.priority = ZE_COMMAND_QUEUE_PRIORITY_NORMAL;
-    ze_command_list_handle_t copyCommandList{ nullptr };
-    resZE = zeCommandListCreateImmediate(m_VkGPU.context, m_VkGPU.device, &copyQueueDesc, &copyCommandList);
-    if (resZE != ZE_RESULT_SUCCESS)
-      return VkFFTResult{ VKFFT_ERROR_FAILED_TO_CREATE_COMMAND_LIST };
-    resZE = zeCommandListAppendMemoryCopy(copyCommandList,
-                                          inputGPUBuffer,
-                                          m_VkParameters.inputCPUBuffer,
-                                          m_VkParameters.inputBufferBytes,
-                                          nullptr,
-                                          0,
-                                          nullptr);
-    if (resZE != ZE_RESULT_SUCCESS)
-      return VkFFTResult{ VKFFT_ERROR_FAILED_TO_COPY };
-    resZE = zeCommandQueueSynchronize(m_VkGPU.commandQueue, UINT32_MAX);
-    if (resZE != ZE_RESULT_SUCCESS)
-      return VkFFTResult{ VKFFT_ERROR_FAILED_TO_SYNCHRONIZE };
-    zeCommandListDestroy(copyCommandList);
+    while (n % factor == 0)
+    {
+      largest = factor;
+      n /= factor;
+    }
   }
-#elif (VKFFT_BACKEND == METAL)
-  // Metal shared-storage buffers are CPU-visible on Apple unified-memory systems,
-  // so host<->device transfers reduce to memcpy into/out of MTL::Buffer::contents().
-  MTL::Buffer * inputGPUBuffer{ nullptr };
-  MTL::Buffer * GPUBuffer{ nullptr };
-  MTL::Buffer * outputGPUBuffer{ nullptr };
-  const auto    storageMode = MTL::ResourceStorageModeShared;
-  if (m_VkParameters.fft == FFTEnum::C2C)
-  {
-    const uint64_t bufferBytes{ 2UL * m_VkParameters.PSize * *m_VkFFTConfiguration.bufferSize };
-    GPUBuffer = m_VkGPU.device->newBuffer(bufferBytes, storageMode);
-    if (GPUBuffer == nullptr)
-      return VkFFTResult{ VKFFT_ERROR_FAILED_TO_ALLOCATE };
-    inputGPUBuffer = GPUBuffer;
-    outputGPUBuffer = GPUBuffer;
-    m_VkFFTConfiguration.buffer = &GPUBuffer;
+  return n > 1 ? n : largest;
+}
+
+uint64_t
+VkCommon::GetGreatestPrimeFactor()
+{
+  return std::prev(std::end(radixCosts))->first;
+}
+
+uint64_t
+VkCommon::GetNextSupportedSize(uint64_t n, uint64_t greatestPrimeFactor)
+{
+  while (GetLargestPrimeFactor(n) > greatestPrimeFactor)
+  {
+    ++n;
   }
-  else
+  return n;
+}
+
+double
+VkCommon::EstimateTransformCost(uint64_t n, PrecisionEnum precision, FFTEnum fft, uint64_t greatestPrimeFactor)
+{
+  if (n <= 1)
   {
-    const uint64_t bufferBytes{ 2UL * m_VkParameters.PSize * *m_VkFFTConfiguration.bufferSize };
-    GPUBuffer = m_VkGPU.device->newBuffer(bufferBytes, storageMode);
-    if (GPUBuffer == nullptr)
-      return VkFFTResult{ VKFFT_ERROR_FAILED_TO_ALLOCATE };
-    m_VkFFTConfiguration.buffer = &GPUBuffer;
+    return 0.0;
+  }
 
-    if (m_VkParameters.I == DirectionEnum::FORWARD)
+  uint64_t remaining{ n };
+  double   passCost{ 0.0 };
+  for (const auto & radixCost : radixCosts)
+  {
+    while (radixCost.first <= greatestPrimeFactor && remaining % radixCost.first == 0)
     {
-      const uint64_t inputBufferBytes{ 1UL * m_VkParameters.PSize * *m_VkFFTConfiguration.inputBufferSize };
-      inputGPUBuffer = m_VkGPU.device->newBuffer(inputBufferBytes, storageMode);
-      if (inputGPUBuffer == nullptr)
-        return VkFFTResult{ VKFFT_ERROR_FAILED_TO_ALLOCATE };
-      outputGPUBuffer = GPUBuffer;
-      m_VkFFTConfiguration.inputBuffer = &inputGPUBuffer;
+      passCost += radixCost.second;
+      remaining /= radixCost.first;
     }
-    else
+  }
+  for (uint64_t factor{ GetGreatestPrimeFactor() + 2 }; factor * factor <= remaining && factor <= greatestPrimeFactor;
+       factor += 2)
+  {
+    while (remaining % factor == 0)
     {
-      const uint64_t outputBufferBytes{ 1UL * m_VkParameters.PSize * *m_VkFFTConfiguration.outputBufferSize };
-      inputGPUBuffer = GPUBuffer;
-      outputGPUBuffer = m_VkGPU.device->newBuffer(outputBufferBytes, storageMode);
-      if (outputGPUBuffer == nullptr)
-        return VkFFTResult{ VKFFT_ERROR_FAILED_TO_ALLOCATE };
-      m_VkFFTConfiguration.outputBuffer = &outputGPUBuffer;
+      passCost += 3.0 * factor;
+      remaining /= factor;
     }
   }
-
-  std::memcpy(inputGPUBuffer->contents(), m_VkParameters.inputCPUBuffer, m_VkParameters.inputBufferBytes);
-#endif
-
-  // Initialize applications. This function loads shaders, creates pipeline and configures FFT based on configuration
-  // file. No buffer allocations inside VkFFT library.
-  VkFFTApplication app{};
-  resFFT = initializeVkFFT(&app, m_VkFFTConfiguration);
-  if (resFFT != VKFFT_SUCCESS)
-    return resFFT;
-
-  // Submit FFT or iFFT.
-  VkFFTLaunchParams launchParams{};
-  launchParams.inputBuffer = m_VkFFTConfiguration.inputBuffer;
-  launchParams.buffer = m_VkFFTConfiguration.buffer;
-  launchParams.outputBuffer = m_VkFFTConfiguration.outputBuffer;
-#if (VKFFT_BACKEND == CUDA)
-  // pass
-#elif (VKFFT_BACKEND == OPENCL)
-  launchParams.commandQueue = &m_VkGPU.commandQueue;
-#elif (VKFFT_BACKEND == LEVEL_ZERO)
-  ze_command_list_desc_t commandListDescription{};
-  commandListDescription.stype = ZE_STRUCTURE_TYPE_COMMAND_LIST_DESC;
-  commandListDescription.commandQueueGroupOrdinal = m_VkGPU.commandQueueID;
-  ze_command_list_handle_t launchCommandList{ nullptr };
-  resZE = zeCommandListCreate(m_VkGPU.context, m_VkGPU.device, &commandListDescription, &launchCommandList);
-  if (resZE != ZE_RESULT_SUCCESS)
-    return VkFFTResult{ VKFFT_ERROR_FAILED_TO_CREATE_COMMAND_LIST };
-  launchParams.commandList = &launchCommandList;
-#elif (VKFFT_BACKEND == METAL)
-  MTL::CommandBuffer *         metalCommandBuffer = m_VkGPU.queue->commandBuffer();
-  MTL::ComputeCommandEncoder * metalEncoder = metalCommandBuffer->computeCommandEncoder();
-  launchParams.commandBuffer = metalCommandBuffer;
-  launchParams.commandEncoder = metalEncoder;
-#endif
-
-  resFFT = VkFFTAppend(&app, m_VkParameters.I == DirectionEnum::INVERSE ? 1 : -1, &launchParams);
-  if (resFFT != VKFFT_SUCCESS)
-    return resFFT;
-
-#if (VKFFT_BACKEND == CUDA)
-  resCu = cudaDeviceSynchronize();
-  if (resCu != cudaSuccess)
+  if (remaining > GetGreatestPrimeFactor() && remaining <= greatestPrimeFactor)
   {
-    std::cerr << __FILE__ "(" << __LINE__ << "): cudaDeviceSynchronize returned " << resCu << std::endl;
-    return VkFFTResult{ VKFFT_ERROR_FAILED_TO_SYNCHRONIZE };
+    // A prime factor of its own
+    passCost += 3.0 * remaining;
+    remaining = 1;
   }
 
-  // Copy result from GPU to CPU
-  resCu = cudaMemcpy(
-    m_VkParameters.outputCPUBuffer, outputGPUBuffer, m_VkParameters.outputBufferBytes, cudaMemcpyDeviceToHost);
-  if (resCu != cudaSuccess)
+  if (remaining > 1)
   {
-    std::cerr << __FILE__ "(" << __LINE__ << "): cudaMemcpy returned " << resCu << std::endl;
-    return VkFFTResult{ VKFFT_ERROR_FAILED_TO_COPY };
+    // Bluestein's algorithm: two forward transforms and one inverse transform
+    // of a supported length of at least 2n - 1, plus pointwise chirp products.
+    const uint64_t bluesteinSize{ GetNextSupportedSize(2 * n - 1, greatestPrimeFactor) };
+    return 3.0 * EstimateTransformCost(bluesteinSize, precision, FFTEnum::C2C, greatestPrimeFactor) +
+           6.0 * bluesteinSize;
   }
 
-  // Release mem buffers
-  cudaFree(inputGPUBuffer);
-  if (m_VkParameters.fft != FFTEnum::C2C)
+  // Sequences that fit in shared memory are transformed in a single upload;
+  // longer sequences are split into several uploads.
+  const uint64_t singleUploadSize{ precision == PrecisionEnum::DOUBLE ? 2048UL : 4096UL };
+  uint64_t       uploads{ 1 };
+  for (uint64_t size{ singleUploadSize }; size < n; size *= singleUploadSize)
   {
-    cudaFree(outputGPUBuffer);
+    ++uploads;
   }
 
-#elif (VKFFT_BACKEND == OPENCL)
-  resCL = clFinish(m_VkGPU.commandQueue);
-  if (resCL != CL_SUCCESS)
+  double cost{ n * (passCost + uploadCost * uploads) };
+  if (fft != FFTEnum::C2C && n % 2 == 0)
   {
-    std::cerr << __FILE__ "(" << __LINE__ << "): clFinish returned " << resCL << std::endl;
-    return VkFFTResult{ VKFFT_ERROR_FAILED_TO_SYNCHRONIZE };
+    // Even-length real transforms are packed into half-length complex transforms.
+    cost *= 0.5;
   }
+  return cost;
+}
 
-  // Copy result from GPU to CPU
-  resCL = clEnqueueReadBuffer(m_VkGPU.commandQueue,
-                              outputGPUBuffer,
-                              CL_TRUE,
-                              0,
-                              m_VkParameters.outputBufferBytes,
-                              m_VkParameters.outputCPUBuffer,
-                              0,
-                              nullptr,
-                              nullptr);
-  if (resCL != CL_SUCCESS)
+uint64_t
+VkCommon::GetOptimalFFTSize(uint64_t n, PrecisionEnum precision, FFTEnum fft, const SizeCostTableType * measuredCosts)
+{
+  if (n <= 1)
   {
-    std::cerr << __FILE__ "(" << __LINE__ << "): clEnqueueReadBuffer returned " << resCL << std::endl;
-    return VkFFTResult{ VKFFT_ERROR_FAILED_TO_COPY };
+    return 1;
   }
 
-  clReleaseMemObject(inputGPUBuffer);
-  if (m_VkParameters.fft != FFTEnum::C2C)
+  const auto cost = [&](const uint64_t size) {
+    if (measuredCosts != nullptr)
+    {
+      const auto measured = measuredCosts->find(size);
+      if (measured != measuredCosts->end())
+      {
+        return measured->second;
+      }
+    }
+    return EstimateTransformCost(size, precision, fft);
+  };
+
+  // A power of two is always supported efficiently, so no larger size
+  // need be considered. Sizes with an unsupported prime factor beyond n
+  // are never faster than a supported size below 2n, so are skipped
+  // unless they have a tabulated cost.
+  uint64_t powerOfTwo{ 1 };
+  while (powerOfTwo < n)
   {
-    // Release other buffer too
-    clReleaseMemObject(outputGPUBuffer);
+    powerOfTwo *= 2;
   }
-#elif (VKFFT_BACKEND == LEVEL_ZERO)
-  resZE = zeCommandListClose(launchCommandList);
-  if (resZE != ZE_RESULT_SUCCESS)
-    return VkFFTResult{ VKFFT_ERROR_FAILED_TO_SUBMIT_QUEUE };
-  resZE = zeCommandQueueExecuteCommandLists(m_VkGPU.commandQueue, 1, &launchCommandList, nullptr);
-  if (resZE != ZE_RESULT_SUCCESS)
-    return VkFFTResult{ VKFFT_ERROR_FAILED_TO_SUBMIT_QUEUE };
-  resZE = zeCommandQueueSynchronize(m_VkGPU.commandQueue, UINT32_MAX);
-  if (resZE != ZE_RESULT_SUCCESS)
-    return VkFFTResult{ VKFFT_ERROR_FAILED_TO_SYNCHRONIZE };
-  zeCommandListDestroy(launchCommandList);
 
-  // Device -> host copy via an immediate command list.
+  uint64_t bestSize{ n };
+  double   bestCost{ cost(n) };
+  for (uint64_t size{ n + 1 }; size <= powerOfTwo; ++size)
   {
-    ze_command_queue_desc_t copyQueueDesc{};
-    copyQueueDesc.stype = ZE_STRUCTURE_TYPE_COMMAND_QUEUE_DESC;
-    copyQueueDesc.ordinal = m_VkGPU.commandQueueID;
-    copyQueueDesc.mode = ZE_COMMAND_QUEUE_MODE_DEFAULT;
-    copyQueueDesc.priority = ZE_COMMAND_QUEUE_PRIORITY_NORMAL;
-    ze_command_list_handle_t copyCommandList{ nullptr };
-    resZE = zeCommandListCreateImmediate(m_VkGPU.context, m_VkGPU.device, &copyQueueDesc, &copyCommandList);
-    if (resZE != ZE_RESULT_SUCCESS)
-      return VkFFTResult{ VKFFT_ERROR_FAILED_TO_CREATE_COMMAND_LIST };
-    resZE = zeCommandListAppendMemoryCopy(copyCommandList,
-                                          m_VkParameters.outputCPUBuffer,
-                                          outputGPUBuffer,
-                                          m_VkParameters.outputBufferBytes,
-                                          nullptr,
-                                          0,
-                                          nullptr);
-    if (resZE != ZE_RESULT_SUCCESS)
-      return VkFFTResult{ VKFFT_ERROR_FAILED_TO_COPY };
-    resZE = zeCommandQueueSynchronize(m_VkGPU.commandQueue, UINT32_MAX);
-    if (resZE != ZE_RESULT_SUCCESS)
-      return VkFFTResult{ VKFFT_ERROR_FAILED_TO_SYNCHRONIZE };
-    zeCommandListDestroy(copyCommandList);
+    const bool tabulated{ measuredCosts != nullptr && measuredCosts->count(size) > 0 };
+    if (!tabulated && GetLargestPrimeFactor(size) > GetGreatestPrimeFactor())
+    {
+      continue;
+    }
+    const double sizeCost{ cost(size) };
+    if (sizeCost < bestCost)
+    {
+      bestSize = size;
+      bestCost = sizeCost;
+    }
   }
+  return bestSize;
+}
+
+bool
+VkCommon::HasAnyPlanFor(const VkParameters & vkParameters)
+{
+  const std::lock_guard<std::mutex> lock(planRegistryMutex);
+  return std::any_of(planRegistry.begin(), planRegistry.end(), [&vkParameters](const VkParameters & registered) {
+    return !(registered != vkParameters);
+  });
+}
 
-  // GPUBuffer aliases input or output in the C2C / inverse-R2H cases; free it once.
-  zeMemFree(m_VkGPU.context, GPUBuffer);
-  if (m_VkParameters.fft != FFTEnum::C2C)
+bool
+VkCommon::IsDeviceUnavailable(VkFFTResult resFFT)
+{
+  switch (resFFT)
   {
-    if (m_VkParameters.I == DirectionEnum::FORWARD)
-      zeMemFree(m_VkGPU.context, inputGPUBuffer);
-    else
-      zeMemFree(m_VkGPU.context, outputGPUBuffer);
+    case VKFFT_ERROR_FAILED_TO_INITIALIZE:
+    case VKFFT_ERROR_FAILED_TO_SET_DEVICE_ID:
+    case VKFFT_ERROR_FAILED_TO_GET_DEVICE:
+    case VKFFT_ERROR_FAILED_TO_CREATE_CONTEXT:
+    case VKFFT_ERROR_FAILED_TO_CREATE_COMMAND_QUEUE:
+      return true;
+    default:
+      return false;
   }
-#elif (VKFFT_BACKEND == METAL)
-  metalEncoder->endEncoding();
-  metalCommandBuffer->commit();
-  metalCommandBuffer->waitUntilCompleted();
-
-  std::memcpy(m_VkParameters.outputCPUBuffer, outputGPUBuffer->contents(), m_VkParameters.outputBufferBytes);
+}
 
-  // The C2C in-place case aliases input/output to GPUBuffer; release once.
-  GPUBuffer->release();
-  if (m_VkParameters.fft != FFTEnum::C2C)
+uint64_t
+VkCommon::GetNumberOfDevices()
+{
+#if (VKFFT_BACKEND == CUDA)
+  int count{ 0 };
+  if (cuInit(0) != CUDA_SUCCESS || cuDeviceGetCount(&count) != CUDA_SUCCESS)
+    return 0;
+  return static_cast<uint64_t>(count);
+#elif (VKFFT_BACKEND == OPENCL)
+  return CountDevices();
+#elif (VKFFT_BACKEND == LEVEL_ZERO)
+  if (zeInit(0) != ZE_RESULT_SUCCESS)
+    return 0;
+  uint32_t numDrivers{ 0 };
+  if (zeDriverGet(&numDrivers, nullptr) != ZE_RESULT_SUCCESS || numDrivers == 0)
+    return 0;
+  std::unique_ptr<ze_driver_handle_t[]> drivers{ std::make_unique<ze_driver_handle_t[]>(numDrivers) };
+  if (zeDriverGet(&numDrivers, drivers.get()) != ZE_RESULT_SUCCESS)
+    return 0;
+  uint64_t numberOfDevices{ 0 };
+  for (uint32_t j{ 0 }; j < numDrivers; ++j)
   {
-    if (m_VkParameters.I == DirectionEnum::FORWARD)
-      inputGPUBuffer->release();
-    else
-      outputGPUBuffer->release();
+    uint32_t numDevices{ 0 };
+    if (zeDeviceGet(drivers[j], &numDevices, nullptr) == ZE_RESULT_SUCCESS)
+      numberOfDevices += numDevices;
   }
+  return numberOfDevices;
+#elif (VKFFT_BACKEND == METAL)
+  NS::Array * devices = MTL::CopyAllDevices();
+  if (devices == nullptr)
+    return 0;
+  const uint64_t numberOfDevices{ devices->count() };
+  devices->release();
+  return numberOfDevices;
+#else
+  return 0;
 #endif
+}
 
-  if (m_VkParameters.fft == FFTEnum::R2FullH && m_VkParameters.I == DirectionEnum::FORWARD)
-  {
-    // Compute complex conjugates for the R2FullH forward computation
-    switch (m_VkParameters.P)
-    {
-      case PrecisionEnum::FLOAT:
-      {
-        using ComplexType = std::complex<float>;
-        ComplexType * const outputCPUFloat{ reinterpret_cast<ComplexType *>(m_VkParameters.outputCPUBuffer) };
-        for (uint64_t z{ 0 }; z < m_VkFFTConfiguration.size[2]; ++z)
-        {
-          for (uint64_t y{ 0 }; y < m_VkFFTConfiguration.size[1]; ++y)
-          {
-            const uint64_t offsetStart{ z * m_VkFFTConfiguration.bufferStride[1] +
-                                        y * m_VkFFTConfiguration.bufferStride[0] };
-            const uint64_t offsetEnd{ offsetStart + m_VkFFTConfiguration.bufferStride[0] };
-            for (uint64_t x = (m_VkFFTConfiguration.size[0] - 1) / 2; x >= 1; --x)
-            {
-              outputCPUFloat[offsetEnd - x] = std::conj(outputCPUFloat[offsetStart + x]);
-            }
-          }
-        }
-      }
-      break;
-      case PrecisionEnum::DOUBLE:
-      {
-        using ComplexType = std::complex<double>;
-        ComplexType * const outputCPUDouble{ reinterpret_cast<ComplexType *>(m_VkParameters.outputCPUBuffer) };
-        for (uint64_t z{ 0 }; z < m_VkFFTConfiguration.size[2]; ++z)
-        {
-          for (uint64_t y{ 0 }; y < m_VkFFTConfiguration.size[1]; ++y)
-          {
-            const uint64_t offsetStart{ z * m_VkFFTConfiguration.bufferStride[1] +
-                                        y * m_VkFFTConfiguration.bufferStride[0] };
-            const uint64_t offsetEnd{ offsetStart + m_VkFFTConfiguration.bufferStride[0] };
-            for (uint64_t x = (m_VkFFTConfiguration.size[0] - 1) / 2; x >= 1; --x)
-            {
-              outputCPUDouble[offsetEnd - x] = std::conj(outputCPUDouble[offsetStart + x]);
-            }
-          }
-        }
-      }
-      break;
-    } // end switch (m_VkParameters.P)
-  } // end if(m_VkParameters.fft == R2FullH && m_VkParameters.I == DirectionEnum::FORWARD)
-  deleteVkFFT(&app);
+uint64_t
+VkCommon::GetDeviceMemoryBytes(uint64_t deviceID)
+{
+#if (VKFFT_BACKEND == CUDA)
+  CUdevice device;
+  size_t   bytes{ 0 };
+  if (cuInit(0) != CUDA_SUCCESS || cuDeviceGet(&device, (int)deviceID) != CUDA_SUCCESS ||
+      cuDeviceTotalMem(&bytes, device) != CUDA_SUCCESS)
+    return 0;
+  return static_cast<uint64_t>(bytes);
+#elif (VKFFT_BACKEND == OPENCL)
+  cl_platform_id platform{ nullptr };
+  cl_device_id   device{ nullptr };
+  if (FindDevice(deviceID, platform, device) != VKFFT_SUCCESS)
+    return 0;
+  cl_ulong bytes{ 0 };
+  if (clGetDeviceInfo(device, CL_DEVICE_GLOBAL_MEM_SIZE, sizeof(cl_ulong), &bytes, nullptr) != CL_SUCCESS)
+    return 0;
+  return static_cast<uint64_t>(bytes);
+#elif (VKFFT_BACKEND == METAL)
+  NS::Array * devices = MTL::CopyAllDevices();
+  if (devices == nullptr)
+    return 0;
+  uint64_t bytes{ 0 };
+  if (deviceID < devices->count())
+    bytes = devices->object<MTL::Device>(deviceID)->recommendedMaxWorkingSetSize();
+  devices->release();
+  return bytes;
+#else
+  // Level Zero reports memory per memory module; treat it as unknown
+  (void)deviceID;
+  return 0;
+#endif
+}
 
-  return resFFT;
+uint64_t
+VkCommon::GetDeviceHostPointerAlignment(uint64_t deviceID)
+{
+#if (VKFFT_BACKEND == OPENCL)
+  cl_platform_id platform{ nullptr };
+  cl_device_id   device{ nullptr };
+  if (FindDevice(deviceID, platform, device) != VKFFT_SUCCESS)
+    return 0;
+  return GetHostPointerAlignment(device);
+#else
+  // Other backends copy between CPU and GPU buffers
+  (void)deviceID;
+  return 0;
+#endif
 }
 
 VkFFTResult
@@ -883,11 +2844,20 @@ VkCommon::ReleaseBackend()
 {
   VkFFTResult resFFT{ VKFFT_SUCCESS };
 
+  // The plan and its GPU buffers belong to the context released here
+  this->ReleasePlan();
+
   // Return to launchVkFFT code
 #if (VKFFT_BACKEND == CUDA)
+  if (m_VkGPU.stream)
+  {
+    cudaStreamDestroy(m_VkGPU.stream);
+    m_VkGPU.stream = nullptr;
+  }
   if (m_VkGPU.context)
   {
-    cuCtxDestroy(m_VkGPU.context);
+    cuDevicePrimaryCtxRelease(m_VkGPU.device);
+    m_VkGPU.context = 0;
   }
 #elif (VKFFT_BACKEND == OPENCL)
   cl_int resCL{ CL_SUCCESS };
@@ -900,11 +2870,13 @@ VkCommon::ReleaseBackend()
       std::cerr << __FILE__ "(" << __LINE__ << "): clReleaseCommandQueue returned " << resCL << std::endl;
       return VkFFTResult{ VKFFT_ERROR_FAILED_TO_RELEASE_COMMAND_QUEUE };
     }
+    m_VkGPU.commandQueue = nullptr;
   }
 
   if (m_VkGPU.context)
   {
-    resCL = clReleaseContext(m_VkGPU.context);
+    resCL = ReleaseSharedContext(m_VkGPU.device_id);
+    m_VkGPU.context = nullptr;
     if (resCL != CL_SUCCESS)
     {
       std::cerr << __FILE__ "(" << __LINE__ << "): clReleaseContext returned " << resCL << std::endl;
@@ -935,7 +2907,8 @@ VkCommon::ReleaseBackend()
   }
 #endif
 
-  // Invalidate cache description!!!
+  // The next run configures the backend again
+  m_MustConfigure = true;
 
   return resFFT;
 }
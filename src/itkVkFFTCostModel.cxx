@@ -0,0 +1,97 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         https://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "itkVkFFTCostModel.h"
+#include "itkVkCommon.h"
+
+namespace itk
+{
+
+VkFFTCostModel::VkFFTCostModel()
+  : m_GreatestPrimeFactor{ VkCommon::GetGreatestPrimeFactor() }
+{}
+
+double
+VkFFTCostModel::EstimateVkSeconds(const LengthsType & lengths,
+                                  SizeValueType       numberOfPixels,
+                                  SizeValueType       transferBytes,
+                                  bool                doublePrecision,
+                                  bool                planCached) const
+{
+  double secondsPerFlop{ m_FFTSecondsPerFlop };
+  if (doublePrecision)
+  {
+    secondsPerFlop *= m_DoublePrecisionFlopFactor;
+  }
+  double seconds{ EstimateFlops(lengths, numberOfPixels, doublePrecision, m_GreatestPrimeFactor) * secondsPerFlop +
+                  static_cast<double>(transferBytes) / m_TransferBytesPerSecond + m_FFTDispatchSeconds };
+  if (!planCached)
+  {
+    seconds += m_FFTPlanSeconds;
+  }
+  return seconds;
+}
+
+double
+VkFFTCostModel::EstimateCPUSeconds(const LengthsType & lengths,
+                                   SizeValueType       numberOfPixels,
+                                   bool                doublePrecision) const
+{
+  double secondsPerFlop{ m_CPUSecondsPerFlop };
+  if (doublePrecision)
+  {
+    secondsPerFlop *= m_CPUDoublePrecisionFlopFactor;
+  }
+  // CPU implementations either support a length or refuse it, so no Bluestein charge
+  return EstimateFlops(lengths, numberOfPixels, doublePrecision, NumericTraits<SizeValueType>::max()) * secondsPerFlop;
+}
+
+double
+VkFFTCostModel::EstimateFlops(const LengthsType & lengths,
+                              SizeValueType       numberOfPixels,
+                              bool                doublePrecision,
+                              SizeValueType       greatestPrimeFactor)
+{
+  const VkCommon::PrecisionEnum precision{ doublePrecision ? VkCommon::PrecisionEnum::DOUBLE
+                                                           : VkCommon::PrecisionEnum::FLOAT };
+  double                        flops{ 0.0 };
+  for (const SizeValueType n : lengths)
+  {
+    if (n > 1)
+    {
+      flops += (static_cast<double>(numberOfPixels) / n) *
+               VkCommon::EstimateTransformCost(n, precision, VkCommon::FFTEnum::C2C, greatestPrimeFactor);
+    }
+  }
+  return flops;
+}
+
+void
+VkFFTCostModel::PrintSelf(std::ostream & os, Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+  os << indent << "CPUSecondsPerFlop: " << m_CPUSecondsPerFlop << std::endl;
+  os << indent << "CPUDoublePrecisionFlopFactor: " << m_CPUDoublePrecisionFlopFactor << std::endl;
+  os << indent << "FFTSecondsPerFlop: " << m_FFTSecondsPerFlop << std::endl;
+  os << indent << "DoublePrecisionFlopFactor: " << m_DoublePrecisionFlopFactor << std::endl;
+  os << indent << "TransferBytesPerSecond: " << m_TransferBytesPerSecond << std::endl;
+  os << indent << "FFTDispatchSeconds: " << m_FFTDispatchSeconds << std::endl;
+  os << indent << "FFTPlanSeconds: " << m_FFTPlanSeconds << std::endl;
+  os << indent << "GreatestPrimeFactor: " << m_GreatestPrimeFactor << std::endl;
+}
+
+} // namespace itk
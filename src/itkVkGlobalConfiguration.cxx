@@ -16,8 +16,13 @@
  *
  *=========================================================================*/
 #include "itkVkGlobalConfiguration.h"
+#include "itkVkCommon.h"
+#include "itkVkTracer.h"
 
+#include <algorithm>
+#include <limits>
 #include <mutex>
+#include <vector>
 #include "itkSingleton.h"
 
 namespace itk
@@ -30,6 +35,12 @@ struct VkGlobalConfigurationGlobals
 
 itkGetGlobalSimpleMacro(VkGlobalConfiguration, VkGlobalConfigurationGlobals, PimplGlobals);
 
+namespace
+{
+// Devices pinned by the VkDevicePin objects of this thread, innermost last
+thread_local std::vector<uint64_t> pinnedDevices;
+} // namespace
+
 VkGlobalConfigurationGlobals * VkGlobalConfiguration::m_PimplGlobals;
 
 VkGlobalConfiguration::Pointer
@@ -74,4 +85,367 @@ VkGlobalConfiguration::GetDeviceID()
   return uint64_t{ GetInstance()->m_DeviceID };
 }
 
+void
+VkGlobalConfiguration::SetSchedulingPolicy(const SchedulingPolicyEnum policy)
+{
+  itkInitGlobalsMacro(PimplGlobals);
+  const Pointer                     instance{ GetInstance() };
+  const std::lock_guard<std::mutex> lock{ instance->m_SchedulingMutex };
+  instance->m_SchedulingPolicy = policy;
+  instance->m_NextDevice = 0;
+}
+
+VkGlobalConfiguration::SchedulingPolicyEnum
+VkGlobalConfiguration::GetSchedulingPolicy()
+{
+  itkInitGlobalsMacro(PimplGlobals);
+  const Pointer                     instance{ GetInstance() };
+  const std::lock_guard<std::mutex> lock{ instance->m_SchedulingMutex };
+  return instance->m_SchedulingPolicy;
+}
+
+void
+VkGlobalConfiguration::SetNumberOfDevices(const uint64_t numberOfDevices)
+{
+  itkInitGlobalsMacro(PimplGlobals);
+  const Pointer                     instance{ GetInstance() };
+  const std::lock_guard<std::mutex> lock{ instance->m_SchedulingMutex };
+  instance->m_NumberOfDevices = numberOfDevices;
+  instance->m_NextDevice = 0;
+}
+
+uint64_t
+VkGlobalConfiguration::GetNumberOfDevices()
+{
+  itkInitGlobalsMacro(PimplGlobals);
+  const Pointer                     instance{ GetInstance() };
+  const std::lock_guard<std::mutex> lock{ instance->m_SchedulingMutex };
+  if (instance->m_NumberOfDevices > 0)
+  {
+    return instance->m_NumberOfDevices;
+  }
+  if (instance->m_NumberOfEnumeratedDevices == 0)
+  {
+    // Enumerate once; a machine without devices still schedules on device 0
+    instance->m_NumberOfEnumeratedDevices = std::max(VkCommon::GetNumberOfDevices(), uint64_t{ 1 });
+  }
+  return instance->m_NumberOfEnumeratedDevices;
+}
+
+void
+VkGlobalConfiguration::SetDeviceMemoryBytes(const uint64_t id, const uint64_t bytes)
+{
+  itkInitGlobalsMacro(PimplGlobals);
+  const Pointer                     instance{ GetInstance() };
+  const std::lock_guard<std::mutex> lock{ instance->m_SchedulingMutex };
+  instance->ResizeDeviceState(id);
+  instance->m_DeviceMemoryBytes[id] = bytes;
+  instance->m_DeviceMemoryKnown[id] = true;
+}
+
+uint64_t
+VkGlobalConfiguration::GetDeviceMemoryBytes(const uint64_t id)
+{
+  itkInitGlobalsMacro(PimplGlobals);
+  const Pointer                     instance{ GetInstance() };
+  const std::lock_guard<std::mutex> lock{ instance->m_SchedulingMutex };
+  instance->ResizeDeviceState(id);
+  if (!instance->m_DeviceMemoryKnown[id])
+  {
+    instance->m_DeviceMemoryBytes[id] = VkCommon::GetDeviceMemoryBytes(id);
+    instance->m_DeviceMemoryKnown[id] = true;
+  }
+  return instance->m_DeviceMemoryBytes[id];
+}
+
+uint64_t
+VkGlobalConfiguration::AcquireDevice(const uint64_t workBytes)
+{
+  itkInitGlobalsMacro(PimplGlobals);
+  uint64_t pinnedID{ 0 };
+  if (VkDevicePin::GetPinnedDevice(pinnedID))
+  {
+    ReserveDevice(pinnedID, workBytes);
+    return pinnedID;
+  }
+  const SchedulingPolicyEnum policy{ GetSchedulingPolicy() };
+  if (policy == SchedulingPolicyEnum::FIXED)
+  {
+    const uint64_t id{ GetDeviceID() };
+    ReserveDevice(id, workBytes);
+    return id;
+  }
+
+  // Query outside of the lock; these may call into the backend
+  const uint64_t        numberOfDevices{ GetNumberOfDevices() };
+  std::vector<uint64_t> memoryBytes;
+  if (policy == SchedulingPolicyEnum::MEMORY_AWARE)
+  {
+    for (uint64_t id{ 0 }; id < numberOfDevices; ++id)
+    {
+      memoryBytes.push_back(GetDeviceMemoryBytes(id));
+    }
+  }
+
+  const Pointer                     instance{ GetInstance() };
+  const std::lock_guard<std::mutex> lock{ instance->m_SchedulingMutex };
+  instance->ResizeDeviceState(numberOfDevices - 1);
+
+  uint64_t chosen{ 0 };
+  switch (policy)
+  {
+    case SchedulingPolicyEnum::ROUND_ROBIN:
+      chosen = instance->m_NextDevice % numberOfDevices;
+      instance->m_NextDevice = chosen + 1;
+      break;
+    case SchedulingPolicyEnum::LEAST_OUTSTANDING_WORK:
+      for (uint64_t id{ 1 }; id < numberOfDevices; ++id)
+      {
+        if (instance->m_OutstandingRuns[id] < instance->m_OutstandingRuns[chosen] ||
+            (instance->m_OutstandingRuns[id] == instance->m_OutstandingRuns[chosen] &&
+             instance->m_OutstandingBytes[id] < instance->m_OutstandingBytes[chosen]))
+        {
+          chosen = id;
+        }
+      }
+      break;
+    case SchedulingPolicyEnum::MEMORY_AWARE:
+    {
+      // Devices of unknown memory are ranked by their outstanding bytes alone
+      const auto available = [&](const uint64_t id) {
+        const uint64_t total{ memoryBytes[id] > 0 ? memoryBytes[id] : std::numeric_limits<uint64_t>::max() };
+        const uint64_t used{ instance->m_OutstandingBytes[id] };
+        return uint64_t{ total > used ? total - used : 0 };
+      };
+      for (uint64_t id{ 1 }; id < numberOfDevices; ++id)
+      {
+        if (available(id) > available(chosen))
+        {
+          chosen = id;
+        }
+      }
+      break;
+    }
+    default:
+      break;
+  }
+
+  ++instance->m_OutstandingRuns[chosen];
+  instance->m_OutstandingBytes[chosen] += workBytes;
+  return chosen;
+}
+
+uint64_t
+VkGlobalConfiguration::AcquireDevice(const uint64_t workBytes, const uint64_t planDeviceID)
+{
+  itkInitGlobalsMacro(PimplGlobals);
+  uint64_t pinnedID{ 0 };
+  if (VkDevicePin::GetPinnedDevice(pinnedID) || GetSchedulingPolicy() == SchedulingPolicyEnum::FIXED ||
+      planDeviceID >= GetNumberOfDevices())
+  {
+    return AcquireDevice(workBytes);
+  }
+  ReserveDevice(planDeviceID, workBytes);
+  return planDeviceID;
+}
+
+void
+VkGlobalConfiguration::ReserveDevice(const uint64_t id, const uint64_t workBytes)
+{
+  itkInitGlobalsMacro(PimplGlobals);
+  const Pointer                     instance{ GetInstance() };
+  const std::lock_guard<std::mutex> lock{ instance->m_SchedulingMutex };
+  instance->ResizeDeviceState(id);
+  ++instance->m_OutstandingRuns[id];
+  instance->m_OutstandingBytes[id] += workBytes;
+}
+
+void
+VkGlobalConfiguration::ReleaseDevice(const uint64_t id, const uint64_t workBytes)
+{
+  itkInitGlobalsMacro(PimplGlobals);
+  const Pointer                     instance{ GetInstance() };
+  const std::lock_guard<std::mutex> lock{ instance->m_SchedulingMutex };
+  instance->ResizeDeviceState(id);
+  // Called from destructors, so an unmatched release is clamped rather than thrown
+  if (instance->m_OutstandingRuns[id] > 0)
+  {
+    --instance->m_OutstandingRuns[id];
+  }
+  instance->m_OutstandingBytes[id] -= std::min(workBytes, instance->m_OutstandingBytes[id]);
+}
+
+uint64_t
+VkGlobalConfiguration::GetNumberOfOutstandingRuns(const uint64_t id)
+{
+  itkInitGlobalsMacro(PimplGlobals);
+  const Pointer                     instance{ GetInstance() };
+  const std::lock_guard<std::mutex> lock{ instance->m_SchedulingMutex };
+  return id < instance->m_OutstandingRuns.size() ? instance->m_OutstandingRuns[id] : uint64_t{ 0 };
+}
+
+uint64_t
+VkGlobalConfiguration::GetNumberOfOutstandingBytes(const uint64_t id)
+{
+  itkInitGlobalsMacro(PimplGlobals);
+  const Pointer                     instance{ GetInstance() };
+  const std::lock_guard<std::mutex> lock{ instance->m_SchedulingMutex };
+  return id < instance->m_OutstandingBytes.size() ? instance->m_OutstandingBytes[id] : uint64_t{ 0 };
+}
+
+void
+VkGlobalConfiguration::ResizeDeviceState(const uint64_t id)
+{
+  if (id >= m_OutstandingRuns.size())
+  {
+    m_OutstandingRuns.resize(id + 1, 0);
+    m_OutstandingBytes.resize(id + 1, 0);
+    m_DeviceMemoryBytes.resize(id + 1, 0);
+    m_DeviceMemoryKnown.resize(id + 1, false);
+  }
+}
+
+void
+VkGlobalConfiguration::SetProfiling(const bool profiling)
+{
+  itkInitGlobalsMacro(PimplGlobals);
+  GetInstance()->m_Profiling = profiling;
+}
+
+bool
+VkGlobalConfiguration::GetProfiling()
+{
+  itkInitGlobalsMacro(PimplGlobals);
+  return GetInstance()->m_Profiling;
+}
+
+void
+VkGlobalConfiguration::SetCostModel(const VkFFTCostModel * costModel)
+{
+  itkInitGlobalsMacro(PimplGlobals);
+  const Pointer                     instance{ GetInstance() };
+  const std::lock_guard<std::mutex> lock{ instance->m_CostModelMutex };
+  instance->m_CostModel = costModel;
+}
+
+VkFFTCostModel::ConstPointer
+VkGlobalConfiguration::GetCostModel()
+{
+  itkInitGlobalsMacro(PimplGlobals);
+  const Pointer                     instance{ GetInstance() };
+  const std::lock_guard<std::mutex> lock{ instance->m_CostModelMutex };
+  return instance->m_CostModel;
+}
+
+void
+VkGlobalConfiguration::SetFallbackToCPU(const bool fallbackToCPU)
+{
+  itkInitGlobalsMacro(PimplGlobals);
+  GetInstance()->m_FallbackToCPU = fallbackToCPU;
+}
+
+bool
+VkGlobalConfiguration::GetFallbackToCPU()
+{
+  itkInitGlobalsMacro(PimplGlobals);
+  return GetInstance()->m_FallbackToCPU;
+}
+
+void
+VkGlobalConfiguration::SetTraceFileName(const std::string & fileName)
+{
+  VkTracer::SetFileName(fileName);
+}
+
+std::string
+VkGlobalConfiguration::GetTraceFileName()
+{
+  return VkTracer::GetFileName();
+}
+
+std::ostream &
+operator<<(std::ostream & out, const VkGlobalConfiguration::SchedulingPolicyEnum value)
+{
+  return out << [value] {
+    switch (value)
+    {
+      case VkGlobalConfiguration::SchedulingPolicyEnum::FIXED:
+        return "itk::VkGlobalConfiguration::SchedulingPolicyEnum::FIXED";
+      case VkGlobalConfiguration::SchedulingPolicyEnum::ROUND_ROBIN:
+        return "itk::VkGlobalConfiguration::SchedulingPolicyEnum::ROUND_ROBIN";
+      case VkGlobalConfiguration::SchedulingPolicyEnum::LEAST_OUTSTANDING_WORK:
+        return "itk::VkGlobalConfiguration::SchedulingPolicyEnum::LEAST_OUTSTANDING_WORK";
+      case VkGlobalConfiguration::SchedulingPolicyEnum::MEMORY_AWARE:
+        return "itk::VkGlobalConfiguration::SchedulingPolicyEnum::MEMORY_AWARE";
+      default:
+        return "INVALID VALUE FOR itk::VkGlobalConfiguration::SchedulingPolicyEnum";
+    }
+  }();
+}
+
+VkDeviceReservation::VkDeviceReservation(const bool     useGlobalConfiguration,
+                                         const uint64_t localDeviceID,
+                                         const uint64_t workBytes)
+  : m_DeviceID{ localDeviceID }
+  , m_WorkBytes{ workBytes }
+{
+  if (useGlobalConfiguration)
+  {
+    m_DeviceID = VkGlobalConfiguration::AcquireDevice(workBytes);
+  }
+  else
+  {
+    VkGlobalConfiguration::ReserveDevice(m_DeviceID, workBytes);
+  }
+}
+
+VkDeviceReservation::VkDeviceReservation(const bool                     useGlobalConfiguration,
+                                         const uint64_t                 localDeviceID,
+                                         const uint64_t                 workBytes,
+                                         const VkCommon &               vkCommon,
+                                         const VkCommon::VkParameters & vkParameters)
+  : m_DeviceID{ localDeviceID }
+  , m_WorkBytes{ workBytes }
+{
+  uint64_t planDeviceID{ 0 };
+  if (useGlobalConfiguration && vkCommon.GetPlanDeviceID(vkParameters, planDeviceID))
+  {
+    m_DeviceID = VkGlobalConfiguration::AcquireDevice(workBytes, planDeviceID);
+  }
+  else if (useGlobalConfiguration)
+  {
+    m_DeviceID = VkGlobalConfiguration::AcquireDevice(workBytes);
+  }
+  else
+  {
+    VkGlobalConfiguration::ReserveDevice(m_DeviceID, workBytes);
+  }
+}
+
+VkDeviceReservation::~VkDeviceReservation()
+{
+  VkGlobalConfiguration::ReleaseDevice(m_DeviceID, m_WorkBytes);
+}
+
+VkDevicePin::VkDevicePin(const uint64_t id)
+{
+  pinnedDevices.push_back(id);
+}
+
+VkDevicePin::~VkDevicePin()
+{
+  pinnedDevices.pop_back();
+}
+
+bool
+VkDevicePin::GetPinnedDevice(uint64_t & id)
+{
+  if (pinnedDevices.empty())
+  {
+    return false;
+  }
+  id = pinnedDevices.back();
+  return true;
+}
+
 } // namespace itk
@@ -0,0 +1,261 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         https://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include "itkVkTracer.h"
+
+#include "itksys/SystemTools.hxx"
+
+#include <atomic>
+#include <cmath>
+#include <fstream>
+#include <functional>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#if defined(_WIN32)
+#  include <process.h>
+#else
+#  include <unistd.h>
+#endif
+
+namespace itk
+{
+namespace
+{
+struct VkTracerState
+{
+  std::mutex                      m_Mutex;
+  std::once_flag                  m_EnvironmentChecked;
+  std::atomic<bool>               m_Enabled{ false };
+  std::string                     m_FileName;
+  std::ofstream                   m_File;
+  bool                            m_FirstEvent{ true };
+  VkTracer::ClockType::time_point m_Epoch{ VkTracer::ClockType::now() };
+
+  ~VkTracerState()
+  {
+    if (m_File.is_open())
+    {
+      m_File << "\n]\n";
+    }
+  }
+};
+
+VkTracerState &
+GetState()
+{
+  static VkTracerState state;
+  return state;
+}
+
+int
+GetProcessID()
+{
+#if defined(_WIN32)
+  return _getpid();
+#else
+  return static_cast<int>(getpid());
+#endif
+}
+
+// Escape a string for use in a JSON string literal
+std::string
+EscapeJSON(const char * text)
+{
+  std::string escaped;
+  for (const char * c = text; c != nullptr && *c != '\0'; ++c)
+  {
+    if (*c == '"' || *c == '\\')
+    {
+      escaped += '\\';
+    }
+    if (static_cast<unsigned char>(*c) >= 0x20)
+    {
+      escaped += *c;
+    }
+  }
+  return escaped;
+}
+
+// Caller holds the state mutex
+void
+OpenTrace(VkTracerState & state, const std::string & fileName)
+{
+  if (state.m_File.is_open())
+  {
+    state.m_File << "\n]\n";
+    state.m_File.close();
+  }
+  state.m_FileName = fileName;
+  state.m_FirstEvent = true;
+  if (!fileName.empty())
+  {
+    state.m_File.open(fileName.c_str(), std::ios::out | std::ios::trunc);
+    if (state.m_File.is_open())
+    {
+      state.m_File << "[";
+    }
+  }
+  state.m_Enabled = state.m_File.is_open();
+}
+
+void
+CheckEnvironment(VkTracerState & state)
+{
+  std::call_once(state.m_EnvironmentChecked, [&state]() {
+    std::string fileName;
+    if (itksys::SystemTools::GetEnv("ITK_VKFFT_TRACE_FILE", fileName) && !fileName.empty())
+    {
+      const std::lock_guard<std::mutex> lock(state.m_Mutex);
+      if (state.m_FileName.empty())
+      {
+        OpenTrace(state, fileName);
+      }
+    }
+  });
+}
+
+// Timestamps and durations must be numbers for trace viewers, so a
+// non-finite value, e.g. from a clock that went backwards, is clamped
+double
+ClampTime(const double microseconds)
+{
+  return std::isfinite(microseconds) ? microseconds : 0.0;
+}
+
+void
+WriteEvent(const char *                    name,
+           const char *                    category,
+           const char *                    phase,
+           VkTracer::ClockType::time_point start,
+           const double *                  durationMicroseconds,
+           uint64_t                        deviceID,
+           const std::string &             args)
+{
+  VkTracerState & state = GetState();
+
+  std::ostringstream event;
+  event.precision(15);
+  event << "{\"name\":\"" << EscapeJSON(name) << "\",\"cat\":\"" << EscapeJSON(category) << "\",\"ph\":\"" << phase
+        << "\",\"ts\":" << ClampTime(std::chrono::duration<double, std::micro>(start - state.m_Epoch).count());
+  if (durationMicroseconds != nullptr)
+  {
+    event << ",\"dur\":" << ClampTime(*durationMicroseconds);
+  }
+  else
+  {
+    event << ",\"s\":\"t\"";
+  }
+  event << ",\"pid\":" << GetProcessID() << ",\"tid\":" << std::hash<std::thread::id>{}(std::this_thread::get_id())
+        << ",\"args\":{\"deviceID\":" << deviceID;
+  if (!args.empty())
+  {
+    event << "," << args;
+  }
+  event << "}}";
+
+  const std::lock_guard<std::mutex> lock(state.m_Mutex);
+  if (!state.m_File.is_open())
+  {
+    return;
+  }
+  state.m_File << (state.m_FirstEvent ? "\n" : ",\n") << event.str();
+  state.m_FirstEvent = false;
+}
+} // namespace
+
+void
+VkTracer::SetFileName(const std::string & fileName)
+{
+  VkTracerState & state = GetState();
+  CheckEnvironment(state);
+  const std::lock_guard<std::mutex> lock(state.m_Mutex);
+  OpenTrace(state, fileName);
+}
+
+std::string
+VkTracer::GetFileName()
+{
+  VkTracerState & state = GetState();
+  CheckEnvironment(state);
+  const std::lock_guard<std::mutex> lock(state.m_Mutex);
+  return state.m_FileName;
+}
+
+bool
+VkTracer::IsEnabled()
+{
+  VkTracerState & state = GetState();
+  CheckEnvironment(state);
+  return state.m_Enabled;
+}
+
+void
+VkTracer::AddCompleteEvent(const char *          name,
+                           const char *          category,
+                           ClockType::time_point start,
+                           ClockType::time_point end,
+                           uint64_t              deviceID,
+                           const std::string &   args)
+{
+  if (!IsEnabled())
+  {
+    return;
+  }
+  const double durationMicroseconds{ std::chrono::duration<double, std::micro>(end - start).count() };
+  WriteEvent(name, category, "X", start, &durationMicroseconds, deviceID, args);
+}
+
+void
+VkTracer::AddInstantEvent(const char * name, const char * category, uint64_t deviceID, const std::string & args)
+{
+  if (!IsEnabled())
+  {
+    return;
+  }
+  WriteEvent(name, category, "i", ClockType::now(), nullptr, deviceID, args);
+}
+
+std::string
+VkTracer::FormatNumber(const double value)
+{
+  if (std::isnan(value))
+  {
+    return "\"nan\"";
+  }
+  if (std::isinf(value))
+  {
+    return value > 0.0 ? "\"inf\"" : "\"-inf\"";
+  }
+  std::ostringstream number;
+  number.precision(15);
+  number << value;
+  return number.str();
+}
+
+void
+VkTracer::Flush()
+{
+  VkTracerState & state = GetState();
+  const std::lock_guard<std::mutex> lock(state.m_Mutex);
+  if (state.m_File.is_open())
+  {
+    state.m_File.flush();
+  }
+}
+
+} // namespace itk
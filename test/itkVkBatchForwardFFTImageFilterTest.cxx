@@ -0,0 +1,195 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         https://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+
+#include "itkVkAlignedImportImageContainer.h"
+#include "itkVkBatchForwardFFTImageFilter.h"
+#include "itkVkForwardFFTImageFilter.h"
+
+#include "itkExtractImageFilter.h"
+#include "itkImageRegionIterator.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkMersenneTwisterRandomVariateGenerator.h"
+#include "itkTestingMacros.h"
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// Verify that a batch of 2-D images stacked along the last dimension is
+// transformed as each image would be on its own, and that results are
+// written in place into a grafted output buffer. On OpenCL devices that
+// share memory with the host, aligned buffers are used without copies.
+
+namespace
+{
+// Point `image` at `count` pixels of `storage` aligned to `alignment` bytes
+template <typename TImage>
+void
+ImportAligned(TImage * image, std::vector<char> & storage, itk::SizeValueType count, uint64_t alignment)
+{
+  using PixelType = typename TImage::PixelType;
+  storage.resize(count * sizeof(PixelType) + alignment);
+  const auto address{ reinterpret_cast<uintptr_t>(storage.data()) };
+  const auto aligned{ reinterpret_cast<PixelType *>((address + alignment - 1) / alignment * alignment) };
+  image->GetPixelContainer()->SetImportPointer(aligned, count, false);
+}
+} // namespace
+
+template <typename PrecisionType>
+int
+runVkBatchForwardFFTImageFilterTest()
+{
+  constexpr unsigned int BatchDimension{ 3 };
+  constexpr unsigned int Dimension{ BatchDimension - 1 };
+  using RealType = PrecisionType;
+  using ComplexType = std::complex<RealType>;
+  using BatchImageType = itk::Image<RealType, BatchDimension>;
+  using BatchComplexImageType = itk::Image<ComplexType, BatchDimension>;
+  using RealImageType = itk::Image<RealType, Dimension>;
+  using ComplexImageType = itk::Image<ComplexType, Dimension>;
+
+  // Odd sizes exercise the conjugate fill of each image of the batch
+  const typename BatchImageType::SizeType batchSize{ { 7, 6, 4 } };
+
+  auto generator = itk::Statistics::MersenneTwisterRandomVariateGenerator::New();
+  generator->Initialize(2024);
+  auto batchImage = BatchImageType::New();
+  batchImage->SetRegions(batchSize);
+  batchImage->Allocate();
+  for (itk::ImageRegionIterator<BatchImageType> it(batchImage, batchImage->GetBufferedRegion()); !it.IsAtEnd(); ++it)
+  {
+    it.Set(static_cast<RealType>(generator->GetUniformVariate(-1.0, 1.0)));
+  }
+
+  using BatchFilterType = itk::VkBatchForwardFFTImageFilter<BatchImageType>;
+  auto batchFilter = BatchFilterType::New();
+  ITK_EXERCISE_BASIC_OBJECT_METHODS(batchFilter, VkBatchForwardFFTImageFilter, ImageToImageFilter);
+  ITK_TEST_EXPECT_EQUAL(BatchFilterType::TransformDimension, Dimension);
+  batchFilter->SetInput(batchImage);
+
+  // Graft a preallocated output as a NumPy array view would be
+  auto preallocated = BatchComplexImageType::New();
+  preallocated->SetRegions(batchSize);
+  preallocated->Allocate();
+  const ComplexType * const preallocatedBuffer{ preallocated->GetBufferPointer() };
+  batchFilter->GraftOutput(preallocated);
+  ITK_TRY_EXPECT_NO_EXCEPTION(batchFilter->Update());
+  ITK_TEST_EXPECT_TRUE(batchFilter->GetOutput()->GetBufferPointer() == preallocatedBuffer);
+  ITK_TEST_EXPECT_EQUAL(batchFilter->GetVkTimings().numberOfRuns, 1u);
+
+  // Compare with transforming each image of the batch on its own
+  using ExtractFilterType = itk::ExtractImageFilter<BatchImageType, RealImageType>;
+  using ForwardFilterType = itk::VkForwardFFTImageFilter<RealImageType, ComplexImageType>;
+  const RealType tolerance{ std::is_same<RealType, float>::value ? RealType{ 1e-4 } : RealType{ 1e-10 } };
+  bool           testPassed{ true };
+  for (itk::SizeValueType batch = 0; batch < batchSize[Dimension]; ++batch)
+  {
+    typename BatchImageType::RegionType sliceRegion{ batchImage->GetLargestPossibleRegion() };
+    sliceRegion.SetIndex(Dimension, batch);
+    sliceRegion.SetSize(Dimension, 0);
+    auto extractFilter = ExtractFilterType::New();
+    extractFilter->SetInput(batchImage);
+    extractFilter->SetExtractionRegion(sliceRegion);
+    extractFilter->SetDirectionCollapseToSubmatrix();
+    auto forwardFilter = ForwardFilterType::New();
+    forwardFilter->SetInput(extractFilter->GetOutput());
+    ITK_TRY_EXPECT_NO_EXCEPTION(forwardFilter->Update());
+
+    sliceRegion.SetSize(Dimension, 1);
+    itk::ImageRegionConstIterator<BatchComplexImageType> batchIt(batchFilter->GetOutput(), sliceRegion);
+    itk::ImageRegionConstIterator<ComplexImageType>      sliceIt(forwardFilter->GetOutput(),
+                                                            forwardFilter->GetOutput()->GetBufferedRegion());
+    for (; !batchIt.IsAtEnd(); ++batchIt, ++sliceIt)
+    {
+      if (std::abs(batchIt.Get() - sliceIt.Get()) > tolerance)
+      {
+        std::cout << "Batch " << batch << " differs at " << batchIt.GetIndex() << ": " << batchIt.Get() << " vs "
+                  << sliceIt.Get() << std::endl;
+        testPassed = false;
+      }
+    }
+  }
+
+  // Aligned buffers are used in place by devices that share memory with the host
+  const uint64_t alignment{ itk::VkCommon::GetDeviceHostPointerAlignment(batchFilter->GetDeviceID()) };
+  std::cout << "Host pointer alignment: " << alignment << std::endl;
+  if (alignment == 0)
+  {
+    ITK_TEST_EXPECT_EQUAL(batchFilter->GetVkTimings().numberOfZeroCopyRuns, 0u);
+  }
+  else
+  {
+    const itk::SizeValueType numberOfPixels{ batchImage->GetLargestPossibleRegion().GetNumberOfPixels() };
+    std::vector<char>        outputStorage;
+    auto                     alignedInput = BatchImageType::New();
+    alignedInput->SetRegions(batchSize);
+    itk::AllocateVkAlignedBuffer(alignedInput.GetPointer(), batchFilter->GetDeviceID());
+    std::memcpy(alignedInput->GetBufferPointer(), batchImage->GetBufferPointer(), numberOfPixels * sizeof(RealType));
+
+    // Outputs allocated by the filter are aligned, so that no copies are needed
+    auto allocatingFilter = BatchFilterType::New();
+    allocatingFilter->SetInput(alignedInput);
+    ITK_TRY_EXPECT_NO_EXCEPTION(allocatingFilter->Update());
+    const auto outputAddress{ reinterpret_cast<uintptr_t>(allocatingFilter->GetOutput()->GetBufferPointer()) };
+    ITK_TEST_EXPECT_EQUAL(outputAddress % alignment, 0u);
+    ITK_TEST_EXPECT_EQUAL(allocatingFilter->GetVkTimings().numberOfZeroCopyRuns, 1u);
+
+    auto alignedOutput = BatchComplexImageType::New();
+    alignedOutput->SetRegions(batchSize);
+    ImportAligned(alignedOutput.GetPointer(), outputStorage, numberOfPixels, alignment);
+
+    auto zeroCopyFilter = BatchFilterType::New();
+    zeroCopyFilter->SetInput(alignedInput);
+    zeroCopyFilter->GraftOutput(alignedOutput);
+    ITK_TRY_EXPECT_NO_EXCEPTION(zeroCopyFilter->Update());
+    ITK_TEST_EXPECT_EQUAL(zeroCopyFilter->GetVkTimings().numberOfZeroCopyRuns, 1u);
+    itk::ImageRegionConstIterator<BatchComplexImageType> zeroCopyIt(zeroCopyFilter->GetOutput(),
+                                                                    zeroCopyFilter->GetOutput()->GetBufferedRegion());
+    itk::ImageRegionConstIterator<BatchComplexImageType> batchIt(batchFilter->GetOutput(),
+                                                                 batchFilter->GetOutput()->GetBufferedRegion());
+    for (; !batchIt.IsAtEnd(); ++batchIt, ++zeroCopyIt)
+    {
+      if (std::abs(batchIt.Get() - zeroCopyIt.Get()) > tolerance)
+      {
+        std::cout << "Zero-copy output differs at " << batchIt.GetIndex() << ": " << zeroCopyIt.Get() << " vs "
+                  << batchIt.Get() << std::endl;
+        testPassed = false;
+      }
+    }
+  }
+
+  return testPassed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+int
+itkVkBatchForwardFFTImageFilterTest(int argc, char * argv[])
+{
+  const std::string precision{ (argc > 1) ? argv[1] : "float" };
+  if (precision == "double")
+  {
+    return runVkBatchForwardFFTImageFilterTest<double>();
+  }
+  if (precision == "float")
+  {
+    return runVkBatchForwardFFTImageFilterTest<float>();
+  }
+  std::cerr << "Unknown precision '" << precision << "'. Expected 'float' or 'double'." << std::endl;
+  return EXIT_FAILURE;
+}
@@ -0,0 +1,174 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         https://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include <iostream>
+#include <string>
+
+#include "itkVkBlurringCostModel.h"
+#include "itkVkDiscreteGaussianImageFilter.h"
+#include "itkVkMultiResolutionPyramidImageFilter.h"
+#include "itkImage.h"
+#include "itkMath.h"
+#include "itkTestingMacros.h"
+
+// Verify runtime estimates of VkBlurringCostModel behave as expected
+// and that the model drives blurring selection in Vk smoothing filters.
+// Only estimates are computed so no GPU is required.
+
+template <typename PrecisionType>
+int
+runVkBlurringCostModelTest()
+{
+  constexpr unsigned int Dimension = 3;
+  using ImageType = itk::Image<PrecisionType, Dimension>;
+  using CostModelType = itk::VkBlurringCostModel<ImageType>;
+  using SizeType = typename CostModelType::RegionSizeType;
+
+  auto costModel = CostModelType::New();
+  ITK_EXERCISE_BASIC_OBJECT_METHODS(costModel, VkBlurringCostModel, Object);
+
+  costModel->SetNumberOfSpatialThreads(8);
+  ITK_TEST_SET_GET_VALUE(8u, costModel->GetNumberOfSpatialThreads());
+  costModel->SetNumberOfSpatialThreads(0);
+  ITK_TEST_SET_GET_VALUE(1u, costModel->GetNumberOfSpatialThreads());
+  costModel->SetNumberOfSpatialThreads(8);
+
+  // Fix calibration constants so that expectations do not depend on defaults
+  costModel->SetSpatialSecondsPerMultiplyAdd(1.0e-9);
+  ITK_TEST_SET_GET_VALUE(1.0e-9, costModel->GetSpatialSecondsPerMultiplyAdd());
+  costModel->SetFFTSecondsPerFlop(1.0e-11);
+  ITK_TEST_SET_GET_VALUE(1.0e-11, costModel->GetFFTSecondsPerFlop());
+  costModel->SetDoublePrecisionFlopFactor(1.0);
+  ITK_TEST_SET_GET_VALUE(1.0, costModel->GetDoublePrecisionFlopFactor());
+  costModel->SetTransferBytesPerSecond(1.0e11);
+  ITK_TEST_SET_GET_VALUE(1.0e11, costModel->GetTransferBytesPerSecond());
+  costModel->SetFFTDispatchSeconds(1.0e-4);
+  ITK_TEST_SET_GET_VALUE(1.0e-4, costModel->GetFFTDispatchSeconds());
+  costModel->SetFFTPlanSeconds(5.0e-3);
+  ITK_TEST_SET_GET_VALUE(5.0e-3, costModel->GetFFTPlanSeconds());
+
+  const SizeType regionSize{ { 256, 256, 256 } };
+  const SizeType smallKernel{ { 3, 3, 3 } };
+  const SizeType largeKernel{ { 101, 101, 101 } };
+
+  // Spatial cost grows linearly with kernel size
+  const double spatialSmall{ costModel->EstimateSpatialSeconds(regionSize, smallKernel) };
+  const double spatialLarge{ costModel->EstimateSpatialSeconds(regionSize, largeKernel) };
+  ITK_TEST_EXPECT_TRUE(spatialLarge > 30.0 * spatialSmall);
+
+  // FFT cost grows only with the padded region size
+  const double fftSmall{ costModel->EstimateFFTSeconds(regionSize, smallKernel) };
+  const double fftLarge{ costModel->EstimateFFTSeconds(regionSize, largeKernel) };
+  ITK_TEST_EXPECT_TRUE(fftLarge < 4.0 * fftSmall);
+
+  ITK_TEST_EXPECT_TRUE(!costModel->GetUseFFT(regionSize, smallKernel));
+  ITK_TEST_EXPECT_TRUE(costModel->GetUseFFT(regionSize, largeKernel));
+
+  // No VkCommon holds a plan, so each of the three transforms is charged its plan
+  costModel->SetFFTPlanSeconds(0.0);
+  ITK_TEST_EXPECT_TRUE(itk::Math::FloatAlmostEqual(
+    costModel->EstimateFFTSeconds(regionSize, largeKernel), fftLarge - 3.0 * 5.0e-3, 4, 1.0e-12));
+  costModel->SetFFTPlanSeconds(5.0e-3);
+
+  // Regions are padded to sizes supported by the radix kernels
+  costModel->SetGreatestPrimeFactor(2);
+  const double fftPowerOfTwo{ costModel->EstimateFFTSeconds(SizeType{ { 128, 128, 128 } }, SizeType{ { 1, 1, 1 } }) };
+  const double fftPaddedToPowerOfTwo{ costModel->EstimateFFTSeconds(SizeType{ { 129, 129, 129 } },
+                                                                    SizeType{ { 1, 1, 1 } }) };
+  costModel->SetGreatestPrimeFactor(13);
+  const double fftSmooth{ costModel->EstimateFFTSeconds(SizeType{ { 128, 128, 128 } }, SizeType{ { 1, 1, 1 } }) };
+  ITK_TEST_EXPECT_EQUAL(fftPowerOfTwo, fftSmooth);
+  const double fftPaddedToSmooth{ costModel->EstimateFFTSeconds(SizeType{ { 129, 129, 129 } },
+                                                                SizeType{ { 1, 1, 1 } }) };
+  ITK_TEST_EXPECT_TRUE(fftPaddedToPowerOfTwo > fftPaddedToSmooth);
+  costModel->SetGreatestPrimeFactor(127);
+  ITK_TEST_SET_GET_VALUE(127UL, costModel->GetGreatestPrimeFactor());
+  costModel->SetGreatestPrimeFactor(13);
+
+  // Along one dimension, only the kernel along that dimension matters
+  const SizeType anisotropicKernel{ { 3, 3, 101 } };
+  ITK_TEST_EXPECT_TRUE(costModel->EstimateSpatialSeconds1D(regionSize, anisotropicKernel, 2) >
+                       30.0 * costModel->EstimateSpatialSeconds1D(regionSize, anisotropicKernel, 0));
+  ITK_TEST_EXPECT_TRUE(costModel->EstimateFFTSeconds1D(regionSize, anisotropicKernel, 0) <
+                       costModel->EstimateFFTSeconds(regionSize, anisotropicKernel));
+  ITK_TEST_EXPECT_TRUE(!costModel->GetUseFFT1D(regionSize, anisotropicKernel, 0));
+  ITK_TEST_EXPECT_TRUE(costModel->GetUseFFT1D(regionSize, anisotropicKernel, 2));
+
+  // Verify the cost model drives VkDiscreteGaussianImageFilter selection
+  auto image = ImageType::New();
+  image->SetRegions(regionSize);
+  image->Allocate();
+
+  using GaussianFilterType = itk::VkDiscreteGaussianImageFilter<ImageType, ImageType>;
+  auto gaussianFilter = GaussianFilterType::New();
+  gaussianFilter->SetInput(image);
+  gaussianFilter->SetUseImageSpacing(false);
+  gaussianFilter->SetMaximumKernelWidth(128);
+  gaussianFilter->SetAnticipatedPerformanceMetricThreshold(100.0f);
+  gaussianFilter->UpdateOutputInformation();
+  gaussianFilter->GetOutput()->SetRequestedRegionToLargestPossibleRegion();
+
+  gaussianFilter->SetVariance(0.1);
+  ITK_TEST_EXPECT_TRUE(!gaussianFilter->GetUseFFT());
+  gaussianFilter->SetVariance(400.0);
+  ITK_TEST_EXPECT_TRUE(!gaussianFilter->GetUseFFT());
+  gaussianFilter->SetCostModel(costModel);
+  ITK_TEST_SET_GET_VALUE(costModel, gaussianFilter->GetCostModel());
+  ITK_TEST_EXPECT_TRUE(gaussianFilter->GetUseFFT());
+  gaussianFilter->SetVariance(0.1);
+  ITK_TEST_EXPECT_TRUE(!gaussianFilter->GetUseFFT());
+
+  // Select blurring per dimension for anisotropic kernels
+  typename GaussianFilterType::ArrayType anisotropicVariance;
+  anisotropicVariance[0] = 0.1;
+  anisotropicVariance[1] = 0.1;
+  anisotropicVariance[2] = 400.0;
+  gaussianFilter->SetVariance(anisotropicVariance);
+  ITK_TEST_EXPECT_TRUE(!gaussianFilter->GetUseFFT(0));
+  ITK_TEST_EXPECT_TRUE(!gaussianFilter->GetUseFFT(1));
+  ITK_TEST_EXPECT_TRUE(gaussianFilter->GetUseFFT(2));
+
+  // Verify the cost model drives VkMultiResolutionPyramidImageFilter selection
+  using PyramidType = itk::VkMultiResolutionPyramidImageFilter<ImageType, ImageType>;
+  auto pyramidFilter = PyramidType::New();
+  pyramidFilter->SetInput(image);
+  pyramidFilter->SetMetricThreshold(100.0f);
+  ITK_TEST_EXPECT_TRUE(!pyramidFilter->GetUseFFT(SizeType{ { 50, 50, 50 } }));
+  pyramidFilter->SetCostModel(costModel);
+  ITK_TEST_SET_GET_VALUE(costModel, pyramidFilter->GetCostModel());
+  ITK_TEST_EXPECT_TRUE(pyramidFilter->GetUseFFT(SizeType{ { 50, 50, 50 } }));
+  ITK_TEST_EXPECT_TRUE(!pyramidFilter->GetUseFFT(SizeType{ { 1, 1, 1 } }));
+
+  return EXIT_SUCCESS;
+}
+
+int
+itkVkBlurringCostModelTest(int argc, char * argv[])
+{
+  const std::string precision{ (argc > 1) ? argv[1] : "float" };
+  if (precision == "double")
+  {
+    return runVkBlurringCostModelTest<double>();
+  }
+  if (precision == "float")
+  {
+    return runVkBlurringCostModelTest<float>();
+  }
+  std::cerr << "Unknown precision '" << precision << "'. Expected 'float' or 'double'." << std::endl;
+  return EXIT_FAILURE;
+}
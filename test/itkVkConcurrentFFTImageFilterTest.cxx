@@ -0,0 +1,208 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         https://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+
+#include "itkVkForwardFFTImageFilter.h"
+#include "itkVkGlobalConfiguration.h"
+
+#include "itkImageRegionIterator.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkMersenneTwisterRandomVariateGenerator.h"
+#include "itkTestingMacros.h"
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Verify that Vk FFT filters updated concurrently from several threads on
+// one device give the same results as sequential updates, that a
+// repeated update reuses the backend configuration, and that runs of one
+// VkCommon shared by all threads are serialized on one plan.
+
+template <typename PrecisionType>
+int
+runVkConcurrentFFTImageFilterTest()
+{
+  constexpr unsigned int Dimension{ 2 };
+  using RealImageType = itk::Image<PrecisionType, Dimension>;
+  using ComplexImageType = itk::Image<std::complex<PrecisionType>, Dimension>;
+  using FilterType = itk::VkForwardFFTImageFilter<RealImageType, ComplexImageType>;
+
+  constexpr unsigned int numberOfThreads{ 8 };
+  constexpr unsigned int numberOfUpdates{ 4 };
+
+  auto generator = itk::Statistics::MersenneTwisterRandomVariateGenerator::New();
+  generator->Initialize(2024);
+  std::vector<typename RealImageType::Pointer> images;
+  std::vector<typename FilterType::Pointer>    filters;
+  for (unsigned int thread = 0; thread < numberOfThreads; ++thread)
+  {
+    auto image = RealImageType::New();
+    image->SetRegions(typename RealImageType::SizeType{ { 64, 48 } });
+    image->Allocate();
+    for (itk::ImageRegionIterator<RealImageType> it(image, image->GetBufferedRegion()); !it.IsAtEnd(); ++it)
+    {
+      it.Set(static_cast<PrecisionType>(generator->GetUniformVariate(-1.0, 1.0)));
+    }
+    images.push_back(image);
+    auto filter = FilterType::New();
+    filter->SetInput(image);
+    filters.push_back(filter);
+  }
+
+  // Sequential reference results
+  std::vector<typename ComplexImageType::Pointer> expected;
+  for (unsigned int thread = 0; thread < numberOfThreads; ++thread)
+  {
+    auto reference = FilterType::New();
+    reference->SetInput(images[thread]);
+    ITK_TRY_EXPECT_NO_EXCEPTION(reference->Update());
+    expected.push_back(reference->GetOutput());
+  }
+
+  std::atomic<unsigned int> numberOfFailures{ 0 };
+  std::vector<std::thread>  threads;
+  for (unsigned int thread = 0; thread < numberOfThreads; ++thread)
+  {
+    threads.emplace_back([&filters, &numberOfFailures, thread]() {
+      try
+      {
+        for (unsigned int update = 0; update < numberOfUpdates; ++update)
+        {
+          filters[thread]->Modified();
+          filters[thread]->Update();
+        }
+      }
+      catch (const itk::ExceptionObject & exception)
+      {
+        std::cerr << "Thread " << thread << ": " << exception << std::endl;
+        ++numberOfFailures;
+      }
+    });
+  }
+  for (auto & thread : threads)
+  {
+    thread.join();
+  }
+  ITK_TEST_EXPECT_EQUAL(numberOfFailures.load(), 0u);
+
+  // All threads run the same transform on their own buffers through one
+  // VkCommon, which serializes the runs and keeps a single plan
+  itk::VkCommon  sharedVkCommon;
+  const uint64_t numberOfPixels{ images[0]->GetBufferedRegion().GetNumberOfPixels() };
+  std::vector<std::vector<std::complex<PrecisionType>>> sharedOutputs(
+    numberOfThreads, std::vector<std::complex<PrecisionType>>(numberOfPixels));
+  threads.clear();
+  for (unsigned int thread = 0; thread < numberOfThreads; ++thread)
+  {
+    threads.emplace_back([&sharedVkCommon, &sharedOutputs, &images, &numberOfFailures, numberOfPixels, thread]() {
+      itk::VkCommon::VkGPU vkGPU;
+      vkGPU.device_id = itk::VkGlobalConfiguration::GetDeviceID();
+      itk::VkCommon::VkParameters vkParameters;
+      vkParameters.X = images[thread]->GetBufferedRegion().GetSize(0);
+      vkParameters.Y = images[thread]->GetBufferedRegion().GetSize(1);
+      vkParameters.P = std::is_same<PrecisionType, double>::value ? itk::VkCommon::PrecisionEnum::DOUBLE
+                                                                  : itk::VkCommon::PrecisionEnum::FLOAT;
+      vkParameters.fft = itk::VkCommon::FFTEnum::R2FullH;
+      vkParameters.PSize = sizeof(PrecisionType);
+      vkParameters.inputCPUBuffer = images[thread]->GetBufferPointer();
+      vkParameters.inputBufferBytes = numberOfPixels * sizeof(PrecisionType);
+      vkParameters.outputCPUBuffer = sharedOutputs[thread].data();
+      vkParameters.outputBufferBytes = numberOfPixels * sizeof(std::complex<PrecisionType>);
+      for (unsigned int update = 0; update < numberOfUpdates; ++update)
+      {
+        const VkFFTResult resFFT{ sharedVkCommon.Run(vkGPU, vkParameters) };
+        if (resFFT != VKFFT_SUCCESS)
+        {
+          std::cerr << "Thread " << thread << ": VkFFT error " << resFFT << std::endl;
+          ++numberOfFailures;
+          return;
+        }
+      }
+    });
+  }
+  for (auto & thread : threads)
+  {
+    thread.join();
+  }
+  ITK_TEST_EXPECT_EQUAL(numberOfFailures.load(), 0u);
+  ITK_TEST_EXPECT_EQUAL(sharedVkCommon.GetTimings().numberOfRuns, uint64_t{ numberOfThreads * numberOfUpdates });
+  ITK_TEST_EXPECT_EQUAL(sharedVkCommon.GetTimings().numberOfConfigurations, uint64_t{ 1 });
+
+  const PrecisionType tolerance{ std::is_same<PrecisionType, float>::value ? PrecisionType{ 1e-4 }
+                                                                           : PrecisionType{ 1e-10 } };
+  bool                testPassed{ true };
+  for (unsigned int thread = 0; thread < numberOfThreads; ++thread)
+  {
+    // Repeated updates of unchanged sizes configure the backend once, whatever the buffers
+    const typename itk::VkCommon::VkTimings timings{ filters[thread]->GetVkTimings() };
+    if (timings.numberOfRuns != numberOfUpdates || timings.numberOfConfigurations != 1)
+    {
+      std::cout << "Filter " << thread << ": " << timings.numberOfRuns << " runs, " << timings.numberOfConfigurations
+                << " configurations." << std::endl;
+      testPassed = false;
+    }
+
+    itk::ImageRegionConstIterator<ComplexImageType> outputIt(filters[thread]->GetOutput(),
+                                                             filters[thread]->GetOutput()->GetBufferedRegion());
+    itk::ImageRegionConstIterator<ComplexImageType> expectedIt(expected[thread], expected[thread]->GetBufferedRegion());
+    for (; !outputIt.IsAtEnd(); ++outputIt, ++expectedIt)
+    {
+      if (std::abs(outputIt.Get() - expectedIt.Get()) > tolerance)
+      {
+        std::cout << "Filter " << thread << " differs at " << outputIt.GetIndex() << ": " << outputIt.Get() << " vs "
+                  << expectedIt.Get() << std::endl;
+        testPassed = false;
+        break;
+      }
+    }
+
+    itk::ImageRegionConstIterator<ComplexImageType> sharedExpectedIt(expected[thread],
+                                                                     expected[thread]->GetBufferedRegion());
+    for (const auto & value : sharedOutputs[thread])
+    {
+      if (std::abs(value - sharedExpectedIt.Get()) > tolerance)
+      {
+        std::cout << "Shared VkCommon run of thread " << thread << " differs at " << sharedExpectedIt.GetIndex()
+                  << ": " << value << " vs " << sharedExpectedIt.Get() << std::endl;
+        testPassed = false;
+        break;
+      }
+      ++sharedExpectedIt;
+    }
+  }
+
+  return testPassed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+int
+itkVkConcurrentFFTImageFilterTest(int argc, char * argv[])
+{
+  const std::string precision{ (argc > 1) ? argv[1] : "float" };
+  if (precision == "double")
+  {
+    return runVkConcurrentFFTImageFilterTest<double>();
+  }
+  if (precision == "float")
+  {
+    return runVkConcurrentFFTImageFilterTest<float>();
+  }
+  std::cerr << "Unknown precision '" << precision << "'. Expected 'float' or 'double'." << std::endl;
+  return EXIT_FAILURE;
+}
@@ -0,0 +1,237 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         https://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkVkDCTImageFilter.h"
+#include "itkVkDCT1DImageFilter.h"
+#include "itkVkDSTImageFilter.h"
+#include "itkVkDST1DImageFilter.h"
+#include "itkVkTestingHelpers.h"
+
+#include "itkImageRegionConstIterator.h"
+#include "itkMath.h"
+#include "itkTestingMacros.h"
+
+#include <cmath>
+#include <string>
+#include <vector>
+
+// Verify the Vk DCT and DST filters against direct evaluation of the
+// FFTW definitions of types I to IV, and that each inverse transform
+// recovers the input of the forward transform.
+
+namespace
+{
+// One-dimensional transform of `x` with the unnormalized FFTW definitions
+std::vector<double>
+DirectRealToReal(const std::vector<double> & x, bool sine, unsigned int type)
+{
+  const std::size_t   n{ x.size() };
+  const double        pi{ itk::Math::pi };
+  std::vector<double> y(n, 0.0);
+  for (std::size_t k{ 0 }; k < n; ++k)
+  {
+    for (std::size_t j{ 0 }; j < n; ++j)
+    {
+      const double jj{ static_cast<double>(j) };
+      const double kk{ static_cast<double>(k) };
+      if (!sine)
+      {
+        switch (type)
+        {
+          case 1:
+            y[k] += (j == 0 || j == n - 1 ? 1.0 : 2.0) * x[j] * std::cos(pi * jj * kk / static_cast<double>(n - 1));
+            break;
+          case 2:
+            y[k] += 2.0 * x[j] * std::cos(pi * (jj + 0.5) * kk / static_cast<double>(n));
+            break;
+          case 3:
+            y[k] += (j == 0 ? 1.0 : 2.0) * x[j] * std::cos(pi * jj * (kk + 0.5) / static_cast<double>(n));
+            break;
+          default:
+            y[k] += 2.0 * x[j] * std::cos(pi * (jj + 0.5) * (kk + 0.5) / static_cast<double>(n));
+            break;
+        }
+      }
+      else
+      {
+        switch (type)
+        {
+          case 1:
+            y[k] += 2.0 * x[j] * std::sin(pi * (jj + 1.0) * (kk + 1.0) / static_cast<double>(n + 1));
+            break;
+          case 2:
+            y[k] += 2.0 * x[j] * std::sin(pi * (jj + 0.5) * (kk + 1.0) / static_cast<double>(n));
+            break;
+          case 3:
+            y[k] += (j == n - 1 ? 1.0 : 2.0) * x[j] * std::sin(pi * (jj + 1.0) * (kk + 0.5) / static_cast<double>(n));
+            break;
+          default:
+            y[k] += 2.0 * x[j] * std::sin(pi * (jj + 0.5) * (kk + 0.5) / static_cast<double>(n));
+            break;
+        }
+      }
+    }
+  }
+  return y;
+}
+
+// Transform of `image` along `direction` with DirectRealToReal
+template <typename TImage>
+typename TImage::Pointer
+DirectRealToRealAlong(const TImage * image, unsigned int direction, bool sine, unsigned int type)
+{
+  auto output = TImage::New();
+  output->SetRegions(image->GetLargestPossibleRegion());
+  output->Allocate();
+  const auto  size{ image->GetLargestPossibleRegion().GetSize() };
+  const auto  length{ size[direction] };
+  const auto  numberOfLines{ image->GetLargestPossibleRegion().GetNumberOfPixels() / length };
+  auto        lineSize{ size };
+  lineSize[direction] = 1;
+  itk::ImageRegionConstIterator<TImage> lineIt(image, typename TImage::RegionType(lineSize));
+  for (itk::SizeValueType line{ 0 }; line < numberOfLines; ++line, ++lineIt)
+  {
+    typename TImage::IndexType index{ lineIt.GetIndex() };
+    std::vector<double>        x(length);
+    for (itk::SizeValueType j{ 0 }; j < length; ++j)
+    {
+      index[direction] = j;
+      x[j] = image->GetPixel(index);
+    }
+    const std::vector<double> y{ DirectRealToReal(x, sine, type) };
+    for (itk::SizeValueType k{ 0 }; k < length; ++k)
+    {
+      index[direction] = k;
+      output->SetPixel(index, static_cast<typename TImage::PixelType>(y[k]));
+    }
+  }
+  return output;
+}
+
+template <typename TImage>
+bool
+ImagesAreClose(const TImage * image, const TImage * reference, double tolerance)
+{
+  itk::ImageRegionConstIterator<TImage> it(image, image->GetBufferedRegion());
+  itk::ImageRegionConstIterator<TImage> rit(reference, reference->GetBufferedRegion());
+  for (; !it.IsAtEnd() && !rit.IsAtEnd(); ++it, ++rit)
+  {
+    if (std::abs(it.Get() - rit.Get()) > tolerance)
+    {
+      std::cerr << "Pixel " << it.GetIndex() << " is " << it.Get() << " but expected " << rit.Get() << std::endl;
+      return false;
+    }
+  }
+  return it.IsAtEnd() && rit.IsAtEnd();
+}
+
+// Forward transform of `image` with `filter`, compared to the direct
+// separable evaluation, then inverse transform compared to `image`
+template <typename TFilter, typename TImage>
+bool
+CheckRealToReal(TFilter * filter, TImage * image, bool sine, unsigned int type, bool oneDimensional)
+{
+  const double tolerance{ 1.0e-3 };
+  std::cout << (sine ? "DST" : "DCT") << "-" << type << (oneDimensional ? " 1-D" : "") << std::endl;
+
+  filter->SetInput(image);
+  filter->SetType(type);
+  filter->SetTransformDirection(TFilter::TransformDirectionEnum::FORWARD);
+  filter->Update();
+  typename TImage::Pointer forward{ filter->GetOutput() };
+  forward->DisconnectPipeline();
+
+  typename TImage::Pointer expected{ image };
+  for (unsigned int dim{ 0 }; dim < TImage::ImageDimension; ++dim)
+  {
+    if (!oneDimensional || dim == 1)
+    {
+      expected = DirectRealToRealAlong<TImage>(expected, dim, sine, type);
+    }
+  }
+  if (!ImagesAreClose<TImage>(forward, expected, tolerance * image->GetLargestPossibleRegion().GetNumberOfPixels()))
+  {
+    return false;
+  }
+
+  filter->SetInput(forward);
+  filter->SetTransformDirection(TFilter::TransformDirectionEnum::INVERSE);
+  filter->Update();
+  return ImagesAreClose<TImage>(filter->GetOutput(), image, tolerance);
+}
+} // namespace
+
+template <typename PrecisionType>
+int
+runVkDCTImageFilterTest()
+{
+  constexpr unsigned int Dimension{ 2 };
+  using ImageType = itk::Image<PrecisionType, Dimension>;
+  using DCTFilterType = itk::VkDCTImageFilter<ImageType>;
+  using DSTFilterType = itk::VkDSTImageFilter<ImageType>;
+  using DCT1DFilterType = itk::VkDCT1DImageFilter<ImageType>;
+  using DST1DFilterType = itk::VkDST1DImageFilter<ImageType>;
+
+  auto dctFilter = DCTFilterType::New();
+  ITK_EXERCISE_BASIC_OBJECT_METHODS(dctFilter, VkDCTImageFilter, VkRealToRealFFTImageFilter);
+  auto dstFilter = DSTFilterType::New();
+  ITK_EXERCISE_BASIC_OBJECT_METHODS(dstFilter, VkDSTImageFilter, VkRealToRealFFTImageFilter);
+  auto dct1DFilter = DCT1DFilterType::New();
+  ITK_EXERCISE_BASIC_OBJECT_METHODS(dct1DFilter, VkDCT1DImageFilter, VkRealToRealFFTImageFilter);
+  auto dst1DFilter = DST1DFilterType::New();
+  ITK_EXERCISE_BASIC_OBJECT_METHODS(dst1DFilter, VkDST1DImageFilter, VkRealToRealFFTImageFilter);
+
+  ITK_TEST_EXPECT_EQUAL(dctFilter->GetType(), 2);
+  dctFilter->SetType(7);
+  ITK_TEST_EXPECT_EQUAL(dctFilter->GetType(), 4);
+  dct1DFilter->SetDirection(1);
+  ITK_TEST_SET_GET_VALUE(1, dct1DFilter->GetDirection());
+  dst1DFilter->SetDirection(1);
+
+  // Forward transforms are checked against the direct evaluation and
+  // inverse transforms against the input
+  const typename ImageType::Pointer image{ MakeRandomImage<ImageType>({ { 12, 10 } }) };
+  bool                              success{ true };
+  for (unsigned int type{ 1 }; type <= 4; ++type)
+  {
+    ITK_TRY_EXPECT_NO_EXCEPTION(
+      success &= CheckRealToReal(dctFilter.GetPointer(), image.GetPointer(), false, type, false);
+      success &= CheckRealToReal(dstFilter.GetPointer(), image.GetPointer(), true, type, false);
+      success &= CheckRealToReal(dct1DFilter.GetPointer(), image.GetPointer(), false, type, true);
+      success &= CheckRealToReal(dst1DFilter.GetPointer(), image.GetPointer(), true, type, true));
+  }
+  ITK_TEST_EXPECT_TRUE(success);
+
+  return EXIT_SUCCESS;
+}
+
+int
+itkVkDCTImageFilterTest(int argc, char * argv[])
+{
+  const std::string precision{ (argc > 1) ? argv[1] : "float" };
+  if (precision == "double")
+  {
+    return runVkDCTImageFilterTest<double>();
+  }
+  if (precision == "float")
+  {
+    return runVkDCTImageFilterTest<float>();
+  }
+  std::cerr << "Unknown precision '" << precision << "'. Expected 'float' or 'double'." << std::endl;
+  return EXIT_FAILURE;
+}
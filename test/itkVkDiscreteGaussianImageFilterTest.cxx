@@ -38,6 +38,8 @@ runVkDiscreteGaussianImageFilterTest(int argc, char * argv[])
   float        sigma = (argc > 5) ? std::stof(argv[5]) : 0.0;
   float        kernelError = (argc > 6) ? std::stof(argv[6]) : 0.01;
   unsigned int kernelWidth = (argc > 7) ? std::stoi(argv[7]) : 32;
+  unsigned int fftMemoryBudget = (argc > 8) ? std::stoi(argv[8]) : 0;
+  bool         useHybridBlurring = (argc > 9) ? (std::atoi(argv[9]) == 1) : false;
 
   typename ImageType::Pointer inputImage = itk::ReadImage<ImageType>(argv[1]);
 
@@ -75,21 +77,47 @@ runVkDiscreteGaussianImageFilterTest(int argc, char * argv[])
   filter->SetFilterDimensionality(ImageType::ImageDimension);
   ITK_TEST_SET_GET_VALUE(ImageType::ImageDimension, filter->GetFilterDimensionality());
 
+  filter->SetFFTMemoryBudget(fftMemoryBudget);
+  ITK_TEST_SET_GET_VALUE(fftMemoryBudget, filter->GetFFTMemoryBudget());
+
+  ITK_TEST_SET_GET_BOOLEAN(filter, UseHybridBlurring, useHybridBlurring);
+
   // Test with default input boundary conditions
 
   // Check metric value and filter to use
   filter->UpdateOutputInformation();
   filter->GetOutput()->SetRequestedRegionToLargestPossibleRegion();
-  ITK_TEST_EXPECT_EQUAL(expectFFT, filter->GetUseFFT());
+  bool anticipatedFFT = filter->GetUseFFT();
+  if (useHybridBlurring)
+  {
+    // FFT is used if selected along any dimension
+    anticipatedFFT = false;
+    for (unsigned int dim = 0; dim < ImageDimension; ++dim)
+    {
+      anticipatedFFT = anticipatedFFT || filter->GetUseFFT(dim);
+    }
+  }
+  ITK_TEST_EXPECT_EQUAL(expectFFT, anticipatedFFT);
 
   // Run convolution
   ITK_TRY_EXPECT_NO_EXCEPTION(filter->Update());
 
   // Verify selected filter matched expectation
-  ITK_TEST_EXPECT_EQUAL(filter->GetLastRunUsedFFT(), filter->GetUseFFT());
+  ITK_TEST_EXPECT_EQUAL(filter->GetLastRunUsedFFT(), anticipatedFFT);
   ITK_TEST_EXPECT_EQUAL(expectFFT, filter->GetLastRunUsedFFT());
   filter->Print(std::cout);
 
+  // Verify FFT blurring was tiled to fit the memory budget
+  const auto requestedRegion = filter->GetOutput()->GetRequestedRegion();
+  if (expectFFT && fftMemoryBudget > 0 && filter->EstimateFFTMemory(requestedRegion) > fftMemoryBudget)
+  {
+    ITK_TEST_EXPECT_TRUE(filter->GetLastRunNumberOfTiles() > 1);
+  }
+  else
+  {
+    ITK_TEST_EXPECT_EQUAL(filter->GetLastRunNumberOfTiles(), 1u);
+  }
+
   itk::WriteImage(filter->GetOutput(), argv[2], true);
 
   return EXIT_SUCCESS;
@@ -104,7 +132,7 @@ itkVkDiscreteGaussianImageFilterTest(int argc, char * argv[])
     std::cerr << "Usage:" << std::endl;
     std::cerr << itkNameOfTestExecutableMacro(argv)
               << " <float|double> inputFilename outputFilename [expectFFT] [metricThreshold] [sigma] [kernelError] "
-                 "[kernelWidth] "
+                 "[kernelWidth] [fftMemoryBudget] [useHybridBlurring] "
               << std::endl;
     return EXIT_FAILURE;
   }
@@ -0,0 +1,158 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         https://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkVkForward1DFFTImageFilter.h"
+#include "itkVkForwardFFTImageFilter.h"
+#include "itkVkGlobalConfiguration.h"
+#include "itkVnlForward1DFFTImageFilter.h"
+#include "itkVnlForwardFFTImageFilter.h"
+#include "itkVkTestingHelpers.h"
+
+#include "itkImageRegionConstIterator.h"
+#include "itkTestingMacros.h"
+
+#include <complex>
+#include <string>
+
+// Verify that the Vk FFT filters run small transforms with a CPU
+// implementation when the cost model of VkGlobalConfiguration anticipates
+// that to be faster, with the same results as that implementation, and
+// large transforms with VkFFT.
+
+namespace
+{
+template <typename TImage>
+bool
+ImagesAreClose(const TImage * image, const TImage * reference, double tolerance)
+{
+  itk::ImageRegionConstIterator<TImage> it(image, image->GetBufferedRegion());
+  itk::ImageRegionConstIterator<TImage> rit(reference, reference->GetBufferedRegion());
+  for (; !it.IsAtEnd() && !rit.IsAtEnd(); ++it, ++rit)
+  {
+    if (std::abs(it.Get() - rit.Get()) > tolerance)
+    {
+      std::cerr << "Pixel " << it.GetIndex() << " is " << it.Get() << " but expected " << rit.Get() << std::endl;
+      return false;
+    }
+  }
+  return it.IsAtEnd() && rit.IsAtEnd();
+}
+} // namespace
+
+template <typename PrecisionType>
+int
+runVkFFTDispatchTest()
+{
+  constexpr unsigned int Dimension{ 2 };
+  using RealImageType = itk::Image<PrecisionType, Dimension>;
+  using ComplexImageType = itk::Image<std::complex<PrecisionType>, Dimension>;
+  using VkFilterType = itk::VkForwardFFTImageFilter<RealImageType, ComplexImageType>;
+  using VnlFilterType = itk::VnlForwardFFTImageFilter<RealImageType, ComplexImageType>;
+  using Vk1DFilterType = itk::VkForward1DFFTImageFilter<RealImageType, ComplexImageType>;
+  using Vnl1DFilterType = itk::VnlForward1DFFTImageFilter<RealImageType, ComplexImageType>;
+  const double tolerance{ 1.0e-3 };
+
+  // The cost model charges plan creation against VkFFT, so it prefers
+  // the CPU for small transforms and VkFFT for large ones
+  auto costModel = itk::VkFFTCostModel::New();
+  ITK_EXERCISE_BASIC_OBJECT_METHODS(costModel, VkFFTCostModel, Object);
+  costModel->SetFFTPlanSeconds(1.0e-2);
+  const itk::VkFFTCostModel::LengthsType smallLengths{ 8, 8 };
+  const itk::VkFFTCostModel::LengthsType largeLengths{ 2048, 2048 };
+  ITK_TEST_EXPECT_TRUE(!costModel->GetUseVk(smallLengths, 64, 64 * 24, false, false));
+  ITK_TEST_EXPECT_TRUE(costModel->GetUseVk(largeLengths, 2048 * 2048, 2048 * 2048 * 24, false, false));
+  ITK_TEST_EXPECT_TRUE(costModel->EstimateVkSeconds(smallLengths, 64, 64 * 24, false, true) <
+                       costModel->EstimateVkSeconds(smallLengths, 64, 64 * 24, false, false));
+  ITK_TEST_EXPECT_TRUE(costModel->EstimateCPUSeconds(largeLengths, 2048 * 2048, false) <
+                       costModel->EstimateCPUSeconds(largeLengths, 2048 * 2048, true));
+
+  // Without a cost model every update runs with VkFFT
+  ITK_TEST_EXPECT_TRUE(itk::VkGlobalConfiguration::GetCostModel().IsNull());
+  const typename RealImageType::Pointer smallImage{ MakeRandomImage<RealImageType>({ { 8, 8 } }) };
+  {
+    auto vkFilter = VkFilterType::New();
+    vkFilter->SetInput(smallImage);
+    ITK_TRY_EXPECT_NO_EXCEPTION(vkFilter->Update());
+    ITK_TEST_EXPECT_EQUAL(vkFilter->GetNumberOfCPURuns(), 0);
+    ITK_TEST_EXPECT_EQUAL(vkFilter->GetVkTimings().numberOfRuns, 1);
+  }
+
+  itk::VkGlobalConfiguration::SetCostModel(costModel);
+  ITK_TEST_EXPECT_TRUE(itk::VkGlobalConfiguration::GetCostModel().GetPointer() == costModel.GetPointer());
+
+  // A small N-D transform runs on the CPU with the results of the CPU implementation
+  {
+    auto vkFilter = VkFilterType::New();
+    vkFilter->SetInput(smallImage);
+    ITK_TRY_EXPECT_NO_EXCEPTION(vkFilter->Update());
+    ITK_TEST_EXPECT_EQUAL(vkFilter->GetNumberOfCPURuns(), 1);
+    ITK_TEST_EXPECT_EQUAL(vkFilter->GetVkTimings().numberOfRuns, 0);
+
+    auto vnlFilter = VnlFilterType::New();
+    vnlFilter->SetInput(smallImage);
+    ITK_TRY_EXPECT_NO_EXCEPTION(vnlFilter->Update());
+    ITK_TEST_EXPECT_TRUE(ImagesAreClose(vkFilter->GetOutput(), vnlFilter->GetOutput(), tolerance));
+    ITK_TEST_EXPECT_EQUAL(vkFilter->GetOutput()->GetLargestPossibleRegion(),
+                          vnlFilter->GetOutput()->GetLargestPossibleRegion());
+  }
+
+  // A small 1-D transform keeps its direction on the CPU
+  const typename RealImageType::Pointer stripImage{ MakeRandomImage<RealImageType>({ { 3, 16 } }) };
+  {
+    auto vkFilter = Vk1DFilterType::New();
+    vkFilter->SetInput(stripImage);
+    vkFilter->SetDirection(1);
+    ITK_TRY_EXPECT_NO_EXCEPTION(vkFilter->Update());
+    ITK_TEST_EXPECT_EQUAL(vkFilter->GetNumberOfCPURuns(), 1);
+
+    auto vnlFilter = Vnl1DFilterType::New();
+    vnlFilter->SetInput(stripImage);
+    vnlFilter->SetDirection(1);
+    ITK_TRY_EXPECT_NO_EXCEPTION(vnlFilter->Update());
+    ITK_TEST_EXPECT_TRUE(ImagesAreClose(vkFilter->GetOutput(), vnlFilter->GetOutput(), tolerance));
+  }
+
+  // A large transform runs with VkFFT
+  {
+    const typename RealImageType::Pointer largeImage{ MakeRandomImage<RealImageType>({ { 1024, 1024 } }) };
+    auto                                  vkFilter = VkFilterType::New();
+    vkFilter->SetInput(largeImage);
+    ITK_TRY_EXPECT_NO_EXCEPTION(vkFilter->Update());
+    ITK_TEST_EXPECT_EQUAL(vkFilter->GetNumberOfCPURuns(), 0);
+    ITK_TEST_EXPECT_EQUAL(vkFilter->GetVkTimings().numberOfRuns, 1);
+  }
+
+  itk::VkGlobalConfiguration::SetCostModel(nullptr);
+  return EXIT_SUCCESS;
+}
+
+int
+itkVkFFTDispatchTest(int argc, char * argv[])
+{
+  const std::string precision{ (argc > 1) ? argv[1] : "float" };
+  if (precision == "double")
+  {
+    return runVkFFTDispatchTest<double>();
+  }
+  if (precision == "float")
+  {
+    return runVkFFTDispatchTest<float>();
+  }
+  std::cerr << "Unknown precision '" << precision << "'. Expected 'float' or 'double'." << std::endl;
+  return EXIT_FAILURE;
+}
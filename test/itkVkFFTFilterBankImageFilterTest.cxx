@@ -0,0 +1,157 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         https://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkVkFFTFilterBankImageFilter.h"
+#include "itkVkTestingHelpers.h"
+
+#include "itkConvolutionImageFilter.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkImageRegionIterator.h"
+#include "itkTestingMacros.h"
+
+#include <string>
+#include <vector>
+
+// Verify that each output of the filter bank matches the spatial
+// convolution of the input with its kernel, that the kernels are
+// transformed only once for a sequence of inputs, and that the inverse
+// transforms of all kernels run as a single batch.
+
+namespace
+{
+template <typename TImage>
+bool
+ImagesAreClose(const TImage * image, const TImage * reference, double tolerance)
+{
+  itk::ImageRegionConstIterator<TImage> it(image, image->GetBufferedRegion());
+  itk::ImageRegionConstIterator<TImage> rit(reference, reference->GetBufferedRegion());
+  for (; !it.IsAtEnd() && !rit.IsAtEnd(); ++it, ++rit)
+  {
+    if (std::abs(it.Get() - rit.Get()) > tolerance)
+    {
+      std::cerr << "Pixel " << it.GetIndex() << " is " << it.Get() << " but expected " << rit.Get() << std::endl;
+      return false;
+    }
+  }
+  return it.IsAtEnd() && rit.IsAtEnd();
+}
+
+// Compare every output of `filterBank` with ConvolutionImageFilter
+template <typename TFilterBank, typename TImage>
+bool
+MatchesSpatialConvolution(TFilterBank *                                  filterBank,
+                          const TImage *                                 image,
+                          const std::vector<typename TImage::Pointer> & kernels)
+{
+  using ConvolutionFilterType = itk::ConvolutionImageFilter<TImage>;
+  bool matches{ true };
+  for (unsigned int n{ 0 }; n < kernels.size(); ++n)
+  {
+    auto convolution = ConvolutionFilterType::New();
+    convolution->SetInput(image);
+    convolution->SetKernelImage(kernels[n]);
+    convolution->SetNormalize(filterBank->GetNormalize());
+    convolution->Update();
+    if (!ImagesAreClose<TImage>(filterBank->GetOutput(n), convolution->GetOutput(), 1.0e-3))
+    {
+      std::cerr << "Output " << n << " differs from the spatial convolution" << std::endl;
+      matches = false;
+    }
+  }
+  return matches;
+}
+} // namespace
+
+template <typename PrecisionType>
+int
+runVkFFTFilterBankImageFilterTest()
+{
+  constexpr unsigned int Dimension{ 2 };
+  using ImageType = itk::Image<PrecisionType, Dimension>;
+  using FilterBankType = itk::VkFFTFilterBankImageFilter<ImageType>;
+
+  auto filterBank = FilterBankType::New();
+  ITK_EXERCISE_BASIC_OBJECT_METHODS(filterBank, VkFFTFilterBankImageFilter, ImageToImageFilter);
+  ITK_TEST_SET_GET_BOOLEAN(filterBank, Normalize, false);
+
+  // Odd kernels of different sizes, with positive sums for normalization
+  std::vector<typename ImageType::Pointer> kernels;
+  for (const auto & kernelSize : { itk::Size<Dimension>{ { 5, 5 } },
+                                   itk::Size<Dimension>{ { 9, 3 } },
+                                   itk::Size<Dimension>{ { 1, 7 } } })
+  {
+    kernels.push_back(MakeRandomImage<ImageType>(kernelSize, static_cast<int>(kernels.size())));
+    for (itk::ImageRegionIterator<ImageType> it(kernels.back(), kernels.back()->GetBufferedRegion()); !it.IsAtEnd();
+         ++it)
+    {
+      it.Set(it.Get() + PrecisionType{ 1 });
+    }
+    filterBank->SetKernelImage(kernels.size() - 1, kernels.back());
+  }
+  ITK_TEST_EXPECT_EQUAL(filterBank->GetNumberOfKernelImages(), kernels.size());
+  ITK_TEST_EXPECT_EQUAL(filterBank->GetNumberOfIndexedOutputs(), kernels.size());
+  ITK_TEST_EXPECT_TRUE(filterBank->GetKernelImage(1) == kernels[1].GetPointer());
+
+  // The kernels are transformed once, and the convolutions with all kernels run as one VkFFT run
+  const typename ImageType::Pointer image{ MakeRandomImage<ImageType>({ { 37, 30 } }, 2025) };
+  filterBank->SetInput(image);
+  ITK_TRY_EXPECT_NO_EXCEPTION(filterBank->Update());
+  ITK_TEST_EXPECT_EQUAL(filterBank->GetNumberOfKernelTransforms(), kernels.size());
+  ITK_TEST_EXPECT_EQUAL(filterBank->GetVkTimings().numberOfRuns, 1u);
+  ITK_TEST_EXPECT_TRUE(MatchesSpatialConvolution(filterBank.GetPointer(), image.GetPointer(), kernels));
+
+  // Another image of the same size reuses the kernel spectra and the plan
+  const typename ImageType::Pointer nextImage{ MakeRandomImage<ImageType>({ { 37, 30 } }, 2026) };
+  filterBank->SetInput(nextImage);
+  ITK_TRY_EXPECT_NO_EXCEPTION(filterBank->Update());
+  ITK_TEST_EXPECT_EQUAL(filterBank->GetNumberOfKernelTransforms(), kernels.size());
+  ITK_TEST_EXPECT_EQUAL(filterBank->GetVkTimings().numberOfRuns, 2u);
+  ITK_TEST_EXPECT_EQUAL(filterBank->GetLastRunVkTimings().numberOfConfigurations, 0u);
+  ITK_TEST_EXPECT_TRUE(MatchesSpatialConvolution(filterBank.GetPointer(), nextImage.GetPointer(), kernels));
+
+  // Normalizing the kernels transforms them again
+  filterBank->NormalizeOn();
+  ITK_TRY_EXPECT_NO_EXCEPTION(filterBank->Update());
+  ITK_TEST_EXPECT_EQUAL(filterBank->GetNumberOfKernelTransforms(), 2 * kernels.size());
+  ITK_TEST_EXPECT_TRUE(MatchesSpatialConvolution(filterBank.GetPointer(), nextImage.GetPointer(), kernels));
+
+  // Removing a kernel removes its output
+  filterBank->SetNumberOfKernelImages(2);
+  ITK_TEST_EXPECT_EQUAL(filterBank->GetNumberOfIndexedOutputs(), 2u);
+  kernels.pop_back();
+  ITK_TRY_EXPECT_NO_EXCEPTION(filterBank->Update());
+  ITK_TEST_EXPECT_TRUE(MatchesSpatialConvolution(filterBank.GetPointer(), nextImage.GetPointer(), kernels));
+
+  return EXIT_SUCCESS;
+}
+
+int
+itkVkFFTFilterBankImageFilterTest(int argc, char * argv[])
+{
+  const std::string precision{ (argc > 1) ? argv[1] : "float" };
+  if (precision == "double")
+  {
+    return runVkFFTFilterBankImageFilterTest<double>();
+  }
+  if (precision == "float")
+  {
+    return runVkFFTFilterBankImageFilterTest<float>();
+  }
+  std::cerr << "Unknown precision '" << precision << "'. Expected 'float' or 'double'." << std::endl;
+  return EXIT_FAILURE;
+}
@@ -0,0 +1,128 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         https://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include <iostream>
+#include <string>
+
+#include "itkVkFFTPadImageFilter.h"
+#include "itkImage.h"
+#include "itkTestingMacros.h"
+
+// Verify VkFFT transform size selection and that VkFFTPadImageFilter
+// pads to the selected sizes. No transform is run so no GPU is required.
+
+template <typename PrecisionType>
+int
+runVkFFTPadImageFilterTest()
+{
+  using VkCommon = itk::VkCommon;
+  const VkCommon::PrecisionEnum precision{ sizeof(PrecisionType) >= 8 ? VkCommon::PrecisionEnum::DOUBLE
+                                                                      : VkCommon::PrecisionEnum::FLOAT };
+
+  // Sizes factoring into supported radices are never padded further than the next power of two
+  for (uint64_t n = 1; n <= 600; ++n)
+  {
+    const uint64_t optimal{ VkCommon::GetOptimalFFTSize(n, precision, VkCommon::FFTEnum::C2C) };
+    ITK_TEST_EXPECT_TRUE(optimal >= n);
+    ITK_TEST_EXPECT_TRUE(VkCommon::GetLargestPrimeFactor(optimal) <= VkCommon::GetGreatestPrimeFactor());
+    if ((n & (n - 1)) == 0)
+    {
+      ITK_TEST_EXPECT_EQUAL(optimal, n);
+    }
+  }
+
+  // Prime sizes would require Bluestein's algorithm
+  ITK_TEST_EXPECT_TRUE(VkCommon::EstimateTransformCost(17, precision, VkCommon::FFTEnum::C2C) >
+                       VkCommon::EstimateTransformCost(18, precision, VkCommon::FFTEnum::C2C));
+  ITK_TEST_EXPECT_EQUAL(VkCommon::GetOptimalFFTSize(17, precision, VkCommon::FFTEnum::R2HalfH), 18UL);
+
+  // Measured costs override the estimates
+  VkCommon::SizeCostTableType measuredCosts;
+  measuredCosts[18] = 1.0e9;
+  ITK_TEST_EXPECT_EQUAL(VkCommon::GetOptimalFFTSize(17, precision, VkCommon::FFTEnum::R2HalfH, &measuredCosts), 20UL);
+  measuredCosts[17] = 0.0;
+  ITK_TEST_EXPECT_EQUAL(VkCommon::GetOptimalFFTSize(17, precision, VkCommon::FFTEnum::R2HalfH, &measuredCosts), 17UL);
+
+  constexpr unsigned int Dimension = 2;
+  using ImageType = itk::Image<PrecisionType, Dimension>;
+  using FilterType = itk::VkFFTPadImageFilter<ImageType>;
+
+  auto filter = FilterType::New();
+  ITK_EXERCISE_BASIC_OBJECT_METHODS(filter, VkFFTPadImageFilter, FFTPadImageFilter);
+
+  ITK_TEST_EXPECT_TRUE(filter->GetTransformType() == VkCommon::FFTEnum::R2HalfH);
+  filter->SetTransformType(VkCommon::FFTEnum::C2C);
+  ITK_TEST_EXPECT_TRUE(filter->GetTransformType() == VkCommon::FFTEnum::C2C);
+  filter->SetTransformType(VkCommon::FFTEnum::R2HalfH);
+
+  typename ImageType::IndexType inputIndex{ { 3, -2 } };
+  typename ImageType::SizeType  inputSize{ { 17, 97 } };
+  auto                          image = ImageType::New();
+  image->SetRegions(typename ImageType::RegionType(inputIndex, inputSize));
+  image->Allocate();
+  image->FillBuffer(1.0);
+
+  filter->SetInput(image);
+  ITK_TRY_EXPECT_NO_EXCEPTION(filter->Update());
+
+  const auto & outputRegion = filter->GetOutput()->GetLargestPossibleRegion();
+  for (unsigned int dim = 0; dim < Dimension; ++dim)
+  {
+    const auto transformType = dim == 0 ? VkCommon::FFTEnum::R2HalfH : VkCommon::FFTEnum::C2C;
+    const auto expectedSize = VkCommon::GetOptimalFFTSize(inputSize[dim], precision, transformType);
+    ITK_TEST_EXPECT_EQUAL(outputRegion.GetSize()[dim], expectedSize);
+    // The input is centered in the padded region
+    const auto padSize = static_cast<itk::IndexValueType>(expectedSize - inputSize[dim]);
+    ITK_TEST_EXPECT_EQUAL(outputRegion.GetIndex()[dim], inputIndex[dim] - padSize / 2);
+  }
+  ITK_TEST_EXPECT_TRUE(outputRegion.IsInside(image->GetLargestPossibleRegion()));
+
+  // The pad radius is held on either side before choosing the fastest size
+  typename ImageType::SizeType padRadius{ { 4, 0 } };
+  filter->SetPadRadius(padRadius);
+  ITK_TEST_SET_GET_VALUE(padRadius, filter->GetPadRadius());
+  ITK_TRY_EXPECT_NO_EXCEPTION(filter->Update());
+  const auto paddedSize = VkCommon::GetOptimalFFTSize(inputSize[0] + 8, precision, VkCommon::FFTEnum::R2HalfH);
+  ITK_TEST_EXPECT_EQUAL(filter->GetOutput()->GetLargestPossibleRegion().GetSize()[0], paddedSize);
+  ITK_TEST_EXPECT_TRUE(paddedSize >= inputSize[0] + 8);
+  filter->SetPadRadius(typename ImageType::SizeType{ { 0, 0 } });
+
+  // A measured cost table changes the padded size
+  filter->SetSizeCostTable(measuredCosts);
+  ITK_TEST_EXPECT_EQUAL(filter->GetSizeCostTable().size(), measuredCosts.size());
+  ITK_TRY_EXPECT_NO_EXCEPTION(filter->Update());
+  ITK_TEST_EXPECT_EQUAL(filter->GetOutput()->GetLargestPossibleRegion().GetSize()[0], 17UL);
+
+  return EXIT_SUCCESS;
+}
+
+int
+itkVkFFTPadImageFilterTest(int argc, char * argv[])
+{
+  const std::string precision{ (argc > 1) ? argv[1] : "float" };
+  if (precision == "double")
+  {
+    return runVkFFTPadImageFilterTest<double>();
+  }
+  if (precision == "float")
+  {
+    return runVkFFTPadImageFilterTest<float>();
+  }
+  std::cerr << "Unknown precision '" << precision << "'. Expected 'float' or 'double'." << std::endl;
+  return EXIT_FAILURE;
+}
@@ -18,6 +18,7 @@
 
 #include "itkVkForwardFFTImageFilter.h"
 #include "itkVkInverseFFTImageFilter.h"
+#include "itkVkGlobalConfiguration.h"
 
 #include "itkCommand.h"
 #include "itkImageFileWriter.h"
@@ -57,8 +58,10 @@ public:
 
 template <typename PrecisionType>
 int
-runVkForwardInverseFFTImageFilterTest(unsigned int maxSize = 20)
+runVkForwardInverseFFTImageFilterTest(unsigned int maxSize = 20, bool profiling = false)
 {
+  itk::VkGlobalConfiguration::SetProfiling(profiling);
+
   int  testNumber{ 0 };
   bool testsPassed{ true };
   {
@@ -119,6 +122,46 @@ runVkForwardInverseFFTImageFilterTest(unsigned int maxSize = 20)
 
       bool thisTestPassed{ true };
       forwardFilter->Update();
+
+      // Each run of a new filter configures the backend once and accumulates phase timings
+      const typename itk::VkCommon::VkTimings timings{ forwardFilter->GetVkTimings() };
+      if (timings.numberOfRuns != 1 || timings.numberOfConfigurations != 1 || !(timings.GetTotalSeconds() > 0.0))
+      {
+        std::cout << "Unexpected VkFFT timings: " << timings.numberOfRuns << " runs, "
+                  << timings.numberOfConfigurations << " configurations, " << timings.GetTotalSeconds() << " seconds."
+                  << std::endl;
+        thisTestPassed = false;
+      }
+      if (profiling)
+      {
+        // Device-side timings of one run, with kernel times on every backend but Level Zero
+        const typename itk::VkCommon::VkTimings lastRunTimings{ forwardFilter->GetLastRunVkTimings() };
+        const bool kernelTimed{ VKFFT_BACKEND != LEVEL_ZERO };
+        if (lastRunTimings.numberOfRuns != 1 || lastRunTimings.numberOfProfiledRuns != 1 ||
+            !(lastRunTimings.transformFlops > 0.0) || lastRunTimings.hostToDeviceBytes != mySize * sizeof(RealType) ||
+            lastRunTimings.deviceToHostBytes != mySize * sizeof(ComplexType) ||
+            (kernelTimed ? !(lastRunTimings.deviceKernelSeconds > 0.0) : lastRunTimings.deviceKernelSeconds != 0.0))
+        {
+          std::cout << "Unexpected VkFFT device timings: " << lastRunTimings.numberOfProfiledRuns
+                    << " profiled runs, " << lastRunTimings.transformFlops << " flops, "
+                    << lastRunTimings.deviceKernelSeconds << " kernel seconds." << std::endl;
+          thisTestPassed = false;
+        }
+        std::cout << "Kernel GFLOP/s: " << lastRunTimings.GetKernelGFLOPS()
+                  << ", host-to-device GB/s: " << lastRunTimings.GetHostToDeviceGBPerSecond()
+                  << ", device-to-host GB/s: " << lastRunTimings.GetDeviceToHostGBPerSecond() << std::endl;
+      }
+      else if (timings.numberOfProfiledRuns != 0)
+      {
+        std::cout << "VkFFT device timings were recorded without profiling." << std::endl;
+        thisTestPassed = false;
+      }
+      forwardFilter->ResetVkTimings();
+      if (forwardFilter->GetVkTimings().numberOfRuns != 0 || forwardFilter->GetVkTimings().GetTotalSeconds() != 0.0)
+      {
+        std::cout << "VkFFT timings were not reset." << std::endl;
+        thisTestPassed = false;
+      }
       typename ComplexImageType::Pointer        output{ forwardFilter->GetOutput() };
       const typename ComplexImageType::SizeType outputSize{ output->GetLargestPossibleRegion().GetSize() };
       if (outputSize[0] != mySize)
@@ -187,13 +230,14 @@ itkVkForwardInverseFFTImageFilterTest(int argc, char * argv[])
 {
   const std::string  precision{ (argc > 1) ? argv[1] : "float" };
   const unsigned int maxSize{ (argc > 2) ? static_cast<unsigned int>(std::stoul(argv[2])) : 20 };
+  const bool         profiling{ (argc > 3) && std::string{ argv[3] } == "profiling" };
   if (precision == "double")
   {
-    return runVkForwardInverseFFTImageFilterTest<double>(maxSize);
+    return runVkForwardInverseFFTImageFilterTest<double>(maxSize, profiling);
   }
   if (precision == "float")
   {
-    return runVkForwardInverseFFTImageFilterTest<float>(maxSize);
+    return runVkForwardInverseFFTImageFilterTest<float>(maxSize, profiling);
   }
   std::cerr << "Unknown precision '" << precision << "'. Expected 'float' or 'double'." << std::endl;
   return EXIT_FAILURE;
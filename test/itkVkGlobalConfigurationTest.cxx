@@ -64,6 +64,119 @@ itkVkGlobalConfigurationTestProcedure()
   return EXIT_SUCCESS;
 }
 
+// Verify device choice and queue-depth tracking of the scheduling policies.
+// Device counts and memory are set explicitly, so no device is used.
+int
+itkVkGlobalConfigurationSchedulingTestProcedure()
+{
+  using PolicyEnum = itk::VkGlobalConfiguration::SchedulingPolicyEnum;
+
+  ITK_TEST_SET_GET_VALUE(itk::VkGlobalConfiguration::GetSchedulingPolicy(), PolicyEnum::FIXED);
+  itk::VkGlobalConfiguration::SetNumberOfDevices(4);
+  ITK_TEST_SET_GET_VALUE(itk::VkGlobalConfiguration::GetNumberOfDevices(), 4);
+
+  // FIXED keeps every run on the global device
+  itk::VkGlobalConfiguration::SetDeviceID(2);
+  {
+    const itk::VkDeviceReservation first{ true, 0, 100 };
+    const itk::VkDeviceReservation second{ true, 0, 100 };
+    ITK_TEST_EXPECT_EQUAL(first.GetDeviceID(), 2);
+    ITK_TEST_EXPECT_EQUAL(second.GetDeviceID(), 2);
+    ITK_TEST_EXPECT_EQUAL(itk::VkGlobalConfiguration::GetNumberOfOutstandingRuns(2), 2);
+    ITK_TEST_EXPECT_EQUAL(itk::VkGlobalConfiguration::GetNumberOfOutstandingBytes(2), 200);
+  }
+  ITK_TEST_EXPECT_EQUAL(itk::VkGlobalConfiguration::GetNumberOfOutstandingRuns(2), 0);
+  ITK_TEST_EXPECT_EQUAL(itk::VkGlobalConfiguration::GetNumberOfOutstandingBytes(2), 0);
+  itk::VkGlobalConfiguration::SetDeviceID(0);
+
+  // ROUND_ROBIN cycles over the devices
+  itk::VkGlobalConfiguration::SetSchedulingPolicy(PolicyEnum::ROUND_ROBIN);
+  ITK_TEST_SET_GET_VALUE(itk::VkGlobalConfiguration::GetSchedulingPolicy(), PolicyEnum::ROUND_ROBIN);
+  for (uint64_t run{ 0 }; run < 8; ++run)
+  {
+    const itk::VkDeviceReservation reservation{ true, 0, 1 };
+    ITK_TEST_EXPECT_EQUAL(reservation.GetDeviceID(), run % 4);
+  }
+
+  // A run that reuses a plan stays on the device of the plan
+  for (uint64_t run{ 0 }; run < 4; ++run)
+  {
+    const uint64_t id{ itk::VkGlobalConfiguration::AcquireDevice(1, 3) };
+    ITK_TEST_EXPECT_EQUAL(id, 3);
+    itk::VkGlobalConfiguration::ReleaseDevice(id, 1);
+  }
+  ITK_TEST_EXPECT_EQUAL(itk::VkGlobalConfiguration::AcquireDevice(1, 7), 0);
+  itk::VkGlobalConfiguration::ReleaseDevice(0, 1);
+  {
+    // Without a plan, the policy places the run
+    const itk::VkCommon            vkCommon;
+    const itk::VkDeviceReservation reservation{ true, 0, 1, vkCommon, itk::VkCommon::VkParameters{} };
+    ITK_TEST_EXPECT_EQUAL(reservation.GetDeviceID(), 1);
+  }
+
+  // A pinned device takes precedence over the policy and the plan device
+  {
+    uint64_t pinnedID{ 0 };
+    ITK_TEST_EXPECT_TRUE(!itk::VkDevicePin::GetPinnedDevice(pinnedID));
+    const itk::VkDevicePin outerPin{ 2 };
+    {
+      const itk::VkDevicePin         innerPin{ 3 };
+      const itk::VkDeviceReservation reservation{ true, 0, 1 };
+      ITK_TEST_EXPECT_EQUAL(reservation.GetDeviceID(), 3);
+      ITK_TEST_EXPECT_EQUAL(itk::VkGlobalConfiguration::AcquireDevice(1, 1), 3);
+      itk::VkGlobalConfiguration::ReleaseDevice(3, 1);
+    }
+    ITK_TEST_EXPECT_TRUE(itk::VkDevicePin::GetPinnedDevice(pinnedID));
+    ITK_TEST_EXPECT_EQUAL(pinnedID, 2);
+    const itk::VkDeviceReservation reservation{ true, 0, 1 };
+    ITK_TEST_EXPECT_EQUAL(reservation.GetDeviceID(), 2);
+  }
+
+  // LEAST_OUTSTANDING_WORK fills idle devices first
+  itk::VkGlobalConfiguration::SetSchedulingPolicy(PolicyEnum::LEAST_OUTSTANDING_WORK);
+  {
+    const itk::VkDeviceReservation local{ false, 0, 10 };
+    ITK_TEST_EXPECT_EQUAL(local.GetDeviceID(), 0);
+    const itk::VkDeviceReservation a{ true, 0, 10 };
+    const itk::VkDeviceReservation b{ true, 0, 10 };
+    const itk::VkDeviceReservation c{ true, 0, 10 };
+    ITK_TEST_EXPECT_EQUAL(a.GetDeviceID(), 1);
+    ITK_TEST_EXPECT_EQUAL(b.GetDeviceID(), 2);
+    ITK_TEST_EXPECT_EQUAL(c.GetDeviceID(), 3);
+    for (uint64_t id{ 0 }; id < 4; ++id)
+    {
+      ITK_TEST_EXPECT_EQUAL(itk::VkGlobalConfiguration::GetNumberOfOutstandingRuns(id), 1);
+    }
+  }
+
+  // MEMORY_AWARE prefers the device with the most memory left
+  itk::VkGlobalConfiguration::SetSchedulingPolicy(PolicyEnum::MEMORY_AWARE);
+  itk::VkGlobalConfiguration::SetDeviceMemoryBytes(0, 1000);
+  itk::VkGlobalConfiguration::SetDeviceMemoryBytes(1, 4000);
+  itk::VkGlobalConfiguration::SetDeviceMemoryBytes(2, 2000);
+  itk::VkGlobalConfiguration::SetDeviceMemoryBytes(3, 3000);
+  {
+    const itk::VkDeviceReservation a{ true, 0, 2500 };
+    ITK_TEST_EXPECT_EQUAL(a.GetDeviceID(), 1);
+    const itk::VkDeviceReservation b{ true, 0, 500 };
+    ITK_TEST_EXPECT_EQUAL(b.GetDeviceID(), 3);
+    const itk::VkDeviceReservation c{ true, 0, 500 };
+    ITK_TEST_EXPECT_EQUAL(c.GetDeviceID(), 3);
+    const itk::VkDeviceReservation d{ true, 0, 500 };
+    ITK_TEST_EXPECT_EQUAL(d.GetDeviceID(), 2);
+  }
+  for (uint64_t id{ 0 }; id < 4; ++id)
+  {
+    ITK_TEST_EXPECT_EQUAL(itk::VkGlobalConfiguration::GetNumberOfOutstandingRuns(id), 0);
+    ITK_TEST_EXPECT_EQUAL(itk::VkGlobalConfiguration::GetNumberOfOutstandingBytes(id), 0);
+  }
+
+  itk::VkGlobalConfiguration::SetSchedulingPolicy(PolicyEnum::FIXED);
+  itk::VkGlobalConfiguration::SetNumberOfDevices(0);
+
+  return EXIT_SUCCESS;
+}
+
 template <typename PrecisionType>
 int
 runVkGlobalConfigurationTest()
@@ -82,7 +195,7 @@ runVkGlobalConfigurationTest()
   itkVkGlobalConfigurationTestProcedure<
     itk::VkRealToHalfHermitianForwardFFTImageFilter<RealImageType, ComplexImageType>>();
 
-  return EXIT_SUCCESS;
+  return itkVkGlobalConfigurationSchedulingTestProcedure();
 }
 
 int
@@ -0,0 +1,145 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         https://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkVkMaskedFFTNormalizedCorrelationImageFilter.h"
+#include "itkVkTestingHelpers.h"
+
+#include "itkImageRegionConstIterator.h"
+#include "itkImageRegionIterator.h"
+#include "itkMaskedFFTNormalizedCorrelationImageFilter.h"
+#include "itkTestingMacros.h"
+
+#include <string>
+
+// Verify that the masked normalized cross correlation matches
+// MaskedFFTNormalizedCorrelationImageFilter, with and without masks,
+// and that each update makes one forward and one inverse run.
+
+namespace
+{
+// Mask of ones with a band of zeros along the first dimension
+template <typename TMask>
+typename TMask::Pointer
+MakeMask(const typename TMask::SizeType & size)
+{
+  auto mask = TMask::New();
+  mask->SetRegions(size);
+  mask->Allocate();
+  for (itk::ImageRegionIterator<TMask> it(mask, mask->GetBufferedRegion()); !it.IsAtEnd(); ++it)
+  {
+    it.Set(it.GetIndex()[0] % 4 == 1 ? 0 : 1);
+  }
+  return mask;
+}
+
+template <typename TImage>
+bool
+ImagesAreClose(const TImage * image, const TImage * reference, double tolerance)
+{
+  if (image->GetBufferedRegion().GetSize() != reference->GetBufferedRegion().GetSize())
+  {
+    std::cerr << "Size " << image->GetBufferedRegion().GetSize() << " but expected "
+              << reference->GetBufferedRegion().GetSize() << std::endl;
+    return false;
+  }
+  itk::ImageRegionConstIterator<TImage> it(image, image->GetBufferedRegion());
+  itk::ImageRegionConstIterator<TImage> rit(reference, reference->GetBufferedRegion());
+  for (; !it.IsAtEnd(); ++it, ++rit)
+  {
+    if (std::abs(it.Get() - rit.Get()) > tolerance)
+    {
+      std::cerr << "Pixel " << it.GetIndex() << " is " << it.Get() << " but expected " << rit.Get() << std::endl;
+      return false;
+    }
+  }
+  return true;
+}
+} // namespace
+
+template <typename PrecisionType>
+int
+runVkMaskedFFTNormalizedCorrelationImageFilterTest()
+{
+  constexpr unsigned int Dimension{ 2 };
+  using ImageType = itk::Image<PrecisionType, Dimension>;
+  using MaskType = itk::Image<unsigned char, Dimension>;
+  using FilterType = itk::VkMaskedFFTNormalizedCorrelationImageFilter<ImageType, ImageType, MaskType>;
+  using ReferenceType = itk::MaskedFFTNormalizedCorrelationImageFilter<ImageType, ImageType, MaskType>;
+  const double tolerance{ std::is_same<PrecisionType, float>::value ? 2.0e-3 : 1.0e-6 };
+
+  auto filter = FilterType::New();
+  ITK_EXERCISE_BASIC_OBJECT_METHODS(filter, VkMaskedFFTNormalizedCorrelationImageFilter, ImageToImageFilter);
+  ITK_TEST_SET_GET_VALUE(0u, filter->GetRequiredNumberOfOverlappingPixels());
+  filter->SetRequiredNumberOfOverlappingPixels(10);
+  ITK_TEST_SET_GET_VALUE(10u, filter->GetRequiredNumberOfOverlappingPixels());
+
+  // A positive fixed image exercises the cancellation in the variances
+  const typename ImageType::Pointer fixedImage{ MakeRandomImage<ImageType>({ { 31, 24 } }, 2025, 0.0, 1.0) };
+  const typename ImageType::Pointer movingImage{ MakeRandomImage<ImageType>({ { 9, 12 } }, 2026, -1.0, 1.0) };
+  filter->SetFixedImage(fixedImage);
+  filter->SetMovingImage(movingImage);
+
+  auto reference = ReferenceType::New();
+  reference->SetFixedImage(fixedImage);
+  reference->SetMovingImage(movingImage);
+  reference->SetRequiredNumberOfOverlappingPixels(10);
+
+  // Without masks, as a plain normalized cross correlation
+  ITK_TRY_EXPECT_NO_EXCEPTION(filter->Update());
+  ITK_TRY_EXPECT_NO_EXCEPTION(reference->Update());
+  ITK_TEST_EXPECT_EQUAL(filter->GetOutput()->GetLargestPossibleRegion().GetSize(),
+                        (itk::Size<Dimension>{ { 39, 35 } }));
+  ITK_TEST_EXPECT_EQUAL(filter->GetMaximumNumberOfOverlappingPixels(),
+                        movingImage->GetBufferedRegion().GetNumberOfPixels());
+  ITK_TEST_EXPECT_EQUAL(filter->GetVkTimings().numberOfRuns, 1u);
+  ITK_TEST_EXPECT_TRUE(ImagesAreClose<ImageType>(filter->GetOutput(), reference->GetOutput(), tolerance));
+
+  // With masks and a required fraction of the largest overlap
+  const typename MaskType::Pointer fixedMask{ MakeMask<MaskType>(fixedImage->GetBufferedRegion().GetSize()) };
+  const typename MaskType::Pointer movingMask{ MakeMask<MaskType>(movingImage->GetBufferedRegion().GetSize()) };
+  filter->SetFixedImageMask(fixedMask);
+  filter->SetMovingImageMask(movingMask);
+  filter->SetRequiredFractionOfOverlappingPixels(0.25);
+  reference->SetFixedImageMask(fixedMask);
+  reference->SetMovingImageMask(movingMask);
+  reference->SetRequiredFractionOfOverlappingPixels(0.25);
+  ITK_TRY_EXPECT_NO_EXCEPTION(filter->Update());
+  ITK_TRY_EXPECT_NO_EXCEPTION(reference->Update());
+  ITK_TEST_EXPECT_EQUAL(filter->GetMaximumNumberOfOverlappingPixels(),
+                        reference->GetMaximumNumberOfOverlappingPixels());
+  ITK_TEST_EXPECT_EQUAL(filter->GetVkTimings().numberOfRuns, 2u);
+  ITK_TEST_EXPECT_TRUE(ImagesAreClose<ImageType>(filter->GetOutput(), reference->GetOutput(), tolerance));
+
+  return EXIT_SUCCESS;
+}
+
+int
+itkVkMaskedFFTNormalizedCorrelationImageFilterTest(int argc, char * argv[])
+{
+  const std::string precision{ (argc > 1) ? argv[1] : "float" };
+  if (precision == "double")
+  {
+    return runVkMaskedFFTNormalizedCorrelationImageFilterTest<double>();
+  }
+  if (precision == "float")
+  {
+    return runVkMaskedFFTNormalizedCorrelationImageFilterTest<float>();
+  }
+  std::cerr << "Unknown precision '" << precision << "'. Expected 'float' or 'double'." << std::endl;
+  return EXIT_FAILURE;
+}
@@ -16,14 +16,21 @@
  *
  *=========================================================================*/
 
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 #include <iomanip>
 #include <string>
 
 #include "itkVkMultiResolutionPyramidImageFilter.h"
+#include "itkDiscreteGaussianImageFilter.h"
+#include "itkIdentityTransform.h"
 #include "itkImageFileReader.h"
 #include "itkImageFileWriter.h"
+#include "itkLinearInterpolateImageFunction.h"
 #include "itkMath.h"
+#include "itkResampleImageFilter.h"
+#include "itkShrinkImageFilter.h"
 #include "itkTestingMacros.h"
 
 namespace
@@ -56,6 +63,11 @@ runVkMultiResolutionPyramidImageFilterTest(int argc, char * argv[])
   using PyramidType = itk::VkMultiResolutionPyramidImageFilter<ImageType, ImageType>;
   using ScheduleType = typename PyramidType::ScheduleType;
   using KernelSizeType = typename PyramidType::KernelSizeType;
+  using SmootherType = itk::DiscreteGaussianImageFilter<ImageType, ImageType>;
+  using ShrinkerType = itk::ShrinkImageFilter<ImageType, ImageType>;
+  using ResamplerType = itk::ResampleImageFilter<ImageType, ImageType>;
+  using InterpolatorType = itk::LinearInterpolateImageFunction<ImageType, double>;
+  using TransformType = itk::IdentityTransform<double, ImageDimension>;
 
   KernelSizeType kernelRadiusThreshold;
   if (argc == 4)
@@ -76,6 +88,10 @@ runVkMultiResolutionPyramidImageFilterTest(int argc, char * argv[])
   bool         useShrinkFilter = (argc > 6 && std::atoi(argv[6]) == 1);
   unsigned int numLevels = (argc > 7 ? std::atoi(argv[7]) : 3);
   int          expectedFFTCount = (argc > 8 ? std::atoi(argv[8]) : -1); // only test if specified
+  bool         useSharedSpectrum = (argc > 9 && std::atoi(argv[9]) == 1);
+  bool         useSpectralDownsampling = (argc > 10 && std::atoi(argv[10]) == 1);
+  bool         useConcurrentLevels = (argc > 11 && std::atoi(argv[11]) == 1);
+  bool         useCascadedLevels = (argc > 12 && std::atoi(argv[12]) == 1);
 
   // Set up multi-resolution pyramid
   auto pyramidFilter = PyramidType::New();
@@ -147,6 +163,16 @@ runVkMultiResolutionPyramidImageFilterTest(int argc, char * argv[])
   ITK_EXERCISE_BASIC_OBJECT_METHODS(
     pyramidFilter, VkMultiResolutionPyramidImageFilter, MultiResolutionPyramidImageFilter);
 
+  ITK_TEST_SET_GET_BOOLEAN(pyramidFilter, UseSharedSpectrum, useSharedSpectrum);
+  ITK_TEST_SET_GET_BOOLEAN(pyramidFilter, UseSpectralDownsampling, useSpectralDownsampling);
+  ITK_TEST_SET_GET_BOOLEAN(pyramidFilter, UseConcurrentLevels, useConcurrentLevels);
+  ITK_TEST_SET_GET_BOOLEAN(pyramidFilter, UseCascadedLevels, useCascadedLevels);
+  if (useCascadedLevels)
+  {
+    // The default schedule halves the resolution from each level to the next
+    ITK_TEST_EXPECT_TRUE(pyramidFilter->IsScheduleCascadable());
+  }
+
   // Run the filter and track progress
   ShowProgressObject                                    progressWatch(pyramidFilter);
   itk::SimpleMemberCommand<ShowProgressObject>::Pointer command;
@@ -160,6 +186,78 @@ runVkMultiResolutionPyramidImageFilterTest(int argc, char * argv[])
     itk::WriteImage(pyramidFilter->GetOutput(ilevel), argv[2] + std::to_string(ilevel) + ".mha");
   }
 
+  if (useSharedSpectrum || useConcurrentLevels || useCascadedLevels)
+  {
+    // Verify levels smoothed (and shrunk) from the shared spectrum or
+    // generated concurrently match levels generated one at a time.
+    // Cascaded levels are smoothed from already sampled levels, so each
+    // of them is compared with the next finer output smoothed by the
+    // incremental variance and shrunk by the ratio of shrink factors.
+    auto referenceFilter = PyramidType::New();
+    referenceFilter->SetInput(inputImage);
+    referenceFilter->SetUseShrinkImageFilter(useShrinkFilter);
+    referenceFilter->SetMetricThreshold(pyramidFilter->GetMetricThreshold());
+    referenceFilter->SetNumberOfLevels(numLevels);
+    referenceFilter->UseSharedSpectrumOff();
+    referenceFilter->UseConcurrentLevelsOff();
+    referenceFilter->UseCascadedLevelsOff();
+    referenceFilter->Update();
+
+    for (unsigned int ilevel = 0; ilevel < numLevels; ++ilevel)
+    {
+      const auto *                     output = pyramidFilter->GetOutput(ilevel);
+      typename ImageType::ConstPointer reference = referenceFilter->GetOutput(ilevel);
+      if (useCascadedLevels && ilevel + 1 < numLevels)
+      {
+        const auto &                     schedule = pyramidFilter->GetSchedule();
+        const auto                       variance = pyramidFilter->GetVariance(ilevel);
+        const auto                       finerVariance = pyramidFilter->GetVariance(ilevel + 1);
+        typename SmootherType::ArrayType incrementalVariance;
+        unsigned int                     factors[ImageDimension];
+        for (unsigned int dim = 0; dim < ImageDimension; ++dim)
+        {
+          incrementalVariance[dim] =
+            (variance[dim] - finerVariance[dim]) / itk::Math::sqr(static_cast<double>(schedule[ilevel + 1][dim]));
+          factors[dim] = schedule[ilevel][dim] / schedule[ilevel + 1][dim];
+        }
+        auto smoother = SmootherType::New();
+        smoother->SetInput(pyramidFilter->GetOutput(ilevel + 1));
+        smoother->SetUseImageSpacing(false);
+        smoother->SetMaximumError(pyramidFilter->GetMaximumError());
+        smoother->SetVariance(incrementalVariance);
+        typename itk::ImageToImageFilter<ImageType, ImageType>::Pointer shrinker;
+        if (useShrinkFilter)
+        {
+          auto shrinkFilter = ShrinkerType::New();
+          shrinkFilter->SetShrinkFactors(factors);
+          shrinker = shrinkFilter.GetPointer();
+        }
+        else
+        {
+          auto resampleFilter = ResamplerType::New();
+          resampleFilter->SetInterpolator(InterpolatorType::New());
+          resampleFilter->SetDefaultPixelValue(0);
+          resampleFilter->SetOutputParametersFromImage(reference);
+          resampleFilter->SetTransform(TransformType::New());
+          shrinker = resampleFilter.GetPointer();
+        }
+        shrinker->SetInput(smoother->GetOutput());
+        shrinker->UpdateLargestPossibleRegion();
+        reference = shrinker->GetOutput();
+      }
+      ITK_TEST_EXPECT_EQUAL(output->GetBufferedRegion(), reference->GetBufferedRegion());
+      const auto numberOfPixels = output->GetBufferedRegion().GetNumberOfPixels();
+      double     maximumDifference = 0.0;
+      for (itk::SizeValueType pixel = 0; pixel < numberOfPixels; ++pixel)
+      {
+        const double difference = std::abs(output->GetBufferPointer()[pixel] - reference->GetBufferPointer()[pixel]);
+        maximumDifference = std::max(maximumDifference, difference);
+      }
+      std::cout << "Level " << ilevel << " differs from reference by at most " << maximumDifference << std::endl;
+      ITK_TEST_EXPECT_TRUE(maximumDifference < 5.0e-2);
+    }
+  }
+
   return EXIT_SUCCESS;
 }
 
@@ -171,7 +269,8 @@ itkVkMultiResolutionPyramidImageFilterTest(int argc, char * argv[])
     std::cerr << "Missing Parameters." << std::endl;
     std::cerr << "Usage: " << itkNameOfTestExecutableMacro(argv);
     std::cerr << " <float|double> inputImage outputImage <threshold0> [threshold1] [kernelThresholdDimension] "
-                 "[useShrinkFilter] [numLevels] [expectedFFTLevelCount]"
+                 "[useShrinkFilter] [numLevels] [expectedFFTLevelCount] [useSharedSpectrum] [useSpectralDownsampling] "
+                 "[useConcurrentLevels] [useCascadedLevels]"
               << std::endl;
     std::cerr << std::flush;
     return EXIT_FAILURE;
@@ -0,0 +1,219 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         https://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkVkMultiTemplateMatchingImageFilter.h"
+#include "itkVkTestingHelpers.h"
+
+#include "itkImageRegionConstIteratorWithIndex.h"
+#include "itkImageRegionIterator.h"
+#include "itkTestingMacros.h"
+
+#include <cmath>
+#include <string>
+#include <vector>
+
+// Verify that the best match of each template agrees with an exhaustive
+// search of the zero-normalized cross correlation, that templates cut from
+// the image are found where they were cut, that the templates are
+// transformed once, in one batch, for a sequence of images, and that chunks
+// of at most MaximumBatchSize templates find the same matches, also in an
+// image large enough that its correlation maps dwarf their maxima.
+
+namespace
+{
+// Copy of the region of `image` at `index` of `size`, scaled and offset
+template <typename TImage>
+typename TImage::Pointer
+CutTemplate(const TImage * image, const typename TImage::IndexType & index, const typename TImage::SizeType & size)
+{
+  auto templateImage = TImage::New();
+  templateImage->SetRegions(size);
+  templateImage->Allocate();
+  for (itk::ImageRegionIterator<TImage> it(templateImage, templateImage->GetBufferedRegion()); !it.IsAtEnd(); ++it)
+  {
+    it.Set(2 * image->GetPixel(index + (it.GetIndex() - templateImage->GetBufferedRegion().GetIndex())) + 5);
+  }
+  return templateImage;
+}
+
+// Highest zero-normalized cross correlation of `templateImage` over its placements in `image`
+template <typename TImage>
+double
+ExhaustiveBestScore(const TImage * image, const TImage * templateImage)
+{
+  const typename TImage::RegionType templateRegion{ templateImage->GetBufferedRegion() };
+  const auto                         pixels{ static_cast<double>(templateRegion.GetNumberOfPixels()) };
+  typename TImage::RegionType        placements{ image->GetBufferedRegion() };
+  for (unsigned int dim{ 0 }; dim < TImage::ImageDimension; ++dim)
+  {
+    placements.SetSize(dim, placements.GetSize(dim) - templateRegion.GetSize(dim) + 1);
+  }
+
+  double best{ -1.0 };
+  for (itk::ImageRegionConstIteratorWithIndex<TImage> pit(image, placements); !pit.IsAtEnd(); ++pit)
+  {
+    double imageSum{ 0.0 };
+    double imageSumOfSquares{ 0.0 };
+    double templateSum{ 0.0 };
+    double templateSumOfSquares{ 0.0 };
+    double crossSum{ 0.0 };
+    for (itk::ImageRegionConstIteratorWithIndex<TImage> tit(templateImage, templateRegion); !tit.IsAtEnd(); ++tit)
+    {
+      const typename TImage::IndexType index{ pit.GetIndex() + (tit.GetIndex() - templateRegion.GetIndex()) };
+      const double                      i{ static_cast<double>(image->GetPixel(index)) };
+      const double t{ static_cast<double>(tit.Get()) };
+      imageSum += i;
+      imageSumOfSquares += i * i;
+      templateSum += t;
+      templateSumOfSquares += t * t;
+      crossSum += i * t;
+    }
+    const double numerator{ crossSum - imageSum * templateSum / pixels };
+    const double denominator{ std::sqrt((imageSumOfSquares - imageSum * imageSum / pixels) *
+                                        (templateSumOfSquares - templateSum * templateSum / pixels)) };
+    if (denominator > 0.0)
+    {
+      best = std::max(best, numerator / denominator);
+    }
+  }
+  return best;
+}
+} // namespace
+
+template <typename PrecisionType>
+int
+runVkMultiTemplateMatchingImageFilterTest()
+{
+  constexpr unsigned int Dimension{ 2 };
+  using ImageType = itk::Image<PrecisionType, Dimension>;
+  using FilterType = itk::VkMultiTemplateMatchingImageFilter<ImageType>;
+  using IndexType = typename ImageType::IndexType;
+  using SizeType = typename ImageType::SizeType;
+  const double tolerance{ std::is_same<PrecisionType, float>::value ? 1.0e-3 : 1.0e-6 };
+
+  auto filter = FilterType::New();
+  ITK_EXERCISE_BASIC_OBJECT_METHODS(filter, VkMultiTemplateMatchingImageFilter, ProcessObject);
+
+  // Templates cut from the image at known places, and one that is not
+  const typename ImageType::Pointer image{ MakeRandomImage<ImageType>({ { 48, 40 } }, 2025, 0.0, 1.0) };
+  const std::vector<IndexType>      cutIndices{ { { 5, 7 } }, { { 30, 21 } }, { { 0, 0 } }, { { 17, 3 } } };
+  const std::vector<SizeType>       cutSizes{ { { 9, 9 } }, { { 12, 7 } }, { { 1, 5 } }, { { 9, 9 } } };
+  std::vector<typename ImageType::Pointer> templates;
+  for (unsigned int n{ 0 }; n < cutIndices.size(); ++n)
+  {
+    templates.push_back(CutTemplate<ImageType>(image, cutIndices[n], cutSizes[n]));
+  }
+  templates.push_back(MakeRandomImage<ImageType>({ { 6, 6 } }, 2026, 0.0, 1.0));
+  for (unsigned int n{ 0 }; n < templates.size(); ++n)
+  {
+    filter->SetTemplateImage(n, templates[n]);
+  }
+  ITK_TEST_EXPECT_EQUAL(filter->GetNumberOfTemplateImages(), templates.size());
+  ITK_TEST_EXPECT_TRUE(filter->GetTemplateImage(1) == templates[1].GetPointer());
+
+  // All templates fit in one chunk, which is matched in one run
+  ITK_TEST_SET_GET_VALUE(16u, filter->GetMaximumBatchSize());
+  filter->SetInput(image);
+  ITK_TRY_EXPECT_NO_EXCEPTION(filter->Update());
+  ITK_TEST_EXPECT_EQUAL(filter->GetNumberOfTemplateTransforms(), templates.size());
+  ITK_TEST_EXPECT_EQUAL(filter->GetVkTimings().numberOfRuns, 1u);
+  ITK_TEST_EXPECT_EQUAL(filter->GetMatches().size(), templates.size());
+  for (unsigned int n{ 0 }; n < cutIndices.size(); ++n)
+  {
+    ITK_TEST_EXPECT_EQUAL(filter->GetMatches()[n].index, cutIndices[n]);
+    ITK_TEST_EXPECT_TRUE(std::abs(filter->GetMatches()[n].score - 1.0) < tolerance);
+  }
+  for (unsigned int n{ 0 }; n < templates.size(); ++n)
+  {
+    ITK_TEST_EXPECT_TRUE(std::abs(filter->GetMatches()[n].score -
+                                  ExhaustiveBestScore<ImageType>(image, templates[n])) < tolerance);
+  }
+
+  // Another image of the same size reuses the template spectra
+  const typename ImageType::Pointer nextImage{ MakeRandomImage<ImageType>({ { 48, 40 } }, 2027, 0.0, 1.0) };
+  filter->SetInput(nextImage);
+  ITK_TRY_EXPECT_NO_EXCEPTION(filter->Update());
+  ITK_TEST_EXPECT_EQUAL(filter->GetNumberOfTemplateTransforms(), templates.size());
+  ITK_TEST_EXPECT_EQUAL(filter->GetVkTimings().numberOfRuns, 2u);
+  for (unsigned int n{ 0 }; n < templates.size(); ++n)
+  {
+    ITK_TEST_EXPECT_TRUE(std::abs(filter->GetMatches()[n].score -
+                                  ExhaustiveBestScore<ImageType>(nextImage, templates[n])) < tolerance);
+  }
+
+  // Removing a template removes its entry
+  filter->SetNumberOfTemplateImages(2);
+  ITK_TRY_EXPECT_NO_EXCEPTION(filter->Update());
+  ITK_TEST_EXPECT_EQUAL(filter->GetMatches().size(), 2u);
+  ITK_TEST_EXPECT_EQUAL(filter->GetNumberOfTemplateTransforms(), templates.size() + 2);
+
+  // Chunks of two templates, the last one padded, take a run each and find the same matches
+  for (unsigned int n{ 0 }; n < templates.size(); ++n)
+  {
+    filter->SetTemplateImage(n, templates[n]);
+  }
+  filter->SetMaximumBatchSize(2);
+  ITK_TEST_SET_GET_VALUE(2u, filter->GetMaximumBatchSize());
+  const auto runs{ filter->GetVkTimings().numberOfRuns };
+  ITK_TRY_EXPECT_NO_EXCEPTION(filter->Update());
+  ITK_TEST_EXPECT_EQUAL(filter->GetVkTimings().numberOfRuns, runs + 3);
+  ITK_TEST_EXPECT_EQUAL(filter->GetMatches().size(), templates.size());
+  for (unsigned int n{ 0 }; n < templates.size(); ++n)
+  {
+    ITK_TEST_EXPECT_TRUE(std::abs(filter->GetMatches()[n].score -
+                                  ExhaustiveBestScore<ImageType>(nextImage, templates[n])) < tolerance);
+  }
+
+  // A large image with a full chunk of templates: the correlation maps that VkFFT writes on the device are
+  // megabytes, while only their maxima are copied back
+  const typename ImageType::Pointer largeImage{ MakeRandomImage<ImageType>({ { 512, 384 } }, 2028, 0.0, 1.0) };
+  std::vector<IndexType>            largeIndices;
+  auto                              largeFilter = FilterType::New();
+  for (unsigned int n{ 0 }; n < 16; ++n)
+  {
+    const auto offset{ static_cast<itk::IndexValueType>(n) };
+    largeIndices.push_back({ { 31 * offset + 3, 23 * offset } });
+    largeFilter->SetTemplateImage(n, CutTemplate<ImageType>(largeImage, largeIndices.back(), { { 11, 8 } }));
+  }
+  largeFilter->SetInput(largeImage);
+  ITK_TRY_EXPECT_NO_EXCEPTION(largeFilter->Update());
+  ITK_TEST_EXPECT_EQUAL(largeFilter->GetVkTimings().numberOfRuns, 1u);
+  for (unsigned int n{ 0 }; n < largeIndices.size(); ++n)
+  {
+    ITK_TEST_EXPECT_EQUAL(largeFilter->GetMatches()[n].index, largeIndices[n]);
+    ITK_TEST_EXPECT_TRUE(std::abs(largeFilter->GetMatches()[n].score - 1.0) < tolerance);
+  }
+
+  return EXIT_SUCCESS;
+}
+
+int
+itkVkMultiTemplateMatchingImageFilterTest(int argc, char * argv[])
+{
+  const std::string precision{ (argc > 1) ? argv[1] : "float" };
+  if (precision == "double")
+  {
+    return runVkMultiTemplateMatchingImageFilterTest<double>();
+  }
+  if (precision == "float")
+  {
+    return runVkMultiTemplateMatchingImageFilterTest<float>();
+  }
+  std::cerr << "Unknown precision '" << precision << "'. Expected 'float' or 'double'." << std::endl;
+  return EXIT_FAILURE;
+}
@@ -0,0 +1,160 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         https://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkVkPhaseCorrelationImageRegistrationMethod.h"
+#include "itkVkTestingHelpers.h"
+
+#include "itkImageRegionIterator.h"
+#include "itkTestingMacros.h"
+
+#include <cmath>
+#include <string>
+
+// Verify that phase correlation recovers circular and cropped translations
+// in index and physical units, that each estimate makes one run, and that
+// images whose spectra vanish exactly are correlated on the host instead.
+
+namespace
+{
+// Copy of `image` from `start` on, wrapping around, with an origin at the physical point of `start`
+template <typename TImage>
+typename TImage::Pointer
+ShiftImage(const TImage * image, const typename TImage::IndexType & start, const typename TImage::SizeType & size)
+{
+  const typename TImage::SizeType & imageSize{ image->GetBufferedRegion().GetSize() };
+  auto                              shifted = TImage::New();
+  shifted->SetRegions(size);
+  shifted->SetSpacing(image->GetSpacing());
+  typename TImage::PointType origin;
+  image->TransformIndexToPhysicalPoint(start, origin);
+  shifted->SetOrigin(origin);
+  shifted->Allocate();
+  for (itk::ImageRegionIterator<TImage> it(shifted, shifted->GetBufferedRegion()); !it.IsAtEnd(); ++it)
+  {
+    typename TImage::IndexType index;
+    for (unsigned int dim{ 0 }; dim < TImage::ImageDimension; ++dim)
+    {
+      const auto length{ static_cast<itk::IndexValueType>(imageSize[dim]) };
+      index[dim] = ((start[dim] + it.GetIndex()[dim]) % length + length) % length;
+    }
+    it.Set(image->GetPixel(index));
+  }
+  return shifted;
+}
+
+itk::Vector<double, 2>
+MakeTranslation(double x, double y)
+{
+  itk::Vector<double, 2> vector;
+  vector[0] = x;
+  vector[1] = y;
+  return vector;
+}
+
+template <typename TVector>
+bool
+VectorsAreClose(const TVector & vector, const TVector & expected, double tolerance)
+{
+  if ((vector - expected).GetNorm() > tolerance)
+  {
+    std::cerr << "Vector " << vector << " but expected " << expected << std::endl;
+    return false;
+  }
+  return true;
+}
+} // namespace
+
+template <typename PrecisionType>
+int
+runVkPhaseCorrelationImageRegistrationMethodTest()
+{
+  constexpr unsigned int Dimension{ 2 };
+  using ImageType = itk::Image<unsigned char, Dimension>;
+  using RegistrationType = itk::VkPhaseCorrelationImageRegistrationMethod<ImageType, ImageType, PrecisionType>;
+
+  auto registration = RegistrationType::New();
+  ITK_EXERCISE_BASIC_OBJECT_METHODS(registration, VkPhaseCorrelationImageRegistrationMethod, ProcessObject);
+
+  const typename ImageType::Pointer image{ MakeRandomImage<ImageType>({ { 64, 48 } }, 2025, 0.0, 255.0) };
+  const typename ImageType::SpacingType spacing{ 0.5 };
+  image->SetSpacing(spacing);
+
+  // A circular shift is recovered exactly, with a peak of full height when
+  // no padding is needed
+  const typename ImageType::Pointer shifted{ ShiftImage<ImageType>(image, { { -5, 3 } }, { { 64, 48 } }) };
+  shifted->SetOrigin(image->GetOrigin());
+  registration->SetFixedImage(image);
+  registration->SetMovingImage(shifted);
+  ITK_TRY_EXPECT_NO_EXCEPTION(registration->Update());
+  ITK_TEST_EXPECT_TRUE(VectorsAreClose(registration->GetOffset(), MakeTranslation(5.0, -3.0), 1.0e-3));
+  ITK_TEST_EXPECT_TRUE(VectorsAreClose(registration->GetTranslation(), MakeTranslation(2.5, -1.5), 1.0e-3));
+  ITK_TEST_EXPECT_TRUE(registration->GetConfidence() > 0.5);
+  ITK_TEST_EXPECT_EQUAL(registration->GetVkTimings().numberOfRuns, 1u);
+
+  // Crops of different sizes from one image; their origins place them
+  // where they were cut, so they are already aligned physically
+  const typename ImageType::Pointer fixedCrop{ ShiftImage<ImageType>(image, { { 10, 10 } }, { { 40, 30 } }) };
+  const typename ImageType::Pointer movingCrop{ ShiftImage<ImageType>(image, { { 13, 8 } }, { { 36, 32 } }) };
+  registration->SetFixedImage(fixedCrop);
+  registration->SetMovingImage(movingCrop);
+  ITK_TRY_EXPECT_NO_EXCEPTION(registration->Update());
+  ITK_TEST_EXPECT_TRUE(VectorsAreClose(registration->GetOffset(), MakeTranslation(-3.0, 2.0), 0.25));
+  ITK_TEST_EXPECT_TRUE(VectorsAreClose(registration->GetTranslation(), MakeTranslation(0.0, 0.0), 0.125));
+  ITK_TEST_EXPECT_TRUE(registration->GetConfidence() > 0.0);
+  ITK_TEST_EXPECT_EQUAL(registration->GetVkTimings().numberOfRuns, 2u);
+
+  // A sum of a random row and a random column has a spectrum that vanishes exactly off the axes, so the
+  // device normalization gives NaN and the spectra are normalized on the host in two more runs
+  const typename ImageType::Pointer separable{ ImageType::New() };
+  separable->SetRegions(typename ImageType::SizeType{ { 64, 32 } });
+  separable->Allocate();
+  const typename ImageType::Pointer row{ MakeRandomImage<ImageType>({ { 64, 1 } }, 2026, 0.0, 255.0) };
+  const typename ImageType::Pointer column{ MakeRandomImage<ImageType>({ { 1, 32 } }, 2027, 0.0, 255.0) };
+  for (itk::ImageRegionIterator<ImageType> it(separable, separable->GetBufferedRegion()); !it.IsAtEnd(); ++it)
+  {
+    const typename ImageType::IndexType index{ it.GetIndex() };
+    const int                           rowValue{ row->GetPixel({ { index[0], 0 } }) };
+    it.Set(static_cast<unsigned char>(rowValue / 2 + column->GetPixel({ { 0, index[1] } }) / 2));
+  }
+  const typename ImageType::Pointer separableShifted{ ShiftImage<ImageType>(separable, { { -5, 3 } }, { { 64, 32 } }) };
+  separableShifted->SetOrigin(separable->GetOrigin());
+  registration->SetFixedImage(separable);
+  registration->SetMovingImage(separableShifted);
+  ITK_TRY_EXPECT_NO_EXCEPTION(registration->Update());
+  ITK_TEST_EXPECT_TRUE(VectorsAreClose(registration->GetOffset(), MakeTranslation(5.0, -3.0), 1.0e-3));
+  ITK_TEST_EXPECT_TRUE(registration->GetConfidence() > 0.0);
+  ITK_TEST_EXPECT_EQUAL(registration->GetVkTimings().numberOfRuns, 5u);
+
+  return EXIT_SUCCESS;
+}
+
+int
+itkVkPhaseCorrelationImageRegistrationMethodTest(int argc, char * argv[])
+{
+  const std::string precision{ (argc > 1) ? argv[1] : "float" };
+  if (precision == "double")
+  {
+    return runVkPhaseCorrelationImageRegistrationMethodTest<double>();
+  }
+  if (precision == "float")
+  {
+    return runVkPhaseCorrelationImageRegistrationMethodTest<float>();
+  }
+  std::cerr << "Unknown precision '" << precision << "'. Expected 'float' or 'double'." << std::endl;
+  return EXIT_FAILURE;
+}
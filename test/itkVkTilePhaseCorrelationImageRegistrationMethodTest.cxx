@@ -0,0 +1,164 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         https://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkVkTilePhaseCorrelationImageRegistrationMethod.h"
+#include "itkVkTestingHelpers.h"
+
+#include "itkImageRegionIterator.h"
+#include "itkTestingMacros.h"
+
+#include <cmath>
+#include <string>
+#include <vector>
+
+// Verify that the translations of overlapping tiles cut from one image
+// are recovered from nominal offsets, that pairs are correlated in one run
+// per batch of at most MaximumBatchSize, and that pairs with a constant
+// tile keep their nominal offset.
+
+namespace
+{
+template <typename TImage>
+typename TImage::Pointer
+CutTile(const TImage * image, const typename TImage::IndexType & start, const typename TImage::SizeType & size)
+{
+  auto tile = TImage::New();
+  tile->SetRegions(size);
+  tile->Allocate();
+  for (itk::ImageRegionIterator<TImage> it(tile, tile->GetBufferedRegion()); !it.IsAtEnd(); ++it)
+  {
+    it.Set(image->GetPixel(start + (it.GetIndex() - tile->GetBufferedRegion().GetIndex())));
+  }
+  return tile;
+}
+} // namespace
+
+template <typename PrecisionType>
+int
+runVkTilePhaseCorrelationImageRegistrationMethodTest()
+{
+  constexpr unsigned int Dimension{ 2 };
+  using ImageType = itk::Image<float, Dimension>;
+  using RegistrationType = itk::VkTilePhaseCorrelationImageRegistrationMethod<ImageType, PrecisionType>;
+  using IndexType = typename ImageType::IndexType;
+  using OffsetType = typename RegistrationType::OffsetType;
+
+  auto registration = RegistrationType::New();
+  ITK_EXERCISE_BASIC_OBJECT_METHODS(registration, VkTilePhaseCorrelationImageRegistrationMethod, ProcessObject);
+  ITK_TEST_SET_GET_VALUE(64u, registration->GetMaximumBatchSize());
+  registration->SetMaximumBatchSize(5);
+  ITK_TEST_SET_GET_VALUE(5u, registration->GetMaximumBatchSize());
+  typename RegistrationType::SizeType searchRadius;
+  searchRadius.Fill(4);
+  registration->SetSearchRadius(searchRadius);
+  ITK_TEST_SET_GET_VALUE(searchRadius, registration->GetSearchRadius());
+
+  // A 3 x 3 grid of tiles that overlap their neighbors by 10 and 8 pixels
+  const typename ImageType::Pointer image{ MakeRandomImage<ImageType>({ { 100, 80 } }, 2025, 0.0, 1.0) };
+  std::vector<IndexType>            starts;
+  for (itk::IndexValueType row{ 0 }; row < 3; ++row)
+  {
+    for (itk::IndexValueType column{ 0 }; column < 3; ++column)
+    {
+      starts.push_back({ { 30 * column, 24 * row } });
+      registration->SetTileImage(static_cast<unsigned int>(starts.size() - 1),
+                                 CutTile<ImageType>(image, starts.back(), { { 40, 32 } }));
+    }
+  }
+  ITK_TEST_EXPECT_EQUAL(registration->GetNumberOfTileImages(), 9u);
+
+  // Pair each tile with its right and lower neighbors, with nominal
+  // offsets a few pixels from the true ones
+  std::vector<OffsetType> expectedOffsets;
+  for (unsigned int n{ 0 }; n < starts.size(); ++n)
+  {
+    for (const unsigned int neighbor : { n + 1, n + 3 })
+    {
+      if (neighbor >= starts.size() || (neighbor == n + 1 && n % 3 == 2))
+      {
+        continue;
+      }
+      const OffsetType expectedOffset{ starts[n] - starts[neighbor] };
+      const OffsetType nominalOffset{ { expectedOffset[0] + 2, expectedOffset[1] - 3 } };
+      registration->AddTilePair(n, neighbor, nominalOffset);
+      expectedOffsets.push_back(expectedOffset);
+    }
+  }
+  ITK_TEST_EXPECT_EQUAL(registration->GetTilePairs().size(), 12u);
+
+  // Three batches of pairs, one run each
+  ITK_TRY_EXPECT_NO_EXCEPTION(registration->Update());
+  ITK_TEST_EXPECT_EQUAL(registration->GetVkTimings().numberOfRuns, 3u);
+  ITK_TEST_EXPECT_EQUAL(registration->GetResults().size(), expectedOffsets.size());
+  for (unsigned int n{ 0 }; n < expectedOffsets.size(); ++n)
+  {
+    const auto & result{ registration->GetResults()[n] };
+    for (unsigned int dim{ 0 }; dim < Dimension; ++dim)
+    {
+      if (std::abs(result.offset[dim] - expectedOffsets[n][dim]) > 0.25)
+      {
+        std::cerr << "Pair " << n << " has offset " << result.offset << " but expected " << expectedOffsets[n]
+                  << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+    ITK_TEST_EXPECT_TRUE(result.confidence > 0.0);
+  }
+
+  // A constant tile has no phase to correlate, and its pair is not transformed
+  auto constantTile = ImageType::New();
+  constantTile->SetRegions(typename ImageType::SizeType{ { 40, 32 } });
+  constantTile->Allocate();
+  constantTile->FillBuffer(0.5f);
+  registration->SetTileImage(9, constantTile);
+  registration->ClearTilePairs();
+  const OffsetType constantNominalOffset{ { -30, 0 } };
+  registration->AddTilePair(0, 9, constantNominalOffset);
+  registration->AddTilePair(0, 1, constantNominalOffset);
+  registration->ResetVkTimings();
+  ITK_TRY_EXPECT_NO_EXCEPTION(registration->Update());
+  ITK_TEST_EXPECT_EQUAL(registration->GetVkTimings().numberOfRuns, 1u);
+  ITK_TEST_EXPECT_EQUAL(registration->GetResults()[0].offset[0], -30.0);
+  ITK_TEST_EXPECT_EQUAL(registration->GetResults()[0].confidence, 0.0);
+  ITK_TEST_EXPECT_TRUE(std::abs(registration->GetResults()[1].offset[0] - expectedOffsets[0][0]) < 0.25);
+
+  // Without pairs, nothing is transformed
+  registration->ResetVkTimings();
+  registration->ClearTilePairs();
+  ITK_TRY_EXPECT_NO_EXCEPTION(registration->Update());
+  ITK_TEST_EXPECT_TRUE(registration->GetResults().empty());
+  ITK_TEST_EXPECT_EQUAL(registration->GetVkTimings().numberOfRuns, 0u);
+
+  return EXIT_SUCCESS;
+}
+
+int
+itkVkTilePhaseCorrelationImageRegistrationMethodTest(int argc, char * argv[])
+{
+  const std::string precision{ (argc > 1) ? argv[1] : "float" };
+  if (precision == "double")
+  {
+    return runVkTilePhaseCorrelationImageRegistrationMethodTest<double>();
+  }
+  if (precision == "float")
+  {
+    return runVkTilePhaseCorrelationImageRegistrationMethodTest<float>();
+  }
+  std::cerr << "Unknown precision '" << precision << "'. Expected 'float' or 'double'." << std::endl;
+  return EXIT_FAILURE;
+}
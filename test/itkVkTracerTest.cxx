@@ -0,0 +1,114 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         https://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <string>
+
+#include "itkVkDiscreteGaussianImageFilter.h"
+#include "itkVkGlobalConfiguration.h"
+#include "itkVkTracer.h"
+#include "itkImage.h"
+#include "itkTestingMacros.h"
+
+// Verify that VkTracer writes Chrome trace events for Vk filter activity.
+// Only spatial blurring is run so no GPU is required.
+
+template <typename PrecisionType>
+int
+runVkTracerTest(const std::string & traceFileName)
+{
+  constexpr unsigned int Dimension = 2;
+  using ImageType = itk::Image<PrecisionType, Dimension>;
+
+  itk::VkGlobalConfiguration::SetTraceFileName(traceFileName);
+  ITK_TEST_SET_GET_VALUE(traceFileName, itk::VkGlobalConfiguration::GetTraceFileName());
+  ITK_TEST_EXPECT_TRUE(itk::VkTracer::IsEnabled());
+
+  {
+    const itk::VkTraceScope traceScope{ "TestScope", "test", 3 };
+    itk::VkTracer::AddInstantEvent("TestInstant", "test", 3, "\"value\":1");
+  }
+
+  // JSON has no infinity or NaN
+  ITK_TEST_EXPECT_EQUAL(itk::VkTracer::FormatNumber(2.5), "2.5");
+  ITK_TEST_EXPECT_EQUAL(itk::VkTracer::FormatNumber(std::numeric_limits<double>::infinity()), "\"inf\"");
+  ITK_TEST_EXPECT_EQUAL(itk::VkTracer::FormatNumber(-std::numeric_limits<double>::infinity()), "\"-inf\"");
+  ITK_TEST_EXPECT_EQUAL(itk::VkTracer::FormatNumber(std::numeric_limits<double>::quiet_NaN()), "\"nan\"");
+
+  auto image = ImageType::New();
+  image->SetRegions(typename ImageType::SizeType{ { 32, 32 } });
+  image->Allocate();
+  image->FillBuffer(1.0);
+
+  using FilterType = itk::VkDiscreteGaussianImageFilter<ImageType, ImageType>;
+  auto filter = FilterType::New();
+  filter->SetInput(image);
+  filter->SetVariance(1.0);
+  filter->SetAnticipatedPerformanceMetricThreshold(100.0f);
+  ITK_TRY_EXPECT_NO_EXCEPTION(filter->Update());
+  ITK_TEST_EXPECT_TRUE(!filter->GetLastRunUsedFFT());
+
+  // Close the trace and disable tracing
+  itk::VkGlobalConfiguration::SetTraceFileName("");
+  ITK_TEST_EXPECT_TRUE(!itk::VkTracer::IsEnabled());
+  itk::VkTracer::AddInstantEvent("Ignored", "test", 0);
+
+  std::ifstream      traceFile(traceFileName.c_str());
+  std::ostringstream contents;
+  contents << traceFile.rdbuf();
+  const std::string trace{ contents.str() };
+  std::cout << trace << std::endl;
+
+  ITK_TEST_EXPECT_TRUE(trace.front() == '[');
+  ITK_TEST_EXPECT_TRUE(trace.find(']') != std::string::npos);
+  ITK_TEST_EXPECT_TRUE(trace.find("\"name\":\"TestScope\",\"cat\":\"test\",\"ph\":\"X\"") != std::string::npos);
+  ITK_TEST_EXPECT_TRUE(trace.find("\"name\":\"TestInstant\",\"cat\":\"test\",\"ph\":\"i\"") != std::string::npos);
+  ITK_TEST_EXPECT_TRUE(trace.find("\"args\":{\"deviceID\":3,\"value\":1}") != std::string::npos);
+  ITK_TEST_EXPECT_TRUE(trace.find("\"name\":\"VkDiscreteGaussianImageFilter\"") != std::string::npos);
+  ITK_TEST_EXPECT_TRUE(trace.find("\"name\":\"BlurringDecision\"") != std::string::npos);
+  ITK_TEST_EXPECT_TRUE(trace.find("\"useFFT\":false") != std::string::npos);
+  ITK_TEST_EXPECT_TRUE(trace.find("\"tid\":") != std::string::npos);
+  ITK_TEST_EXPECT_TRUE(trace.find("Ignored") == std::string::npos);
+
+  return EXIT_SUCCESS;
+}
+
+int
+itkVkTracerTest(int argc, char * argv[])
+{
+  if (argc < 3)
+  {
+    std::cerr << "Missing parameters." << std::endl;
+    std::cerr << "Usage: " << itkNameOfTestExecutableMacro(argv) << " <float|double> traceFileName" << std::endl;
+    return EXIT_FAILURE;
+  }
+  const std::string precision{ argv[1] };
+  if (precision == "double")
+  {
+    return runVkTracerTest<double>(argv[2]);
+  }
+  if (precision == "float")
+  {
+    return runVkTracerTest<float>(argv[2]);
+  }
+  std::cerr << "Unknown precision '" << precision << "'. Expected 'float' or 'double'." << std::endl;
+  return EXIT_FAILURE;
+}
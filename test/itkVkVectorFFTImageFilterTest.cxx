@@ -0,0 +1,185 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         https://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+
+#include "itkVkForwardFFTImageFilter.h"
+#include "itkVkVectorForwardFFTImageFilter.h"
+#include "itkVkVectorInverseFFTImageFilter.h"
+
+#include "itkImageRegionConstIterator.h"
+#include "itkImageRegionIterator.h"
+#include "itkMersenneTwisterRandomVariateGenerator.h"
+#include "itkTestingMacros.h"
+#include "itkVectorImage.h"
+#include "itkVectorIndexSelectionCastImageFilter.h"
+
+#include <string>
+
+// Verify that the components of vector images are transformed in a single
+// run as each component would be on its own, for Image of Vector and
+// VectorImage inputs, and that the inverse transform recovers the input.
+
+namespace
+{
+template <typename TImage>
+void
+FillRandom(TImage * image, int seed)
+{
+  auto generator = itk::Statistics::MersenneTwisterRandomVariateGenerator::New();
+  generator->Initialize(seed);
+  for (itk::ImageRegionIterator<TImage> it(image, image->GetBufferedRegion()); !it.IsAtEnd(); ++it)
+  {
+    typename TImage::PixelType pixel{ it.Get() };
+    for (unsigned int component{ 0 }; component < image->GetNumberOfComponentsPerPixel(); ++component)
+    {
+      pixel[component] = generator->GetUniformVariate(-1.0, 1.0);
+    }
+    it.Set(pixel);
+  }
+}
+
+// Compare each component of the vector spectrum with the transform of that component
+template <typename TVectorImage, typename TSpectrum>
+bool
+ComponentsMatchScalarTransforms(const TVectorImage * image, const TSpectrum * spectrum, double tolerance)
+{
+  using RealType = typename itk::NumericTraits<typename TVectorImage::PixelType>::ValueType;
+  using RealImageType = itk::Image<RealType, TVectorImage::ImageDimension>;
+  using ComplexImageType = itk::Image<std::complex<RealType>, TVectorImage::ImageDimension>;
+  using SelectFilterType = itk::VectorIndexSelectionCastImageFilter<TVectorImage, RealImageType>;
+  using ForwardFilterType = itk::VkForwardFFTImageFilter<RealImageType, ComplexImageType>;
+
+  bool matches{ true };
+  for (unsigned int component{ 0 }; component < image->GetNumberOfComponentsPerPixel(); ++component)
+  {
+    auto select = SelectFilterType::New();
+    select->SetInput(image);
+    select->SetIndex(component);
+    auto forward = ForwardFilterType::New();
+    forward->SetInput(select->GetOutput());
+    forward->Update();
+
+    itk::ImageRegionConstIterator<TSpectrum>        vectorIt(spectrum, spectrum->GetBufferedRegion());
+    itk::ImageRegionConstIterator<ComplexImageType> scalarIt(forward->GetOutput(),
+                                                             forward->GetOutput()->GetBufferedRegion());
+    for (; !scalarIt.IsAtEnd(); ++vectorIt, ++scalarIt)
+    {
+      if (std::abs(vectorIt.Get()[component] - scalarIt.Get()) > tolerance)
+      {
+        std::cerr << "Component " << component << " differs at " << scalarIt.GetIndex() << ": "
+                  << vectorIt.Get()[component] << " vs " << scalarIt.Get() << std::endl;
+        matches = false;
+      }
+    }
+  }
+  return matches;
+}
+
+template <typename TImage>
+bool
+RoundTripMatches(const TImage * image, const TImage * roundTrip, double tolerance)
+{
+  itk::ImageRegionConstIterator<TImage> it(image, image->GetBufferedRegion());
+  itk::ImageRegionConstIterator<TImage> rit(roundTrip, roundTrip->GetBufferedRegion());
+  for (; !it.IsAtEnd(); ++it, ++rit)
+  {
+    for (unsigned int component{ 0 }; component < image->GetNumberOfComponentsPerPixel(); ++component)
+    {
+      if (std::abs(it.Get()[component] - rit.Get()[component]) > tolerance)
+      {
+        std::cerr << "Round trip differs at " << it.GetIndex() << std::endl;
+        return false;
+      }
+    }
+  }
+  return true;
+}
+} // namespace
+
+template <typename PrecisionType>
+int
+runVkVectorFFTImageFilterTest()
+{
+  constexpr unsigned int Dimension{ 2 };
+  const double           tolerance{ 1.0e-3 };
+
+  // A displacement field as an Image of Vector pixels
+  using FieldType = itk::Image<itk::Vector<PrecisionType, Dimension>, Dimension>;
+  using FieldForwardType = itk::VkVectorForwardFFTImageFilter<FieldType>;
+  using SpectrumType = typename FieldForwardType::OutputImageType;
+  using FieldInverseType = itk::VkVectorInverseFFTImageFilter<SpectrumType, FieldType>;
+
+  auto field = FieldType::New();
+  field->SetRegions(typename FieldType::SizeType{ { 9, 12 } });
+  field->Allocate();
+  FillRandom(field.GetPointer(), 2025);
+
+  auto fieldForward = FieldForwardType::New();
+  ITK_EXERCISE_BASIC_OBJECT_METHODS(fieldForward, VkVectorForwardFFTImageFilter, ImageToImageFilter);
+  fieldForward->SetInput(field);
+  ITK_TRY_EXPECT_NO_EXCEPTION(fieldForward->Update());
+  ITK_TEST_EXPECT_EQUAL(fieldForward->GetOutput()->GetNumberOfComponentsPerPixel(), Dimension);
+  ITK_TEST_EXPECT_EQUAL(fieldForward->GetVkTimings().numberOfRuns, 1u);
+  ITK_TEST_EXPECT_TRUE(ComponentsMatchScalarTransforms(field.GetPointer(), fieldForward->GetOutput(), tolerance));
+
+  auto fieldInverse = FieldInverseType::New();
+  ITK_EXERCISE_BASIC_OBJECT_METHODS(fieldInverse, VkVectorInverseFFTImageFilter, ImageToImageFilter);
+  fieldInverse->SetInput(fieldForward->GetOutput());
+  ITK_TRY_EXPECT_NO_EXCEPTION(fieldInverse->Update());
+  ITK_TEST_EXPECT_EQUAL(fieldInverse->GetVkTimings().numberOfRuns, 1u);
+  ITK_TEST_EXPECT_TRUE(RoundTripMatches(field.GetPointer(), fieldInverse->GetOutput(), tolerance));
+
+  // A multi-channel VectorImage
+  using VectorImageType = itk::VectorImage<PrecisionType, Dimension>;
+  using VectorForwardType = itk::VkVectorForwardFFTImageFilter<VectorImageType>;
+  using VectorInverseType = itk::VkVectorInverseFFTImageFilter<typename VectorForwardType::OutputImageType>;
+
+  auto channels = VectorImageType::New();
+  channels->SetRegions(typename VectorImageType::SizeType{ { 16, 7 } });
+  channels->SetNumberOfComponentsPerPixel(5);
+  channels->Allocate();
+  FillRandom(channels.GetPointer(), 2026);
+
+  auto vectorForward = VectorForwardType::New();
+  vectorForward->SetInput(channels);
+  ITK_TRY_EXPECT_NO_EXCEPTION(vectorForward->Update());
+  ITK_TEST_EXPECT_EQUAL(vectorForward->GetOutput()->GetNumberOfComponentsPerPixel(), 5u);
+  ITK_TEST_EXPECT_TRUE(ComponentsMatchScalarTransforms(channels.GetPointer(), vectorForward->GetOutput(), tolerance));
+
+  auto vectorInverse = VectorInverseType::New();
+  vectorInverse->SetInput(vectorForward->GetOutput());
+  ITK_TRY_EXPECT_NO_EXCEPTION(vectorInverse->Update());
+  ITK_TEST_EXPECT_TRUE(RoundTripMatches(channels.GetPointer(), vectorInverse->GetOutput(), tolerance));
+
+  return EXIT_SUCCESS;
+}
+
+int
+itkVkVectorFFTImageFilterTest(int argc, char * argv[])
+{
+  const std::string precision{ (argc > 1) ? argv[1] : "float" };
+  if (precision == "double")
+  {
+    return runVkVectorFFTImageFilterTest<double>();
+  }
+  if (precision == "float")
+  {
+    return runVkVectorFFTImageFilterTest<float>();
+  }
+  std::cerr << "Unknown precision '" << precision << "'. Expected 'float' or 'double'." << std::endl;
+  return EXIT_FAILURE;
+}
@@ -0,0 +1,41 @@
+# ==========================================================================
+#
+#   Copyright NumFOCUS
+#
+#   Licensed under the Apache License, Version 2.0 (the "License");
+#   you may not use this file except in compliance with the License.
+#   You may obtain a copy of the License at
+#
+#          https://www.apache.org/licenses/LICENSE-2.0.txt
+#
+#   Unless required by applicable law or agreed to in writing, software
+#   distributed under the License is distributed on an "AS IS" BASIS,
+#   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+#   See the License for the specific language governing permissions and
+#   limitations under the License.
+#
+
+# Verify that a stacked NumPy array is transformed as one batch without
+# copying the input and that results are written into a preallocated array
+
+import numpy as np
+
+import itk
+
+batch_size = 4
+image_shape = (6, 8)
+rng = np.random.default_rng(2024)
+stacked = rng.random((batch_size,) + image_shape, dtype=np.float32)
+result = np.zeros(stacked.shape, dtype=np.complex64)
+
+# NumPy axis 0 is the last ITK image dimension, which indexes the batch
+input_view = itk.image_view_from_array(stacked)
+output_view = itk.image_view_from_array(result)
+
+batch_filter = itk.VkBatchForwardFFTImageFilter[type(input_view)].New()
+batch_filter.SetInput(input_view)
+batch_filter.GraftOutput(output_view)
+batch_filter.Update()
+
+expected = np.fft.fftn(stacked, axes=(1, 2))
+assert np.allclose(result, expected, rtol=1e-4, atol=1e-4)